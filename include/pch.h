@@ -77,6 +77,8 @@ using Microsoft::WRL::ComPtr;
 #include <thread>
 #include <chrono>
 #include <algorithm>
+#include <bit>
+#include <span>
 #include <cctype>
 
 inline glm::fvec2 ToGLM(const XrVector2f& vec) {
@@ -10,6 +10,7 @@ moduleMatches = 0x6267BFD0
 ;   - one major issue that the Actor::update() is also filtered, but Actor::update() is also responsible for requesting a draw and adding themselves into the gsys::ModelSceneContext. However, Actor::update() also requests the actor to be drawn, which
 ; - preventUnrequestingDraw and preventModelQueueClear are used to prevent the game from clearing the model queue at the start of the right eye rendering. This way they're still rendered despite the Actor::update() being filtered.
 ; - agl__lyr__Layer__getRenderCamera and agl__lyr__Layer__getRenderProjection are hooked to modify the draw calls for the left and right eye. The modifified camera and projection matrix data is computed by combining from OpenXR and the game's camera
+; - with alternate-eye rendering, hook_PlanEyeRendering can skip the second pass (its calcDraw, and the procDraw at the start of the next frame). The C++ hooks then treat the first pass as whichever eye was picked for that frame.
 
 ; This modification causes the game to do all the draw calls for all actors, and then present that to the regular screen twice. The Vulkan layer waits for Cemu to draw to the regular screen twice, after which it has obtained both the rendered images for both eyes.
 ; Its not as optimized as it could be since Cemu has to translate the draw calls twice which is usually the bottleneck for emulation, but it provides a great stable image which can later be interpolated so that performance is less of an issue.
@@ -21,6 +22,10 @@ currentEyeSide:
 currentFrameCounter:
 .int 0
 
+; Set by hook_PlanEyeRendering every frame. With alternate-eye rendering only the first pass runs, and it renders whichever eye the mod picked.
+renderSecondEye:
+.int 1
+
 0x10463EB0 = FadeProgress__sInstance:
 0x031FB1B4 = sub_31FB1B4_getTimeForGameUpdateMaybe:
 0x0309F72C = sead_GameFramework_lockFrameDrawContext:
@@ -133,12 +138,20 @@ bctrl ; bl calculateUIMaybe
 ; FIRST EYE SIDE
 ; ========================================================================
 
+; this draws the second eye of the previous frame, so skip it when that eye wasn't calculated
+lis r12, renderSecondEye@ha
+lwz r0, renderSecondEye@l(r12)
+cmpwi r0, 0
+beq skipSecondEyeDraw
+
 lwz r12, 0(r30)
 lwz r0, 0xF4(r12)
 mtctr r0
 mr r3, r30
 bctrl ; sead__GameFrameworkCafe__procDraw
 
+skipSecondEyeDraw:
+
 ; doesn't seem to be necessary
 ;bl import.gx2.GX2DrawDone
 
@@ -158,6 +171,11 @@ li r3, 0
 skip_resetFrameCounter:
 stw r3, currentFrameCounter@l(r12)
 
+; decide whether this frame renders both eyes, r3 is the frame counter and returns 0 to skip the second pass
+bl import.coreinit.hook_PlanEyeRendering
+lis r12, renderSecondEye@ha
+stw r3, renderSecondEye@l(r12)
+
 ; start rendering for the left eye
 li r0, 0
 lis r12, currentEyeSide@ha
@@ -223,6 +241,10 @@ skipStallDuringLoadingScreens_one:
 li r3, 0
 bl import.coreinit.hook_EndCameraSide
 
+lis r12, renderSecondEye@ha
+lwz r0, renderSecondEye@l(r12)
+cmpwi r0, 0
+beq skipSecondEyeCalc
 
 li r0, 1
 lis r12, currentEyeSide@ha
@@ -242,6 +264,7 @@ mtctr r0
 mr r3, r30
 bctrl ; sead__Framework__procReset
 
+skipSecondEyeCalc:
 lwz r12, 0x74(r30)
 clrlwi. r11, r12, 31
 li r31, 1
@@ -2,6 +2,8 @@
 #include "instance.h"
 #include "rendering/openxr.h"
 #include "utils/debug_draw.h"
+#include "utils/endian_convert_glm.h"
+#include "utils/frame_trace.h"
 
 bool CemuHooks::UseMonoFrameBufferTemporarilyDuringMenusOrPictures() {
     return IsScreenOpen(ScreenId::PauseMenuInfo_00) || VRManager::instance().XR->GetRenderer()->IsGameCapturing3DFrameBuffer();
@@ -14,7 +16,40 @@ void CemuHooks::hook_BeginCameraSide(PPCInterpreter_t* hCPU) {
 
     Log::print<RENDERING>("");
     Log::print<RENDERING>("===============================================================================");
-    Log::print<RENDERING>("{0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0}", side);
+    LOG_LAZY(RENDERING, "{0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0}", side);
+}
+
+EyeScheduler CemuHooks::s_eyeScheduler;
+std::atomic<EyeScheduler::Plan> CemuHooks::s_currentEyePlan = EyeScheduler::Plan::BOTH;
+
+void CemuHooks::hook_PlanEyeRendering(PPCInterpreter_t* hCPU) {
+    hCPU->instructionPointer = hCPU->sprNew.LR;
+
+    const uint32_t frameCounter = hCPU->gpr[3];
+    auto* renderer = VRManager::instance().XR->GetRenderer();
+
+    // only gameplay alternates, menus, cutscenes and photos keep rendering both eyes
+    EyeScheduler::Input input = {
+        .allowed = GetSettings().UseAlternateEyeRendering() && renderer && renderer->IsInitialized() && IsInGame() && !HasActiveCutscene() && !UseMonoFrameBufferTemporarilyDuringMenusOrPictures(),
+        .timeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count()
+    };
+    if (auto headPose = renderer ? renderer->GetPose(OpenXR::EyeSide::LEFT) : std::nullopt; headPose.has_value()) {
+        input.headOrientation = ToGLM(headPose->orientation);
+    }
+    else {
+        input.allowed = false;
+    }
+
+    const EyeScheduler::Plan plan = s_eyeScheduler.Next(input);
+    s_currentEyePlan = plan;
+    // the game starts the frame here, so its slot is acquired now and the Vulkan hooks find it once Cemu records the frame
+    if (renderer && renderer->IsInitialized()) {
+        renderer->GetFrame(renderer->AcquireFrameSlot(frameCounter)).eyePlan = plan;
+    }
+    Log::print<RENDERING>("[{}] Eye plan: {} (head speed {:.2f} rad/s)", frameCounter, EyeScheduler::GetPlanName(plan), s_eyeScheduler.GetAngularSpeed());
+
+    // tells the stereo rendering patch whether to run the second rendering pass
+    hCPU->gpr[3] = EyeScheduler::RendersBothEyes(plan) ? 1 : 0;
 }
 
 static std::pair<glm::quat, glm::quat> swingTwistY(const glm::quat& q) {
@@ -88,6 +123,41 @@ uint32_t s_isLadderClimbing = 0;
 uint32_t s_isRiding = 0;
 uint32_t s_isRidingSandSeal = 0;
 
+EpochSnapshot<CemuHooks::FrameSnapshot> CemuHooks::s_frameSnapshot;
+
+// called for every bone, so it only costs an atomic load once the snapshot of this frame was published
+const CemuHooks::FrameSnapshot& CemuHooks::GetFrameSnapshot() {
+    return s_frameSnapshot.Get(s_frameEpoch, ReadPlayerIntoFrameSnapshot);
+}
+
+const CemuHooks::FrameSnapshot& CemuHooks::RefreshFrameSnapshot() {
+    return s_frameSnapshot.Publish(s_frameEpoch, ReadPlayerIntoFrameSnapshot);
+}
+
+// the camera fields are kept from the previous version, since they're only ever updated by hook_UpdateCameraForGameplay
+void CemuHooks::ReadPlayerIntoFrameSnapshot(FrameSnapshot& snapshot) {
+    snapshot.hasPlayer = s_playerAddress != 0;
+    if (snapshot.hasPlayer) {
+        // only read the two fields that are needed instead of the whole Player struct
+        snapshot.playerMtx = EndianConvert::ToLE(getMemory<BEMatrix34>(s_playerAddress + offsetof(ActorWiiU, mtx)));
+        snapshot.playerMtxInverse = glm::inverse(glm::fmat4(snapshot.playerMtx));
+        snapshot.playerPos = snapshot.playerMtx[3];
+        snapshot.playerRot = glm::quat_cast(glm::fmat3(snapshot.playerMtx));
+        snapshot.moveBits = getMemory<BEType<PlayerMoveBitFlags>>(s_playerAddress + offsetof(PlayerBase, moveBitFlags)).getLE();
+    }
+}
+
+void CemuHooks::UpdateFrameSnapshotCamera(const glm::fvec3& position, const glm::fquat& rotation) {
+    const glm::fmat4 cameraMtx = ToMat4(position, rotation);
+    const glm::fmat4 cameraMtxInverse = glm::inverse(cameraMtx);
+    s_frameSnapshot.Update([&](FrameSnapshot& snapshot) {
+        snapshot.cameraPos = position;
+        snapshot.cameraRot = rotation;
+        snapshot.cameraMtx = cameraMtx;
+        snapshot.cameraMtxInverse = cameraMtxInverse;
+    });
+}
+
 void CemuHooks::hook_UpdateCameraForGameplay(PPCInterpreter_t* hCPU) {
     hCPU->instructionPointer = hCPU->sprNew.LR;
 
@@ -101,6 +171,15 @@ void CemuHooks::hook_UpdateCameraForGameplay(PPCInterpreter_t* hCPU) {
     ActCamera actCam = {};
     readMemory(ppc_cameraMatrixOffsetIn, &actCam);
 
+#if ENABLE_FRAME_TRACE
+    // both eyes render the same game frame, so the left eye's update starts the flow that ends at xrEndFrame
+    if (side == EyeSide::LEFT) {
+        const uint64_t flowId = FrameTrace::NewFlowId();
+        FrameTrace::FlowStart("Camera update", flowId);
+        VRManager::instance().XR->GetRenderer()->SetCameraTraceFlowId(flowId);
+    }
+#endif
+
     // extract components from the existing camera matrix
     glm::fvec3 oldCameraPosition = actCam.finalCamMtx.pos.getLE();
     glm::fvec3 oldCameraTarget = actCam.finalCamMtx.target.getLE();
@@ -124,14 +203,15 @@ void CemuHooks::hook_UpdateCameraForGameplay(PPCInterpreter_t* hCPU) {
     // GetRenderCamera recalculates the left and right eye positions from the base camera position
     s_wsCameraPosition = oldCameraPosition;
     s_wsCameraRotation = glm::quat_cast(glm::inverse(existingGameMtx));
+    UpdateFrameSnapshotCamera(s_wsCameraPosition, s_wsCameraRotation);
+
+    // the player has moved for this frame by now, so the rest of the frame's hooks can reuse this
+    const FrameSnapshot& snapshot = RefreshFrameSnapshot();
 
     // rebase the rotation to the player position
-    if (IsFirstPerson()) {
+    if (IsFirstPerson() && snapshot.hasPlayer) {
         // check if player is swimming
-        Player actor;
-        readMemory(s_playerAddress, &actor);
-
-        PlayerMoveBitFlags moveBits = actor.moveBitFlags.getLE();
+        PlayerMoveBitFlags moveBits = snapshot.moveBits;
         s_isSwimming = HAS_FLAG(moveBits, PlayerMoveBitFlags::IS_SWIMMING_OR_CLIMBING | PlayerMoveBitFlags::IS_SWIMMING);
         s_isCrouching = HAS_FLAG(moveBits, PlayerMoveBitFlags::IS_CROUCHING);
 
@@ -165,9 +245,7 @@ void CemuHooks::hook_UpdateCameraForGameplay(PPCInterpreter_t* hCPU) {
             actualCrouchOffset = s_isCrouching ? test : 0.0f;
         }
 
-        // read player MTX
-        BEMatrix34& mtx = actor.mtx;
-        glm::fvec3 playerPos = actor.mtx.getPos().getLE();
+        glm::fvec3 playerPos = snapshot.playerPos;
 
         if (s_isRiding) {
             playerPos.y -= hardcodedRidingOffset;
@@ -183,9 +261,9 @@ void CemuHooks::hook_UpdateCameraForGameplay(PPCInterpreter_t* hCPU) {
 
         if (auto eventSettings = GetFirstPersonSettingsForActiveEvent()) {
             if (eventSettings->ignoreCameraRotation) {
-                glm::fquat playerRot = mtx.getRotLE();
-                auto [swing, baseYaw] = swingTwistY(playerRot);
+                auto [swing, baseYaw] = swingTwistY(snapshot.playerRot);
                 s_wsCameraRotation = baseYaw * glm::angleAxis(glm::radians(180.0f), glm::fvec3(0.0f, 1.0f, 0.0f));
+                UpdateFrameSnapshotCamera(s_wsCameraPosition, s_wsCameraRotation);
             }
         }
 
@@ -278,7 +356,7 @@ void CemuHooks::hook_GetRenderCamera(PPCInterpreter_t* hCPU) {
     hCPU->instructionPointer = hCPU->sprNew.LR;
     uint32_t cameraIn = hCPU->gpr[3];
     uint32_t cameraOut = hCPU->gpr[12];
-    EyeSide side = hCPU->gpr[11] == 0 ? EyeSide::LEFT : EyeSide::RIGHT;
+    EyeSide side = (EyeSide)GetRenderedEye(hCPU->gpr[11] == 0 ? EyeSide::LEFT : EyeSide::RIGHT);
 
     if (UseBlackBarsDuringEvents()) {
         return;
@@ -298,16 +376,15 @@ void CemuHooks::hook_GetRenderCamera(PPCInterpreter_t* hCPU) {
     glm::quat baseRot = glm::quat_cast(worldGame);
 
     // overwrite with our stored camera pos/rot
-    basePos = s_wsCameraPosition;
-    baseRot = s_wsCameraRotation;
+    const FrameSnapshot& snapshot = GetFrameSnapshot();
+    basePos = snapshot.cameraPos;
+    baseRot = snapshot.cameraRot;
     auto [swing, baseYaw] = swingTwistY(baseRot);
     glm::fquat baseYawWithoutClimbingFix = baseYaw;
 
-    if (IsFirstPerson()) {
+    if (IsFirstPerson() && snapshot.hasPlayer) {
         // take link's direction, then rotate the headset position
-        BEMatrix34 playerMtx = {};
-        readMemory(s_playerMtxAddress, &playerMtx);
-        glm::fvec3 playerPos = playerMtx.getPos().getLE();
+        glm::fvec3 playerPos = snapshot.playerPos;
 
         if (s_isRiding) {
             playerPos.y -= hardcodedRidingOffset;
@@ -323,8 +400,7 @@ void CemuHooks::hook_GetRenderCamera(PPCInterpreter_t* hCPU) {
         if (auto eventSettings = GetFirstPersonSettingsForActiveEvent()) {
 
             if (eventSettings->ignoreCameraRotation) {
-                glm::fquat playerRot = playerMtx.getRotLE();
-                auto [swing, yaw] = swingTwistY(playerRot);
+                auto [swing, yaw] = swingTwistY(snapshot.playerRot);
                 baseYaw = yaw * glm::angleAxis(glm::radians(180.0f), glm::fvec3(0.0f, 1.0f, 0.0f));
                 baseYawWithoutClimbingFix = yaw * glm::angleAxis(glm::radians(180.0f), glm::fvec3(0.0f, 1.0f, 0.0f));
             }
@@ -397,7 +473,7 @@ void CemuHooks::hook_GetRenderProjection(PPCInterpreter_t* hCPU) {
 
     uint32_t projectionIn = hCPU->gpr[3];
     uint32_t projectionOut = hCPU->gpr[12];
-    OpenXR::EyeSide side = hCPU->gpr[0] == 0 ? EyeSide::LEFT : EyeSide::RIGHT;
+    OpenXR::EyeSide side = (EyeSide)GetRenderedEye(hCPU->gpr[0] == 0 ? EyeSide::LEFT : EyeSide::RIGHT);
 
     BESeadPerspectiveProjection perspectiveProjection = {};
     readMemory(projectionIn, &perspectiveProjection);
@@ -466,7 +542,7 @@ void CemuHooks::hook_ModifyLightPrePassProjectionMatrix(PPCInterpreter_t* hCPU)
     }
 
     uint32_t projectionIn = hCPU->gpr[3];
-    OpenXR::EyeSide side = hCPU->gpr[11] == 0 ? EyeSide::LEFT : EyeSide::RIGHT;
+    OpenXR::EyeSide side = (EyeSide)GetRenderedEye(hCPU->gpr[11] == 0 ? EyeSide::LEFT : EyeSide::RIGHT);
 
     BESeadPerspectiveProjection perspectiveProjection = {};
     readMemory(projectionIn, &perspectiveProjection);
@@ -533,7 +609,7 @@ void CemuHooks::hook_ModifyProjectionUsingCamera(PPCInterpreter_t* hCPU) {
 
     uint32_t projectionPtr = hCPU->gpr[4];
     uint32_t cameraPtr = hCPU->gpr[7];
-    OpenXR::EyeSide side = hCPU->gpr[5] == 0 ? EyeSide::LEFT : EyeSide::RIGHT;
+    OpenXR::EyeSide side = (EyeSide)GetRenderedEye(hCPU->gpr[5] == 0 ? EyeSide::LEFT : EyeSide::RIGHT);
 
     // this is always true, since we currently only hook one caller
     if (hCPU->gpr[6] == 0x02C43454) {
@@ -549,19 +625,16 @@ void CemuHooks::hook_ModifyProjectionUsingCamera(PPCInterpreter_t* hCPU) {
         glm::quat baseRot = glm::quat_cast(worldGame);
 
         // ignore the current rotation since it is already changed by the gameplay camera hooking
-        baseRot = s_wsCameraRotation;
+        const FrameSnapshot& snapshot = GetFrameSnapshot();
+        baseRot = snapshot.cameraRot;
         auto [swing, baseYaw] = swingTwistY(baseRot);
 
-        if (IsFirstPerson()) {
+        if (IsFirstPerson() && snapshot.hasPlayer) {
             // take link's direction, then rotate the headset position
-            BEMatrix34 playerMtx = {};
-            readMemory(s_playerMtxAddress, &playerMtx);
-
             if (auto eventSettings = GetFirstPersonSettingsForActiveEvent()) {
 
                 if (eventSettings->ignoreCameraRotation) {
-                    glm::fquat playerRot = playerMtx.getRotLE();
-                    auto [swing, yaw] = swingTwistY(playerRot);
+                    auto [swing, yaw] = swingTwistY(snapshot.playerRot);
                     baseYaw = yaw * glm::angleAxis(glm::radians(180.0f), glm::fvec3(0.0f, 1.0f, 0.0f));
                 }
             }
@@ -638,23 +711,16 @@ void CemuHooks::hook_ModifyProjectionUsingCamera(PPCInterpreter_t* hCPU) {
     writeMemory(projectionPtr, &perspectiveProjection);
 }
 
-std::pair<glm::vec3, glm::fquat> CemuHooks::CalculateVRWorldPose(const BESeadLookAtCamera& camera, uint8_t side) {
-    // in-game camera
-    glm::mat4x3 viewMatrix = camera.mtx.getLEMatrix();
-    glm::mat4 worldGame = glm::inverse(glm::mat4(viewMatrix));
-    glm::vec3 basePos = glm::vec3(worldGame[3]);
-    glm::quat baseRot = glm::quat_cast(worldGame);
-
-    // overwrite with our stored camera pos/rot
-    basePos = s_wsCameraPosition;
-    baseRot = s_wsCameraRotation;
+std::pair<glm::vec3, glm::fquat> CemuHooks::CalculateVRWorldPose(uint8_t side) {
+    // use our stored camera pos/rot instead of the in-game camera
+    const FrameSnapshot& snapshot = GetFrameSnapshot();
+    glm::vec3 basePos = snapshot.cameraPos;
+    glm::quat baseRot = snapshot.cameraRot;
 
     auto [swing, baseYaw] = swingTwistY(baseRot);
-    if (IsFirstPerson()) {
+    if (IsFirstPerson() && snapshot.hasPlayer) {
         // take link's direction, then rotate the headset position
-        BEMatrix34 playerMtx = {};
-        readMemory(s_playerMtxAddress, &playerMtx);
-        glm::fvec3 playerPos = playerMtx.getPos().getLE();
+        glm::fvec3 playerPos = snapshot.playerPos;
 
         if (s_isRiding) {
             playerPos.y -= hardcodedRidingOffset;
@@ -669,8 +735,7 @@ std::pair<glm::vec3, glm::fquat> CemuHooks::CalculateVRWorldPose(const BESeadLoo
         basePos = playerPos;
         if (auto eventSettings = GetFirstPersonSettingsForActiveEvent()) {
             if (eventSettings->ignoreCameraRotation) {
-                glm::fquat playerRot = playerMtx.getRotLE();
-                auto [swing, yaw] = swingTwistY(playerRot);
+                auto [swing, yaw] = swingTwistY(snapshot.playerRot);
                 baseYaw = yaw * glm::angleAxis(glm::radians(180.0f), glm::fvec3(0.0f, 1.0f, 0.0f));
             }
         }
@@ -699,15 +764,11 @@ void CemuHooks::hook_CheckIfCameraCanSeePos(PPCInterpreter_t* hCPU) {
         return;
     }
 
-    uint32_t camPtr = hCPU->gpr[3];
     uint32_t posPtr = hCPU->gpr[4];
     float radius = hCPU->fpr[1].fp0;
     float nearClip = hCPU->fpr[2].fp0;
     float farClip = hCPU->fpr[3].fp0;
 
-    BESeadLookAtCamera camera = {};
-    readMemory(camPtr, &camera);
-
     BEVec3 center;
     readMemory(posPtr, &center);
 
@@ -717,7 +778,7 @@ void CemuHooks::hook_CheckIfCameraCanSeePos(PPCInterpreter_t* hCPU) {
     for (int i = 0; i < 2; ++i) {
         OpenXR::EyeSide side = (i == 0) ? EyeSide::LEFT : EyeSide::RIGHT;
         if (auto fovOpt = VRManager::instance().XR->GetRenderer()->GetFOV(side)) {
-            auto [pos, rot] = CalculateVRWorldPose(camera, side);
+            auto [pos, rot] = CalculateVRWorldPose(side);
 
             // pull the camera backwards a bit to account for it being a third-person game that encompassed a bigger area
             pos += rot * glm::vec3(0.0f, 0.0f, 1.0f);
@@ -777,7 +838,7 @@ void CemuHooks::hook_EndCameraSide(PPCInterpreter_t* hCPU) {
         }
     }
 
-    Log::print<RENDERING>("{0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0}", side);
+    LOG_LAZY(RENDERING, "{0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0} {0}", side);
     Log::print<RENDERING>("===============================================================================");
     Log::print<RENDERING>("");
 }
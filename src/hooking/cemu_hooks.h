@@ -1,6 +1,9 @@
 #pragma once
 #include "entity_debugger.h"
 #include "utils/mod_settings.h"
+#include "utils/eye_scheduler.h"
+#include "utils/epoch_snapshot.h"
+#include "utils/hook_profiler.h"
 
 class CemuHooks {
 public:
@@ -21,70 +24,71 @@ public:
 
         InitWindowHandles();
 
-        osLib_registerHLEFunction("coreinit", "hook_UpdateSettings", &hook_UpdateSettings);
+        RegisterHook<&hook_UpdateSettings>("hook_UpdateSettings");
 
         // Actor Hooks
-        osLib_registerHLEFunction("coreinit", "hook_UpdateActorList", &hook_UpdateActorList);
-        osLib_registerHLEFunction("coreinit", "hook_CreateNewActor", &hook_CreateNewActor);
+        RegisterHook<&hook_UpdateActorList>("hook_UpdateActorList");
+        RegisterHook<&hook_CreateNewActor>("hook_CreateNewActor");
 
-        osLib_registerHLEFunction("coreinit", "hook_SetRigidBodyVelocity", &hook_SetRigidBodyVelocity);
-        osLib_registerHLEFunction("coreinit", "hook_SetRigidBodyTransform", &hook_SetRigidBodyTransform);
-        osLib_registerHLEFunction("coreinit", "hook_SetRigidBodyPosition", &hook_SetRigidBodyPosition);
-        osLib_registerHLEFunction("coreinit", "hook_SetRigidBodyPositionAndRotation", &hook_SetRigidBodyPositionAndRotation);
-        osLib_registerHLEFunction("coreinit", "hook_SetRigidBodyRotation", &hook_SetRigidBodyRotation);
+        RegisterHook<&hook_SetRigidBodyVelocity>("hook_SetRigidBodyVelocity");
+        RegisterHook<&hook_SetRigidBodyTransform>("hook_SetRigidBodyTransform");
+        RegisterHook<&hook_SetRigidBodyPosition>("hook_SetRigidBodyPosition");
+        RegisterHook<&hook_SetRigidBodyPositionAndRotation>("hook_SetRigidBodyPositionAndRotation");
+        RegisterHook<&hook_SetRigidBodyRotation>("hook_SetRigidBodyRotation");
 
         // Stereo Rendering/Camera Hooks
-        osLib_registerHLEFunction("coreinit", "hook_BeginCameraSide", &hook_BeginCameraSide);
-        osLib_registerHLEFunction("coreinit", "hook_ModifyLightPrePassProjectionMatrix", &hook_ModifyLightPrePassProjectionMatrix);
-        osLib_registerHLEFunction("coreinit", "hook_OverwriteSeadPerspectiveProjectionSet", &hook_OverwriteSeadPerspectiveProjectionSet);
-        osLib_registerHLEFunction("coreinit", "hook_ModifyProjectionUsingCamera", &hook_ModifyProjectionUsingCamera);
-        osLib_registerHLEFunction("coreinit", "hook_CheckIfCameraCanSeePos", &hook_CheckIfCameraCanSeePos);
-        osLib_registerHLEFunction("coreinit", "hook_UpdateCameraForGameplay", &hook_UpdateCameraForGameplay);
-        osLib_registerHLEFunction("coreinit", "hook_GetRenderCamera", &hook_GetRenderCamera);
-        osLib_registerHLEFunction("coreinit", "hook_GetRenderProjection", &hook_GetRenderProjection);
-        osLib_registerHLEFunction("coreinit", "hook_EndCameraSide", &hook_EndCameraSide);
-        osLib_registerHLEFunction("coreinit", "hook_RouteActorJob", &hook_RouteActorJob);
-
-        osLib_registerHLEFunction("coreinit", "hook_UseCameraDistance", &hook_UseCameraDistance);
-        osLib_registerHLEFunction("coreinit", "hook_ReplaceCameraMode", &hook_ReplaceCameraMode);
-        osLib_registerHLEFunction("coreinit", "hook_GetEventName", &hook_GetEventName);
-        osLib_registerHLEFunction("coreinit", "hook_OverwriteCameraParam", &hook_OverwriteCameraParam);
-        osLib_registerHLEFunction("coreinit", "hook_PlayerLadderFix", &hook_PlayerLadderFix);
-        osLib_registerHLEFunction("coreinit", "hook_PlayerIsRiding", &hook_PlayerIsRiding);
-        osLib_registerHLEFunction("coreinit", "hook_PlayerIsRidingSandSeal", &hook_PlayerIsRidingSandSeal);
-        osLib_registerHLEFunction("coreinit", "hook_FixStaminaGaugeScreenPosition", &hook_FixStaminaGaugeScreenPosition);
-        osLib_registerHLEFunction("coreinit", "hook_FixExtraStaminaGaugeIconPositions", &hook_FixExtraStaminaGaugeIconPositions);
-        osLib_registerHLEFunction("coreinit", "hook_ModifyPixelUniformBlockData", &hook_ModifyPixelUniformBlockData);
+        RegisterHook<&hook_BeginCameraSide>("hook_BeginCameraSide");
+        RegisterHook<&hook_PlanEyeRendering>("hook_PlanEyeRendering");
+        RegisterHook<&hook_ModifyLightPrePassProjectionMatrix>("hook_ModifyLightPrePassProjectionMatrix");
+        RegisterHook<&hook_OverwriteSeadPerspectiveProjectionSet>("hook_OverwriteSeadPerspectiveProjectionSet");
+        RegisterHook<&hook_ModifyProjectionUsingCamera>("hook_ModifyProjectionUsingCamera");
+        RegisterHook<&hook_CheckIfCameraCanSeePos>("hook_CheckIfCameraCanSeePos");
+        RegisterHook<&hook_UpdateCameraForGameplay>("hook_UpdateCameraForGameplay");
+        RegisterHook<&hook_GetRenderCamera>("hook_GetRenderCamera");
+        RegisterHook<&hook_GetRenderProjection>("hook_GetRenderProjection");
+        RegisterHook<&hook_EndCameraSide>("hook_EndCameraSide");
+        RegisterHook<&hook_RouteActorJob>("hook_RouteActorJob");
+
+        RegisterHook<&hook_UseCameraDistance>("hook_UseCameraDistance");
+        RegisterHook<&hook_ReplaceCameraMode>("hook_ReplaceCameraMode");
+        RegisterHook<&hook_GetEventName>("hook_GetEventName");
+        RegisterHook<&hook_OverwriteCameraParam>("hook_OverwriteCameraParam");
+        RegisterHook<&hook_PlayerLadderFix>("hook_PlayerLadderFix");
+        RegisterHook<&hook_PlayerIsRiding>("hook_PlayerIsRiding");
+        RegisterHook<&hook_PlayerIsRidingSandSeal>("hook_PlayerIsRidingSandSeal");
+        RegisterHook<&hook_FixStaminaGaugeScreenPosition>("hook_FixStaminaGaugeScreenPosition");
+        RegisterHook<&hook_FixExtraStaminaGaugeIconPositions>("hook_FixExtraStaminaGaugeIconPositions");
+        RegisterHook<&hook_ModifyPixelUniformBlockData>("hook_ModifyPixelUniformBlockData");
 
         // First-Person Model Hooks
-        osLib_registerHLEFunction("coreinit", "hook_SetActorOpacity", &hook_SetActorOpacity);
-        osLib_registerHLEFunction("coreinit", "hook_CalculateModelOpacity", &hook_CalculateModelOpacity);
-        osLib_registerHLEFunction("coreinit", "hook_ModifyBoneMatrix", &hook_ModifyBoneMatrix);
-        osLib_registerHLEFunction("coreinit", "hook_ChangeWeaponMtx", &hook_ChangeWeaponMtx);
+        RegisterHook<&hook_SetActorOpacity>("hook_SetActorOpacity");
+        RegisterHook<&hook_CalculateModelOpacity>("hook_CalculateModelOpacity");
+        RegisterHook<&hook_ModifyBoneMatrix>("hook_ModifyBoneMatrix");
+        RegisterHook<&hook_ChangeWeaponMtx>("hook_ChangeWeaponMtx");
 
         // First-Person Weapon Hooks
-        osLib_registerHLEFunction("coreinit", "hook_EquipWeapon", &hook_EquipWeapon);
-        osLib_registerHLEFunction("coreinit", "hook_DropEquipment", &hook_DropEquipment);
-        osLib_registerHLEFunction("coreinit", "hook_EnableWeaponAttackSensor", &hook_EnableWeaponAttackSensor);
-        osLib_registerHLEFunction("coreinit", "hook_SetPlayerWeaponScale", &hook_SetPlayerWeaponScale);
-        osLib_registerHLEFunction("coreinit", "hook_GetContactLayerOfAttack", &hook_GetContactLayerOfAttack);
+        RegisterHook<&hook_EquipWeapon>("hook_EquipWeapon");
+        RegisterHook<&hook_DropEquipment>("hook_DropEquipment");
+        RegisterHook<&hook_EnableWeaponAttackSensor>("hook_EnableWeaponAttackSensor");
+        RegisterHook<&hook_SetPlayerWeaponScale>("hook_SetPlayerWeaponScale");
+        RegisterHook<&hook_GetContactLayerOfAttack>("hook_GetContactLayerOfAttack");
 
         // Input Hooks
-        osLib_registerHLEFunction("coreinit", "hook_InjectXRInput", &hook_InjectXRInput);
-        osLib_registerHLEFunction("coreinit", "hook_XRRumble_VPADControlMotor", &hook_XRRumble_VPADControlMotor);
-        osLib_registerHLEFunction("coreinit", "hook_XRRumble_VPADStopMotor", &hook_XRRumble_VPADStopMotor);
-        osLib_registerHLEFunction("coreinit", "hook_FixLadder", &hook_FixLadder);
+        RegisterHook<&hook_InjectXRInput>("hook_InjectXRInput");
+        RegisterHook<&hook_XRRumble_VPADControlMotor>("hook_XRRumble_VPADControlMotor");
+        RegisterHook<&hook_XRRumble_VPADStopMotor>("hook_XRRumble_VPADStopMotor");
+        RegisterHook<&hook_FixLadder>("hook_FixLadder");
 
         // Misc. Hooks
-        osLib_registerHLEFunction("coreinit", "hook_OSReportToConsole", &hook_OSReportToConsole);
-        osLib_registerHLEFunction("coreinit", "hook_DropWeaponLogging", &hook_DropWeaponLogging);
-        osLib_registerHLEFunction("coreinit", "hook_ModifyHandModelAccessSearch", &hook_ModifyHandModelAccessSearch);
-        osLib_registerHLEFunction("coreinit", "hook_CreateNewScreen", &hook_CreateNewScreen);
-        osLib_registerHLEFunction("coreinit", "hook_FixUIBlending", &hook_FixUIBlending);
-        osLib_registerHLEFunction("coreinit", "hook_FixCameraSaveFilesAndInventory", &hook_FixCameraSaveFilesAndInventory);
-        osLib_registerHLEFunction("coreinit", "hook_VisualizeRayCastHits", &hook_VisualizeRayCastHits);
-        osLib_registerHLEFunction("coreinit", "hook_LoadDynamicVec3", &hook_LoadDynamicVec3);
-        osLib_registerHLEFunction("coreinit", "hook_LoadDynamicBool", &hook_LoadDynamicBool);
+        RegisterHook<&hook_OSReportToConsole>("hook_OSReportToConsole");
+        RegisterHook<&hook_DropWeaponLogging>("hook_DropWeaponLogging");
+        RegisterHook<&hook_ModifyHandModelAccessSearch>("hook_ModifyHandModelAccessSearch");
+        RegisterHook<&hook_CreateNewScreen>("hook_CreateNewScreen");
+        RegisterHook<&hook_FixUIBlending>("hook_FixUIBlending");
+        RegisterHook<&hook_FixCameraSaveFilesAndInventory>("hook_FixCameraSaveFilesAndInventory");
+        RegisterHook<&hook_VisualizeRayCastHits>("hook_VisualizeRayCastHits");
+        RegisterHook<&hook_LoadDynamicVec3>("hook_LoadDynamicVec3");
+        RegisterHook<&hook_LoadDynamicBool>("hook_LoadDynamicBool");
     };
     ~CemuHooks() {
         FreeLibrary(m_cemuHandle);
@@ -118,10 +122,33 @@ public:
         return GetFramesSinceLastCameraUpdate() <= 4 && !IsScreenOpen(ScreenId::PauseMenuInfo_00);
     }
     static bool IsShowingMenu() {
-        return !IsInGame() || IsScreenOpen(ScreenId::ShopBG_00) || IsScreenOpen(ScreenId::MessageDialog);
+        const ScreenStates screens = GetScreenStates();
+        return !IsInGame() || screens.IsOpen(ScreenId::ShopBG_00) || screens.IsOpen(ScreenId::MessageDialog);
     }
     static bool UseMonoFrameBufferTemporarilyDuringMenusOrPictures();
 
+    // The eye that the given rendering pass draws in the frame that the game is currently rendering
+    static uint8_t GetRenderedEye(uint8_t pass) { return EyeScheduler::GetPassEye(s_currentEyePlan, pass); }
+
+    // Player and camera state that several hooks need every frame, decoded once per frame instead of re-reading guest memory in each hook.
+    // It's refreshed when the gameplay camera is updated, and lazily by GetFrameSnapshot() on frames where that hook didn't run.
+    // The PPC threads refresh and read it concurrently, the returned reference is only valid until the hook that got it returns.
+    struct FrameSnapshot {
+        bool hasPlayer = false; // the player fields are only valid when this is set
+        glm::mat4x3 playerMtx = glm::mat4x3(1.0f);
+        glm::fmat4 playerMtxInverse = glm::fmat4(1.0f);
+        glm::fvec3 playerPos = {};
+        glm::fquat playerRot = glm::identity<glm::fquat>();
+        PlayerMoveBitFlags moveBits = {};
+        // the gameplay camera in world space, before the headset pose is applied, and its view matrix
+        glm::fvec3 cameraPos = {};
+        glm::fquat cameraRot = glm::identity<glm::fquat>();
+        glm::fmat4 cameraMtx = glm::fmat4(1.0f);
+        glm::fmat4 cameraMtxInverse = glm::fmat4(1.0f);
+    };
+    static const FrameSnapshot& GetFrameSnapshot();
+    static const FrameSnapshot& RefreshFrameSnapshot();
+
     static std::string s_currentEvent;
     static HybridEventSettings s_currentEventSettings;
     static std::unordered_map<std::string, HybridEventSettings> s_eventSettings;
@@ -209,22 +236,38 @@ public:
 
         return GetSettings().UseBlackBarsForCutscenes();
     }
+    // Uses the snapshot that's taken once per frame in hook_UpdateSettings
     static bool IsScreenOpen(ScreenId screen);
+    static ScreenStates GetScreenStates();
 
     static void DrawDebugOverlays();
 
 private:
     HMODULE m_cemuHandle;
 
+    template <HookProfiler::HookFunction Hook>
+    void RegisterHook(const char* name) {
+        osLib_registerHLEFunction("coreinit", name, HookProfiler::Wrap<Hook>(name));
+    }
+
     osLib_registerHLEFunctionPtr_t osLib_registerHLEFunction;
     memory_getBasePtr_t memory_getBase;
     gameMeta_getTitleIdPtr_t gameMeta_getTitleId;
 
     static std::atomic_uint32_t s_framesSinceLastCameraUpdate;
+    static std::atomic_uint32_t s_frameEpoch;
+    static EpochSnapshot<FrameSnapshot> s_frameSnapshot;
+    static void ReadPlayerIntoFrameSnapshot(FrameSnapshot& snapshot);
+    static void UpdateFrameSnapshotCamera(const glm::fvec3& position, const glm::fquat& rotation);
+    static EyeScheduler s_eyeScheduler;
+    static std::atomic<EyeScheduler::Plan> s_currentEyePlan;
+    static std::array<std::atomic_uint64_t, ScreenStates::WORD_COUNT> s_openScreens;
+
+    static ScreenStates ReadScreenStates();
 
     static void InitWindowHandles();
 
-    static std::pair<glm::vec3, glm::fquat> CalculateVRWorldPose(const BESeadLookAtCamera& camera, uint8_t side);
+    static std::pair<glm::vec3, glm::fquat> CalculateVRWorldPose(uint8_t side);
 
     static void hook_UpdateSettings(PPCInterpreter_t* hCPU);
 
@@ -240,6 +283,7 @@ private:
 
     // Camera Hooks
     static void hook_BeginCameraSide(PPCInterpreter_t* hCPU);
+    static void hook_PlanEyeRendering(PPCInterpreter_t* hCPU);
     static void hook_ModifyLightPrePassProjectionMatrix(PPCInterpreter_t* hCPU);
     static void hook_ModifyProjectionUsingCamera(PPCInterpreter_t* hCPU);
     static void hook_CheckIfCameraCanSeePos(PPCInterpreter_t* hCPU);
@@ -1,6 +1,9 @@
 #include "cemu_hooks.h"
 #include "../instance.h"
 #include "openxr_motion_bridge.h"
+#include "gesture_zones.h"
+#include "utils/action_change_gate.h"
+#include "utils/stick_emulation.h"
 
 
 void spreadWeaponDetectionOverFrames(OpenXR::GameState& gameState) {
@@ -35,16 +38,12 @@ void spreadWeaponDetectionOverFrames(OpenXR::GameState& gameState) {
 
 
 struct HandGestureState {
-    bool isBehindHead;
-    bool isBehindHeadWithWaistOffset;
-    bool isCloseToHead;
-    bool isCloseToMouth;
-    bool isCloseToWaist;
-    bool isNearChestHeight;
-    bool isOnLeftSide;  // true = left side of body, false = right side
+    GestureZones::ZoneMask zones;
     bool isFarEnoughFromStoredPosition;
     float magnesisForwardAmount;
     float magnesisVerticalAmount;
+
+    bool IsIn(GestureZones::Zone zone) const { return (zones & GestureZones::Bit(zone)) != 0; }
 };
 
 int getMagnesisForwardFrameInterval(float v)
@@ -59,55 +58,14 @@ int getMagnesisForwardFrameInterval(float v)
 // Gesture detection functions
 HandGestureState calculateHandGesture(
     OpenXR::GameState& gameState,
+    const GestureZones::ZoneMask zones,
     const glm::fvec3& handPos,
-    const glm::fmat4& headsetMatrix,
-    const glm::fvec3& headsetPos,
+    const glm::fvec3& bodyForward,
     const bool ProcessStoredPositionDistanceCheck,
     const glm::fvec3& storedHandPos
 ) {
     HandGestureState gesture = {};
-    
-    // Calculate directional vectors
-    glm::fvec3 headsetForward = -glm::normalize(glm::fvec3(headsetMatrix[2]));
-    headsetForward.y = 0.0f;
-    headsetForward = glm::normalize(headsetForward);
-    
-    glm::fvec3 headsetRight = glm::normalize(glm::fvec3(headsetMatrix[0]));
-    glm::fvec3 headToHand = handPos - headsetPos;
-    
-    // Check if hand is behind head (for shoulder slots)
-    float forwardDot = glm::dot(headsetForward, headToHand);
-    gesture.isBehindHead = (forwardDot < 0.0f);
-    
-    // Check if hand is behind head (for waist slot) - uses flattened vectors
-    glm::vec3 flatForward = glm::normalize(glm::vec3(headsetForward.x, 0.0f, headsetForward.z));
-    glm::vec3 flatHandOffset = glm::vec3(headToHand.x, 0.0f, headToHand.z);
-    
-    constexpr float WAIST_BEHIND_OFFSET = -0.05f; //0.15f
-    float flatForwardDot = glm::dot(flatForward, flatHandOffset) + WAIST_BEHIND_OFFSET;
-    gesture.isBehindHeadWithWaistOffset = (flatForwardDot < 0.0f);
-    
-    // Check which side of body the hand is on
-    float rightDot = glm::dot(headsetRight, headToHand);
-    gesture.isOnLeftSide = (rightDot < 0.0f);
-    
-    // Check distance from head (for shoulder slots)
-    constexpr float SHOULDER_RADIUS = 0.35f;
-    constexpr float SHOULDER_RADIUS_SQ = SHOULDER_RADIUS * SHOULDER_RADIUS;
-    gesture.isCloseToHead = (glm::length2(headToHand) < SHOULDER_RADIUS_SQ);
-
-    // Check distance from head (for mouth slot)
-    constexpr float MOUTH_RADIUS = 0.2f;
-    constexpr float MOUTH_RADIUS_SQ = MOUTH_RADIUS * MOUTH_RADIUS;
-    gesture.isCloseToMouth = (glm::length2(headToHand) < MOUTH_RADIUS_SQ);
-    
-    // Check distance from waist (rough estimate)
-    glm::fvec3 waistPos = headsetPos - glm::fvec3(0.0f, 0.45f, 0.0f);
-    gesture.isCloseToWaist = (handPos.y < waistPos.y);
-
-    // Check hand height for shield (rough estimate)
-    glm::fvec3 chestPos = headsetPos - glm::fvec3(0.0f, 0.3f, 0.0f);
-    gesture.isNearChestHeight = (handPos.y > chestPos.y);
+    gesture.zones = zones;
 
     // Check distance from stored position
     if (ProcessStoredPositionDistanceCheck) {
@@ -123,7 +81,7 @@ HandGestureState calculateHandGesture(
         }
         else {
             const glm::vec3 headsetUp(0.0f, 1.0f, 0.0f);
-            auto forwardAmount = glm::dot(delta, headsetForward);
+            auto forwardAmount = glm::dot(delta, bodyForward);
             auto verticalAmount = glm::dot(delta, headsetUp);
 
             auto remapSigned = [&](float value) {
@@ -157,23 +115,27 @@ HandGestureState calculateHandGesture(
 }
 
 bool isHandOverLeftShoulderSlot(const HandGestureState& gesture) {
-    return gesture.isBehindHead && gesture.isCloseToHead && gesture.isOnLeftSide;
+    return gesture.IsIn(GestureZones::Zone::LEFT_SHOULDER);
 }
 
 bool isHandOverRightShoulderSlot(const HandGestureState& gesture) {
-    return gesture.isBehindHead && gesture.isCloseToHead && !gesture.isOnLeftSide;
+    return gesture.IsIn(GestureZones::Zone::RIGHT_SHOULDER);
 }
 
 bool isHandOverLeftWaistSlot(const HandGestureState& gesture) {
-    return gesture.isBehindHeadWithWaistOffset && gesture.isCloseToWaist && gesture.isOnLeftSide;
+    return gesture.IsIn(GestureZones::Zone::LEFT_WAIST);
 }
 
 bool isHandOverRightWaistSlot(const HandGestureState& gesture) {
-    return gesture.isBehindHeadWithWaistOffset && gesture.isCloseToWaist && !gesture.isOnLeftSide;
+    return gesture.IsIn(GestureZones::Zone::RIGHT_WAIST);
 }
 
 bool isHandOverMouthSlot(const HandGestureState& gesture) {
-    return gesture.isCloseToMouth && !gesture.isBehindHead;
+    return gesture.IsIn(GestureZones::Zone::MOUTH);
+}
+
+bool isHandNearChestHeight(const HandGestureState& gesture) {
+    return gesture.IsIn(GestureZones::Zone::CHEST_HEIGHT);
 }
 
 bool isHandFarEnoughFromStoredPosition(const HandGestureState& gesture) {
@@ -181,7 +143,7 @@ bool isHandFarEnoughFromStoredPosition(const HandGestureState& gesture) {
 }
 
 bool isHandNotOverAnySlot(const HandGestureState& gesture) {
-    return !gesture.isBehindHead && !gesture.isBehindHeadWithWaistOffset && !gesture.isCloseToMouth;
+    return gesture.IsIn(GestureZones::Zone::FRONT) && !gesture.IsIn(GestureZones::Zone::MOUTH);
 }
 
 bool openDpadMenuRuneButton(ButtonState::Event lastEvent, uint32_t& buttonHold, OpenXR::GameState& gameState) {
@@ -348,7 +310,7 @@ void processLeftHandInGameInput(
     // if shield with lock on isn't already being used with left trigger, use gesture to guard without lock on instead.
     // Gesture enabled only when both melee weapon and shield are in hands to prevent 2 handed weapons and quick drawing shield 
     // alone with Left Trigger to trigger it. So people can still move hands freely without the shield appearing when not wanted.
-    if (!inputs.inGame.useLeftItem.currentState && gameState.left_hand_current_equip_type == EquipType::Shield && gameState.right_hand_current_equip_type == EquipType::Melee && (leftGesture.isNearChestHeight)) {
+    if (!inputs.inGame.useLeftItem.currentState && gameState.left_hand_current_equip_type == EquipType::Shield && gameState.right_hand_current_equip_type == EquipType::Melee && isHandNearChestHeight(leftGesture)) {
         buttonHold |= VPAD_BUTTON_ZL;
         rightStickSource.currentState.y = 0.2f; // Force disable the lock on view when holding shield
         gameState.is_shield_guarding = true;
@@ -825,7 +787,8 @@ void processInputPrevention(OpenXR::GameState& gameState, std::chrono::steady_cl
         gameState.prevent_grab_inputs = false;
 }
 
-void processModMenuInput(std::atomic_bool& isMenuOpen, OpenXR::InputState& inputs, VPADStatus& vpadInputs, RND_Renderer::ImGuiOverlay* imguiOverlay, XrActionStateVector2f& leftStickSource, XrActionStateVector2f& rightStickSource)
+// returns whether the game's inputs were blocked
+bool processModMenuInput(std::atomic_bool& isMenuOpen, OpenXR::InputState& inputs, VPADStatus& vpadInputs, RND_Renderer::ImGuiOverlay* imguiOverlay, XrActionStateVector2f& leftStickSource, XrActionStateVector2f& rightStickSource)
 {
     if (inputs.shared.modMenuState.lastEvent == ButtonState::Event::LongPress && inputs.shared.modMenuState.longFired_actedUpon) {
         isMenuOpen = !isMenuOpen;
@@ -840,55 +803,79 @@ void processModMenuInput(std::atomic_bool& isMenuOpen, OpenXR::InputState& input
         vpadInputs = {};
         leftStickSource.currentState = { 0.0f, 0.0f };
         rightStickSource.currentState = { 0.0f, 0.0f };
+        return true;
     }
+    return false;
 }
 
 void processHandGesture(RND_Renderer* renderer, OpenXR::InputState& inputs, HandGestureState& leftGesture, HandGestureState& rightGesture, OpenXR::GameState& gameState)
 {
+    static GestureZones s_gestureZones = []() {
+        GestureZones zones;
+        zones.LoadConfig("BetterVR_gesture_zones.txt");
+        return zones;
+    }();
+
     auto headsetPose = renderer->GetMiddlePose();
     if (headsetPose.has_value()) {
         const auto headsetMtx = headsetPose.value();
-        const glm::fvec3 headsetPos(headsetMtx[3]);
-        
+
         const auto leftHandPos = ToGLM(inputs.shared.poseLocation[0].pose.position);
         const auto rightHandPos = ToGLM(inputs.shared.poseLocation[1].pose.position);
-        
-        leftGesture = calculateHandGesture(gameState, leftHandPos, headsetMtx, headsetPos, gameState.left_hand_position_stored, gameState.stored_left_hand_position);
-        rightGesture = calculateHandGesture(gameState, rightHandPos, headsetMtx, headsetPos, gameState.right_hand_position_stored, gameState.stored_right_hand_position);
+
+        const auto zones = s_gestureZones.Update({
+            inputs.shared.pose[0].isActive ? std::make_optional(leftHandPos) : std::nullopt,
+            inputs.shared.pose[1].isActive ? std::make_optional(rightHandPos) : std::nullopt
+        }, headsetMtx, inputs.shared.inputTime);
+        const glm::fvec3 bodyForward = s_gestureZones.GetBodyForward();
+
+        leftGesture = calculateHandGesture(gameState, zones[0], leftHandPos, bodyForward, gameState.left_hand_position_stored, gameState.stored_left_hand_position);
+        rightGesture = calculateHandGesture(gameState, zones[1], rightHandPos, bodyForward, gameState.right_hand_position_stored, gameState.stored_right_hand_position);
     }
 }
 
-void processJoystickInput(VPADButtons& oldXRStickHold, VPADButtons& newXRStickHold, VPADStatus& vpadStatus, XrActionStateVector2f& leftStickSource, XrActionStateVector2f& rightStickSource)
+// maps the directions of StickEmulation to the stick emulation buttons of the left and right stick
+static VPADButtons ToVPADStickButtons(uint8_t left, uint8_t right) {
+    uint32_t buttons = VPAD_BUTTON_NONE;
+    if (left & StickEmulation::LEFT) buttons |= VPAD_STICK_L_EMULATION_LEFT;
+    if (left & StickEmulation::RIGHT) buttons |= VPAD_STICK_L_EMULATION_RIGHT;
+    if (left & StickEmulation::DOWN) buttons |= VPAD_STICK_L_EMULATION_DOWN;
+    if (left & StickEmulation::UP) buttons |= VPAD_STICK_L_EMULATION_UP;
+    if (right & StickEmulation::LEFT) buttons |= VPAD_STICK_R_EMULATION_LEFT;
+    if (right & StickEmulation::RIGHT) buttons |= VPAD_STICK_R_EMULATION_RIGHT;
+    if (right & StickEmulation::DOWN) buttons |= VPAD_STICK_R_EMULATION_DOWN;
+    if (right & StickEmulation::UP) buttons |= VPAD_STICK_R_EMULATION_UP;
+    return (VPADButtons)buttons;
+}
+
+// the stick emulation only changes when the runtime reported the stick as changed, or when something else about its inputs did
+struct StickEmulationKey {
+    bool inGame;
+    bool blocked;
+    float deadzone;
+    float axisThreshold;
+    bool operator==(const StickEmulationKey&) const = default;
+};
+
+void processJoystickInput(const OpenXR::InputState& inputs, bool blocked, VPADButtons& newXRStickHold, VPADStatus& vpadStatus, XrActionStateVector2f& leftStickSource, XrActionStateVector2f& rightStickSource)
 {
     // movement/navigation stick
     vpadStatus.leftStick = { leftStickSource.currentState.x + vpadStatus.leftStick.x.getLE(), leftStickSource.currentState.y + vpadStatus.leftStick.y.getLE() };
-
-    const float axisThreshold = GetSettings().axisThreshold;
-    const float holdThreshold = axisThreshold * 0.5f;
-    if (leftStickSource.currentState.x <= -axisThreshold || (HAS_FLAG(oldXRStickHold, VPAD_STICK_L_EMULATION_LEFT) && leftStickSource.currentState.x <= -holdThreshold))
-        newXRStickHold |= VPAD_STICK_L_EMULATION_LEFT;
-    else if (leftStickSource.currentState.x >= axisThreshold || (HAS_FLAG(oldXRStickHold, VPAD_STICK_L_EMULATION_RIGHT) && leftStickSource.currentState.x >= holdThreshold))
-        newXRStickHold |= VPAD_STICK_L_EMULATION_RIGHT;
-
-    if (leftStickSource.currentState.y <= -axisThreshold || (HAS_FLAG(oldXRStickHold, VPAD_STICK_L_EMULATION_DOWN) && leftStickSource.currentState.y <= -holdThreshold))
-        newXRStickHold |= VPAD_STICK_L_EMULATION_DOWN;
-    else if (leftStickSource.currentState.y >= axisThreshold || (HAS_FLAG(oldXRStickHold, VPAD_STICK_L_EMULATION_UP) && leftStickSource.currentState.y >= holdThreshold))
-        newXRStickHold |= VPAD_STICK_L_EMULATION_UP;
-
     vpadStatus.rightStick = { rightStickSource.currentState.x + vpadStatus.rightStick.x.getLE(), rightStickSource.currentState.y + vpadStatus.rightStick.y.getLE() };
 
-    if (rightStickSource.currentState.x <= -axisThreshold || (HAS_FLAG(oldXRStickHold, VPAD_STICK_R_EMULATION_LEFT) && rightStickSource.currentState.x <= -holdThreshold))
-        newXRStickHold |= VPAD_STICK_R_EMULATION_LEFT;
-    else if (rightStickSource.currentState.x >= axisThreshold || (HAS_FLAG(oldXRStickHold, VPAD_STICK_R_EMULATION_RIGHT) && rightStickSource.currentState.x >= holdThreshold))
-        newXRStickHold |= VPAD_STICK_R_EMULATION_RIGHT;
+    // the right stick gets overridden by the hand inputs (shield lock-on, magnesis), so only the left one can be gated
+    static ActionChangeGate<StickEmulationKey> s_leftStickGate;
+    static uint8_t s_leftDirections = StickEmulation::NONE;
+    static uint8_t s_rightDirections = StickEmulation::NONE;
 
-    if (rightStickSource.currentState.y <= -axisThreshold || (HAS_FLAG(oldXRStickHold, VPAD_STICK_R_EMULATION_DOWN) && rightStickSource.currentState.y <= -holdThreshold))
-        newXRStickHold |= VPAD_STICK_R_EMULATION_DOWN;
-    else if (rightStickSource.currentState.y >= axisThreshold || (HAS_FLAG(oldXRStickHold, VPAD_STICK_R_EMULATION_UP) && rightStickSource.currentState.y >= holdThreshold))
-        newXRStickHold |= VPAD_STICK_R_EMULATION_UP;
-
-
-    oldXRStickHold = newXRStickHold;
+    const float axisThreshold = GetSettings().axisThreshold;
+    const OpenXR::InputAction leftStickAction = inputs.shared.in_game ? OpenXR::InputAction::MOVE : OpenXR::InputAction::NAVIGATE;
+    const StickEmulationKey key = { inputs.shared.in_game, blocked, GetSettings().stickDeadzone, axisThreshold };
+    if (s_leftStickGate.ShouldRun(inputs.syncIndex, inputs.changedActions, 1u << std::to_underlying(leftStickAction), key)) {
+        s_leftDirections = StickEmulation::EmulateDirections(leftStickSource.currentState.x, leftStickSource.currentState.y, s_leftDirections, axisThreshold);
+    }
+    s_rightDirections = StickEmulation::EmulateDirections(rightStickSource.currentState.x, rightStickSource.currentState.y, s_rightDirections, axisThreshold);
+    newXRStickHold = ToVPADStickButtons(s_leftDirections, s_rightDirections);
 }
 
 XrTime prev_sample = 0;
@@ -919,6 +906,43 @@ void updatePreviousValues(OpenXR::GameState& gameState, uint32_t& buttonHold, Ha
     prev_sample = inputTime;
 }
 
+// only the right hand drives the gamepad's motion sensors
+static OpenXRMotionBridge s_motionBridge;
+
+static void updateMotionSensors(OpenXRMotionBridge& bridge, const OpenXR::InputState& inputs, OpenXR::EyeSide side, VPADStatus& vpadStatus) {
+    auto& poseState = inputs.shared.poseLocation[side];
+    auto& velState = inputs.shared.poseVelocity[side];
+
+    if ((poseState.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) && inputs.shared.in_game) {
+        glm::quat orientation = ToGLM(poseState.pose.orientation);
+        glm::vec3 linearVel = (velState.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) ? ToGLM(velState.linearVelocity) : glm::vec3(0.0f);
+
+        WiiUMotionData motion = bridge.AddSample(inputs.shared.inputTime, orientation, linearVel);
+
+        vpadStatus.acc = motion.acc;
+        vpadStatus.accMagnitude = glm::length(motion.acc);
+        vpadStatus.accAcceleration = motion.jerk;
+        vpadStatus.gyroChange = motion.gyro;
+        vpadStatus.gyroOrientation = motion.orientation;
+        vpadStatus.accXY = { motion.acc.x, motion.acc.y };
+
+        // the gamepad's pitch and roll are inverted compared to OpenXR while yaw is kept, which is the same as mirroring
+        // the rotation along the Y axis
+        const glm::quat& stepOrientation = bridge.GetOrientation();
+        const glm::quat mirrored = glm::quat(stepOrientation.w, -stepOrientation.x, stepOrientation.y, -stepOrientation.z);
+        vpadStatus.dir.x = mirrored * glm::vec3(1, 0, 0);
+        vpadStatus.dir.y = mirrored * glm::vec3(0, 1, 0);
+        vpadStatus.dir.z = mirrored * glm::vec3(0, 0, 1);
+    }
+    else {
+        bridge.Reset();
+        vpadStatus.dir.x = glm::fvec3{ 1, 0, 0 };
+        vpadStatus.dir.y = glm::fvec3{ 0, 1, 0 };
+        vpadStatus.dir.z = glm::fvec3{ 0, 0, 1 };
+        vpadStatus.accXY = { 1.0f, 0.0f };
+    }
+}
+
 void CemuHooks::hook_InjectXRInput(PPCInterpreter_t* hCPU) {
     hCPU->instructionPointer = hCPU->sprNew.LR;
 
@@ -984,8 +1008,8 @@ void CemuHooks::hook_InjectXRInput(PPCInterpreter_t* hCPU) {
     // Apply deadzone
     float stickDeadzone = GetSettings().stickDeadzone;
     auto applyDeadzone = [stickDeadzone](XrVector2f& v) {
-        if (std::abs(v.x) < stickDeadzone) v.x = 0.0f;
-        if (std::abs(v.y) < stickDeadzone) v.y = 0.0f;
+        v.x = StickEmulation::ApplyDeadzone(v.x, stickDeadzone);
+        v.y = StickEmulation::ApplyDeadzone(v.y, stickDeadzone);
     };
     applyDeadzone(leftStickSource.currentState);
     applyDeadzone(rightStickSource.currentState);
@@ -997,7 +1021,7 @@ void CemuHooks::hook_InjectXRInput(PPCInterpreter_t* hCPU) {
     processInputPrevention(gameState, now, delay);
 
     auto& isMenuOpen = VRManager::instance().XR->m_isMenuOpen;
-    processModMenuInput(isMenuOpen, inputs, vpadStatus, imguiOverlay, leftStickSource, rightStickSource);
+    const bool inputsBlocked = processModMenuInput(isMenuOpen, inputs, vpadStatus, imguiOverlay, leftStickSource, rightStickSource);
 
     // Calculate hand gestures
     HandGestureState leftGesture = {};
@@ -1093,9 +1117,8 @@ void CemuHooks::hook_InjectXRInput(PPCInterpreter_t* hCPU) {
     rumbleMgr->updateHaptics();
 
     // sticks
-    static VPADButtons oldXRStickHold = VPAD_BUTTON_NONE;
     VPADButtons newXRStickHold = VPAD_BUTTON_NONE;
-    processJoystickInput(oldXRStickHold, newXRStickHold, vpadStatus, leftStickSource, rightStickSource);
+    processJoystickInput(inputs, inputsBlocked, newXRStickHold, vpadStatus, leftStickSource, rightStickSource);
 
     // calculate new hold, trigger and release
     uint32_t combinedHold = (vpadStatus.hold.getLE() | (newXRBtnHold | newXRStickHold));
@@ -1113,7 +1136,7 @@ void CemuHooks::hook_InjectXRInput(PPCInterpreter_t* hCPU) {
     vpadStatus.tpData.validity = 3;
 
     // motion
-    OpenXRMotionBridge::UpdateVPADStatus(inputs, vpadStatus);
+    updateMotionSensors(s_motionBridge, inputs, OpenXR::EyeSide::RIGHT, vpadStatus);
 
     // write the input back to VPADStatus
     writeMemory(vpadStatusOffset, &vpadStatus);
@@ -7,6 +7,7 @@
 
 #include "implot3d_internal.h"
 #include "utils/debug_draw.h"
+#include "utils/alloc_tracker.h"
 
 std::mutex g_actorListMutex;
 std::unordered_map<uint32_t, std::pair<std::string, uint32_t>> s_knownActors;
@@ -72,6 +73,7 @@ void CemuHooks::hook_UpdateActorList(PPCInterpreter_t* hCPU) {
 std::unordered_map<uint32_t, std::pair<std::string, uint32_t>> s_alreadyAddedActors;
 
 void EntityDebugger::UpdateEntityMemory() {
+    ALLOC_TRACKER_SCOPE("EntityDebugger::UpdateEntityMemory");
     std::scoped_lock lock(g_actorListMutex);
 
     // remove actors in s_alreadyAddedActors that are no longer in s_knownActors
@@ -311,6 +313,7 @@ void DrawAABBInPlot(glm::fvec3 pos, glm::fvec3& min, glm::fvec3& max, glm::fquat
 }
 
 void EntityDebugger::DrawEntityInspector() {
+    ALLOC_TRACKER_SCOPE("EntityDebugger::DrawEntityInspector");
     ImGui::Begin("BetterVR Debugger");
 
     static char buf[256];
@@ -676,6 +679,9 @@ void EntityDebugger::DrawFPSOverlayContent(RND_Renderer* renderer, bool renderTe
         ImGui::Text("");
         ImGui::Text("OpenXR waited %.1f ms so that it can interpolate/have low latency.", waitMs);
         ImGui::Text("Theoretically, it'd run at %.1f FPS if that didn't matter", workFps);
+        if (GetSettings().UseDynamicResolution()) {
+            ImGui::Text("Dynamic resolution is rendering at %.0f%% of the resolution", renderer->GetDynamicResolutionScale() * 100.0f);
+        }
     }
 
     if (predictedHz > 0.0f && workFps >= 0.0f) {
@@ -774,4 +780,9 @@ void EntityDebugger::DrawFPSOverlayContent(RND_Renderer* renderer, bool renderTe
 
         ImPlot::EndPlot();
     }
+
+    // --- 6. GPU Time Of The VR Passes ---
+    if (const RND_Renderer::GpuTimings gpuTimings = renderer->GetGpuTimings(); gpuTimings.supported) {
+        ImGui::Text("GPU: copies %.2f ms | overlay %.2f ms | present %.2f ms", gpuTimings.interopCopyMs, gpuTimings.imguiMs, gpuTimings.presentMs);
+    }
 }
\ No newline at end of file
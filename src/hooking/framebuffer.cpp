@@ -1,42 +1,78 @@
 #include "framebuffer.h"
 #include "instance.h"
 #include "layer.h"
+#include "utils/concurrent_handle_map.h"
+#include "utils/pending_copies.h"
 #include "utils/vulkan_utils.h"
 #include "utils/debug_draw.h"
+#include "utils/frame_trace.h"
+#include "utils/alloc_tracker.h"
+
+
+// packed into 64 bits so that the registry can read it without locking, Vulkan's max image dimension fits into 16 bits
+struct ImageResolution {
+    uint16_t width;
+    uint16_t height;
+    VkFormat format;
+
+    VkExtent2D GetExtent() const { return VkExtent2D{ width, height }; }
+};
+ConcurrentHandleMap<VkImage, ImageResolution> imageResolutions;
+
+// Interop copies recorded into a command buffer, stored in the command buffer's vkroots dispatch user data so that
+// QueueSubmit only has to look up the buffers it's actually submitting. Begin/ResetCommandBuffer, resetting or destroying the
+// command pool and freeing the command buffer drop copies that never got submitted.
+struct InteropCopy {
+    SharedTexture* texture;
+    RND_Renderer::FrameCopy frameCopy;
+};
+using InteropCopyTracker = PendingCopyTracker<VkCommandPool, InteropCopy>;
+InteropCopyTracker s_pendingCopies;
+
+struct PendingInteropCopies : InteropCopyTracker::Buffer {
+    explicit PendingInteropCopies(VkCommandPool pool): Buffer(pool) {}
+    ~PendingInteropCopies() {
+        // the dispatch got destroyed without going through one of the hooks
+        s_pendingCopies.Clear(*this);
+    }
+};
 
+static void AddPendingCopy(const vkroots::VkCommandBufferDispatch& pDispatch, SharedTexture* texture, const RND_Renderer::FrameCopy& frameCopy) {
+    if (!pDispatch.UserData.has()) {
+        // allocated before the layer could see its pool, so only resetting the buffer itself drops its copies
+        pDispatch.UserData.emplace<PendingInteropCopies>((VkCommandPool)VK_NULL_HANDLE);
+    }
+    s_pendingCopies.Add(pDispatch.UserData.cast<PendingInteropCopies>(), { texture, frameCopy });
+}
 
-std::mutex lockImageResolutions;
-std::unordered_map<VkImage, std::pair<VkExtent2D, VkFormat>> imageResolutions;
-
-std::mutex s_activeCopyMutex;
-std::vector<std::pair<VkCommandBuffer, SharedTexture*>> s_activeCopyOperations;
+static void ClearPendingCopies(const vkroots::VkCommandBufferDispatch& pDispatch) {
+    if (pDispatch.UserData.has()) {
+        s_pendingCopies.Clear(pDispatch.UserData.cast<PendingInteropCopies>());
+    }
+}
 
-VkImage s_curr3DColorImage = VK_NULL_HANDLE;
-VkImage s_curr3DDepthImage = VK_NULL_HANDLE;
+std::atomic<VkImage> s_curr3DColorImage = VK_NULL_HANDLE;
+std::atomic<VkImage> s_curr3DDepthImage = VK_NULL_HANDLE;
 
 using namespace VRLayer;
 
 VkResult VkDeviceOverrides::CreateImage(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, const VkImageCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImage* pImage) {
     VkResult res = pDispatch.CreateImage(device, pCreateInfo, pAllocator, pImage);
 
-    if (pCreateInfo->extent.width >= 1280 && pCreateInfo->extent.height >= 720) {
-        lockImageResolutions.lock();
-        checkAssert(imageResolutions.try_emplace(*pImage, std::make_pair(VkExtent2D{ pCreateInfo->extent.width, pCreateInfo->extent.height }, pCreateInfo->format)).second, "Couldn't insert image resolution into map!");
-        lockImageResolutions.unlock();
+    if (res == VK_SUCCESS && pCreateInfo->extent.width >= 1280 && pCreateInfo->extent.height >= 720) {
+        checkAssert(imageResolutions.Insert(*pImage, ImageResolution{ (uint16_t)pCreateInfo->extent.width, (uint16_t)pCreateInfo->extent.height, pCreateInfo->format }), "Couldn't insert image resolution into map!");
     }
     return res;
 }
 
 void VkDeviceOverrides::DestroyImage(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator) {
-    lockImageResolutions.lock();
-    imageResolutions.erase(image);
-    if (s_curr3DColorImage == image) {
-        s_curr3DColorImage = VK_NULL_HANDLE;
+    // evict before the driver can hand out the same handle again, so a recycled handle never inherits stale metadata
+    imageResolutions.Erase(image);
+    VkImage expectedImage = image;
+    if (!s_curr3DColorImage.compare_exchange_strong(expectedImage, VK_NULL_HANDLE)) {
+        expectedImage = image;
+        s_curr3DDepthImage.compare_exchange_strong(expectedImage, VK_NULL_HANDLE);
     }
-    else if (s_curr3DDepthImage == image) {
-        s_curr3DDepthImage = VK_NULL_HANDLE;
-    }
-    lockImageResolutions.unlock();
 
     pDispatch.DestroyImage(device, image, pAllocator);
 }
@@ -73,10 +109,10 @@ void VkDeviceOverrides::CmdClearColorImage(const vkroots::VkCommandBufferDispatc
     if (side != (OpenXR::EyeSide)-1) {
         // r value in magical clear value is the capture idx after rounding down
         const long captureIdx = std::lroundf(pColor->float32[0] * 32.0f);
-        const long frameIdx = pColor->float32[3] < 0.5f ? 0 : 1;
+        const uint32_t gameFrameCounter = pColor->float32[3] < 0.5f ? 0 : 1;
         checkAssert(captureIdx == 0 || captureIdx == 2, "Invalid capture index!");
 
-        Log::print<RENDERING>("[{}] Clearing color image for {} layer for {} side", frameIdx, captureIdx == 0 ? "3D" : "2D", side == OpenXR::EyeSide::LEFT ? "left" : "right");
+        Log::print<RENDERING>("[{}] Clearing color image for {} layer for {} side", gameFrameCounter, captureIdx == 0 ? "3D" : "2D", side == OpenXR::EyeSide::LEFT ? "left" : "right");
 
         auto* renderer = VRManager::instance().XR->GetRenderer();
         if (!renderer) {
@@ -90,12 +126,11 @@ void VkDeviceOverrides::CmdClearColorImage(const vkroots::VkCommandBufferDispatc
         // initialize the textures of both 2D and 3D layer if either is found since they share the same VkImage and resolution
         if (captureIdx == 0 || captureIdx == 2) {
             if (!layer2D) {
-                lockImageResolutions.lock();
-                if (const auto it = imageResolutions.find(image); it != imageResolutions.end()) {
+                if (const auto imageRes = imageResolutions.Find(image); imageRes.has_value()) {
                     auto viewConfs = VRManager::instance().XR->GetViewConfigurations();
 
-                    VkExtent2D renderRes = it->second.first;
-                    VkExtent2D swapchainRes = it->second.first;
+                    VkExtent2D renderRes = imageRes->GetExtent();
+                    VkExtent2D swapchainRes = imageRes->GetExtent();
                     if (VRManager::instance().XR->m_capabilities.isMetaSimulator) {
                         swapchainRes = VkExtent2D{ viewConfs[0].recommendedImageRectWidth, viewConfs[0].recommendedImageRectHeight };
                     }
@@ -104,26 +139,31 @@ void VkDeviceOverrides::CmdClearColorImage(const vkroots::VkCommandBufferDispatc
                     layer2D = std::make_unique<RND_Renderer::Layer2D>(renderRes, swapchainRes);
                     for (auto& textures : layer3D->GetSharedTextures()) {
                         for (auto& texture : textures) {
-                            texture->Init(commandBuffer);
+                            if (texture) {
+                                texture->Init(commandBuffer);
+                            }
                         }
                     }
                     for (auto& textures : layer3D->GetDepthSharedTextures()) {
                         for (auto& texture : textures) {
-                            texture->Init(commandBuffer);
+                            if (texture) {
+                                texture->Init(commandBuffer);
+                            }
                         }
                     }
                     for (auto& texture : layer2D->GetSharedTextures()) {
-                        texture->Init(commandBuffer);
+                        if (texture) {
+                            texture->Init(commandBuffer);
+                        }
                     }
 
-                    Log::print<INFO>("Found rendering resolution {}x{} @ {} using capture #{}", renderRes.width, renderRes.height, it->second.second, captureIdx);
+                    Log::print<INFO>("Found rendering resolution {}x{} @ {} using capture #{}", renderRes.width, renderRes.height, imageRes->format, captureIdx);
                     imguiOverlay = std::make_unique<RND_Renderer::ImGuiOverlay>(commandBuffer, renderRes, VK_FORMAT_A2B10G10R10_UNORM_PACK32);
                     VRManager::instance().Hooks->m_entityDebugger = std::make_unique<EntityDebugger>();
                 }
                 else {
                     checkAssert(false, "Couldn't find image resolution in map!");
                 }
-                lockImageResolutions.unlock();
             }
         }
 
@@ -133,6 +173,14 @@ void VkDeviceOverrides::CmdClearColorImage(const vkroots::VkCommandBufferDispatc
 
         checkAssert(layer3D && layer2D, "Couldn't find 3D or 2D layer!");
 
+        // hook_PlanEyeRendering acquired the slot when the game started this frame
+        const std::optional<long> frameSlot = renderer->FindFrameSlot(gameFrameCounter);
+        if (!frameSlot) {
+            Log::print<RENDERING>("[{}] The frame started before the renderer was initialized, skipping it", gameFrameCounter);
+            return;
+        }
+        const long frameIdx = *frameSlot;
+
         // change source image to GENERAL layout
         VulkanUtils::TransitionLayout(commandBuffer, image, imageLayout, VK_IMAGE_LAYOUT_GENERAL);
         VulkanUtils::DebugPipelineBarrier(commandBuffer);
@@ -143,6 +191,7 @@ void VkDeviceOverrides::CmdClearColorImage(const vkroots::VkCommandBufferDispatc
         };
 
         RND_Renderer::RenderFrame& frame = renderer->GetFrame(frameIdx);
+        const EyeScheduler::Plan eyePlan = frame.eyePlan;
 
         auto clearFramebuffer = [&](bool disableAlpha) -> void {
             VkClearColorValue clearColor = disableAlpha ? VkClearColorValue{ { 0.0f, 0.0f, 0.0f, 1.0f } } : VkClearColorValue{ { 0.0f, 0.0f, 0.0f, 0.0f } };
@@ -151,15 +200,16 @@ void VkDeviceOverrides::CmdClearColorImage(const vkroots::VkCommandBufferDispatc
 
         // 3D layer - color texture for 3D rendering
         if (captureIdx == 0) {
+            // with alternate-eye rendering the first pass can draw the right eye instead
+            const OpenXR::EyeSide eye = (OpenXR::EyeSide)EyeScheduler::GetPassEye(eyePlan, side);
+
             // check if the color texture has the appropriate texture format
             if (s_curr3DColorImage == VK_NULL_HANDLE) {
-                lockImageResolutions.lock();
-                if (const auto it = imageResolutions.find(image); it != imageResolutions.end()) {
-                    if (it->second.second == VK_FORMAT_A2B10G10R10_UNORM_PACK32) {
-                        s_curr3DColorImage = it->first;
+                if (const auto imageRes = imageResolutions.Find(image); imageRes.has_value()) {
+                    if (imageRes->format == VK_FORMAT_A2B10G10R10_UNORM_PACK32) {
+                        s_curr3DColorImage = image;
                     }
                 }
-                lockImageResolutions.unlock();
             }
 
             // don't clear the image if we're in the faux 2D mode
@@ -169,12 +219,12 @@ void VkDeviceOverrides::CmdClearColorImage(const vkroots::VkCommandBufferDispatc
             }
 
             if (image != s_curr3DColorImage) {
-                Log::print<RENDERING>("Color image is not the same as the current 3D color image! ({} != {})", (void*)image, (void*)s_curr3DColorImage);
+                Log::print<RENDERING>("Color image is not the same as the current 3D color image! ({} != {})", (void*)image, (void*)s_curr3DColorImage.load());
                 returnToLayout();
                 return clearFramebuffer(!VRManager::instance().XR->GetRenderer()->IsRendering3D(frameIdx));
             }
 
-            if (renderer->GetFrame(frameIdx).copiedColor[side]) {
+            if (renderer->GetFrame(frameIdx).copiedColor[eye]) {
                 // the color texture has already been copied to the layer
                 Log::print<RENDERING>("A 3D color texture is already been copied for the current frame!");
 
@@ -185,23 +235,27 @@ void VkDeviceOverrides::CmdClearColorImage(const vkroots::VkCommandBufferDispatc
                 return clearFramebuffer(false);
             }
 
-            // note: This uses vkCmdCopyImage to copy the image to the D3D12-created interop texture. s_activeCopyOperations queues a semaphore for the D3D12 side to wait on.
-            SharedTexture* texture = layer3D->CopyColorToLayer(side, commandBuffer, image, frameIdx);
-            renderer->On3DColorCopied(side, frameIdx);
-
-            {
-                std::lock_guard lk(s_activeCopyMutex);
-                s_activeCopyOperations.emplace_back(commandBuffer, texture);
+            // note: This uses vkCmdCopyImage to copy the image to the D3D12-created interop texture. The pending copy queues a semaphore for the D3D12 side to wait on once the command buffer is submitted.
+            std::optional<FrameTrace::Scope> traceScope;
+            if (side == EyeSide::LEFT) {
+                traceScope.emplace("Record 3D copy");
+                frame.traceFlowId = renderer->GetCameraTraceFlowId();
+                FrameTrace::FlowStep("Camera update", frame.traceFlowId);
             }
+            SharedTexture* texture = layer3D->CopyColorToLayer(eye, commandBuffer, image, frameIdx);
+            const RND_Renderer::FrameCopy frameCopy = renderer->On3DColorCopied(eye, frameIdx);
+            traceScope.reset();
+
+            AddPendingCopy(pDispatch, texture, frameCopy);
 
             if (CemuHooks::UseMonoFrameBufferTemporarilyDuringMenusOrPictures()) {
                 return;
             }
 
-            // imgui needs only one eye to render Cemu's 2D output, so use right side since it looks better
-            if (side == EyeSide::RIGHT) {
+            // imgui needs only one eye to render Cemu's 2D output, so use right side since it looks better, or whichever eye was rendered
+            if (eye == EyeSide::RIGHT || !EyeScheduler::RendersBothEyes(eyePlan)) {
                 // note: Uses vkCmdCopyImage to copy the (right-eye-only) image to the imgui overlay's texture
-                float aspectRatio = layer3D->GetAspectRatio(side);
+                float aspectRatio = layer3D->GetAspectRatio(eye);
                 imguiOverlay->Draw3DLayerAsBackground(commandBuffer, image, aspectRatio, frameIdx);
             }
 
@@ -229,29 +283,43 @@ void VkDeviceOverrides::CmdClearColorImage(const vkroots::VkCommandBufferDispatc
                         VulkanUtils::DebugPipelineBarrier(commandBuffer);
                     }
 
+                    // the ImGui pass blends the HUD onto a transparent image, which premultiplies its colors with its alpha
+                    bool hudPremultiplied = false;
                     if (imguiOverlay && !hudCopied) {
                         // render imgui, and then copy the framebuffer to the 2D layer
-                        imguiOverlay->Update();
-                        imguiOverlay->Render(frameIdx, false);
-                        imguiOverlay->DrawAndCopyToImage(commandBuffer, image, frameIdx);
-                        VulkanUtils::DebugPipelineBarrier(commandBuffer);
+                        // otherwise nothing would've been drawn on top, so the HUD goes to the layer as is
+                        if (imguiOverlay->ShouldRenderHUDPass(frameIdx)) {
+                            imguiOverlay->Update();
+                            imguiOverlay->Render(frameIdx, false);
+                            imguiOverlay->DrawAndCopyToImage(commandBuffer, image, frameIdx);
+                            VulkanUtils::DebugPipelineBarrier(commandBuffer);
+                            hudPremultiplied = true;
+                        }
                     }
 
                     // copy the HUD texture to D3D12 to be presented
                     // only copy the first attempt at capturing when GX2ClearColor is called with this capture index since the game/Cemu clears the 2D layer twice
-                    SharedTexture* texture = layer2D->CopyColorToLayer(commandBuffer, image, frameIdx);
-                    renderer->On2DCopied(frameIdx);
+                    SharedTexture* texture = layer2D->CopyColorToLayer(commandBuffer, image, frameIdx, hudPremultiplied);
+                    const RND_Renderer::FrameCopy frameCopy = renderer->On2DCopied(frameIdx);
 
-                    returnToLayout();
-                    {
-                        std::lock_guard lk(s_activeCopyMutex);
-                        s_activeCopyOperations.emplace_back(commandBuffer, texture);
+                    // a frame that only renders one eye has no right side pass, so the flatscreen image is composited here instead
+                    if (imguiOverlay && !EyeScheduler::RendersBothEyes(eyePlan)) {
+                        VulkanUtils::DebugPipelineBarrier(commandBuffer);
+                        imguiOverlay->Render(frameIdx, true);
+                        imguiOverlay->Update();
+                        imguiOverlay->DrawAndCopyToImage(commandBuffer, image, frameIdx);
+                        DebugDraw::instance().Clear();
                     }
+
+                    returnToLayout();
+                    AddPendingCopy(pDispatch, texture, frameCopy);
                     return;
                 }
             }
             if (side == EyeSide::RIGHT) {
                 // render the imgui overlay on the right side
+                // unlike the HUD layer's pass this one can't be skipped when no overlay is visible, since it's what composites the 3D image
+                // behind the HUD for Cemu's window, which has nothing else to draw it. Update only polls the mouse while it's needed though.
                 if (imguiOverlay) {
                     // render imgui, and then copy the framebuffer to the 2D layer
                     imguiOverlay->Render(frameIdx, true);
@@ -302,39 +370,36 @@ void VkDeviceOverrides::CmdClearDepthStencilImage(const vkroots::VkCommandBuffer
             return;
         }
 
+        const std::optional<long> frameSlot = VRManager::instance().XR->GetRenderer()->FindFrameSlot(frameCounter);
+        if (!frameSlot) {
+            Log::print<RENDERING>("[{}] The frame started before the renderer was initialized, skipping it", frameCounter);
+            return;
+        }
+        const long frameIdx = *frameSlot;
+        // with alternate-eye rendering the first pass can draw the right eye instead
+        const EyeScheduler::Plan eyePlan = VRManager::instance().XR->GetRenderer()->GetFrame(frameIdx).eyePlan;
+        side = (OpenXR::EyeSide)EyeScheduler::GetPassEye(eyePlan, side);
         Log::print<RENDERING>("[{}] Clearing depth image for 3D layer for {} side", frameCounter, side == OpenXR::EyeSide::LEFT ? "left" : "right");
 
-        // change source image to GENERAL layout
-        VulkanUtils::TransitionLayout(commandBuffer, image, imageLayout, VK_IMAGE_LAYOUT_GENERAL);
-        VulkanUtils::DebugPipelineBarrier(commandBuffer);
-
-        auto returnToLayout = [&]() {
-            VulkanUtils::TransitionLayout(commandBuffer, image, VK_IMAGE_LAYOUT_GENERAL, imageLayout);
-            VulkanUtils::DebugPipelineBarrier(commandBuffer);
-        };
-
         if (side == OpenXR::EyeSide::LEFT || side == OpenXR::EyeSide::RIGHT) {
             // 3D layer - depth texture for 3D rendering
             if (s_curr3DDepthImage == VK_NULL_HANDLE) {
-                lockImageResolutions.lock();
-                if (const auto it = imageResolutions.find(image); it != imageResolutions.end()) {
-                    if (it->second.second == VK_FORMAT_D32_SFLOAT) {
-                        s_curr3DDepthImage = it->first;
+                if (const auto imageRes = imageResolutions.Find(image); imageRes.has_value()) {
+                    if (imageRes->format == VK_FORMAT_D32_SFLOAT) {
+                        s_curr3DDepthImage = image;
                     }
                 }
-                lockImageResolutions.unlock();
             }
 
+            // checked before anything is recorded, so that a clear of some other image with the magic values can't complete the frame's depth
             if (image != s_curr3DDepthImage) {
-                Log::print<RENDERING>("Depth image is not the same as the current 3D depth image! ({} != {})", (void*)image, (void*)s_curr3DDepthImage);
-                returnToLayout();
+                Log::print<RENDERING>("Depth image is not the same as the current 3D depth image! ({} != {})", (void*)image, (void*)s_curr3DDepthImage.load());
                 return;
             }
 
-            if (VRManager::instance().XR->GetRenderer()->GetFrame(frameCounter).copiedDepth[side]) {
+            if (VRManager::instance().XR->GetRenderer()->GetFrame(frameIdx).copiedDepth[side]) {
                 // the depth texture has already been copied to the layer
                 Log::print<RENDERING>("A depth texture is already bound for the current frame!");
-                returnToLayout();
                 return;
             }
 
@@ -346,14 +411,23 @@ void VkDeviceOverrides::CmdClearDepthStencilImage(const vkroots::VkCommandBuffer
             //
             // checkAssert(layer3D.GetStatus() == Status3D::LEFT_BINDING_COLOR || layer3D.GetStatus() == Status3D::RIGHT_BINDING_COLOR, "3D layer is not in the correct state for capturing depth images!");
 
-            SharedTexture* texture = layer3D->CopyDepthToLayer(side, commandBuffer, image, frameCounter);
-            VRManager::instance().XR->GetRenderer()->On3DDepthCopied(side, frameCounter);
-
-            {
-                std::lock_guard lk(s_activeCopyMutex);
-                s_activeCopyOperations.emplace_back(commandBuffer, texture);
+            // without depth submission there's nothing to copy, but the frame still waits on both eyes' depth before it's complete
+            if (!layer3D->IsSubmittingDepth()) {
+                RND_Renderer* renderer = VRManager::instance().XR->GetRenderer();
+                renderer->OnCopySubmitted(renderer->On3DDepthCopied(side, frameIdx));
+                return;
             }
-            returnToLayout();
+
+            // change source image to GENERAL layout
+            VulkanUtils::TransitionLayout(commandBuffer, image, imageLayout, VK_IMAGE_LAYOUT_GENERAL);
+            VulkanUtils::DebugPipelineBarrier(commandBuffer);
+
+            SharedTexture* texture = layer3D->CopyDepthToLayer(side, commandBuffer, image, frameIdx);
+            const RND_Renderer::FrameCopy frameCopy = VRManager::instance().XR->GetRenderer()->On3DDepthCopied(side, frameIdx);
+
+            AddPendingCopy(pDispatch, texture, frameCopy);
+            VulkanUtils::TransitionLayout(commandBuffer, image, VK_IMAGE_LAYOUT_GENERAL, imageLayout);
+            VulkanUtils::DebugPipelineBarrier(commandBuffer);
             return;
         }
     }
@@ -362,16 +436,58 @@ void VkDeviceOverrides::CmdClearDepthStencilImage(const vkroots::VkCommandBuffer
     }
 }
 
+VkResult VkDeviceOverrides::BeginCommandBuffer(const vkroots::VkCommandBufferDispatch& pDispatch, VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo) {
+    // beginning a command buffer implicitly resets it, so anything recorded earlier won't be submitted anymore
+    ClearPendingCopies(pDispatch);
+    return pDispatch.BeginCommandBuffer(commandBuffer, pBeginInfo);
+}
+
+VkResult VkDeviceOverrides::ResetCommandBuffer(const vkroots::VkCommandBufferDispatch& pDispatch, VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags) {
+    ClearPendingCopies(pDispatch);
+    return pDispatch.ResetCommandBuffer(commandBuffer, flags);
+}
+
+VkResult VkDeviceOverrides::AllocateCommandBuffers(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers) {
+    VkResult result = pDispatch.AllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+    if (result == VK_SUCCESS) {
+        // remember the pool, since resetting or destroying it implicitly resets its command buffers
+        for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++) {
+            if (const vkroots::VkCommandBufferDispatch* cmdBufferDispatch = vkroots::LookupDispatch(pCommandBuffers[i])) {
+                cmdBufferDispatch->UserData.emplace<PendingInteropCopies>(pAllocateInfo->commandPool);
+            }
+        }
+    }
+    return result;
+}
+
+void VkDeviceOverrides::FreeCommandBuffers(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers) {
+    for (uint32_t i = 0; i < commandBufferCount; i++) {
+        if (pCommandBuffers[i] == VK_NULL_HANDLE) {
+            continue;
+        }
+        if (const vkroots::VkCommandBufferDispatch* cmdBufferDispatch = vkroots::LookupDispatch(pCommandBuffers[i])) {
+            ClearPendingCopies(*cmdBufferDispatch);
+        }
+    }
+    pDispatch.FreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+}
+
+VkResult VkDeviceOverrides::ResetCommandPool(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags) {
+    s_pendingCopies.ClearPool(commandPool);
+    return pDispatch.ResetCommandPool(device, commandPool, flags);
+}
+
+void VkDeviceOverrides::DestroyCommandPool(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator) {
+    s_pendingCopies.ClearPool(commandPool);
+    pDispatch.DestroyCommandPool(device, commandPool, pAllocator);
+}
+
 VkResult VkDeviceOverrides::QueueSubmit(const vkroots::VkQueueDispatch& pDispatch, VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence) {
+    FrameTrace::Scope traceScope("QueueSubmit");
+    ALLOC_TRACKER_SCOPE("QueueSubmit");
     VkResult result = VK_SUCCESS;
-    
-    size_t activeCopyCount;
-    {
-        std::lock_guard lk(s_activeCopyMutex);
-        activeCopyCount = s_activeCopyOperations.size();
-    }
 
-    if (activeCopyCount == 0) {
+    if (!s_pendingCopies.HasPendingCopies()) {
         result = pDispatch.QueueSubmit(queue, submitCount, pSubmits, fence);
     }
     else {
@@ -389,8 +505,7 @@ VkResult VkDeviceOverrides::QueueSubmit(const vkroots::VkQueueDispatch& pDispatc
         // insert (possible) pipeline barriers for any active copy operations
         std::vector<ModifiedSubmitInfo_t> modifiedSubmitInfos{ submitCount };
         std::vector<VkSubmitInfo> shadowSubmits{ submitCount };
-
-        std::lock_guard lk(s_activeCopyMutex);
+        std::vector<RND_Renderer::FrameCopy> submittedCopies;
 
         for (uint32_t i = 0; i < submitCount; i++) {
             const VkSubmitInfo& submitInfo = pSubmits[i];
@@ -429,26 +544,27 @@ VkResult VkDeviceOverrides::QueueSubmit(const vkroots::VkQueueDispatch& pDispatc
                 }
             }
 
-            // Insert timeline semaphores for active copy operations
+            // Insert timeline semaphores for the copies that were recorded into the submitted command buffers
             for (uint32_t j = 0; j < submitInfo.commandBufferCount; j++) {
-                for (auto it = s_activeCopyOperations.begin(); it != s_activeCopyOperations.end();) {
-                    if (submitInfo.pCommandBuffers[j] == it->first) {
-                        // Wait for D3D12/XR to finish with the previous shared texture render
-                        uint64_t waitValue = it->second->GetVulkanWaitValue();
-                        modifiedSubmitInfo.waitSemaphores.emplace_back(it->second->GetSemaphoreForWait(waitValue));
-                        modifiedSubmitInfo.waitDstStageMasks.emplace_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
-                        modifiedSubmitInfo.timelineWaitValues.emplace_back(waitValue);
-
-                        // Signal to D3D12/XR rendering that the shared texture can be rendered to VR headset
-                        uint64_t signalValue = it->second->GetVulkanSignalValue();
-                        modifiedSubmitInfo.signalSemaphores.emplace_back(it->second->GetSemaphoreForSignal(signalValue));
-                        modifiedSubmitInfo.timelineSignalValues.emplace_back(signalValue);
-                        it = s_activeCopyOperations.erase(it);
-                    }
-                    else {
-                        ++it;
-                    }
+                const vkroots::VkCommandBufferDispatch* cmdBufferDispatch = vkroots::LookupDispatch(submitInfo.pCommandBuffers[j]);
+                if (cmdBufferDispatch == nullptr || !cmdBufferDispatch->UserData.has()) {
+                    continue;
                 }
+
+                s_pendingCopies.Consume(cmdBufferDispatch->UserData.cast<PendingInteropCopies>(), [&](const InteropCopy& copy) {
+                    SharedTexture* texture = copy.texture;
+                    // Wait for D3D12/XR to finish with the previous shared texture render
+                    uint64_t waitValue = texture->GetVulkanWaitValue();
+                    modifiedSubmitInfo.waitSemaphores.emplace_back(texture->GetSemaphoreForWait(waitValue));
+                    modifiedSubmitInfo.waitDstStageMasks.emplace_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+                    modifiedSubmitInfo.timelineWaitValues.emplace_back(waitValue);
+
+                    // Signal to D3D12/XR rendering that the shared texture can be rendered to VR headset
+                    uint64_t signalValue = texture->GetVulkanSignalValue();
+                    modifiedSubmitInfo.signalSemaphores.emplace_back(texture->GetSemaphoreForSignal(signalValue));
+                    modifiedSubmitInfo.timelineSignalValues.emplace_back(signalValue);
+                    submittedCopies.emplace_back(copy.frameCopy);
+                });
             }
 
             // Update timeline semaphore submit info
@@ -470,24 +586,38 @@ VkResult VkDeviceOverrides::QueueSubmit(const vkroots::VkQueueDispatch& pDispatc
             shadowSubmits[i] = modifiedSubmitInfo.submitInfoCopy;
         }
         result = pDispatch.QueueSubmit(queue, submitCount, shadowSubmits.data(), fence);
+
+        // the XR frame loop can only wait on the timeline values of the copies once they're assigned and submitted
+        if (result == VK_SUCCESS) {
+            if (RND_Renderer* renderer = VRManager::instance().XR->GetRenderer()) {
+                for (const RND_Renderer::FrameCopy& frameCopy : submittedCopies) {
+                    renderer->OnCopySubmitted(frameCopy);
+                }
+            }
+        }
     }
 
     if (result != VK_SUCCESS) {
         Log::print<ERROR>("QueueSubmit failed with error {}", result);
     }
+    else if (VRManager::instance().VK) {
+        // the uploads that used the shared staging buffer can only be retired once their command buffers got submitted
+        VRManager::instance().VK->OnQueueSubmitted(queue, submitCount, pSubmits);
+    }
 
     return result;
 }
 
 VkResult VkDeviceOverrides::QueuePresentKHR(const vkroots::VkQueueDispatch& pDispatch, VkQueue queue, const VkPresentInfoKHR* pPresentInfo) {
+    FrameTrace::SetThreadName("Cemu GPU");
+    FrameTrace::OnFrame();
+    FrameTrace::Scope traceScope("QueuePresentKHR");
+
     VRManager::instance().XR->ProcessEvents();
 
     auto* renderer = VRManager::instance().XR->GetRenderer();
     if (renderer && renderer->m_layer3D && renderer->m_layer2D && renderer->m_imguiOverlay) {
-        if (renderer->IsInitialized()) {
-            renderer->EndFrame();
-        }
-        renderer->StartFrame();
+        renderer->OnGamePresent();
     }
 
     return pDispatch.QueuePresentKHR(queue, pPresentInfo);
@@ -0,0 +1,213 @@
+#include "pch.h"
+#include "gesture_zones.h"
+
+#include <fstream>
+#include <sstream>
+
+
+// The defaults match the distance checks that were used before the zones were data-driven
+GestureZones::GestureZones() {
+    constexpr float SHOULDER_RADIUS = 0.35f;
+    constexpr float MOUTH_RADIUS = 0.2f;
+    constexpr float WAIST_BEHIND_OFFSET = 0.05f;
+    constexpr float WAIST_HEIGHT = -0.45f;
+    constexpr float CHEST_HEIGHT = -0.3f;
+
+    ZoneShape leftShoulder;
+    leftShoulder.boxMax.x = 0.0f;
+    leftShoulder.boxMin.z = 0.0f;
+    leftShoulder.capsuleRadius = SHOULDER_RADIUS;
+    leftShoulder.hysteresis = 0.03f;
+    leftShoulder.dwell = 20'000'000;
+    SetShape(Zone::LEFT_SHOULDER, leftShoulder);
+
+    ZoneShape rightShoulder = leftShoulder;
+    rightShoulder.boxMin.x = 0.0f;
+    rightShoulder.boxMax.x = UNBOUNDED;
+    SetShape(Zone::RIGHT_SHOULDER, rightShoulder);
+
+    ZoneShape leftWaist;
+    leftWaist.boxMax.x = 0.0f;
+    leftWaist.boxMax.y = WAIST_HEIGHT;
+    leftWaist.boxMin.z = -WAIST_BEHIND_OFFSET;
+    leftWaist.hysteresis = 0.03f;
+    leftWaist.dwell = 20'000'000;
+    SetShape(Zone::LEFT_WAIST, leftWaist);
+
+    ZoneShape rightWaist = leftWaist;
+    rightWaist.boxMin.x = 0.0f;
+    rightWaist.boxMax.x = UNBOUNDED;
+    SetShape(Zone::RIGHT_WAIST, rightWaist);
+
+    // eating needs both hands here, the dwell keeps a hand passing by the face from triggering it
+    ZoneShape mouth;
+    mouth.boxMax.z = 0.0f;
+    mouth.capsuleRadius = MOUTH_RADIUS;
+    mouth.hysteresis = 0.03f;
+    mouth.dwell = 150'000'000;
+    SetShape(Zone::MOUTH, mouth);
+
+    ZoneShape front;
+    front.boxMax.z = -WAIST_BEHIND_OFFSET;
+    front.hysteresis = 0.02f;
+    SetShape(Zone::FRONT, front);
+
+    ZoneShape chestHeight;
+    chestHeight.boxMin.y = CHEST_HEIGHT;
+    chestHeight.hysteresis = 0.02f;
+    SetShape(Zone::CHEST_HEIGHT, chestHeight);
+}
+
+const char* GestureZones::GetZoneName(Zone zone) {
+    switch (zone) {
+        case Zone::LEFT_SHOULDER:
+            return "left_shoulder";
+        case Zone::RIGHT_SHOULDER:
+            return "right_shoulder";
+        case Zone::LEFT_WAIST:
+            return "left_waist";
+        case Zone::RIGHT_WAIST:
+            return "right_waist";
+        case Zone::MOUTH:
+            return "mouth";
+        case Zone::FRONT:
+            return "front";
+        case Zone::CHEST_HEIGHT:
+            return "chest_height";
+        default:
+            return "";
+    }
+}
+
+// -----------------------------------------------------------------------
+// Config
+// -----------------------------------------------------------------------
+
+bool GestureZones::LoadConfig(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (size_t comment = line.find('#'); comment != std::string::npos) {
+            line.resize(comment);
+        }
+
+        std::istringstream stream(line);
+        std::string zoneName;
+        if (!(stream >> zoneName)) {
+            continue;
+        }
+
+        std::optional<Zone> zone;
+        for (uint32_t i = 0; i < ZONE_COUNT; i++) {
+            if (zoneName == GetZoneName((Zone)i)) {
+                zone = (Zone)i;
+            }
+        }
+        if (!zone.has_value()) {
+            Log::print<WARNING>("Gesture zone config line {}: unknown zone \"{}\"", lineNumber, zoneName);
+            continue;
+        }
+
+        ZoneShape shape = m_shapes[std::to_underlying(*zone)];
+        std::string property;
+        stream >> property;
+        bool valid = false;
+        if (property == "box") {
+            valid = (bool)(stream >> shape.boxMin.x >> shape.boxMin.y >> shape.boxMin.z >> shape.boxMax.x >> shape.boxMax.y >> shape.boxMax.z);
+        }
+        else if (property == "capsule") {
+            valid = (bool)(stream >> shape.capsuleA.x >> shape.capsuleA.y >> shape.capsuleA.z >> shape.capsuleB.x >> shape.capsuleB.y >> shape.capsuleB.z >> shape.capsuleRadius);
+        }
+        else if (property == "hysteresis") {
+            valid = (bool)(stream >> shape.hysteresis);
+        }
+        else if (property == "dwell") {
+            float milliseconds = 0.0f;
+            valid = (bool)(stream >> milliseconds) && milliseconds >= 0.0f;
+            shape.dwell = (XrDuration)(milliseconds * 1e6f);
+        }
+
+        if (valid) {
+            SetShape(*zone, shape);
+        }
+        else {
+            Log::print<WARNING>("Gesture zone config line {}: couldn't parse \"{}\"", lineNumber, line);
+        }
+    }
+
+    Log::print<INFO>("Loaded gesture zones from {}", path.string());
+    return true;
+}
+
+// -----------------------------------------------------------------------
+// Classification
+// -----------------------------------------------------------------------
+
+glm::fvec3 GestureZones::ToBodyFrame(const glm::fvec3& position, const glm::fmat4& headsetMtx) {
+    // keep the previous yaw while looking straight up or down, where the flattened forward vector is meaningless
+    glm::fvec3 forward = -glm::fvec3(headsetMtx[2]);
+    forward.y = 0.0f;
+    if (glm::length2(forward) > 1e-4f) {
+        m_bodyForward = glm::normalize(forward);
+    }
+    const glm::fvec3 right = glm::cross(m_bodyForward, glm::fvec3(0.0f, 1.0f, 0.0f));
+
+    const glm::fvec3 offset = position - glm::fvec3(headsetMtx[3]);
+    return { glm::dot(offset, right), offset.y, -glm::dot(offset, m_bodyForward) };
+}
+
+bool GestureZones::IsInside(const ZoneShape& shape, const glm::fvec3& bodyPosition, float margin) {
+    if (glm::any(glm::lessThan(bodyPosition, shape.boxMin - margin)) || glm::any(glm::greaterThan(bodyPosition, shape.boxMax + margin))) {
+        return false;
+    }
+    if (shape.capsuleRadius <= 0.0f) {
+        return true;
+    }
+
+    const glm::fvec3 segment = shape.capsuleB - shape.capsuleA;
+    const float segmentLengthSq = glm::length2(segment);
+    const float t = segmentLengthSq > 0.0f ? glm::clamp(glm::dot(bodyPosition - shape.capsuleA, segment) / segmentLengthSq, 0.0f, 1.0f) : 0.0f;
+    const float radius = shape.capsuleRadius + margin;
+    return glm::length2(bodyPosition - (shape.capsuleA + segment * t)) < radius * radius;
+}
+
+std::array<GestureZones::ZoneMask, 2> GestureZones::Update(const std::array<std::optional<glm::fvec3>, 2>& handPositions, const glm::fmat4& headsetMtx, XrTime time) {
+    std::array<std::optional<glm::fvec3>, 2> bodyPositions;
+    for (size_t hand = 0; hand < 2; hand++) {
+        if (handPositions[hand].has_value()) {
+            bodyPositions[hand] = ToBodyFrame(*handPositions[hand], headsetMtx);
+        }
+    }
+
+    std::array<ZoneMask, 2> masks = { 0, 0 };
+    for (uint32_t i = 0; i < ZONE_COUNT; i++) {
+        const ZoneShape& shape = m_shapes[i];
+        for (size_t hand = 0; hand < 2; hand++) {
+            ZoneState& state = m_states[hand][i];
+            if (bodyPositions[hand].has_value() && IsInside(shape, *bodyPositions[hand], state.active ? shape.hysteresis : 0.0f)) {
+                if (state.enteredTime == 0) {
+                    state.enteredTime = time;
+                }
+                state.active = state.active || time - state.enteredTime >= shape.dwell;
+            }
+            else {
+                state = {};
+            }
+
+            if (state.active) {
+                masks[hand] |= 1u << i;
+            }
+        }
+    }
+    return masks;
+}
+
+void GestureZones::Reset() {
+    m_states = {};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <filesystem>
+
+
+// Body-relative zones that the hands can be put in to grab weapons from the back, eat, use the waist slot, etc.
+// Zones are defined in a body frame that is centered on the headset and only follows its yaw:
+// +X is to the right, +Y is up and +Z is behind the player (OpenXR's convention), in meters.
+// A zone is a box, optionally intersected with a capsule, and becomes active once the hand stayed inside of it for its dwell
+// time. It only becomes inactive again once the hand left the zone grown by its hysteresis margin, so that hovering at the
+// edge of a zone doesn't make it flicker.
+//
+// The defaults can be overridden from BetterVR_gesture_zones.txt, one command per line and '#' starts a comment:
+//   <zone> box <minX> <minY> <minZ> <maxX> <maxY> <maxZ>
+//   <zone> capsule <aX> <aY> <aZ> <bX> <bY> <bZ> <radius>     (a radius of 0 removes the capsule)
+//   <zone> hysteresis <meters>
+//   <zone> dwell <milliseconds>
+// where <zone> is one of left_shoulder, right_shoulder, left_waist, right_waist, mouth, front or chest_height.
+class GestureZones {
+public:
+    enum class Zone : uint8_t {
+        LEFT_SHOULDER,
+        RIGHT_SHOULDER,
+        LEFT_WAIST,
+        RIGHT_WAIST,
+        MOUTH,
+        FRONT,        // in front of the body, away from the slots
+        CHEST_HEIGHT, // above the chest, used for raising the shield
+
+        COUNT
+    };
+    static constexpr uint32_t ZONE_COUNT = std::to_underlying(Zone::COUNT);
+
+    // effectively unbounded along an axis, without having to deal with infinities when growing the box
+    static constexpr float UNBOUNDED = 10.0f;
+
+    struct ZoneShape {
+        glm::fvec3 boxMin = glm::fvec3(-UNBOUNDED);
+        glm::fvec3 boxMax = glm::fvec3(UNBOUNDED);
+        glm::fvec3 capsuleA = {};
+        glm::fvec3 capsuleB = {};
+        float capsuleRadius = 0.0f;
+        float hysteresis = 0.0f;
+        XrDuration dwell = 0;
+    };
+
+    // Which zones a hand is in, as bits indexed by Zone
+    using ZoneMask = uint32_t;
+    static constexpr ZoneMask Bit(Zone zone) { return 1u << std::to_underlying(zone); }
+
+    GestureZones();
+
+    const std::array<ZoneShape, ZONE_COUNT>& GetShapes() const { return m_shapes; }
+    void SetShape(Zone zone, const ZoneShape& shape) { m_shapes[std::to_underlying(zone)] = shape; }
+    static const char* GetZoneName(Zone zone);
+
+    // Applies the overrides from a config file, returns false if the file couldn't be opened
+    bool LoadConfig(const std::filesystem::path& path);
+
+    // Evaluates both hands against all zones and advances the dwell/hysteresis state, once per input update.
+    // Hands that aren't tracked should be passed as std::nullopt, which makes all of their zones inactive.
+    std::array<ZoneMask, 2> Update(const std::array<std::optional<glm::fvec3>, 2>& handPositions, const glm::fmat4& headsetMtx, XrTime time);
+    void Reset();
+
+    // Converts a stage space position into the yaw-aligned body frame of the given headset pose
+    glm::fvec3 ToBodyFrame(const glm::fvec3& position, const glm::fmat4& headsetMtx);
+    glm::fvec3 GetBodyForward() const { return m_bodyForward; }
+
+    static bool IsInside(const ZoneShape& shape, const glm::fvec3& bodyPosition, float margin);
+
+private:
+    struct ZoneState {
+        bool active = false;
+        XrTime enteredTime = 0; // 0 while the hand is outside of the zone
+    };
+
+    std::array<ZoneShape, ZONE_COUNT> m_shapes;
+    std::array<std::array<ZoneState, ZONE_COUNT>, 2> m_states = {};
+    glm::fvec3 m_bodyForward = { 0.0f, 0.0f, -1.0f };
+};
@@ -473,6 +473,7 @@ const std::vector<std::string> additionalDeviceExtensions = {
     VK_KHR_EXTERNAL_SEMAPHORE_EXTENSION_NAME,
     VK_KHR_EXTERNAL_SEMAPHORE_WIN32_EXTENSION_NAME,
     VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME,
+    VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME,
 #if ENABLE_VK_ROBUSTNESS
     VK_EXT_DEVICE_FAULT_EXTENSION_NAME,
     VK_EXT_ROBUSTNESS_2_EXTENSION_NAME,
@@ -511,13 +512,15 @@ VkResult VRLayer::VkInstanceOverrides::CreateDevice(const vkroots::VkPhysicalDev
 
     // Query supported features from the GPU
     VkPhysicalDeviceTimelineSemaphoreFeatures supportedTimelineSemaphoreFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES };
+    VkPhysicalDeviceHostQueryResetFeaturesEXT supportedHostQueryResetFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES_EXT };
     VkPhysicalDeviceFeatures2 supportedFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
     supportedFeatures.pNext = &supportedTimelineSemaphoreFeatures;
+    supportedTimelineSemaphoreFeatures.pNext = &supportedHostQueryResetFeatures;
 
 #if ENABLE_VK_ROBUSTNESS
     VkPhysicalDeviceImageRobustnessFeatures supportedImageRobustnessFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_ROBUSTNESS_FEATURES };
     VkPhysicalDeviceRobustness2FeaturesEXT supportedRobustness2Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ROBUSTNESS_2_FEATURES_EXT };
-    supportedTimelineSemaphoreFeatures.pNext = &supportedImageRobustnessFeatures;
+    supportedHostQueryResetFeatures.pNext = &supportedImageRobustnessFeatures;
     supportedImageRobustnessFeatures.pNext = &supportedRobustness2Features;
 #endif
 
@@ -525,6 +528,7 @@ VkResult VRLayer::VkInstanceOverrides::CreateDevice(const vkroots::VkPhysicalDev
 
     // Test if timeline semaphores are already enabled in the create info
     bool timelineSemaphoresEnabled = false;
+    bool hostQueryResetEnabled = false;
     bool imageRobustnessEnabled = false;
     bool robustness2Enabled = false;
     const void* current_pNext = pCreateInfo->pNext;
@@ -533,6 +537,9 @@ VkResult VRLayer::VkInstanceOverrides::CreateDevice(const vkroots::VkPhysicalDev
         if (base->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES) {
             timelineSemaphoresEnabled = true;
         }
+        if (base->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES_EXT) {
+            hostQueryResetEnabled = true;
+        }
 #if ENABLE_VK_ROBUSTNESS
         if (base->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_ROBUSTNESS_FEATURES) {
             imageRobustnessEnabled = true;
@@ -547,6 +554,10 @@ VkResult VRLayer::VkInstanceOverrides::CreateDevice(const vkroots::VkPhysicalDev
     VkPhysicalDeviceTimelineSemaphoreFeatures createSemaphoreFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES };
     createSemaphoreFeatures.timelineSemaphore = true;
 
+    // lets the GPU timer reset its timestamp queries from the CPU, see VulkanGpuTimer
+    VkPhysicalDeviceHostQueryResetFeaturesEXT createHostQueryResetFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES_EXT };
+    createHostQueryResetFeatures.hostQueryReset = true;
+
     VkPhysicalDeviceImageRobustnessFeatures createImageRobustnessFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_ROBUSTNESS_FEATURES };
     createImageRobustnessFeatures.robustImageAccess = true;
 
@@ -582,6 +593,11 @@ VkResult VRLayer::VkInstanceOverrides::CreateDevice(const vkroots::VkPhysicalDev
         Log::print<ERROR>("Timeline semaphores are not supported by this GPU! VR functionality may not work.");
     }
 
+    if (!hostQueryResetEnabled && isExtensionSupported(VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME) && supportedHostQueryResetFeatures.hostQueryReset) {
+        createHostQueryResetFeatures.pNext = nextChain;
+        nextChain = &createHostQueryResetFeatures;
+    }
+
     VkDeviceCreateInfo modifiedCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
     modifiedCreateInfo.pNext = nextChain;
     modifiedCreateInfo.flags = pCreateInfo->flags;
@@ -25,6 +25,14 @@ namespace VRLayer {
         static void CmdClearDepthStencilImage(const vkroots::VkCommandBufferDispatch& pDispatch, VkCommandBuffer commandBuffer, VkImage image, VkImageLayout imageLayout, const VkClearDepthStencilValue* pDepthStencil, uint32_t rangeCount, const VkImageSubresourceRange* pRanges);
         static VkResult QueuePresentKHR(const vkroots::VkQueueDispatch& pDispatch, VkQueue queue, const VkPresentInfoKHR* pPresentInfo);
 
+        // Overrides used for tracking which interop copies were recorded into a command buffer
+        static VkResult BeginCommandBuffer(const vkroots::VkCommandBufferDispatch& pDispatch, VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo);
+        static VkResult ResetCommandBuffer(const vkroots::VkCommandBufferDispatch& pDispatch, VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags);
+        static VkResult AllocateCommandBuffers(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers);
+        static void FreeCommandBuffers(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers);
+        static VkResult ResetCommandPool(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags);
+        static void DestroyCommandPool(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator);
+
 
         // frame manager
         static VkResult CreateSwapchainKHR(const vkroots::VkDeviceDispatch& pDispatch, VkDevice device, const VkSwapchainCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSwapchainKHR* pSwapchain);
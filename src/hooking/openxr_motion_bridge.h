@@ -8,183 +8,150 @@
 struct WiiUMotionData {
     glm::vec3 acc;
     glm::vec3 gyro;
-    glm::vec3 orientation; // Euler angles in Revolutions (x=Roll, y=Pitch, z=Yaw)
+    glm::vec3 orientation; // Euler angles in Revolutions (x=Yaw, y=Pitch, z=Roll)
     float jerk;
     struct {
         float w, x, y, z;
     } quad;
 };
 
+// Synthesizes the Wii U gamepad's motion sensors from a stream of OpenXR controller poses.
+// The pose stream is resampled at a fixed internal step so that the output only depends on the poses themselves and
+// not on how often or how evenly the game polls, which also keeps the finite differences from amplifying frame-time jitter.
+// Each instance tracks one controller.
 class OpenXRMotionBridge {
-private:
-    glm::vec3 lastEuler = { 0.0f, 0.0f, 0.0f };
-    glm::ivec3 winding = { 0, 0, 0 };
-    glm::vec3 lastAcc = { 0.0f, 0.0f, 0.0f };
-    bool firstFrame = true;
+public:
+    static constexpr XrDuration STEP_NS = 5'000'000; // 200Hz
+    static constexpr float STEP_SECONDS = (float)STEP_NS * 1e-9f;
+    // gaps longer than this (tracking loss, pauses) restart the synthesis instead of integrating across them
+    static constexpr XrDuration MAX_GAP_NS = 250'000'000;
+    // per-step weight of the newest acceleration estimate, the velocity from the runtime is too noisy to differentiate raw
+    static constexpr float ACC_SMOOTHING = 0.25f;
+    static inline const glm::vec3 GRAVITY = { 0.0f, 9.81f, 0.0f };
+
+    void Reset() {
+        m_hasSample = false;
+    }
 
-    // Constants
-    static constexpr float PIf = glm::pi<float>();
-    static constexpr float TWO_PIf = glm::two_pi<float>();
+    // Feeds one pose sample. orientation is the world space rotation (right-handed, Y-up), linearVelocity is in meters/sec.
+    WiiUMotionData AddSample(XrTime time, const glm::quat& orientation, const glm::vec3& linearVelocity) {
+        if (!m_hasSample || time <= m_sampleTime || time - m_sampleTime > MAX_GAP_NS) {
+            Restart(time, orientation, linearVelocity);
+        }
+        else {
+            // step through the interval between the previous and this sample, interpolating the pose for each step
+            const double interval = (double)(time - m_sampleTime);
+            for (XrTime stepTime = m_stepTime + STEP_NS; stepTime <= time; stepTime += STEP_NS) {
+                const float alpha = (float)((double)(stepTime - m_sampleTime) / interval);
+                Step(stepTime, glm::slerp(m_sampleOrientation, orientation, alpha), glm::mix(m_sampleVelocity, linearVelocity, alpha));
+            }
+        }
 
-public:
-    // Process OpenXR motion data and convert to Wii U format
-    // xrPose: World space pose (Standard Right-Handed, Y-Up)
-    // xrAngVel: Angular velocity in Radians/sec
-    // xrAccel: Acceleration in Meters/sec^2
+        m_sampleTime = time;
+        m_sampleOrientation = orientation;
+        m_sampleVelocity = linearVelocity;
+        return GetOutput();
+    }
 
-    WiiUMotionData Process(const glm::quat& xrPose, const glm::vec3& xrAngVel, const glm::vec3& xrAccel) {
-        WiiUMotionData out;
+    // orientation at the last fixed step, which is what the motion output describes
+    const glm::quat& GetOrientation() const { return m_stepOrientation; }
+    // the fixed steps trail the last sample by less than STEP_NS
+    XrTime GetStepTime() const { return m_stepTime; }
 
-        // 1. Map inputs to Cemu Coordinate System
-        // Based on SDL: Gyro passed as (x, -y, -z). Accel passed as (-x, y, z).
-        out.acc = glm::vec3(-xrAccel.x, xrAccel.y, xrAccel.z);
-        out.gyro = glm::vec3(xrAngVel.x, -xrAngVel.y, -xrAngVel.z);
+private:
+    // Cemu's Mahony filter assumes a rest pose of (0.707, 0.707, 0, 0), so a 90 degree rotation around X relative to OpenXR's identity
+    static inline const glm::quat MAHONY_OFFSET = glm::quat(0.70710678f, 0.70710678f, 0.0f, 0.0f);
+
+    // Euler angles using the formulas of Cemu's Mahony filter, as (roll, pitch, yaw) in radians
+    static glm::vec3 GetMahonyEuler(const glm::quat& q) {
+        const float roll = std::atan2(2.0f * (q.z * q.w + q.x * q.y), 1.0f - 2.0f * (q.w * q.w + q.x * q.x));
+        const float pitch = std::asin(glm::clamp(2.0f * (q.z * q.x - q.y * q.w), -1.0f, 1.0f));
+        const float yaw = std::atan2(2.0f * (q.z * q.y + q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+        return { roll, pitch, yaw };
+    }
 
-        // 2. Jerk calculation
-        if (firstFrame) {
-            out.jerk = 0.0f;
-            lastAcc = xrAccel; // Keep jerk calculation in raw space to avoid mixups
+    static float WrapAngle(float radians) {
+        return radians - glm::two_pi<float>() * std::floor((radians + glm::pi<float>()) / glm::two_pi<float>());
+    }
+
+    // body space angular velocity that rotates from -> to within one step
+    static glm::vec3 GetAngularVelocity(const glm::quat& from, const glm::quat& to) {
+        glm::quat delta = glm::inverse(from) * to;
+        if (delta.w < 0.0f) {
+            delta = -delta;
         }
-        else {
-            out.jerk = glm::length(xrAccel - lastAcc);
-            lastAcc = xrAccel;
+        const glm::vec3 axis = { delta.x, delta.y, delta.z };
+        const float sinHalfAngle = glm::length(axis);
+        if (sinHalfAngle < 1e-7f) {
+            return axis * (2.0f / STEP_SECONDS);
         }
+        const float angle = 2.0f * std::atan2(sinHalfAngle, delta.w);
+        return axis * (angle / (sinHalfAngle * STEP_SECONDS));
+    }
 
-        // 3. Transformation to Cemu/Mahony Reference Frame
-        // Cemu's Mahony filter assumes a rest pose of (0.707, 0.707, 0, 0)
-        // implying a 90 degree rotation around X relative to the identity.
-        // We apply this offset to the OpenXR pose.
-        static const glm::quat offsetQ = glm::quat(0.70710678f, 0.70710678f, 0.0f, 0.0f);
-        glm::quat q = offsetQ * xrPose;
-
-        // User Requirement: "quad: Quaternion (reordered {w, x, y, z})" for output.
-        // We output the transformed quaternion to match the Euler angles derived from it.
-        float w = q.w;
-        float x = q.x;
-        float y = q.y;
-        float z = q.z;
-
-        out.quad = { w, x, y, z };
-
-        // 4. Euler Extraction (Exact Mahony Formulas)
-        // These formulas are specific to the coordinate system used in Cemu's Mahony filter.
-        // They map the quaternion to (MahonyRoll, MahonyPitch, MahonyYaw).
-
-        // Mahony Roll (Corresponds to VPAD Roll / Z-axis)
-        // Formula: atan2(2(zw + xy), 1 - 2(w^2 + x^2))
-        float rollY = 2.0f * (z * w + x * y);
-        float rollX = 1.0f - 2.0f * (w * w + x * x);
-        float currentRoll = std::atan2(rollY, rollX);
-
-        // Mahony Pitch (Corresponds to VPAD Pitch / Y-axis)
-        // Formula: asin(2(zx - yw))
-        float pitchVal = 2.0f * (z * x - y * w);
-        if (pitchVal > 1.0f) pitchVal = 1.0f;
-        if (pitchVal < -1.0f) pitchVal = -1.0f;
-        float currentPitch = std::asin(pitchVal);
-
-        // Mahony Yaw (Corresponds to VPAD Yaw / X-axis)
-        // Formula: atan2(2(zy + wx), 1 - 2(x^2 + y^2))
-        float yawY = 2.0f * (z * y + w * x);
-        float yawX = 1.0f - 2.0f * (x * x + y * y);
-        float currentYaw = std::atan2(yawY, yawX);
-
-        if (firstFrame) {
-            lastEuler = { currentRoll, currentPitch, currentYaw };
-            firstFrame = false;
-        }
+    void Restart(XrTime time, const glm::quat& orientation, const glm::vec3& linearVelocity) {
+        m_hasSample = true;
+        m_stepTime = time;
+        m_stepOrientation = orientation;
+        m_stepVelocity = linearVelocity;
+        m_gyro = glm::vec3(0.0f);
+        m_acc = glm::inverse(orientation) * GRAVITY;
+        m_lastOutputAcc = m_acc;
+        m_mahonyEuler = GetMahonyEuler(MAHONY_OFFSET * orientation);
+        m_unwrappedEuler = m_mahonyEuler;
+    }
 
-        // 5. Winding Logic
-        auto updateWinding = [&](float current, float& last, int& windingVal) {
-            float diff = current - last;
-            if (diff > PIf) {
-                windingVal--;
-            }
-            else if (diff < -PIf) {
-                windingVal++;
-            }
-            last = current;
-        };
+    void Step(XrTime time, const glm::quat& orientation, const glm::vec3& linearVelocity) {
+        m_gyro = GetAngularVelocity(m_stepOrientation, orientation);
+
+        const glm::vec3 accWorld = (linearVelocity - m_stepVelocity) / STEP_SECONDS + GRAVITY;
+        m_acc = glm::mix(m_acc, glm::inverse(orientation) * accWorld, ACC_SMOOTHING);
 
-        // Track winding for each axis (Roll, Pitch, Yaw)
-        // Note: lastEuler stores {Roll, Pitch, Yaw} in Mahony definitions
-        updateWinding(currentRoll, lastEuler.x, winding.x);
-        updateWinding(currentPitch, lastEuler.y, winding.y);
-        updateWinding(currentYaw, lastEuler.z, winding.z);
+        // the angles only change a little per step, so unwrapping them never confuses a fast turn with a wrap-around
+        const glm::vec3 euler = GetMahonyEuler(MAHONY_OFFSET * orientation);
+        m_unwrappedEuler.x += WrapAngle(euler.x - m_mahonyEuler.x);
+        m_unwrappedEuler.y += WrapAngle(euler.y - m_mahonyEuler.y);
+        m_unwrappedEuler.z += WrapAngle(euler.z - m_mahonyEuler.z);
+        m_mahonyEuler = euler;
 
-        // 6. Final Value Mapping (MotionHandler to VPAD logic)
-        // MotionHandler maps Mahony values to VPAD indices as follows:
-        // Index 0 (Yaw):   -YawRad   - 0.5
-        // Index 1 (Pitch): -PitchRad - 0.5
-        // Index 2 (Roll):   RollRad
+        m_stepTime = time;
+        m_stepOrientation = orientation;
+        m_stepVelocity = linearVelocity;
+    }
 
-        float vpadYaw = (-currentYaw / TWO_PIf) - winding.z - 0.5;
-        float vpadPitch = (-currentPitch / TWO_PIf) - winding.y - 0.5;
-        float vpadRoll = (currentRoll / TWO_PIf) + winding.x;
+    WiiUMotionData GetOutput() {
+        WiiUMotionData out;
 
-        // Output vector: x=Yaw, y=Pitch, z=Roll
-        out.orientation = { vpadYaw, vpadPitch, vpadRoll };
+        // Cemu's SDL path passes gyro as (x, -y, -z) and acceleration as (-x, y, z)
+        out.acc = glm::vec3(-m_acc.x, m_acc.y, m_acc.z);
+        out.gyro = glm::vec3(m_gyro.x, -m_gyro.y, -m_gyro.z);
 
+        out.jerk = glm::length(m_acc - m_lastOutputAcc);
+        m_lastOutputAcc = m_acc;
+
+        const glm::quat q = MAHONY_OFFSET * m_stepOrientation;
+        out.quad = { q.w, q.x, q.y, q.z };
+
+        // MotionHandler maps the Mahony angles to the VPAD as yaw = -yaw - 0.5, pitch = -pitch - 0.5 and roll = roll, in revolutions
+        const glm::vec3 revolutions = m_unwrappedEuler / glm::two_pi<float>();
+        out.orientation = { -revolutions.z - 0.5f, -revolutions.y - 0.5f, revolutions.x };
         return out;
     }
 
-    static void UpdateVPADStatus(const OpenXR::InputState& inputs, VPADStatus& vpadStatus) {
-        // motion
-        static OpenXRMotionBridge motionBridge;
-        static glm::vec3 lastWorldVelocity = { 0.0f, 0.0f, 0.0f };
-        static XrTime lastInputTime = 0;
-
-        // Using Right Hand (index 1) for motion controls
-        const int handIdx = 1;
-        auto& poseState = inputs.shared.poseLocation[handIdx];
-        auto& velState = inputs.shared.poseVelocity[handIdx];
-
-        if ((poseState.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) && inputs.shared.in_game) {
-            glm::quat orientation = ToGLM(poseState.pose.orientation);
-            glm::vec3 angularVel = ToGLM(velState.angularVelocity);
-            glm::vec3 linearVel = ToGLM(velState.linearVelocity);
-
-            float dt = 1.0f / 60.0f;
-            if (lastInputTime != 0) {
-                dt = (float)(inputs.shared.inputTime - lastInputTime) * 1e-9f;
-            }
-            if (dt <= 1e-5f) dt = 1.0f / 60.0f;
-            if (dt > 0.1f) dt = 0.1f;
-            lastInputTime = inputs.shared.inputTime;
-
-            // Calculate Acceleration (World Space) + Gravity
-            glm::vec3 accWorld = (linearVel - lastWorldVelocity) / dt;
-            accWorld += glm::vec3(0.0f, 9.81f, 0.0f);
-            lastWorldVelocity = linearVel;
-
-            // Convert to Local Space
-            glm::quat invRot = glm::inverse(orientation);
-            glm::vec3 accLocal = invRot * accWorld;
-            glm::vec3 gyroLocal = invRot * angularVel;
-
-            WiiUMotionData motion = motionBridge.Process(orientation, gyroLocal, accLocal);
-
-            vpadStatus.acc = motion.acc;
-            vpadStatus.accMagnitude = glm::length(motion.acc);
-            vpadStatus.accAcceleration = motion.jerk;
-            vpadStatus.gyroChange = motion.gyro;
-            vpadStatus.gyroOrientation = motion.orientation;
-            vpadStatus.accXY = { motion.acc.x, motion.acc.y };
-
-            // Construct corrected orientation for 'dir' to match Bridge logic
-            // Bridge Logic: Invert Pitch, Invert Roll, Keep Yaw.
-            glm::vec3 euler = glm::eulerAngles(orientation); // Pitch(x), Yaw(y), Roll(z)
-            glm::quat corrected = glm::quat(glm::vec3(-euler.x, euler.y, -euler.z));
-
-            vpadStatus.dir.x = corrected * glm::vec3(1, 0, 0);
-            vpadStatus.dir.y = corrected * glm::vec3(0, 1, 0);
-            vpadStatus.dir.z = corrected * glm::vec3(0, 0, 1);
-        }
-        else {
-            vpadStatus.dir.x = glm::fvec3{ 1, 0, 0 };
-            vpadStatus.dir.y = glm::fvec3{ 0, 1, 0 };
-            vpadStatus.dir.z = glm::fvec3{ 0, 0, 1 };
-            vpadStatus.accXY = { 1.0f, 0.0f };
-        }
-    }
+    bool m_hasSample = false;
+
+    // last sample that was fed in
+    XrTime m_sampleTime = 0;
+    glm::quat m_sampleOrientation = glm::identity<glm::quat>();
+    glm::vec3 m_sampleVelocity = {};
+
+    // state at the last fixed step, which trails the last sample by less than one step
+    XrTime m_stepTime = 0;
+    glm::quat m_stepOrientation = glm::identity<glm::quat>();
+    glm::vec3 m_stepVelocity = {};
+    glm::vec3 m_gyro = {};
+    glm::vec3 m_acc = {};
+    glm::vec3 m_lastOutputAcc = {};
+    glm::vec3 m_mahonyEuler = {};
+    glm::vec3 m_unwrappedEuler = {};
 };
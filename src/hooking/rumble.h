@@ -1,10 +1,11 @@
 #pragma once
 
 #include "cemu_hooks.h"
+#include "rendering/xr_backend.h"
 
 class RumbleManager {
 public:
-    RumbleManager(XrSession session, XrAction haptic_action, XrPath subaction_path = XR_NULL_PATH) : m_session(session), m_haptic_action(haptic_action), m_subaction_path(subaction_path) {
+    RumbleManager(XrBackend* backend, XrSession session, XrAction haptic_action, XrPath subaction_path = XR_NULL_PATH) : m_backend(backend), m_session(session), m_haptic_action(haptic_action), m_subaction_path(subaction_path) {
         m_update_thread = std::thread(&RumbleManager::update_thread, this);
     }
 
@@ -176,7 +177,7 @@ public:
             haptic_info.action = m_haptic_action;
             haptic_info.subactionPath = m_handSubactionPaths[state.params.hand];
 
-            xrApplyHapticFeedback(m_session, &haptic_info, (const XrHapticBaseHeader*)&vibration);
+            m_backend->ApplyHapticFeedback(m_session, &haptic_info, (const XrHapticBaseHeader*)&vibration);
         }
     }
 
@@ -262,7 +263,7 @@ void apply_haptic_infinite() {
         haptic_info.action = m_haptic_action;
         haptic_info.subactionPath = m_subaction_path;
 
-        checkXRResult(xrApplyHapticFeedback(m_session, &haptic_info, (const XrHapticBaseHeader*)&vibration), "Failed to start rumble");
+        checkXRResult(m_backend->ApplyHapticFeedback(m_session, &haptic_info, (const XrHapticBaseHeader*)&vibration), "Failed to start rumble");
 
         m_haptic_start_time = std::chrono::steady_clock::now();
         m_haptic_active = true;
@@ -275,7 +276,7 @@ void apply_haptic_infinite() {
         haptic_info.action = m_haptic_action;
         haptic_info.subactionPath = m_subaction_path;
 
-        checkXRResult(xrStopHapticFeedback(m_session, &haptic_info), "Failed to stop rumble");
+        checkXRResult(m_backend->StopHapticFeedback(m_session, &haptic_info), "Failed to stop rumble");
 
         if (m_haptic_active) {
             auto end_time = std::chrono::steady_clock::now();
@@ -286,6 +287,7 @@ void apply_haptic_infinite() {
     }
 
     XrInstance m_instance;
+    XrBackend* m_backend;
     XrSession m_session;
     XrAction m_haptic_action;
     XrPath m_subaction_path;
@@ -3,6 +3,7 @@
 #include "instance.h"
 #include "hooking/entity_debugger.h"
 #include "utils/mod_settings.h"
+#include "utils/alloc_tracker.h"
 
 ModSettings g_settings = {};
 
@@ -91,19 +92,29 @@ HWND CemuHooks::m_cemuTopWindow = NULL;
 HWND CemuHooks::m_cemuRenderWindow = NULL;
 uint64_t CemuHooks::s_memoryBaseAddress = 0;
 std::atomic_uint32_t CemuHooks::s_framesSinceLastCameraUpdate = 0;
+std::atomic_uint32_t CemuHooks::s_frameEpoch = 1;
 
 
-bool CemuHooks::IsScreenOpen(ScreenId screen) {
-    uint32_t screenManagerInstance = getMemory<BEType<uint32_t>>(0x1047E650).getLE();
-    if (screenManagerInstance != 0) {
-        uint32_t screenBools = getMemory<BEType<uint32_t>>(screenManagerInstance + 0x18).getLE();
-        uint32_t screenPtr = getMemory<BEType<uint32_t>>(screenBools + (std::to_underlying(screen) * 4)).getLE();
-        return screenPtr != 0;
+std::array<std::atomic_uint64_t, ScreenStates::WORD_COUNT> CemuHooks::s_openScreens = {};
+
+ScreenStates CemuHooks::ReadScreenStates() {
+    return ScreenStates::ReadFromGuest([](uint32_t address, void* destination, size_t size) {
+        memcpy(destination, (void*)(s_memoryBaseAddress + address), size);
+    });
+}
+
+ScreenStates CemuHooks::GetScreenStates() {
+    ScreenStates states;
+    for (uint32_t i = 0; i < ScreenStates::WORD_COUNT; i++) {
+        states.words[i] = s_openScreens[i].load(std::memory_order_relaxed);
     }
-    return false;
+    return states;
 }
 
-std::unordered_set<ScreenId> prevEnabledScreens = {};
+bool CemuHooks::IsScreenOpen(ScreenId screen) {
+    const uint32_t idx = std::to_underlying(screen);
+    return (s_openScreens[idx / 64].load(std::memory_order_relaxed) >> (idx % 64)) & 1;
+}
 
 void CemuHooks::InitWindowHandles() {
     // find HWND that starts with Cemu in its title
@@ -153,29 +164,31 @@ void CemuHooks::hook_UpdateSettings(PPCInterpreter_t* hCPU) {
     }
 
     ++s_framesSinceLastCameraUpdate;
+    ++s_frameEpoch;
+
+#if ENABLE_HOOK_PROFILER
+    HookProfiler::EndFrame();
+#endif
+#if ENABLE_ALLOC_TRACKER
+    AllocTracker::EndFrame();
+#endif
+    FrameTrace::SetThreadName("PPC");
+
+    // snapshot which screens are open once per frame so that IsScreenOpen doesn't have to chase guest pointers
+    const ScreenStates prevScreens = GetScreenStates();
+    const ScreenStates currScreens = ReadScreenStates();
+    for (uint32_t i = 0; i < ScreenStates::WORD_COUNT; i++) {
+        s_openScreens[i].store(currScreens.words[i], std::memory_order_relaxed);
+    }
 
 #ifdef _DEBUG
-    constexpr uint32_t maxScreenIdx = std::to_underlying(ScreenId::ScreenId_END);
-    std::unordered_set<ScreenId> currentEnabledScreens;
-    for (uint32_t i = 0; i < maxScreenIdx; i++) {
-        ScreenId id = (ScreenId)i;
-        bool hasScreen = IsScreenOpen(id);
-
-        if (hasScreen) {            
-
-            if (!prevEnabledScreens.contains(id)) {
-                if (currentEnabledScreens.empty()) {
-                    Log::print<INFO>("---------");
-                }
-                Log::print<INFO>("Screen {} is ON", ScreenIdToString((ScreenId)i));
-            }
-            currentEnabledScreens.emplace(id);
-        }
-        else if (prevEnabledScreens.contains(id)) {
-            Log::print<INFO>("Screen {} is OFF", ScreenIdToString((ScreenId)i));
-        }
+    const ScreenStates changedScreens = currScreens ^ prevScreens;
+    if (changedScreens.Any()) {
+        Log::print<INFO>("---------");
+        changedScreens.ForEachScreen([&](ScreenId id) {
+            Log::print<INFO>("Screen {} is {}", ScreenIdToString(id), currScreens.IsOpen(id) ? "ON" : "OFF");
+        });
     }
-    prevEnabledScreens = currentEnabledScreens;
 #endif
 
     initCutsceneDefaultSettings(ppc_tableOfCutsceneEventSettings);
@@ -1,6 +1,8 @@
 #include "instance.h"
 #include "cemu_hooks.h"
 #include "rendering/openxr.h"
+#include "utils/endian_convert_glm.h"
+#include "utils/pose_predictor.h"
 
 struct Bone {
     std::string name;
@@ -281,8 +283,7 @@ void CemuHooks::hook_ModifyBoneMatrix(PPCInterpreter_t* hCPU) {
 
     // helpers to write back matrix and scale
     auto writeBoneMatrix = [&](const glm::mat4x3& mtx, const glm::fvec3& scale) {
-        BEMatrix34 m{ mtx };
-        setMemory(matrixPtr, m);
+        setMemory(matrixPtr, EndianConvert::ToBE(mtx));
         setMemory(scalePtr, scale);
     };
     auto writeBoneQuat = [&](const glm::vec3& pos, const glm::quat& rot, const glm::fvec3& scale) {
@@ -305,14 +306,22 @@ void CemuHooks::hook_ModifyBoneMatrix(PPCInterpreter_t* hCPU) {
     }
 
     glm::fvec3 boneScale = getMemory<BEVec3>(scalePtr).getLE();
-    const glm::fmat4 playerMtx4 = glm::fmat4(getMemory<BEMatrix34>(s_playerMtxAddress).getLEMatrix());
+    const FrameSnapshot& snapshot = GetFrameSnapshot();
+    if (!snapshot.hasPlayer)
+        return;
+    const glm::fmat4& playerMtxInverse = snapshot.playerMtxInverse;
     const glm::mat4 cameraMtx = s_lastCameraMtx;
 
     const OpenXR::InputState inputs = VRManager::instance().XR->m_input.load();
     if (!inputs.shared.pose[side].isActive)
         return;
 
-    const auto& pose = inputs.shared.poseLocation[side];
+    auto pose = inputs.shared.poseLocation[side];
+    // the hands were sampled for an earlier display time than the one this game frame will end up being shown at
+    if (GetSettings().ShouldPredictHandPoses()) {
+        const XrDuration horizon = VRManager::instance().XR->GetRenderer()->GetInputToDisplayLag();
+        pose.pose = PosePredictor::Predict(pose.pose, inputs.shared.poseMotion[side], horizon);
+    }
     glm::fvec3 controllerPos = glm::fvec3();
     glm::fquat controllerRot = glm::identity<glm::fquat>();
     if (pose.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT)
@@ -358,7 +367,7 @@ void CemuHooks::hook_ModifyBoneMatrix(PPCInterpreter_t* hCPU) {
             targetWorld = targetWorld * glm::translate(glm::identity<glm::mat4>(), -weaponOffset);
         }
 
-        return glm::inverse(playerMtx4) * targetWorld;
+        return playerMtxInverse * targetWorld;
     };
 
     glm::mat4 calculatedLocalMat = s_skeleton.GetBone(boneIndex)->localMatrix;
@@ -383,7 +392,7 @@ void CemuHooks::hook_ModifyBoneMatrix(PPCInterpreter_t* hCPU) {
         }
 
         // headset in model space
-        glm::mat4 headsetModel = glm::inverse(playerMtx4) * cameraMtx * headsetMtx;
+        glm::mat4 headsetModel = playerMtxInverse * cameraMtx * headsetMtx;
 
         // extract yaw-only rotation (twist around Y)
         glm::quat headsetRot = glm::quat_cast(headsetModel);
@@ -6,6 +6,8 @@
 std::array<WeaponMotionAnalyser, 2> CemuHooks::m_motionAnalyzers = {};
 std::array<uint32_t, 2> CemuHooks::m_heldWeapons = { 0, 0 };
 std::array<uint32_t, 2> CemuHooks::m_heldWeaponsLastUpdate = { 0, 0 };
+// the frame epoch that the motion analysis of each hand last ran in, 0 is never since the epoch starts at 1
+static std::array<uint32_t, 2> s_motionAnalysisEpochs = { 0, 0 };
 
 std::array s_cameraRotations = {
     glm::identity<glm::fquat>(),
@@ -150,10 +152,15 @@ void CemuHooks::hook_ChangeWeaponMtx(PPCInterpreter_t* hCPU) {
     uint32_t targetActorPtr = hCPU->gpr[8]; // weapon that's being held
     uint32_t cameraPtr = hCPU->gpr[10];
 
+    // read once, it's needed for both the bow aiming check and the first-person weapon logic
+    std::string actorName;
+    if (actorPtr != 0) {
+        actorName = getMemory<sead::FixedSafeString40>(actorPtr + offsetof(ActorWiiU, name)).getLE();
+    }
+
     if (actorPtr != 0 && boneNamePtr != 0) {
-        sead::FixedSafeString40 actorName = getMemory<sead::FixedSafeString40>(actorPtr + offsetof(ActorWiiU, name));
         char* boneName = (char*)s_memoryBaseAddress + boneNamePtr;
-        if (actorName.getLE() == "GameROMPlayer" && (strcmp(boneName, "Weapon_L") == 0 || strcmp(boneName, "Weapon_R") == 0)) {
+        if (actorName == "GameROMPlayer" && (strcmp(boneName, "Weapon_L") == 0 || strcmp(boneName, "Weapon_R") == 0)) {
             Weapon targetActor = {};
             readMemory(targetActorPtr, &targetActor);
 
@@ -172,8 +179,6 @@ void CemuHooks::hook_ChangeWeaponMtx(PPCInterpreter_t* hCPU) {
         return;
     }
 
-    sead::FixedSafeString40 actorName = getMemory<sead::FixedSafeString40>(actorPtr + offsetof(ActorWiiU, name));
-
     // todo: remove this?
     BESeadLookAtCamera camera = {};
     readMemory(cameraPtr, &camera);
@@ -189,13 +194,13 @@ void CemuHooks::hook_ChangeWeaponMtx(PPCInterpreter_t* hCPU) {
     char* boneName = (char*)s_memoryBaseAddress + boneNamePtr;
 
     // real logic
-    bool isHeldByPlayer = actorName.getLE() == "GameROMPlayer";
+    bool isHeldByPlayer = actorName == "GameROMPlayer";
     bool isLeftHandWeapon = strcmp(boneName, "Weapon_L") == 0;
     bool isRightHandWeapon = strcmp(boneName, "Weapon_R") == 0;
 
     //Log::print<INFO>("boneName : {}", boneName);
 
-    if (!actorName.getLE().empty() && boneName[0] != '\0' && isHeldByPlayer && (isLeftHandWeapon || isRightHandWeapon)) {
+    if (!actorName.empty() && boneName[0] != '\0' && isHeldByPlayer && (isLeftHandWeapon || isRightHandWeapon)) {
         OpenXR::EyeSide side = isLeftHandWeapon ? OpenXR::EyeSide::LEFT : OpenXR::EyeSide::RIGHT;
 
         m_heldWeapons[side] = targetActorPtr;
@@ -378,7 +383,6 @@ void CemuHooks::hook_EnableWeaponAttackSensor(PPCInterpreter_t* hCPU) {
     uint32_t weaponPtr = hCPU->gpr[3];
     uint32_t heldIndex = hCPU->gpr[5]; // this is either 0 or 1 depending on which hand the weapon is in
     bool isHeldByPlayer = hCPU->gpr[6] == 0;
-    uint32_t frameCounter = hCPU->gpr[7];
 
     Weapon weapon = {};
     readMemory(weaponPtr, &weapon);
@@ -403,12 +407,13 @@ void CemuHooks::hook_EnableWeaponAttackSensor(PPCInterpreter_t* hCPU) {
         return;
     }
 
-    auto& currFrame = VRManager::instance().XR->GetRenderer()->GetFrame(frameCounter);
-    if (currFrame.ranMotionAnalysis[heldIndex]) {
+    // the game's 0/1 counter can't tell a skipped frame apart from the same frame, the epoch advances once per game frame
+    const uint32_t frameEpoch = s_frameEpoch;
+    if (s_motionAnalysisEpochs[heldIndex] == frameEpoch) {
         Log::print<CONTROLS>("Skipping motion analysis for {}: already ran this frame", heldIndex);
         return;
     }
-    currFrame.ranMotionAnalysis[heldIndex] = true;
+    s_motionAnalysisEpochs[heldIndex] = frameEpoch;
 
     heldIndex = heldIndex == 0 ? 1 : 0;
 
@@ -535,10 +540,12 @@ void CemuHooks::hook_EquipWeapon(PPCInterpreter_t* hCPU) {
 void CemuHooks::hook_DropWeaponLogging(PPCInterpreter_t* hCPU) {
     hCPU->instructionPointer = hCPU->sprNew.LR;
 
-    uint32_t actorPtr = hCPU->gpr[3];
+    // everything below only exists for the log line
+    if (!Log::isEnabled<CONTROLS>()) {
+        return;
+    }
 
-    PlayerOrEnemy player;
-    readMemory(actorPtr, &player);
+    uint32_t actorPtr = hCPU->gpr[3];
 
     uint32_t actorLinkPtr = actorPtr + offsetof(ActorWiiU, name) + offsetof(sead::FixedSafeString40, c_str);
     uint32_t actorNamePtr = 0;
@@ -66,9 +66,12 @@ RND_D3D12::RND_D3D12() {
         .Flags = D3D12_COMMAND_QUEUE_FLAG_NONE
     };
     checkHResult(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_queue)), "Failed to create D3D12 command queue!");
+
+    m_gpuTimer = std::make_unique<D3D12GpuTimer>(m_device.Get(), m_queue.Get());
 }
 
 RND_D3D12::~RND_D3D12() {
+    m_gpuTimer.reset();
 }
 
 template <bool depth>
@@ -235,14 +238,14 @@ void RND_D3D12::PresentPipeline<depth>::BindDepthTarget(ID3D12Resource* dstTextu
 }
 
 template <bool depth>
-void RND_D3D12::PresentPipeline<depth>::BindSettings(float screenWidth, float screenHeight) {
+void RND_D3D12::PresentPipeline<depth>::BindSettings(float screenWidth, float screenHeight, bool premultiplyAlpha) {
     ComPtr<ID3D12Resource> newSettingsStaging;
     ComPtr<ID3D12CommandAllocator> newSettingsAllocator;
     {
         ID3D12Device* device = VRManager::instance().D3D12->GetDevice();
         ID3D12CommandQueue* queue = VRManager::instance().D3D12->GetCommandQueue();
         device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&newSettingsAllocator));
-        RND_D3D12::CommandContext<true> uploadBufferContext(device, queue, newSettingsAllocator.Get(), [this, device, &newSettingsStaging, screenWidth, screenHeight](RND_D3D12::CommandContext<true>* context) {
+        RND_D3D12::CommandContext<true> uploadBufferContext(device, queue, newSettingsAllocator.Get(), [this, device, &newSettingsStaging, screenWidth, screenHeight, premultiplyAlpha](RND_D3D12::CommandContext<true>* context) {
             m_settingsBuffer = D3D12Utils::CreateConstantBuffer(device, D3D12_HEAP_TYPE_DEFAULT, sizeof(presentSettings));
 
             newSettingsStaging = D3D12Utils::CreateConstantBuffer(device, D3D12_HEAP_TYPE_UPLOAD, sizeof(presentSettings));
@@ -254,6 +257,7 @@ void RND_D3D12::PresentPipeline<depth>::BindSettings(float screenWidth, float sc
                 .renderHeight = screenHeight,
                 .swapchainWidth = screenWidth,
                 .swapchainHeight = screenHeight,
+                .premultiplyAlpha = premultiplyAlpha ? 1.0f : 0.0f,
             };
             memcpy(data, &settings, sizeof(presentSettings));
             newSettingsStaging->Unmap(0, nullptr);
@@ -341,15 +345,18 @@ void RND_D3D12::PresentPipeline<depth>::RecreatePipeline() {
 }
 
 template <bool depth>
-void RND_D3D12::PresentPipeline<depth>::Render(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* swapchain) {
+void RND_D3D12::PresentPipeline<depth>::Render(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* swapchain, std::optional<XrExtent2Di> renderExtent) {
     cmdList->SetPipelineState(m_pipelineState.Get());
     cmdList->SetGraphicsRootSignature(m_signature.Get());
 
     // set framebuffer
-    D3D12_VIEWPORT viewportSize = { 0.0f, 0.0f, (float)swapchain->GetDesc().Width, (float)swapchain->GetDesc().Height, 0.0f, 1.0f };
+    const D3D12_RESOURCE_DESC swapchainDesc = swapchain->GetDesc();
+    const LONG width = renderExtent ? std::min((LONG)renderExtent->width, (LONG)swapchainDesc.Width) : (LONG)swapchainDesc.Width;
+    const LONG height = renderExtent ? std::min((LONG)renderExtent->height, (LONG)swapchainDesc.Height) : (LONG)swapchainDesc.Height;
+    D3D12_VIEWPORT viewportSize = { 0.0f, 0.0f, (float)width, (float)height, 0.0f, 1.0f };
     cmdList->RSSetViewports(1, &viewportSize);
 
-    D3D12_RECT scissorRect = { 0, 0, (LONG)swapchain->GetDesc().Width, (LONG)swapchain->GetDesc().Height };
+    D3D12_RECT scissorRect = { 0, 0, width, height };
     cmdList->RSSetScissorRects(1, &scissorRect);
 
     // set settings
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "openxr.h"
+#include "gpu_timer.h"
 
 class RND_D3D12 {
     friend class RND_Renderer;
@@ -11,6 +12,7 @@ public:
 
     ID3D12Device* GetDevice() { return m_device.Get(); };
     ID3D12CommandQueue* GetCommandQueue() { return m_queue.Get(); };
+    D3D12GpuTimer& GetGpuTimer() { return *m_gpuTimer; }
 
     void StartFrame() {
         checkHResult(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_allocator)), "Failed to created D3D12_CommandContext's allocator!");
@@ -43,8 +45,9 @@ public:
         void BindAttachment(uint32_t attachmentIdx, ID3D12Resource* srcTexture, DXGI_FORMAT overwriteFormat = DXGI_FORMAT_UNKNOWN);
         void BindTarget(uint32_t targetIdx, ID3D12Resource* dstTexture, DXGI_FORMAT overwriteFormat = DXGI_FORMAT_UNKNOWN);
         void BindDepthTarget(ID3D12Resource* dstTexture, DXGI_FORMAT overwriteFormat);
-        void BindSettings(float screenWidth, float screenHeight);
-        void Render(ID3D12GraphicsCommandList* commandList, ID3D12Resource* swapchain);
+        void BindSettings(float screenWidth, float screenHeight, bool premultiplyAlpha = false);
+        // renderExtent limits the output to the top-left part of the swapchain, e.g. for dynamic resolution
+        void Render(ID3D12GraphicsCommandList* commandList, ID3D12Resource* swapchain, std::optional<XrExtent2Di> renderExtent = std::nullopt);
 
     private:
         void RecreatePipeline();
@@ -126,4 +129,5 @@ private:
     ComPtr<ID3D12CommandQueue> m_queue;
     ComPtr<ID3D12CommandAllocator> m_allocator;
     ComPtr<ID3D12Fence> m_fence;
+    std::unique_ptr<D3D12GpuTimer> m_gpuTimer;
 };
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "gpu_timer.h"
+#include "utils/logger.h"
+
+// the results are read a few frames after they were recorded, so the ring has to hold at least that many frames
+constexpr uint32_t TIMED_FRAMES_IN_FLIGHT = 8;
+
+
+VulkanGpuTimer::VulkanGpuTimer(VkDevice device, VkPhysicalDevice physicalDevice, const vkroots::VkDeviceDispatch* dispatch, const vkroots::VkInstanceDispatch* instanceDispatch): m_device(device), m_dispatch(dispatch) {
+    VkPhysicalDeviceProperties props = {};
+    instanceDispatch->GetPhysicalDeviceProperties(physicalDevice, &props);
+
+    // Cemu doesn't tell us which queue it renders on, but it's the first queue family with graphics support
+    uint32_t queueFamilyCount = 0;
+    instanceDispatch->GetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    instanceDispatch->GetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    uint32_t validBits = 0;
+    for (const VkQueueFamilyProperties& queueFamily : queueFamilies) {
+        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            validBits = queueFamily.timestampValidBits;
+            break;
+        }
+    }
+
+    if (!props.limits.timestampComputeAndGraphics || props.limits.timestampPeriod <= 0.0f || validBits == 0) {
+        Log::print<WARNING>("The GPU doesn't support Vulkan timestamps, the interop copies won't be timed");
+        return;
+    }
+
+    // the layer enables VK_EXT_host_query_reset whenever the GPU supports it
+    uint32_t extensionCount = 0;
+    instanceDispatch->EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    instanceDispatch->EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+    const bool hasHostQueryResetExtension = std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties& extension) {
+        return std::string_view(extension.extensionName) == VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME;
+    });
+
+    VkPhysicalDeviceHostQueryResetFeaturesEXT hostQueryResetFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES_EXT };
+    VkPhysicalDeviceFeatures2 features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+    features.pNext = &hostQueryResetFeatures;
+    instanceDispatch->GetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+    if (!hasHostQueryResetExtension || !hostQueryResetFeatures.hostQueryReset) {
+        Log::print<WARNING>("The GPU doesn't support resetting queries from the CPU, the interop copies won't be timed");
+        return;
+    }
+
+    m_ring = std::make_unique<GpuTimestampRing>((uint32_t)Pass::COUNT, TIMED_FRAMES_IN_FLIGHT, GpuTimestampRing::Calibration{ .nanosecondsPerTick = (double)props.limits.timestampPeriod, .validBits = validBits });
+
+    VkQueryPoolCreateInfo createInfo = {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = m_ring->GetQueryCount()
+    };
+    if (m_dispatch->CreateQueryPool(m_device, &createInfo, nullptr, &m_queryPool) != VK_SUCCESS) {
+        Log::print<WARNING>("Failed to create the Vulkan timestamp query pool, the interop copies won't be timed");
+        m_queryPool = VK_NULL_HANDLE;
+        m_ring.reset();
+    }
+}
+
+VulkanGpuTimer::~VulkanGpuTimer() {
+    if (m_queryPool != VK_NULL_HANDLE) {
+        m_dispatch->DestroyQueryPool(m_device, m_queryPool, nullptr);
+    }
+}
+
+void VulkanGpuTimer::Resolve() {
+    if (!IsSupported()) {
+        return;
+    }
+    // without VK_QUERY_RESULT_WAIT_BIT this returns VK_NOT_READY instead of blocking until Cemu's command buffer finished
+    m_ring->Resolve([this](uint32_t firstQuery, uint32_t queryCount, uint64_t* ticks) {
+        return m_dispatch->GetQueryPoolResults(m_device, m_queryPool, firstQuery, queryCount, queryCount * sizeof(uint64_t), ticks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS;
+    });
+}
+
+VulkanGpuTimer::Scope::Scope(VulkanGpuTimer& timer, VkCommandBuffer cmdBuffer, Pass pass): m_timer(timer), m_cmdBuffer(cmdBuffer) {
+    if (!m_timer.IsSupported()) {
+        return;
+    }
+    m_firstQuery = m_timer.m_ring->BeginRange((uint32_t)pass);
+    // A reset that's recorded into the command buffer only happens once Cemu submits it and the GPU gets to it. Until then
+    // Resolve would read the results from the last time the ring used these queries, so they're reset right away instead.
+    // The GPU finished with that use long ago, since the ring only hands the queries out again after TIMED_FRAMES_IN_FLIGHT frames.
+    m_timer.m_dispatch->ResetQueryPoolEXT(m_timer.m_device, m_timer.m_queryPool, *m_firstQuery, 2);
+    m_timer.m_dispatch->CmdWriteTimestamp(m_cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timer.m_queryPool, *m_firstQuery);
+}
+
+VulkanGpuTimer::Scope::~Scope() {
+    if (m_firstQuery) {
+        m_timer.m_dispatch->CmdWriteTimestamp(m_cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timer.m_queryPool, *m_firstQuery + 1);
+    }
+}
+
+
+D3D12GpuTimer::D3D12GpuTimer(ID3D12Device* device, ID3D12CommandQueue* queue) {
+    UINT64 frequency = 0;
+    if (FAILED(queue->GetTimestampFrequency(&frequency)) || frequency == 0) {
+        Log::print<WARNING>("The D3D12 queue doesn't support timestamps, the present passes won't be timed");
+        return;
+    }
+
+    auto ring = std::make_unique<GpuTimestampRing>((uint32_t)Pass::COUNT, TIMED_FRAMES_IN_FLIGHT, GpuTimestampRing::Calibration{ .nanosecondsPerTick = 1000000000.0 / (double)frequency, .validBits = 64 });
+
+    D3D12_QUERY_HEAP_DESC heapDesc = {
+        .Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP,
+        .Count = ring->GetQueryCount(),
+        .NodeMask = 0
+    };
+    if (FAILED(device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&m_queryHeap)))) {
+        Log::print<WARNING>("Failed to create the D3D12 timestamp query heap, the present passes won't be timed");
+        return;
+    }
+
+    D3D12_HEAP_PROPERTIES heapProps = { .Type = D3D12_HEAP_TYPE_READBACK };
+    D3D12_RESOURCE_DESC bufferDesc = {
+        .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+        .Width = ring->GetQueryCount() * sizeof(uint64_t),
+        .Height = 1,
+        .DepthOrArraySize = 1,
+        .MipLevels = 1,
+        .Format = DXGI_FORMAT_UNKNOWN,
+        .SampleDesc = { .Count = 1 },
+        .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR
+    };
+    if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_readbackBuffer)))) {
+        Log::print<WARNING>("Failed to create the D3D12 timestamp readback buffer, the present passes won't be timed");
+        m_queryHeap.Reset();
+        return;
+    }
+    m_readbackBuffer->SetName(L"D3D12GpuTimer - Readback Buffer");
+    m_ring = std::move(ring);
+}
+
+void D3D12GpuTimer::Resolve() {
+    if (!IsSupported()) {
+        return;
+    }
+    m_ring->Resolve([this](uint32_t firstQuery, uint32_t queryCount, uint64_t* ticks) {
+        const D3D12_RANGE readRange = { firstQuery * sizeof(uint64_t), (firstQuery + queryCount) * sizeof(uint64_t) };
+        void* mapped = nullptr;
+        if (FAILED(m_readbackBuffer->Map(0, &readRange, &mapped))) {
+            return false;
+        }
+        memcpy(ticks, (uint8_t*)mapped + readRange.Begin, queryCount * sizeof(uint64_t));
+        const D3D12_RANGE writtenRange = { 0, 0 };
+        m_readbackBuffer->Unmap(0, &writtenRange);
+        return true;
+    });
+}
+
+D3D12GpuTimer::Scope::Scope(D3D12GpuTimer& timer, ID3D12GraphicsCommandList* commandList, Pass pass): m_timer(timer), m_commandList(commandList) {
+    if (!m_timer.IsSupported()) {
+        return;
+    }
+    m_firstQuery = m_timer.m_ring->BeginRange((uint32_t)pass);
+    m_commandList->EndQuery(m_timer.m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, *m_firstQuery);
+}
+
+D3D12GpuTimer::Scope::~Scope() {
+    if (m_firstQuery) {
+        m_commandList->EndQuery(m_timer.m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, *m_firstQuery + 1);
+        m_commandList->ResolveQueryData(m_timer.m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, *m_firstQuery, 2, m_timer.m_readbackBuffer.Get(), *m_firstQuery * sizeof(uint64_t));
+    }
+}
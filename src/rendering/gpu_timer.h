@@ -0,0 +1,83 @@
+#pragma once
+
+#include "utils/gpu_timestamps.h"
+
+
+// Times the copies into the shared textures and the ImGui overlay on Cemu's Vulkan queue
+class VulkanGpuTimer {
+public:
+    enum class Pass : uint32_t {
+        COPY_3D_LEFT,
+        COPY_3D_RIGHT,
+        COPY_DEPTH_LEFT,
+        COPY_DEPTH_RIGHT,
+        COPY_2D,
+        IMGUI,
+        COUNT
+    };
+
+    VulkanGpuTimer(VkDevice device, VkPhysicalDevice physicalDevice, const vkroots::VkDeviceDispatch* dispatch, const vkroots::VkInstanceDispatch* instanceDispatch);
+    ~VulkanGpuTimer();
+
+    bool IsSupported() const { return m_queryPool != VK_NULL_HANDLE; }
+    void Resolve();
+    double GetAverageMs(Pass pass) const { return m_ring ? m_ring->GetAverageMs((uint32_t)pass) : 0.0; }
+
+    // Writes timestamps around the commands that are recorded into cmdBuffer during its lifetime, has to be outside of a render pass
+    class Scope {
+    public:
+        Scope(VulkanGpuTimer& timer, VkCommandBuffer cmdBuffer, Pass pass);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        VulkanGpuTimer& m_timer;
+        VkCommandBuffer m_cmdBuffer;
+        std::optional<uint32_t> m_firstQuery;
+    };
+
+private:
+    VkDevice m_device;
+    const vkroots::VkDeviceDispatch* m_dispatch;
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;
+    std::unique_ptr<GpuTimestampRing> m_ring;
+};
+
+// Times the present passes that draw the shared textures into the OpenXR swapchains
+class D3D12GpuTimer {
+public:
+    enum class Pass : uint32_t {
+        PRESENT_3D_LEFT,
+        PRESENT_3D_RIGHT,
+        PRESENT_2D,
+        COUNT
+    };
+
+    D3D12GpuTimer(ID3D12Device* device, ID3D12CommandQueue* queue);
+
+    bool IsSupported() const { return m_queryHeap != nullptr; }
+    // Only call this once the queue finished the command lists that were recorded before
+    void Resolve();
+    double GetLastMs(Pass pass) const { return m_ring ? m_ring->GetLastMs((uint32_t)pass) : 0.0; }
+    double GetAverageMs(Pass pass) const { return m_ring ? m_ring->GetAverageMs((uint32_t)pass) : 0.0; }
+
+    // Writes timestamps around the commands that are recorded into commandList during its lifetime and resolves them into the readback buffer
+    class Scope {
+    public:
+        Scope(D3D12GpuTimer& timer, ID3D12GraphicsCommandList* commandList, Pass pass);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        D3D12GpuTimer& m_timer;
+        ID3D12GraphicsCommandList* m_commandList;
+        std::optional<uint32_t> m_firstQuery;
+    };
+
+private:
+    ComPtr<ID3D12QueryHeap> m_queryHeap;
+    ComPtr<ID3D12Resource> m_readbackBuffer;
+    std::unique_ptr<GpuTimestampRing> m_ring;
+};
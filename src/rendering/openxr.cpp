@@ -42,6 +42,8 @@ static XrBool32 XR_DebugUtilsMessengerCallback(XrDebugUtilsMessageSeverityFlagsE
 }
 
 OpenXR::OpenXR() {
+    m_backend = CreateXrBackend();
+
     char envBuffer[MAX_PATH];
     DWORD envResult = GetEnvironmentVariableA("XR_RUNTIME_JSON", envBuffer, sizeof(envBuffer));
     bool isRuntimeOverridden = (envResult > 0 && envResult < sizeof(envBuffer));
@@ -105,8 +107,7 @@ OpenXR::OpenXR() {
         throw std::runtime_error("Current OpenXR runtime doesn't support Direct3D 12 (XR_KHR_D3D12_ENABLE). See the Github page's troubleshooting section for a solution!");
     }
     if (!depthSupported) {
-        Log::print<ERROR>("OpenXR runtime doesn't support depth composition layers (XR_KHR_COMPOSITION_LAYER_DEPTH)!");
-        throw std::runtime_error("Current OpenXR runtime doesn't support depth composition layers (XR_KHR_COMPOSITION_LAYER_DEPTH). See the Github page's troubleshooting section for a solution!");
+        Log::print<WARNING>("OpenXR runtime doesn't support depth composition layers (XR_KHR_COMPOSITION_LAYER_DEPTH). Only color will be submitted.");
     }
     if (!timeConvSupported) {
         Log::print<WARNING>("OpenXR runtime doesn't support converting time from/to XrTime (XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME). Not required, as of this version.");
@@ -115,7 +116,8 @@ OpenXR::OpenXR() {
         Log::print<INFO>("OpenXR runtime doesn't support debug utils (XR_EXT_DEBUG_UTILS)! Errors/debug information will no longer be able to be shown!");
     }
 
-    std::vector<const char*> enabledExtensions = { XR_KHR_D3D12_ENABLE_EXTENSION_NAME, XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME, XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME };
+    std::vector<const char*> enabledExtensions = { XR_KHR_D3D12_ENABLE_EXTENSION_NAME, XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME };
+    if (depthSupported) enabledExtensions.emplace_back(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME);
     if (debugUtilsSupported) enabledExtensions.emplace_back(XR_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
     XrInstanceCreateInfo xrInstanceCreateInfo = { XR_TYPE_INSTANCE_CREATE_INFO };
@@ -177,6 +179,7 @@ OpenXR::OpenXR() {
     XrViewConfigurationProperties stereoViewConfiguration = { XR_TYPE_VIEW_CONFIGURATION_PROPERTIES };
     checkXRResult(xrGetViewConfigurationProperties(m_instance, m_systemId, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, &stereoViewConfiguration), "There's no VR headset available that allows stereo rendering!");
     m_capabilities.supportsMutatableFOV = stereoViewConfiguration.fovMutable;
+    m_capabilities.supportsDepthLayer = depthSupported;
 
     XrGraphicsRequirementsD3D12KHR graphicsRequirements = { XR_TYPE_GRAPHICS_REQUIREMENTS_D3D12_KHR };
     checkXRResult(func_xrGetD3D12GraphicsRequirementsKHR(m_instance, m_systemId, &graphicsRequirements), "Couldn't get D3D12 requirements for the given VR headset!");
@@ -246,24 +249,36 @@ void OpenXR::CreateSession(const XrGraphicsBindingD3D12KHR& d3d12Binding) {
     sessionCreateInfo.systemId = m_systemId;
     sessionCreateInfo.next = &d3d12Binding;
     sessionCreateInfo.createFlags = 0;
-    checkXRResult(xrCreateSession(m_instance, &sessionCreateInfo, &m_session), "Failed to create Vulkan-based OpenXR session!");
+    checkXRResult(m_backend->CreateSession(m_instance, &sessionCreateInfo, &m_session), "Failed to create Vulkan-based OpenXR session!");
+
+    const DepthSubmissionRuntime depthRuntime = {
+        .supportsDepthLayer = m_capabilities.supportsDepthLayer,
+        .isOculusLinkRuntime = m_capabilities.isOculusLinkRuntime,
+        .isMetaSimulator = m_capabilities.isMetaSimulator
+    };
+    m_submitDepth = ShouldSubmitDepth(depthRuntime, GetSettings().GetDepthSubmissionMode());
+    Log::print<INFO>("Submitting depth with the projection layer: {}", m_submitDepth ? "Yes" : "No");
 
     Log::print<INFO>("Creating the OpenXR spaces...");
     XrReferenceSpaceCreateInfo stageSpaceCreateInfo = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
     stageSpaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_STAGE;
     stageSpaceCreateInfo.poseInReferenceSpace = s_xrIdentityPose;
     checkXRResult(xrCreateReferenceSpace(m_session, &stageSpaceCreateInfo, &m_stageSpace), "Failed to create reference space for stage!");
+    m_backend->NameSpace(m_stageSpace, "stage");
 
     XrReferenceSpaceCreateInfo headSpaceCreateInfo = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
     headSpaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
     headSpaceCreateInfo.poseInReferenceSpace = s_xrIdentityPose;
     checkXRResult(xrCreateReferenceSpace(m_session, &headSpaceCreateInfo, &m_headSpace), "Failed to create reference space for head!");
+    m_backend->NameSpace(m_headSpace, "head");
 }
 
 void OpenXR::CreateActions() {
     Log::print<INFO>("Creating the OpenXR actions...");
 
     m_handPaths = { GetXRPath("/user/hand/left"), GetXRPath("/user/hand/right") };
+    m_backend->NamePath(m_handPaths[EyeSide::LEFT], "left");
+    m_backend->NamePath(m_handPaths[EyeSide::RIGHT], "right");
 
     auto createAction = [this](const XrActionSet& actionSet, const char* id, const char* name, XrActionType actionType, XrAction& action) {
         XrActionCreateInfo actionInfo = { XR_TYPE_ACTION_CREATE_INFO };
@@ -273,6 +288,7 @@ void OpenXR::CreateActions() {
         actionInfo.countSubactionPaths = (uint32_t)m_handPaths.size();
         actionInfo.subactionPaths = m_handPaths.data();
         checkXRResult(xrCreateAction(actionSet, &actionInfo, &action), std::format("Failed to create action for {}", id).c_str());
+        m_backend->NameAction(action, id);
     };
 
     {
@@ -467,6 +483,7 @@ void OpenXR::CreateActions() {
         createInfo.subactionPath = m_handPaths[side];
         createInfo.poseInActionSpace = s_xrIdentityPose;
         checkXRResult(xrCreateActionSpace(m_session, &createInfo, &m_inGameHandSpaces[side]), "Failed to create action space for hand pose!");
+        m_backend->NameSpace(m_inGameHandSpaces[side], side == EyeSide::LEFT ? "left" : "right");
     }
 
     for (EyeSide side : { EyeSide::LEFT, EyeSide::RIGHT }) {
@@ -475,10 +492,11 @@ void OpenXR::CreateActions() {
         createInfo.subactionPath = m_handPaths[side];
         createInfo.poseInActionSpace = s_xrIdentityPose;
         checkXRResult(xrCreateActionSpace(m_session, &createInfo, &m_inMenuHandSpaces[side]), "Failed to create action space for hand pose!");
+        m_backend->NameSpace(m_inMenuHandSpaces[side], side == EyeSide::LEFT ? "left" : "right");
     }
 
     // initialize rumble manager
-    m_rumbleManager = std::make_unique<RumbleManager>(m_session, m_rumbleAction);
+    m_rumbleManager = std::make_unique<RumbleManager>(m_backend.get(), m_session, m_rumbleAction);
     m_rumbleManager.get()->initializeXrPathsAndStartTime(m_instance);
 }
 
@@ -526,24 +544,69 @@ void CheckButtonState(bool buttonPressed, ButtonState& buttonState) {
     buttonState.wasDownLastFrame = down;
 }
 
+std::span<const OpenXR::ActionBinding> OpenXR::GetActionBindings() {
+    using enum InputAction;
+    static const std::array s_bindings = {
+        // shared actions, backed by a separate action in each action set
+        ActionBinding{ .id = INVENTORY_MAP, .action = &OpenXR::m_inGame_inventory_mapAction, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get inventory_help action value!", .boolTarget = [](InputState& s) { return &s.shared.inventory_map; }, .buttonState = [](InputState& s) { return &s.shared.inventory_mapState; } },
+        ActionBinding{ .id = INVENTORY_MAP, .action = &OpenXR::m_inMenu_inventory_mapAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get inventory_help action value!", .boolTarget = [](InputState& s) { return &s.shared.inventory_map; }, .buttonState = [](InputState& s) { return &s.shared.inventory_mapState; } },
+        ActionBinding{ .id = MOD_MENU, .action = &OpenXR::m_inGame_modMenuAction, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get mod menu action value!", .boolTarget = [](InputState& s) { return &s.shared.modMenu; }, .buttonState = [](InputState& s) { return &s.shared.modMenuState; } },
+        ActionBinding{ .id = MOD_MENU, .action = &OpenXR::m_inMenu_modMenuAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get mod menu action value!", .boolTarget = [](InputState& s) { return &s.shared.modMenu; }, .buttonState = [](InputState& s) { return &s.shared.modMenuState; } },
+
+        // in-game actions
+        ActionBinding{ .id = GRAB_LEFT, .action = &OpenXR::m_grab_interactAction, .activeSets = IN_GAME_SET, .hand = EyeSide::LEFT, .errorMessage = "Failed to get grab action value!", .floatTarget = [](InputState& s) { return &s.inGame.grab[EyeSide::LEFT]; }, .buttonState = [](InputState& s) { return &s.inGame.grabState[EyeSide::LEFT]; } },
+        ActionBinding{ .id = GRAB_RIGHT, .action = &OpenXR::m_grab_interactAction, .activeSets = IN_GAME_SET, .hand = EyeSide::RIGHT, .errorMessage = "Failed to get grab action value!", .floatTarget = [](InputState& s) { return &s.inGame.grab[EyeSide::RIGHT]; }, .buttonState = [](InputState& s) { return &s.inGame.grabState[EyeSide::RIGHT]; } },
+        ActionBinding{ .id = CROUCH_SCOPE, .action = &OpenXR::m_crouch_scopeAction, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get crouch and map action value!", .boolTarget = [](InputState& s) { return &s.inGame.crouch_scope; }, .buttonState = [](InputState& s) { return &s.inGame.crouch_scopeState; } },
+        ActionBinding{ .id = MOVE, .action = &OpenXR::m_moveAction, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get move action value!", .vector2Target = [](InputState& s) { return &s.inGame.move; } },
+        ActionBinding{ .id = CAMERA, .action = &OpenXR::m_cameraAction, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get camera action value!", .vector2Target = [](InputState& s) { return &s.inGame.camera; } },
+        ActionBinding{ .id = JUMP_CANCEL, .action = &OpenXR::m_jumpAction, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get jump action value!", .boolTarget = [](InputState& s) { return &s.inGame.jump_cancel; } },
+        ActionBinding{ .id = RUN_INTERACT, .action = &OpenXR::m_run_interactAction, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get run action value!", .boolTarget = [](InputState& s) { return &s.inGame.run_interact; }, .buttonState = [](InputState& s) { return &s.inGame.runState; } },
+        ActionBinding{ .id = USE_RUNE_DPAD_MENU, .action = &OpenXR::m_useRune_dpadMenu_Action, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get use rune action value!", .boolTarget = [](InputState& s) { return &s.inGame.useRune_dpadMenu; }, .buttonState = [](InputState& s) { return &s.inGame.useRune_runeMenuState; } },
+        ActionBinding{ .id = USE_RIGHT_ITEM, .action = &OpenXR::m_useRightItemAction, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get useRightItem action value!", .boolTarget = [](InputState& s) { return &s.inGame.useRightItem; } },
+        ActionBinding{ .id = USE_LEFT_ITEM, .action = &OpenXR::m_useLeftItemAction, .activeSets = IN_GAME_SET, .errorMessage = "Failed to get useLeftItem action value!", .boolTarget = [](InputState& s) { return &s.inGame.useLeftItem; } },
+
+        // in-menu actions
+        ActionBinding{ .id = SCROLL, .action = &OpenXR::m_scrollAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get scroll action value!", .vector2Target = [](InputState& s) { return &s.inMenu.scroll; } },
+        ActionBinding{ .id = NAVIGATE, .action = &OpenXR::m_navigateAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get navigate action value!", .vector2Target = [](InputState& s) { return &s.inMenu.navigate; } },
+        ActionBinding{ .id = SELECT, .action = &OpenXR::m_selectAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get select action value!", .boolTarget = [](InputState& s) { return &s.inMenu.select; } },
+        ActionBinding{ .id = BACK, .action = &OpenXR::m_backAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get back action value!", .boolTarget = [](InputState& s) { return &s.inMenu.back; } },
+        ActionBinding{ .id = SORT, .action = &OpenXR::m_sortAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get sort action value!", .boolTarget = [](InputState& s) { return &s.inMenu.sort; } },
+        ActionBinding{ .id = HOLD, .action = &OpenXR::m_holdAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get hold action value!", .boolTarget = [](InputState& s) { return &s.inMenu.hold; }, .buttonState = [](InputState& s) { return &s.inMenu.holdState; } },
+        ActionBinding{ .id = LEFT_GRIP, .action = &OpenXR::m_leftGripAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get left grip action value!", .boolTarget = [](InputState& s) { return &s.inMenu.leftGrip; } },
+        ActionBinding{ .id = RIGHT_GRIP, .action = &OpenXR::m_rightGripAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get right grip action value!", .boolTarget = [](InputState& s) { return &s.inMenu.rightGrip; } },
+        ActionBinding{ .id = LEFT_TRIGGER, .action = &OpenXR::m_leftTriggerAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get left trigger action value!", .boolTarget = [](InputState& s) { return &s.inMenu.leftTrigger; } },
+        ActionBinding{ .id = RIGHT_TRIGGER, .action = &OpenXR::m_rightTriggerAction, .activeSets = IN_MENU_SET, .errorMessage = "Failed to get right trigger action value!", .boolTarget = [](InputState& s) { return &s.inMenu.rightTrigger; } },
+    };
+    return s_bindings;
+}
+
 std::optional<OpenXR::InputState> OpenXR::UpdateActions(XrTime predictedFrameTime, glm::fquat controllerRotation, bool inMenu) {
     XrActiveActionSet activeActionSet = { (inMenu ? m_menuActionSet : m_gameplayActionSet), XR_NULL_PATH };
 
     XrActionsSyncInfo syncInfo = { XR_TYPE_ACTIONS_SYNC_INFO };
     syncInfo.countActiveActionSets = 1;
     syncInfo.activeActionSets = &activeActionSet;
-    checkXRResult(xrSyncActions(m_session, &syncInfo), "Failed to sync actions!");
+    checkXRResult(m_backend->SyncActions(m_session, &syncInfo), "Failed to sync actions!");
 
     InputState newState = m_input.load();
+    newState.syncIndex = ++m_syncCount;
     newState.shared.in_game = !inMenu;
     newState.shared.inputTime = predictedFrameTime;
 
+    // the in-game and in-menu hand spaces aren't guaranteed to line up, so don't fit across a switch between them
+    if (m_historiesInGame != newState.shared.in_game) {
+        m_historiesInGame = newState.shared.in_game;
+        m_handHistories[EyeSide::LEFT].Reset();
+        m_handHistories[EyeSide::RIGHT].Reset();
+    }
+
     for (EyeSide side : { EyeSide::LEFT, EyeSide::RIGHT }) {
+        newState.shared.poseMotion[side] = {};
         XrActionStateGetInfo getPoseInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
         getPoseInfo.action = newState.shared.in_game ? m_inGameGripPoseAction : m_inMenuGripPoseAction;
         getPoseInfo.subactionPath = m_handPaths[side];
         newState.shared.pose[side] = { XR_TYPE_ACTION_STATE_POSE };
-        checkXRResult(xrGetActionStatePose(m_session, &getPoseInfo, &newState.shared.pose[side]), "Failed to get pose of controller!");
+        checkXRResult(m_backend->GetActionStatePose(m_session, &getPoseInfo, &newState.shared.pose[side]), "Failed to get pose of controller!");
 
         if (newState.shared.pose[side].isActive) {
             XrSpaceLocation spaceLocation = { XR_TYPE_SPACE_LOCATION };
@@ -552,199 +615,98 @@ std::optional<OpenXR::InputState> OpenXR::UpdateActions(XrTime predictedFrameTim
             newState.shared.poseVelocity[side].linearVelocity = { 0.0f, 0.0f, 0.0f };
             newState.shared.poseVelocity[side].angularVelocity = { 0.0f, 0.0f, 0.0f };
             XrSpace handSpace = newState.shared.in_game ? m_inGameHandSpaces[side] : m_inMenuHandSpaces[side];
-            checkXRResult(xrLocateSpace(handSpace, m_stageSpace, predictedFrameTime, &spaceLocation), "Failed to get location from controllers!");
+            checkXRResult(m_backend->LocateSpace(handSpace, m_stageSpace, predictedFrameTime, &spaceLocation), "Failed to get location from controllers!");
             if ((spaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0 && (spaceLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0) {
                 newState.shared.poseLocation[side] = spaceLocation;
 
+                m_handHistories[side].Add(predictedFrameTime, spaceLocation.pose);
+                const PoseHistory::Motion motion = m_handHistories[side].Estimate(predictedFrameTime);
+                newState.shared.poseMotion[side] = motion;
+
                 if ((spaceLocation.locationFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) != 0 && (spaceLocation.locationFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) != 0) {
-                    // rotate angular velocity to world space when it's using a buggy runtime
+                    // replace the angular velocity when it's using a buggy runtime
                     auto mode = GetSettings().AngularVelocityFixer_GetMode();
                     bool isUsingQuestRuntime = m_capabilities.isOculusLinkRuntime;
                     if ((mode == AngularVelocityFixerMode::AUTO && isUsingQuestRuntime) || mode == AngularVelocityFixerMode::FORCED_ON) {
-                        glm::vec3 angularVelocity = ToGLM(spaceVelocity.angularVelocity);
-                        glm::fquat fix_angle = glm::fquat(0.924, -0.383, 0, 0);
-                        angularVelocity = (ToGLM(spaceLocation.pose.orientation) * (fix_angle * angularVelocity)); // TODO: Contact other modders for similar issues with angular velocity being not on the grip rotation (quest 2) + Tune the angular velocity based on manually calculated on rotation positions
-                        spaceVelocity.angularVelocity = { angularVelocity.x, angularVelocity.y, angularVelocity.z };
+                        if (motion.valid) {
+                            spaceVelocity.angularVelocity = { motion.angularVelocity.x, motion.angularVelocity.y, motion.angularVelocity.z };
+                        }
+                        else {
+                            // not enough history yet, so rotate the runtime's angular velocity to world space instead
+                            glm::vec3 angularVelocity = ToGLM(spaceVelocity.angularVelocity);
+                            glm::fquat fix_angle = glm::fquat(0.924, -0.383, 0, 0);
+                            angularVelocity = (ToGLM(spaceLocation.pose.orientation) * (fix_angle * angularVelocity));
+                            spaceVelocity.angularVelocity = { angularVelocity.x, angularVelocity.y, angularVelocity.z };
+                        }
                     }
 
                     newState.shared.poseVelocity[side] = spaceVelocity;
                 }
             }
+            else {
+                m_handHistories[side].Reset();
+            }
+        }
+        else {
+            m_handHistories[side].Reset();
         }
     }
-    // update shared actions
-    XrActionStateGetInfo getInventoryMapInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-    getInventoryMapInfo.action = newState.shared.in_game ? m_inGame_inventory_mapAction : m_inMenu_inventory_mapAction;
-    getInventoryMapInfo.subactionPath = XR_NULL_PATH;
-    auto& inventory_mapAction = newState.shared.inventory_map;
-    inventory_mapAction = { XR_TYPE_ACTION_STATE_BOOLEAN };
-    checkXRResult(xrGetActionStateBoolean(m_session, &getInventoryMapInfo, &inventory_mapAction), "Failed to get inventory_help action value!");
+    // update shared actions and the ones from the active action set
+    const uint8_t activeSet = inMenu ? IN_MENU_SET : IN_GAME_SET;
+    newState.changedActions = 0;
+    for (const ActionBinding& binding : GetActionBindings()) {
+        if ((binding.activeSets & activeSet) == 0) {
+            continue;
+        }
 
-    auto& inventory_mapButtonState = newState.shared.inventory_mapState;
-    if (inventory_mapAction.isActive == XR_TRUE) {
-        auto buttonPressed = inventory_mapAction.currentState == XR_TRUE;
-        CheckButtonState(buttonPressed, inventory_mapButtonState); 
-    }
+        XrActionStateGetInfo getInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
+        getInfo.action = this->*binding.action;
+        getInfo.subactionPath = binding.hand.has_value() ? m_handPaths[binding.hand.value()] : XR_NULL_PATH;
+
+        bool isActive = false;
+        bool buttonPressed = false;
+        bool changed = false;
+        if (binding.boolTarget) {
+            XrActionStateBoolean& state = *binding.boolTarget(newState);
+            state = { XR_TYPE_ACTION_STATE_BOOLEAN };
+            checkXRResult(m_backend->GetActionStateBoolean(m_session, &getInfo, &state), binding.errorMessage);
+            isActive = state.isActive == XR_TRUE;
+            buttonPressed = state.currentState == XR_TRUE;
+            changed = state.changedSinceLastSync == XR_TRUE;
+        }
+        else if (binding.floatTarget) {
+            XrActionStateFloat& state = *binding.floatTarget(newState);
+            state = { XR_TYPE_ACTION_STATE_FLOAT };
+            checkXRResult(m_backend->GetActionStateFloat(m_session, &getInfo, &state), binding.errorMessage);
+            isActive = state.isActive == XR_TRUE;
+            buttonPressed = state.currentState > 0.75f;
+            changed = state.changedSinceLastSync == XR_TRUE;
+        }
+        else if (binding.vector2Target) {
+            XrActionStateVector2f& state = *binding.vector2Target(newState);
+            state = { XR_TYPE_ACTION_STATE_VECTOR2F };
+            checkXRResult(m_backend->GetActionStateVector2f(m_session, &getInfo, &state), binding.errorMessage);
+            isActive = state.isActive == XR_TRUE;
+            changed = state.changedSinceLastSync == XR_TRUE;
+        }
 
-    XrActionStateGetInfo getModMenuInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-    getModMenuInfo.action = newState.shared.in_game ? m_inGame_modMenuAction : m_inMenu_modMenuAction;
-    getModMenuInfo.subactionPath = XR_NULL_PATH;
-    auto& modMenuAction = newState.shared.modMenu;
-    modMenuAction = { XR_TYPE_ACTION_STATE_BOOLEAN };
-    checkXRResult(xrGetActionStateBoolean(m_session, &getModMenuInfo, &modMenuAction), "Failed to get mod menu action value!");
+        if (changed) {
+            newState.changedActions |= 1u << std::to_underlying(binding.id);
+        }
 
-    auto& modMenuButtonState = newState.shared.modMenuState;
-    if (modMenuAction.isActive == XR_TRUE) {
-        auto buttonPressed = modMenuAction.currentState == XR_TRUE;
-        CheckButtonState(buttonPressed, modMenuButtonState);
+        // long presses are based on how long a button is held, so this also has to run while the button didn't change
+        if (binding.buttonState && isActive) {
+            CheckButtonState(buttonPressed, *binding.buttonState(newState));
+        }
     }
 
-    // update in-menu or in-game actions
     if (inMenu) {
-        XrActionStateGetInfo getScrollInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getScrollInfo.action = m_scrollAction;
-        newState.inMenu.scroll = { XR_TYPE_ACTION_STATE_VECTOR2F };
-        checkXRResult(xrGetActionStateVector2f(m_session, &getScrollInfo, &newState.inMenu.scroll), "Failed to get navigate action value!");
-
-        XrActionStateGetInfo getNavigationInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getNavigationInfo.action = m_navigateAction;
-        newState.inMenu.navigate = { XR_TYPE_ACTION_STATE_VECTOR2F };
-        checkXRResult(xrGetActionStateVector2f(m_session, &getNavigationInfo, &newState.inMenu.navigate), "Failed to get select action value!");
-
-        XrActionStateGetInfo getSelectInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getSelectInfo.action = m_selectAction;
-        newState.inMenu.select = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getSelectInfo, &newState.inMenu.select), "Failed to get select action value!");
-
-        XrActionStateGetInfo getBackInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getBackInfo.action = m_backAction;
-        newState.inMenu.back = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getBackInfo, &newState.inMenu.back), "Failed to get back action value!");
-
-        XrActionStateGetInfo getSortInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getSortInfo.action = m_sortAction;
-        newState.inMenu.sort = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getSortInfo, &newState.inMenu.sort), "Failed to get sort action value!");
-
-        XrActionStateGetInfo getHoldInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getHoldInfo.action = m_holdAction;
-        newState.inMenu.hold = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getHoldInfo, &newState.inMenu.hold), "Failed to get hold action value!");
-
-        auto& holdButtonState = newState.inMenu.holdState;
-        if (newState.inMenu.hold.isActive == XR_TRUE) {
-            auto buttonPressed = newState.inMenu.hold.currentState == XR_TRUE;
-            CheckButtonState(buttonPressed, holdButtonState);
-        }
-
-        XrActionStateGetInfo getLeftGripInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getLeftGripInfo.action = m_leftGripAction;
-        newState.inMenu.leftGrip = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getLeftGripInfo, &newState.inMenu.leftGrip), "Failed to get left grip action value!");
-
         if (newState.inMenu.leftGrip.currentState == XR_TRUE) {
             newState.shared.lastPickupSide = OpenXR::EyeSide::LEFT;
         }
-
-        XrActionStateGetInfo getRightGripInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getRightGripInfo.action = m_rightGripAction;
-        newState.inMenu.rightGrip = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getRightGripInfo, &newState.inMenu.rightGrip), "Failed to get right grip action value!");
-
         if (newState.inMenu.rightGrip.currentState == XR_TRUE) {
             newState.shared.lastPickupSide = OpenXR::EyeSide::RIGHT;
         }
-
-        XrActionStateGetInfo getLeftTriggerInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getLeftTriggerInfo.action = m_leftTriggerAction;
-        getLeftTriggerInfo.subactionPath = XR_NULL_PATH;
-        newState.inMenu.leftTrigger = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getLeftTriggerInfo, &newState.inMenu.leftTrigger), "Failed to get left trigger action value!");
-
-        XrActionStateGetInfo getRightTriggerInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getRightTriggerInfo.action = m_rightTriggerAction;
-        getRightTriggerInfo.subactionPath = XR_NULL_PATH;
-        newState.inMenu.rightTrigger = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getRightTriggerInfo, &newState.inMenu.rightTrigger), "Failed to get right trigger action value!");
-    }
-    else {
-        for (EyeSide side : { EyeSide::LEFT, EyeSide::RIGHT }) {
-            XrActionStateGetInfo getGrabInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-            getGrabInfo.action = m_grab_interactAction;
-            getGrabInfo.subactionPath = m_handPaths[side];
-            newState.inGame.grab[side] = { XR_TYPE_ACTION_STATE_FLOAT };
-            checkXRResult(xrGetActionStateFloat(m_session, &getGrabInfo, &newState.inGame.grab[side]), "Failed to get grab action value!");
-
-            auto& buttonState = newState.inGame.grabState[side];
-            if (newState.inGame.grab[side].isActive == XR_TRUE) {
-                auto buttonPressed = newState.inGame.grab[side].currentState > 0.75f;
-                CheckButtonState(buttonPressed, buttonState);
-            }
-        }
-
-        XrActionStateGetInfo getCrouchScopeInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getCrouchScopeInfo.action = m_crouch_scopeAction;
-        getCrouchScopeInfo.subactionPath = XR_NULL_PATH;
-        newState.inGame.crouch_scope = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getCrouchScopeInfo, &newState.inGame.crouch_scope), "Failed to get crouch and map action value!");
-
-        auto& crouch_scopeButtonState = newState.inGame.crouch_scopeState;
-        if (newState.inGame.crouch_scope.isActive == XR_TRUE) {
-            auto buttonPressed = newState.inGame.crouch_scope.currentState == XR_TRUE;
-            CheckButtonState(buttonPressed, crouch_scopeButtonState);
-        }
-
-        XrActionStateGetInfo getMoveInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getMoveInfo.action = m_moveAction;
-        newState.inGame.move = { XR_TYPE_ACTION_STATE_VECTOR2F };
-        checkXRResult(xrGetActionStateVector2f(m_session, &getMoveInfo, &newState.inGame.move), "Failed to get move action value!");
-
-        XrActionStateGetInfo getCameraInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getCameraInfo.action = m_cameraAction;
-        newState.inGame.camera = { XR_TYPE_ACTION_STATE_VECTOR2F };
-        checkXRResult(xrGetActionStateVector2f(m_session, &getCameraInfo, &newState.inGame.camera), "Failed to get camera action value!");
-
-        XrActionStateGetInfo getJumpInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getJumpInfo.action = m_jumpAction;
-        getJumpInfo.subactionPath = XR_NULL_PATH;
-        newState.inGame.jump_cancel = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getJumpInfo, &newState.inGame.jump_cancel), "Failed to get jump action value!");
-
-        XrActionStateGetInfo getRunInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getRunInfo.action = m_run_interactAction;
-        getRunInfo.subactionPath = XR_NULL_PATH;
-        newState.inGame.run_interact = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getRunInfo, &newState.inGame.run_interact), "Failed to get run action value!");
-
-        auto& runButtonState = newState.inGame.runState;
-        if (newState.inGame.run_interact.isActive == XR_TRUE) {
-            auto buttonPressed = newState.inGame.run_interact.currentState == XR_TRUE;
-            CheckButtonState(buttonPressed, runButtonState);
-        }
-
-        XrActionStateGetInfo getUseRuneInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getUseRuneInfo.action = m_useRune_dpadMenu_Action;
-        getUseRuneInfo.subactionPath = XR_NULL_PATH;
-        newState.inGame.useRune_dpadMenu = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getUseRuneInfo, &newState.inGame.useRune_dpadMenu), "Failed to get use rune action value!");
-
-        auto& useRuneButtonState = newState.inGame.useRune_runeMenuState;
-        if (newState.inGame.useRune_dpadMenu.isActive == XR_TRUE) {
-            auto buttonPressed = newState.inGame.useRune_dpadMenu.currentState == XR_TRUE;
-            CheckButtonState(buttonPressed, useRuneButtonState);
-        }
-
-        XrActionStateGetInfo getUseRightItemInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getUseRightItemInfo.action = m_useRightItemAction;
-        getUseRightItemInfo.subactionPath = XR_NULL_PATH;
-        newState.inGame.useRightItem = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getUseRightItemInfo, &newState.inGame.useRightItem), "Failed to get useRightItem action value!");
-
-        XrActionStateGetInfo getUseLeftItemInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        getUseLeftItemInfo.action = m_useLeftItemAction;
-        getUseLeftItemInfo.subactionPath = XR_NULL_PATH;
-        newState.inGame.useLeftItem = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        checkXRResult(xrGetActionStateBoolean(m_session, &getUseLeftItemInfo, &newState.inGame.useLeftItem), "Failed to get useLeftItem action value!");
     }
     this->m_input.store(newState);
     return newState;
@@ -753,7 +715,7 @@ std::optional<OpenXR::InputState> OpenXR::UpdateActions(XrTime predictedFrameTim
 
 std::optional<XrSpaceLocation> OpenXR::UpdateSpaces(XrTime predictedDisplayTime) {
     XrSpaceLocation spaceLocation = { XR_TYPE_SPACE_LOCATION };
-    if (XrResult result = xrLocateSpace(m_headSpace, m_stageSpace, predictedDisplayTime, &spaceLocation); XR_SUCCEEDED(result)) {
+    if (XrResult result = m_backend->LocateSpace(m_headSpace, m_stageSpace, predictedDisplayTime, &spaceLocation); XR_SUCCEEDED(result)) {
         if (result != XR_ERROR_TIME_INVALID) {
             checkXRResult(result, "Failed to get space location!");
         }
@@ -777,7 +739,7 @@ void OpenXR::ProcessEvents() {
                     Log::print<WARNING>("OpenXR has indicated that the session is ready, but we already have a renderer!");
                 }
                 else {
-                    m_renderer = std::make_unique<RND_Renderer>(m_session);
+                    m_renderer = std::make_unique<RND_Renderer>(m_session, m_backend.get());
                 }
                 break;
             }
@@ -811,7 +773,7 @@ void OpenXR::ProcessEvents() {
     };
 
     XrEventDataBuffer eventData = { XR_TYPE_EVENT_DATA_BUFFER };
-    XrResult result = xrPollEvent(m_instance, &eventData);
+    XrResult result = m_backend->PollEvent(m_instance, &eventData);
 
     while (result == XR_SUCCESS) {
         switch (eventData.type) {
@@ -836,6 +798,6 @@ void OpenXR::ProcessEvents() {
         }
 
         eventData = { XR_TYPE_EVENT_DATA_BUFFER };
-        result = xrPollEvent(m_instance, &eventData);
+        result = m_backend->PollEvent(m_instance, &eventData);
     }
 }
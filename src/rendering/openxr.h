@@ -1,6 +1,9 @@
 #pragma once
 
 #include "hooking/rumble.h"
+#include "xr_backend.h"
+#include "utils/pose_history.h"
+#include "utils/mod_settings.h"
 
 class OpenXR {
     friend class RND_Renderer;
@@ -14,12 +17,44 @@ public:
         RIGHT = 1
     };
 
+    // Every action that UpdateActions polls, doubles as the bit index into InputState::changedActions
+    enum class InputAction : uint8_t {
+        INVENTORY_MAP,
+        MOD_MENU,
+
+        GRAB_LEFT,
+        GRAB_RIGHT,
+        CROUCH_SCOPE,
+        MOVE,
+        CAMERA,
+        JUMP_CANCEL,
+        RUN_INTERACT,
+        USE_RUNE_DPAD_MENU,
+        USE_LEFT_ITEM,
+        USE_RIGHT_ITEM,
+
+        SCROLL,
+        NAVIGATE,
+        SELECT,
+        BACK,
+        SORT,
+        HOLD,
+        LEFT_GRIP,
+        RIGHT_GRIP,
+        LEFT_TRIGGER,
+        RIGHT_TRIGGER,
+
+        COUNT
+    };
+    static_assert(std::to_underlying(InputAction::COUNT) <= 32, "InputState::changedActions only has room for 32 actions");
+
     struct Capabilities {
         LUID adapter;
         D3D_FEATURE_LEVEL minFeatureLevel;
         bool supportsOrientational;
         bool supportsPositional;
         bool supportsMutatableFOV;
+        bool supportsDepthLayer;
         bool isOculusLinkRuntime;
         bool isMetaSimulator;
     } m_capabilities = {};
@@ -59,6 +94,8 @@ public:
             std::array<XrActionStatePose, 2> pose;
             std::array<XrSpaceLocation, 2> poseLocation;
             std::array<XrSpaceVelocity, 2> poseVelocity;
+            // estimated from the pose history at inputTime, also has accelerations unlike poseVelocity
+            std::array<PoseHistory::Motion, 2> poseMotion;
             std::array<XrSpaceLocation, 2> hmdRelativePoseLocation;
 
             XrActionStateBoolean inventory_map;
@@ -104,6 +141,14 @@ public:
             XrActionStateBoolean leftTrigger;
             XrActionStateBoolean rightTrigger;
         } inMenu;
+
+        // Only covers the actions of the action set that was active during the last sync, so consumers can skip
+        // re-evaluating inputs that the runtime reported as unchanged. The bits are relative to the previous sync, so they're
+        // only meaningful to a consumer that saw the state of syncIndex - 1 (see ActionChangeGate).
+        uint32_t changedActions = 0;
+        uint32_t syncIndex = 0;
+        bool HasChanged(InputAction action) const { return ((changedActions >> std::to_underlying(action)) & 1) != 0; }
+        bool HasAnyChanged() const { return changedActions != 0; }
     };
     std::atomic<InputState> m_input = InputState{};
     std::atomic<glm::fquat> m_inputCameraRotation = glm::identity<glm::fquat>();
@@ -173,6 +218,8 @@ public:
     std::atomic<RumbleParameters> m_rumbleParameters{};
 
     void CreateSession(const XrGraphicsBindingD3D12KHR& d3d12Binding);
+    // Whether the projection layer carries depth, decided once when the session gets created
+    bool IsSubmittingDepth() const { return m_submitDepth; }
     void CreateActions();
     std::array<XrViewConfigurationView, 2> GetViewConfigurations();
     std::optional<XrSpaceLocation> UpdateSpaces(XrTime predictedDisplayTime);
@@ -181,18 +228,42 @@ public:
     void ProcessEvents();
 
     XrSession GetSession() const { return m_session; }
+    XrBackend* GetBackend() const { return m_backend.get(); }
     RND_Renderer* GetRenderer() const { return m_renderer.get(); }
     RumbleManager* GetRumbleManager() const { return m_rumbleManager.get(); }
 
 private:
+    enum ActionSetBits : uint8_t {
+        IN_GAME_SET = 1 << 0,
+        IN_MENU_SET = 1 << 1
+    };
+
+    // Describes how an action gets polled into InputState, exactly one of the targets is set depending on the action type
+    struct ActionBinding {
+        InputAction id;
+        XrAction OpenXR::* action;
+        uint8_t activeSets;
+        std::optional<EyeSide> hand;
+        const char* errorMessage;
+        XrActionStateBoolean* (*boolTarget)(InputState&) = nullptr;
+        XrActionStateFloat* (*floatTarget)(InputState&) = nullptr;
+        XrActionStateVector2f* (*vector2Target)(InputState&) = nullptr;
+        InputState::ButtonState* (*buttonState)(InputState&) = nullptr;
+    };
+    static std::span<const ActionBinding> GetActionBindings();
+
     XrPath GetXRPath(const char* str) const {
         XrPath path;
         checkXRResult(xrStringToPath(m_instance, str, &path), std::format("Failed to get path for {}", str).c_str());
         return path;
     };
 
+    // declared before anything that calls into it so that it gets destroyed last
+    std::unique_ptr<XrBackend> m_backend;
+
     XrInstance m_instance = XR_NULL_HANDLE;
     XrSystemId m_systemId = XR_NULL_SYSTEM_ID;
+    bool m_submitDepth = false;
     XrSession m_session = XR_NULL_HANDLE;
     XrSpace m_stageSpace = XR_NULL_HANDLE;
     XrSpace m_headSpace = XR_NULL_HANDLE;
@@ -200,6 +271,11 @@ private:
     std::array<XrSpace, 2> m_inMenuHandSpaces = { XR_NULL_HANDLE, XR_NULL_HANDLE };
     std::array<XrPath, 2> m_handPaths = { XR_NULL_PATH, XR_NULL_PATH };
 
+    // fed once per UpdateActions
+    std::array<PoseHistory, 2> m_handHistories;
+    bool m_historiesInGame = true;
+    uint32_t m_syncCount = 0;
+
     XrAction m_inGameGripPoseAction = XR_NULL_HANDLE;
     XrAction m_inGameAimPoseAction = XR_NULL_HANDLE;
     XrAction m_inMenuGripPoseAction = XR_NULL_HANDLE;
@@ -0,0 +1,62 @@
+#include "present_worker.h"
+#include "utils/frame_trace.h"
+
+
+PresentWorker::PresentWorker(std::function<void()> runFrame, Policy policy): m_runFrame(std::move(runFrame)), m_policy(policy) {
+    m_thread = std::thread(&PresentWorker::Run, this);
+}
+
+PresentWorker::~PresentWorker() {
+    {
+        std::lock_guard lk(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    // a frame that's still in the mailbox is dropped, the next XR frame just picks up whatever was rendered by then
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void PresentWorker::Publish() {
+    FrameTrace::Scope traceScope("PresentWorker::Publish");
+    const auto publishStart = std::chrono::high_resolution_clock::now();
+
+    std::unique_lock lk(m_mutex);
+    if (m_policy == Policy::STRICT) {
+        m_cv.wait(lk, [this] { return !m_mailbox.IsFull() || m_stop; });
+    }
+    if (m_mailbox.Publish()) {
+        m_droppedFrames++;
+    }
+    lk.unlock();
+    m_cv.notify_all();
+
+    m_lastStallMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - publishStart).count();
+    FrameTrace::Counter("Present stall (ms)", m_lastStallMs);
+}
+
+void PresentWorker::Run() {
+    FrameTrace::SetThreadName("XR Frame");
+    Log::print<INFO>("Started the XR frame thread");
+
+    while (true) {
+        uint64_t frameId = 0;
+        {
+            std::unique_lock lk(m_mutex);
+            m_cv.wait(lk, [this] { return m_mailbox.IsFull() || m_stop; });
+            if (m_stop) {
+                break;
+            }
+            frameId = *m_mailbox.Take();
+        }
+        // wakes up a producer that waits for the slot to become free
+        m_cv.notify_all();
+
+        FrameTrace::Scope traceScope("XR frame");
+        Log::print<RENDERING>("Running XR frame for present #{}", frameId);
+        m_runFrame();
+    }
+
+    Log::print<INFO>("Stopped the XR frame thread after dropping {} frames", m_droppedFrames.load());
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+
+// Runs the OpenXR frame loop (xrWaitFrame, xrBeginFrame, xrEndFrame and the D3D12 work in between) on its own thread, so
+// that Cemu's present doesn't block on the runtime's frame pacing.
+// Cemu's present publishes into a single-slot mailbox and the worker runs one XR frame per frame it takes out of it.
+// With STRICT every published frame gets its own XR frame, and publishing waits while the previous frame is still in the
+// mailbox. With LATEST_WINS publishing never waits, and a frame that the worker didn't take in time is replaced.
+// The single-slot mailbox itself, without the locking and waiting around it, so that the pacing policies can be simulated
+class PresentMailbox {
+public:
+    // STRICT producers wait until the worker took the previous frame before publishing
+    bool IsFull() const { return m_frameId.has_value(); }
+    // Returns whether a frame that the worker didn't take yet got replaced
+    bool Publish() {
+        const bool replaced = m_frameId.has_value();
+        m_frameId = m_nextFrameId++;
+        return replaced;
+    }
+    std::optional<uint64_t> Take() { return std::exchange(m_frameId, std::nullopt); }
+
+private:
+    std::optional<uint64_t> m_frameId;
+    uint64_t m_nextFrameId = 0;
+};
+
+class PresentWorker {
+public:
+    enum class Policy : uint8_t {
+        STRICT,
+        LATEST_WINS,
+    };
+
+    explicit PresentWorker(std::function<void()> runFrame, Policy policy);
+    ~PresentWorker();
+
+    void SetPolicy(Policy policy) { m_policy = policy; }
+    Policy GetPolicy() const { return m_policy; }
+
+    void Publish();
+
+    uint64_t GetDroppedFrames() const { return m_droppedFrames; }
+    // How long the last Publish call was blocked, only ever non-zero with STRICT
+    double GetLastStallMs() const { return m_lastStallMs; }
+
+private:
+    void Run();
+
+    std::function<void()> m_runFrame;
+    std::atomic<Policy> m_policy;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    PresentMailbox m_mailbox;
+    bool m_stop = false;
+
+    std::atomic_uint64_t m_droppedFrames = 0;
+    std::atomic<double> m_lastStallMs = 0.0;
+
+    // started last so that the thread never sees uninitialized members
+    std::thread m_thread;
+};
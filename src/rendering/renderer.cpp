@@ -2,19 +2,25 @@
 #include "instance.h"
 #include "texture.h"
 #include "utils/d3d12_utils.h"
+#include "utils/frame_trace.h"
+#include "utils/alloc_tracker.h"
 
 std::atomic_bool RND_Renderer::Layer2D::s_isBowAimingActive = false;
 
-RND_Renderer::RND_Renderer(XrSession xrSession): m_session(xrSession) {
+RND_Renderer::RND_Renderer(XrSession xrSession, XrBackend* backend): m_backend(backend), m_session(xrSession), m_frameSlots(GetSettings().GetFramesInFlight()) {
     XrSessionBeginInfo m_sessionCreateInfo = { XR_TYPE_SESSION_BEGIN_INFO };
     m_sessionCreateInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
-    checkXRResult(xrBeginSession(m_session, &m_sessionCreateInfo), "Failed to begin OpenXR session!");
+    checkXRResult(m_backend->BeginSession(m_session, &m_sessionCreateInfo), "Failed to begin OpenXR session!");
+    Log::print<INFO>("Using {} frames in flight", m_frameSlots.GetSlotCount());
 }
 
 RND_Renderer::~RND_Renderer() {
-    xrRequestExitSession(m_session);
+    // the worker calls into this renderer, so it has to finish its frame before anything gets torn down
+    m_presentWorker.reset();
+
+    m_backend->RequestExitSession(m_session);
     if (m_session != XR_NULL_HANDLE) {
-        checkXRResult(xrEndSession(m_session), "Failed to end OpenXR session!");
+        checkXRResult(m_backend->EndSession(m_session), "Failed to end OpenXR session!");
         m_session = XR_NULL_HANDLE;
     }
 
@@ -29,21 +35,29 @@ RND_Renderer::~RND_Renderer() {
 void RND_Renderer::StartFrame() {
     m_isInitialized = true;
 
+    FrameTrace::Scope traceScope("StartFrame");
+
     XrFrameWaitInfo waitFrameInfo = { XR_TYPE_FRAME_WAIT_INFO };
     auto waitStart = std::chrono::high_resolution_clock::now();
-    checkXRResult(xrWaitFrame(m_session, &waitFrameInfo, &m_frameState), "Failed to wait for next frame!");
-    m_lastWaitTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+    FrameTrace::Begin("xrWaitFrame");
+    checkXRResult(m_backend->WaitFrame(m_session, &waitFrameInfo, &m_frameState), "Failed to wait for next frame!");
+    FrameTrace::End();
+    const double waitTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+    m_lastWaitTimeMs = waitTimeMs;
+    FrameTrace::Counter("xrWaitFrame (ms)", waitTimeMs);
 
     // Runtime predicted cadence
-    m_predictedDisplayPeriodMs = (double)m_frameState.predictedDisplayPeriod / 1e6;
+    const double predictedDisplayPeriodMs = (double)m_frameState.predictedDisplayPeriod / 1e6;
+    m_predictedDisplayPeriodMs = predictedDisplayPeriodMs;
 
     // "Frame" as the runtime sees it: delta between predicted display times
     if (m_lastPredictedDisplayTime != 0 && m_frameState.predictedDisplayTime > m_lastPredictedDisplayTime) {
         const XrTime deltaNs = m_frameState.predictedDisplayTime - m_lastPredictedDisplayTime;
-        m_lastFrameTimeMs = (double)deltaNs / 1e6;
+        const double frameTimeMs = (double)deltaNs / 1e6;
+        m_lastFrameTimeMs = frameTimeMs;
 
         // Overhead beyond the runtime cadence (missed interval / late frame, etc.)
-        const double overheadMs = m_lastFrameTimeMs - m_predictedDisplayPeriodMs;
+        const double overheadMs = frameTimeMs - predictedDisplayPeriodMs;
         m_lastOverheadMs = overheadMs > 0.0 ? overheadMs : 0.0;
     }
     m_lastPredictedDisplayTime = m_frameState.predictedDisplayTime;
@@ -51,7 +65,7 @@ void RND_Renderer::StartFrame() {
     m_frameStartTime = std::chrono::high_resolution_clock::now();
 
     XrFrameBeginInfo beginFrameInfo = { XR_TYPE_FRAME_BEGIN_INFO };
-    checkXRResult(xrBeginFrame(m_session, &beginFrameInfo), "Couldn't begin OpenXR frame!");
+    checkXRResult(m_backend->BeginFrame(m_session, &beginFrameInfo), "Couldn't begin OpenXR frame!");
 
     VRManager::instance().D3D12->StartFrame();
     VRManager::instance().XR->UpdateSpaces(m_frameState.predictedDisplayTime);
@@ -68,46 +82,87 @@ void RND_Renderer::StartFrame() {
 }
 
 
+void RND_Renderer::OnGamePresent() {
+    auto runFrame = [this]() {
+        if (IsInitialized()) {
+            EndFrame();
+        }
+        StartFrame();
+    };
+
+    const XrFramePacingMode mode = GetSettings().GetXrFramePacingMode();
+    if (mode == XrFramePacingMode::INLINE) {
+        // joins the worker, so that its frame never overlaps with the inline one
+        m_presentWorker.reset();
+        runFrame();
+        return;
+    }
+
+    const PresentWorker::Policy policy = mode == XrFramePacingMode::LATEST_WINS ? PresentWorker::Policy::LATEST_WINS : PresentWorker::Policy::STRICT;
+    if (!m_presentWorker) {
+        m_presentWorker = std::make_unique<PresentWorker>(runFrame, policy);
+    }
+    m_presentWorker->SetPolicy(policy);
+    m_presentWorker->Publish();
+}
+
 void RND_Renderer::EndFrame() {
+    FrameTrace::Scope traceScope("EndFrame");
+    ALLOC_TRACKER_SCOPE("RND_Renderer::EndFrame");
     static uint32_t s_endFrameCount = 0;
     s_endFrameCount++;
 
-    std::vector<XrCompositionLayerBaseHeader*> compositionLayers;
+    // the layers and the views they point to are owned by the renderer and its layers, so nothing is allocated per frame
+    uint32_t layerCount = 0;
 
     m_presented2DLastFrame = false;
 
-    XrCompositionLayerProjection layer3D = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
-    std::array<XrCompositionLayerProjectionView, 2> layer3DViews = {};
-    std::vector<XrCompositionLayerQuad> layer2DQuads;
-
     long frameIdx = -1;
-    if (m_renderFrames[0].Is3DComplete() && m_renderFrames[0].Is2DComplete()) {
-        frameIdx = 0;
-    }
-    else if (m_renderFrames[1].Is3DComplete() && m_renderFrames[1].Is2DComplete()) {
-        frameIdx = 1;
-    }
-    else if (m_renderFrames[0].Is2DComplete()) {
-        frameIdx = 0;
+    uint64_t traceFlowId = 0;
+    // the oldest complete frame wins, a frame without 3D is only used when none of the frames in flight have it. That frame
+    // has to be one that the game moved on from, otherwise its 3D copies could still be recorded after it got released.
+    std::optional<uint32_t> submittedSlot = m_frameSlots.AcquireForSubmit([this](uint32_t slot) {
+        return m_renderFrames[slot].Is3DComplete() && m_renderFrames[slot].Is2DComplete();
+    });
+    if (!submittedSlot) {
+        submittedSlot = m_frameSlots.AcquireCopiedForSubmit([this](uint32_t slot) {
+            return m_renderFrames[slot].Is2DComplete();
+        });
     }
-    else if (m_renderFrames[1].Is2DComplete()) {
-        frameIdx = 1;
+    if (submittedSlot) {
+        frameIdx = (long)*submittedSlot;
     }
 
     if (frameIdx != -1) {
         if (m_layer3D) {
-            if (m_renderFrames[frameIdx].Is3DComplete()) {
-                m_layer3D->StartRendering();
-                m_layer3D->Render(OpenXR::EyeSide::LEFT, frameIdx);
-                m_layer3D->Render(OpenXR::EyeSide::RIGHT, frameIdx);
-                layer3DViews = m_layer3D->FinishRendering(frameIdx);
-                layer3D.layerFlags = 0;
-                layer3D.space = VRManager::instance().XR->m_stageSpace;
-                layer3D.viewCount = (uint32_t)layer3DViews.size();
-                layer3D.views = layer3DViews.data();
+            const EyeScheduler::Plan eyePlan = m_renderFrames[frameIdx].eyePlan;
+            if (m_renderFrames[frameIdx].Is3DComplete() && m_layer3D->CanSubmit(eyePlan)) {
+                if (GetSettings().UseDynamicResolution()) {
+                    // the scale only applies to the 3D present passes, so their GPU time is what it can actually bring down
+                    const D3D12GpuTimer& d3d12Timer = VRManager::instance().D3D12->GetGpuTimer();
+                    const double presentMs = d3d12Timer.GetLastMs(D3D12GpuTimer::Pass::PRESENT_3D_LEFT) + d3d12Timer.GetLastMs(D3D12GpuTimer::Pass::PRESENT_3D_RIGHT);
+                    m_layer3D->SetRenderScale(m_dynamicResolution.Update({ .gpuTimeMs = presentMs, .displayPeriodMs = m_predictedDisplayPeriodMs }));
+                }
+                else if (m_layer3D->GetRenderScale() != 1.0f) {
+                    m_dynamicResolution.Reset();
+                    m_layer3D->SetRenderScale(1.0f);
+                }
+                m_dynamicResolutionScale = m_dynamicResolution.GetScale();
+                m_layer3D->StartRendering(eyePlan);
+                if (!EyeScheduler::IsEyeStale(eyePlan, OpenXR::EyeSide::LEFT)) {
+                    m_layer3D->Render(OpenXR::EyeSide::LEFT, frameIdx);
+                }
+                if (!EyeScheduler::IsEyeStale(eyePlan, OpenXR::EyeSide::RIGHT)) {
+                    m_layer3D->Render(OpenXR::EyeSide::RIGHT, frameIdx);
+                }
+                const auto& layer3DViews = m_layer3D->FinishRendering(frameIdx, eyePlan);
+                m_projectionLayer.layerFlags = 0;
+                m_projectionLayer.space = VRManager::instance().XR->m_stageSpace;
+                m_projectionLayer.viewCount = (uint32_t)layer3DViews.size();
+                m_projectionLayer.views = layer3DViews.data();
                 if (CemuHooks::IsInGame()) {
                     m_renderFrames[frameIdx].presented3D = true;
-                    compositionLayers.emplace_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer3D));
+                    m_compositionLayers[layerCount++] = reinterpret_cast<XrCompositionLayerBaseHeader*>(&m_projectionLayer);
                 }
                 else {
                     m_renderFrames[frameIdx].presented3D = false;
@@ -119,16 +174,31 @@ void RND_Renderer::EndFrame() {
         }
 
         if (m_layer2D) {
-            m_layer2D->StartRendering();
-            m_layer2D->Render(frameIdx);
-            layer2DQuads = m_layer2D->FinishRendering(m_frameState.predictedDisplayTime, frameIdx);
+            // menus change every frame, so they're never held back by the divider
+            const bool updateHUD = m_layer2D->ShouldUpdate(GetSettings().GetHudUpdateDivider(), CemuHooks::IsShowingMenu());
+            if (updateHUD) {
+                m_layer2D->StartRendering();
+                m_layer2D->Render(frameIdx);
+            }
+            if (const XrCompositionLayerQuad* quad = m_layer2D->FinishRendering(m_frameState.predictedDisplayTime, frameIdx, updateHUD)) {
+                m_compositionLayers[layerCount++] = reinterpret_cast<const XrCompositionLayerBaseHeader*>(quad);
+            }
             m_presented2DLastFrame = true;
-            for (auto& layer : layer2DQuads) {
-                compositionLayers.emplace_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer));
+        }
+
+        // usually a frame or two, depending on how far the game's rendering trails behind the OpenXR frame loop
+        {
+            std::lock_guard lk(m_viewsMutex);
+            if (const XrTime viewsDisplayTime = m_renderFrames[frameIdx].viewsDisplayTime; viewsDisplayTime != 0 && m_frameState.predictedDisplayTime >= viewsDisplayTime) {
+                const XrDuration lag = m_frameState.predictedDisplayTime - viewsDisplayTime;
+                const XrDuration previousLag = m_inputToDisplayLag;
+                m_inputToDisplayLag = previousLag == 0 ? lag : previousLag + (lag - previousLag) / 8;
             }
         }
 
-        m_renderFrames[frameIdx].Reset();
+        traceFlowId = m_renderFrames[frameIdx].traceFlowId;
+        ResetFrame(frameIdx);
+        m_frameSlots.Release((uint32_t)frameIdx);
     }
 
     // decrement camera capture counter since its active only for a few frames
@@ -141,52 +211,124 @@ void RND_Renderer::EndFrame() {
     XrFrameEndInfo frameEndInfo = { XR_TYPE_FRAME_END_INFO };
     frameEndInfo.displayTime = m_frameState.predictedDisplayTime;
     frameEndInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
-    frameEndInfo.layerCount = (uint32_t)compositionLayers.size();
-    frameEndInfo.layers = compositionLayers.data();
+    frameEndInfo.layerCount = layerCount;
+    frameEndInfo.layers = m_compositionLayers.data();
 
     if (s_endFrameCount % 500 == 0) {
         Log::print<INTEROP>("EndFrame #{}: frameIdx={}, layers={}, 3D={}, 2D={}",
-            s_endFrameCount, frameIdx, compositionLayers.size(),
+            s_endFrameCount, frameIdx, layerCount,
             (frameIdx != -1 && m_renderFrames[frameIdx].presented3D) ? "yes" : "no",
             m_presented2DLastFrame ? "yes" : "no");
     }
 
-    XrResult xrResult = xrEndFrame(m_session, &frameEndInfo);
+    FrameTrace::Begin("xrEndFrame");
+    if (traceFlowId != 0) {
+        FrameTrace::FlowEnd("Camera update", traceFlowId);
+    }
+    XrResult xrResult = m_backend->EndFrame(m_session, &frameEndInfo);
+    FrameTrace::End();
     if (XR_FAILED(xrResult)) {
         Log::print<ERROR>("xrEndFrame #{} FAILED with result {}", s_endFrameCount, (int)xrResult);
     }
 
     VRManager::instance().D3D12->EndFrame();
+    UpdateGpuTimings();
+}
+
+void RND_Renderer::UpdateGpuTimings() {
+    // the D3D12 queue is idle after EndFrame, while Cemu's Vulkan work only gets picked up once it's done
+    VulkanGpuTimer& vkTimer = VRManager::instance().VK->GetGpuTimer();
+    D3D12GpuTimer& d3d12Timer = VRManager::instance().D3D12->GetGpuTimer();
+    vkTimer.Resolve();
+    d3d12Timer.Resolve();
+
+    const GpuTimings gpuTimings = {
+        .supported = vkTimer.IsSupported() || d3d12Timer.IsSupported(),
+        .interopCopyMs = vkTimer.GetAverageMs(VulkanGpuTimer::Pass::COPY_3D_LEFT) + vkTimer.GetAverageMs(VulkanGpuTimer::Pass::COPY_3D_RIGHT) + vkTimer.GetAverageMs(VulkanGpuTimer::Pass::COPY_DEPTH_LEFT) + vkTimer.GetAverageMs(VulkanGpuTimer::Pass::COPY_DEPTH_RIGHT) + vkTimer.GetAverageMs(VulkanGpuTimer::Pass::COPY_2D),
+        .imguiMs = vkTimer.GetAverageMs(VulkanGpuTimer::Pass::IMGUI),
+        .presentMs = d3d12Timer.GetAverageMs(D3D12GpuTimer::Pass::PRESENT_3D_LEFT) + d3d12Timer.GetAverageMs(D3D12GpuTimer::Pass::PRESENT_3D_RIGHT) + d3d12Timer.GetAverageMs(D3D12GpuTimer::Pass::PRESENT_2D),
+    };
+    {
+        std::lock_guard lk(m_gpuTimingsMutex);
+        m_gpuTimings = gpuTimings;
+    }
+    FrameTrace::Counter("GPU interop copies (ms)", gpuTimings.interopCopyMs);
+    FrameTrace::Counter("GPU ImGui overlay (ms)", gpuTimings.imguiMs);
+    FrameTrace::Counter("GPU present passes (ms)", gpuTimings.presentMs);
+}
+
+long RND_Renderer::AcquireFrameSlot(uint32_t gameFrameCounter) {
+    const FrameSlotScheduler::Acquired acquired = m_frameSlots.AcquireForGame(gameFrameCounter);
+    if (acquired.recycled) {
+        // the XR frame loop fell behind by more than the frames in flight, so the oldest unsubmitted frame is dropped
+        Log::print<RENDERING>("Dropped the unsubmitted frame in slot {} to make room for game frame {}", acquired.slot, gameFrameCounter);
+        ResetFrame((long)acquired.slot);
+    }
+    return (long)acquired.slot;
+}
+
+std::optional<long> RND_Renderer::FindFrameSlot(uint32_t gameFrameCounter) const {
+    return m_frameSlots.FindForGame(gameFrameCounter).transform([](uint32_t slot) { return (long)slot; });
+}
+
+void RND_Renderer::OnCopySubmitted(const FrameCopy& copy) {
+    // a frame that got dropped in the meantime doesn't get completed by the copies of the frame that it was dropped for
+    m_frameSlots.UpdateIfUnsubmitted(copy.slot, copy.sequence, [&]() {
+        RenderFrame& frame = m_renderFrames[copy.slot];
+        switch (copy.kind) {
+            case FrameCopy::Kind::COLOR_3D:
+                frame.submittedColor[copy.side] = true;
+                break;
+            case FrameCopy::Kind::DEPTH_3D:
+                frame.submittedDepth[copy.side] = true;
+                break;
+            case FrameCopy::Kind::HUD_2D:
+                frame.submitted2D = true;
+                break;
+        }
+    });
 }
 
 RND_Renderer::Layer3D::Layer3D(VkExtent2D inputRes, VkExtent2D outputRes) {
     auto viewConfs = VRManager::instance().XR->GetViewConfigurations();
+    m_submitDepth = VRManager::instance().XR->IsSubmittingDepth();
 
     this->m_recommendedAspectRatios[OpenXR::EyeSide::LEFT] = (float)viewConfs[0].recommendedImageRectWidth / (float)viewConfs[0].recommendedImageRectHeight;
     this->m_recommendedAspectRatios[OpenXR::EyeSide::RIGHT] = (float)viewConfs[1].recommendedImageRectWidth / (float)viewConfs[1].recommendedImageRectHeight;
 
-    this->m_presentPipelines[OpenXR::EyeSide::LEFT] = std::make_unique<RND_D3D12::PresentPipeline<true>>(VRManager::instance().XR->GetRenderer());
-    this->m_presentPipelines[OpenXR::EyeSide::RIGHT] = std::make_unique<RND_D3D12::PresentPipeline<true>>(VRManager::instance().XR->GetRenderer());
-
     this->m_swapchains[OpenXR::EyeSide::LEFT] = std::make_unique<Swapchain<DXGI_FORMAT_R8G8B8A8_UNORM_SRGB>>(outputRes.width, outputRes.height, viewConfs[0].recommendedSwapchainSampleCount);
     this->m_swapchains[OpenXR::EyeSide::RIGHT] = std::make_unique<Swapchain<DXGI_FORMAT_R8G8B8A8_UNORM_SRGB>>(outputRes.width, outputRes.height, viewConfs[1].recommendedSwapchainSampleCount);
-    this->m_depthSwapchains[OpenXR::EyeSide::LEFT] = std::make_unique<Swapchain<DXGI_FORMAT_D32_FLOAT>>(outputRes.width, outputRes.height, viewConfs[0].recommendedSwapchainSampleCount);
-    this->m_depthSwapchains[OpenXR::EyeSide::RIGHT] = std::make_unique<Swapchain<DXGI_FORMAT_D32_FLOAT>>(outputRes.width, outputRes.height, viewConfs[1].recommendedSwapchainSampleCount);
 
-    this->m_presentPipelines[OpenXR::EyeSide::LEFT]->BindSettings((float)outputRes.width, (float)outputRes.height);
-    this->m_presentPipelines[OpenXR::EyeSide::RIGHT]->BindSettings((float)outputRes.width, (float)outputRes.height);
+    if (m_submitDepth) {
+        this->m_presentPipelines[OpenXR::EyeSide::LEFT] = std::make_unique<RND_D3D12::PresentPipeline<true>>(VRManager::instance().XR->GetRenderer());
+        this->m_presentPipelines[OpenXR::EyeSide::RIGHT] = std::make_unique<RND_D3D12::PresentPipeline<true>>(VRManager::instance().XR->GetRenderer());
+        this->m_presentPipelines[OpenXR::EyeSide::LEFT]->BindSettings((float)outputRes.width, (float)outputRes.height);
+        this->m_presentPipelines[OpenXR::EyeSide::RIGHT]->BindSettings((float)outputRes.width, (float)outputRes.height);
+
+        this->m_depthSwapchains[OpenXR::EyeSide::LEFT] = std::make_unique<Swapchain<DXGI_FORMAT_D32_FLOAT>>(outputRes.width, outputRes.height, viewConfs[0].recommendedSwapchainSampleCount);
+        this->m_depthSwapchains[OpenXR::EyeSide::RIGHT] = std::make_unique<Swapchain<DXGI_FORMAT_D32_FLOAT>>(outputRes.width, outputRes.height, viewConfs[1].recommendedSwapchainSampleCount);
+    }
+    else {
+        this->m_colorPresentPipelines[OpenXR::EyeSide::LEFT] = std::make_unique<RND_D3D12::PresentPipeline<false>>(VRManager::instance().XR->GetRenderer());
+        this->m_colorPresentPipelines[OpenXR::EyeSide::RIGHT] = std::make_unique<RND_D3D12::PresentPipeline<false>>(VRManager::instance().XR->GetRenderer());
+        this->m_colorPresentPipelines[OpenXR::EyeSide::LEFT]->BindSettings((float)outputRes.width, (float)outputRes.height);
+        this->m_colorPresentPipelines[OpenXR::EyeSide::RIGHT]->BindSettings((float)outputRes.width, (float)outputRes.height);
+    }
 
     // initialize textures
-    for (int i = 0; i < 2; ++i) {
+    const uint32_t frameCount = VRManager::instance().XR->GetRenderer()->GetFrameCount();
+    for (uint32_t i = 0; i < frameCount; ++i) {
         this->m_textures[OpenXR::EyeSide::LEFT][i] = std::make_unique<SharedTexture>(inputRes.width, inputRes.height, VK_FORMAT_A2B10G10R10_UNORM_PACK32, D3D12Utils::ToDXGIFormat(VK_FORMAT_A2B10G10R10_UNORM_PACK32));
         this->m_textures[OpenXR::EyeSide::RIGHT][i] = std::make_unique<SharedTexture>(inputRes.width, inputRes.height, VK_FORMAT_A2B10G10R10_UNORM_PACK32, D3D12Utils::ToDXGIFormat(VK_FORMAT_A2B10G10R10_UNORM_PACK32));
-        this->m_depthTextures[OpenXR::EyeSide::LEFT][i] = std::make_unique<SharedTexture>(inputRes.width, inputRes.height, VK_FORMAT_D32_SFLOAT, D3D12Utils::ToDXGIFormat(VK_FORMAT_D32_SFLOAT));
-        this->m_depthTextures[OpenXR::EyeSide::RIGHT][i] = std::make_unique<SharedTexture>(inputRes.width, inputRes.height, VK_FORMAT_D32_SFLOAT, D3D12Utils::ToDXGIFormat(VK_FORMAT_D32_SFLOAT));
-
         this->m_textures[OpenXR::EyeSide::LEFT][i]->d3d12GetTexture()->SetName(L"Layer3D - Left Color Texture");
         this->m_textures[OpenXR::EyeSide::RIGHT][i]->d3d12GetTexture()->SetName(L"Layer3D - Right Color Texture");
-        this->m_depthTextures[OpenXR::EyeSide::LEFT][i]->d3d12GetTexture()->SetName(L"Layer3D - Left Depth Texture");
-        this->m_depthTextures[OpenXR::EyeSide::RIGHT][i]->d3d12GetTexture()->SetName(L"Layer3D - Right Depth Texture");
+
+        if (m_submitDepth) {
+            this->m_depthTextures[OpenXR::EyeSide::LEFT][i] = std::make_unique<SharedTexture>(inputRes.width, inputRes.height, VK_FORMAT_D32_SFLOAT, D3D12Utils::ToDXGIFormat(VK_FORMAT_D32_SFLOAT));
+            this->m_depthTextures[OpenXR::EyeSide::RIGHT][i] = std::make_unique<SharedTexture>(inputRes.width, inputRes.height, VK_FORMAT_D32_SFLOAT, D3D12Utils::ToDXGIFormat(VK_FORMAT_D32_SFLOAT));
+            this->m_depthTextures[OpenXR::EyeSide::LEFT][i]->d3d12GetTexture()->SetName(L"Layer3D - Left Depth Texture");
+            this->m_depthTextures[OpenXR::EyeSide::RIGHT][i]->d3d12GetTexture()->SetName(L"Layer3D - Right Depth Texture");
+        }
     }
 }
 
@@ -213,12 +355,16 @@ SharedTexture* RND_Renderer::Layer3D::CopyColorToLayer(OpenXR::EyeSide side, VkC
         Log::print<INTEROP>("Layer3D::CopyColorToLayer #{} - side={}, frameIdx={}, srcImage={}", s_copyCount, side == OpenXR::EyeSide::LEFT ? "L" : "R", frameIdx, (void*)image);
     }
 
+    FrameTrace::Scope traceScope("CopyColorToLayer");
     m_currentFrameIdx = frameIdx;
+    VulkanGpuTimer::Scope gpuScope(VRManager::instance().VK->GetGpuTimer(), copyCmdBuffer, side == OpenXR::EyeSide::LEFT ? VulkanGpuTimer::Pass::COPY_3D_LEFT : VulkanGpuTimer::Pass::COPY_3D_RIGHT);
     m_textures[side][frameIdx]->CopyFromVkImage(copyCmdBuffer, image);
     return m_textures[side][frameIdx].get();
 }
 
 SharedTexture* RND_Renderer::Layer3D::CopyDepthToLayer(OpenXR::EyeSide side, VkCommandBuffer copyCmdBuffer, VkImage image, long frameIdx) {
+    checkAssert(m_submitDepth, "Depth is copied while it isn't submitted!");
+    VulkanGpuTimer::Scope gpuScope(VRManager::instance().VK->GetGpuTimer(), copyCmdBuffer, side == OpenXR::EyeSide::LEFT ? VulkanGpuTimer::Pass::COPY_DEPTH_LEFT : VulkanGpuTimer::Pass::COPY_DEPTH_RIGHT);
     m_depthTextures[side][frameIdx]->CopyFromVkImage(copyCmdBuffer, image);
     return m_depthTextures[side][frameIdx].get();
 }
@@ -226,7 +372,9 @@ SharedTexture* RND_Renderer::Layer3D::CopyDepthToLayer(OpenXR::EyeSide side, VkC
 void RND_Renderer::Layer3D::PrepareRendering(OpenXR::EyeSide side) {
     // Log::print("Preparing rendering for {} side", side == OpenXR::EyeSide::LEFT ? "left" : "right");
     m_swapchains[side]->PrepareRendering();
-    m_depthSwapchains[side]->PrepareRendering();
+    if (m_submitDepth) {
+        m_depthSwapchains[side]->PrepareRendering();
+    }
 }
 
 std::optional<std::array<XrView, 2>> RND_Renderer::UpdateViews(XrTime predictedDisplayTime) {
@@ -237,28 +385,34 @@ std::optional<std::array<XrView, 2>> RND_Renderer::UpdateViews(XrTime predictedD
     viewLocateInfo.space = VRManager::instance().XR->m_stageSpace; // locate the rendering views relative to the room, not the headset center
     XrViewState viewState = { XR_TYPE_VIEW_STATE };
     uint32_t viewCount = (uint32_t)newViews.size();
-    checkXRResult(xrLocateViews(VRManager::instance().XR->m_session, &viewLocateInfo, &viewState, viewCount, &viewCount, newViews.data()), "Failed to get view information!");
+    checkXRResult(m_backend->LocateViews(m_session, &viewLocateInfo, &viewState, viewCount, &viewCount, newViews.data()), "Failed to get view information!");
     if ((viewState.viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) == 0)
         return std::nullopt; // what should occur when the orientation is invalid? keep rendering using old values?
 
+    std::lock_guard lk(m_viewsMutex);
     m_currViews = newViews;
+    m_currViewsDisplayTime = predictedDisplayTime;
     return m_currViews;
 }
 
-void RND_Renderer::Layer3D::StartRendering() {
+void RND_Renderer::Layer3D::StartRendering(EyeScheduler::Plan eyePlan) {
     // checkAssert((this->m_textures[OpenXR::EyeSide::LEFT] == nullptr && this->m_textures[OpenXR::EyeSide::RIGHT] == nullptr) || (this->m_textures[OpenXR::EyeSide::LEFT] != nullptr && this->m_textures[OpenXR::EyeSide::RIGHT] != nullptr), "Both textures must be either null or not null");
     // checkAssert((this->m_depthTextures[OpenXR::EyeSide::LEFT] == nullptr && this->m_depthTextures[OpenXR::EyeSide::RIGHT] == nullptr) || (this->m_depthTextures[OpenXR::EyeSide::LEFT] != nullptr && this->m_depthTextures[OpenXR::EyeSide::RIGHT] != nullptr), "Both depth textures must be either null or not null");
     // checkAssert((this->m_textures[OpenXR::EyeSide::LEFT][0] == nullptr && this->m_textures[OpenXR::EyeSide::RIGHT][0] == nullptr) || (this->m_textures[OpenXR::EyeSide::LEFT][0] != nullptr && this->m_textures[OpenXR::EyeSide::RIGHT][0] != nullptr), "Both textures must be either null or not null");
     // checkAssert((this->m_depthTextures[OpenXR::EyeSide::LEFT][0] == nullptr && this->m_depthTextures[OpenXR::EyeSide::RIGHT][0] == nullptr) || (this->m_depthTextures[OpenXR::EyeSide::LEFT][0] != nullptr && this->m_depthTextures[OpenXR::EyeSide::RIGHT][0] != nullptr), "Both depth textures must be either null or not null");
 
-    this->m_swapchains[OpenXR::EyeSide::LEFT]->PrepareRendering();
-    this->m_swapchains[OpenXR::EyeSide::LEFT]->StartRendering();
-    this->m_depthSwapchains[OpenXR::EyeSide::LEFT]->PrepareRendering();
-    this->m_depthSwapchains[OpenXR::EyeSide::LEFT]->StartRendering();
-    this->m_swapchains[OpenXR::EyeSide::RIGHT]->PrepareRendering();
-    this->m_swapchains[OpenXR::EyeSide::RIGHT]->StartRendering();
-    this->m_depthSwapchains[OpenXR::EyeSide::RIGHT]->PrepareRendering();
-    this->m_depthSwapchains[OpenXR::EyeSide::RIGHT]->StartRendering();
+    for (OpenXR::EyeSide side : { OpenXR::EyeSide::LEFT, OpenXR::EyeSide::RIGHT }) {
+        // the runtime keeps using the last released image of a swapchain that isn't rendered to, which is the stale eye
+        if (EyeScheduler::IsEyeStale(eyePlan, side)) {
+            continue;
+        }
+        this->m_swapchains[side]->PrepareRendering();
+        this->m_swapchains[side]->StartRendering();
+        if (m_submitDepth) {
+            this->m_depthSwapchains[side]->PrepareRendering();
+            this->m_depthSwapchains[side]->StartRendering();
+        }
+    }
 }
 
 void RND_Renderer::Layer3D::Render(OpenXR::EyeSide side, long frameIdx) {
@@ -269,60 +423,90 @@ void RND_Renderer::Layer3D::Render(OpenXR::EyeSide side, long frameIdx) {
     RND_D3D12::CommandContext<false> renderSharedTexture(device, queue, allocator, [this, side, frameIdx](RND_D3D12::CommandContext<false>* context) {
         context->GetRecordList()->SetName(L"RenderSharedTexture");
         auto& texture = m_textures[side][frameIdx];
-        auto& depthTexture = m_depthTextures[side][frameIdx];
-
         context->WaitFor(texture.get(), texture->GetD3D12WaitValue());
-        context->WaitFor(depthTexture.get(), depthTexture->GetD3D12WaitValue());
+        D3D12GpuTimer::Scope gpuScope(VRManager::instance().D3D12->GetGpuTimer(), context->GetRecordList(), side == OpenXR::EyeSide::LEFT ? D3D12GpuTimer::Pass::PRESENT_3D_LEFT : D3D12GpuTimer::Pass::PRESENT_3D_RIGHT);
 
         // swapchains are already in D3D12_RESOURCE_STATE_RENDER_TARGET and depth in D3D12_RESOURCE_STATE_DEPTH_WRITE according to OpenXR spec
+        if (m_submitDepth) {
+            auto& depthTexture = m_depthTextures[side][frameIdx];
+            context->WaitFor(depthTexture.get(), depthTexture->GetD3D12WaitValue());
 
-        m_presentPipelines[side]->BindAttachment(0, texture->d3d12GetTexture());
-        m_presentPipelines[side]->BindAttachment(1, depthTexture->d3d12GetTexture(), DXGI_FORMAT_R32_FLOAT);
-        m_presentPipelines[side]->BindTarget(0, m_swapchains[side]->GetTexture(), m_swapchains[side]->GetFormat());
-        m_presentPipelines[side]->BindDepthTarget(m_depthSwapchains[side]->GetTexture(), m_depthSwapchains[side]->GetFormat());
-        m_presentPipelines[side]->Render(context->GetRecordList(), m_swapchains[side]->GetTexture());
+            m_presentPipelines[side]->BindAttachment(0, texture->d3d12GetTexture());
+            m_presentPipelines[side]->BindAttachment(1, depthTexture->d3d12GetTexture(), DXGI_FORMAT_R32_FLOAT);
+            m_presentPipelines[side]->BindTarget(0, m_swapchains[side]->GetTexture(), m_swapchains[side]->GetFormat());
+            m_presentPipelines[side]->BindDepthTarget(m_depthSwapchains[side]->GetTexture(), m_depthSwapchains[side]->GetFormat());
+            m_presentPipelines[side]->Render(context->GetRecordList(), m_swapchains[side]->GetTexture(), GetRenderExtent(side));
+
+            context->Signal(depthTexture.get(), depthTexture->GetD3D12SignalValue());
+        }
+        else {
+            m_colorPresentPipelines[side]->BindAttachment(0, texture->d3d12GetTexture());
+            m_colorPresentPipelines[side]->BindTarget(0, m_swapchains[side]->GetTexture(), m_swapchains[side]->GetFormat());
+            m_colorPresentPipelines[side]->Render(context->GetRecordList(), m_swapchains[side]->GetTexture(), GetRenderExtent(side));
+        }
 
         // no transition needed here as OpenXR requires the swapchain to be returned in RENDER_TARGET/DEPTH_WRITE too
 
         context->Signal(texture.get(), texture->GetD3D12SignalValue());
-        context->Signal(depthTexture.get(), depthTexture->GetD3D12SignalValue());
     });
     // Log::print("[D3D12 - 3D Layer] Rendering finished");
 }
 
-const std::array<XrCompositionLayerProjectionView, 2>& RND_Renderer::Layer3D::FinishRendering(long frameIdx) {
-    this->m_swapchains[EyeSide::LEFT]->FinishRendering();
-    this->m_depthSwapchains[EyeSide::LEFT]->FinishRendering();
-    this->m_swapchains[EyeSide::RIGHT]->FinishRendering();
-    this->m_depthSwapchains[EyeSide::RIGHT]->FinishRendering();
+XrExtent2Di RND_Renderer::Layer3D::GetRenderExtent(OpenXR::EyeSide side) const {
+    // the color and depth swapchains have the same size, so both use the same sub-rectangle
+    return DynamicResolution::GetScaledExtent(m_swapchains[side]->GetWidth(), m_swapchains[side]->GetHeight(), m_renderScale);
+}
+
+bool RND_Renderer::Layer3D::CanSubmit(EyeScheduler::Plan eyePlan) const {
+    for (OpenXR::EyeSide side : { OpenXR::EyeSide::LEFT, OpenXR::EyeSide::RIGHT }) {
+        if (EyeScheduler::IsEyeStale(eyePlan, side) && !m_lastRenderedViews[side].has_value()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::array<XrCompositionLayerProjectionView, 2>& RND_Renderer::Layer3D::FinishRendering(long frameIdx, EyeScheduler::Plan eyePlan) {
+    for (OpenXR::EyeSide side : { OpenXR::EyeSide::LEFT, OpenXR::EyeSide::RIGHT }) {
+        if (EyeScheduler::IsEyeStale(eyePlan, side)) {
+            continue;
+        }
+        this->m_swapchains[side]->FinishRendering();
+        if (m_submitDepth) {
+            this->m_depthSwapchains[side]->FinishRendering();
+        }
+        m_lastRenderedViews[side] = RenderedView{
+            .pose = VRManager::instance().XR->GetRenderer()->GetPose(side, frameIdx).value(),
+            .fov = VRManager::instance().XR->GetRenderer()->GetFOV(side, frameIdx).value(),
+            .extent = GetRenderExtent(side)
+        };
+    }
+
+    // a stale eye keeps the pose it was rendered with, so that the runtime reprojects it to the current head pose
+    const RenderedView& leftView = *m_lastRenderedViews[EyeSide::LEFT];
+    const RenderedView& rightView = *m_lastRenderedViews[EyeSide::RIGHT];
 
     // clang-format off
     m_projectionViews[EyeSide::LEFT] = {
         .type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW,
-        .next = &m_projectionViewsDepthInfo[EyeSide::LEFT],
-        .pose = VRManager::instance().XR->GetRenderer()->GetPose(EyeSide::LEFT, frameIdx).value(),
-        .fov = VRManager::instance().XR->GetRenderer()->GetFOV(EyeSide::LEFT, frameIdx).value(),
+        .next = m_submitDepth ? &m_projectionViewsDepthInfo[EyeSide::LEFT] : nullptr,
+        .pose = leftView.pose,
+        .fov = leftView.fov,
         .subImage = {
             .swapchain = this->m_swapchains[EyeSide::LEFT]->GetHandle(),
             .imageRect = {
                 .offset = { 0, 0 },
-                .extent = {
-                    .width = (int32_t)this->m_swapchains[EyeSide::LEFT]->GetWidth(),
-                    .height = (int32_t)this->m_swapchains[EyeSide::LEFT]->GetHeight()
-                }
+                .extent = leftView.extent
             }
         }
     };
     m_projectionViewsDepthInfo[EyeSide::LEFT] = {
         .type = XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR,
         .subImage = {
-            .swapchain = this->m_depthSwapchains[EyeSide::LEFT]->GetHandle(),
+            .swapchain = m_submitDepth ? this->m_depthSwapchains[EyeSide::LEFT]->GetHandle() : XR_NULL_HANDLE,
             .imageRect = {
                 .offset = { 0, 0 },
-                .extent = {
-                    .width = (int32_t)this->m_depthSwapchains[EyeSide::LEFT]->GetWidth(),
-                    .height = (int32_t)this->m_depthSwapchains[EyeSide::LEFT]->GetHeight()
-                }
+                .extent = leftView.extent
             },
         },
         .minDepth = 0.0f,
@@ -332,30 +516,24 @@ const std::array<XrCompositionLayerProjectionView, 2>& RND_Renderer::Layer3D::Fi
     };
     m_projectionViews[EyeSide::RIGHT] = {
         .type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW,
-        .next = &m_projectionViewsDepthInfo[EyeSide::RIGHT],
-        .pose = VRManager::instance().XR->GetRenderer()->GetPose(EyeSide::RIGHT, frameIdx).value(),
-        .fov = VRManager::instance().XR->GetRenderer()->GetFOV(EyeSide::RIGHT, frameIdx).value(),
+        .next = m_submitDepth ? &m_projectionViewsDepthInfo[EyeSide::RIGHT] : nullptr,
+        .pose = rightView.pose,
+        .fov = rightView.fov,
         .subImage = {
             .swapchain = this->m_swapchains[EyeSide::RIGHT]->GetHandle(),
             .imageRect = {
                 .offset = { 0, 0 },
-                .extent = {
-                    .width = (int32_t)this->m_swapchains[EyeSide::RIGHT]->GetWidth(),
-                    .height = (int32_t)this->m_swapchains[EyeSide::RIGHT]->GetHeight()
-                }
+                .extent = rightView.extent
             }
         }
     };
     m_projectionViewsDepthInfo[EyeSide::RIGHT] = {
         .type = XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR,
         .subImage = {
-            .swapchain = this->m_depthSwapchains[EyeSide::RIGHT]->GetHandle(),
+            .swapchain = m_submitDepth ? this->m_depthSwapchains[EyeSide::RIGHT]->GetHandle() : XR_NULL_HANDLE,
             .imageRect = {
                 .offset = { 0, 0 },
-                .extent = {
-                    .width = (int32_t)this->m_depthSwapchains[EyeSide::RIGHT]->GetWidth(),
-                    .height = (int32_t)this->m_depthSwapchains[EyeSide::RIGHT]->GetHeight()
-                }
+                .extent = rightView.extent
             },
         },
         .minDepth = 0.0f,
@@ -372,13 +550,16 @@ RND_Renderer::Layer2D::Layer2D(VkExtent2D inputRes, VkExtent2D outputRes) {
     auto viewConfs = VRManager::instance().XR->GetViewConfigurations();
 
     this->m_presentPipeline = std::make_unique<RND_D3D12::PresentPipeline<false>>(VRManager::instance().XR->GetRenderer());
+    this->m_premultiplyPresentPipeline = std::make_unique<RND_D3D12::PresentPipeline<false>>(VRManager::instance().XR->GetRenderer());
 
     this->m_swapchain = std::make_unique<Swapchain<DXGI_FORMAT_R8G8B8A8_UNORM_SRGB>>(inputRes.width, inputRes.height, viewConfs[0].recommendedSwapchainSampleCount);
 
     this->m_presentPipeline->BindSettings(outputRes.width, outputRes.height);
+    this->m_premultiplyPresentPipeline->BindSettings(outputRes.width, outputRes.height, true);
 
     // initialize textures
-    for (int i = 0; i < 2; ++i) {
+    const uint32_t frameCount = VRManager::instance().XR->GetRenderer()->GetFrameCount();
+    for (uint32_t i = 0; i < frameCount; ++i) {
         this->m_textures[i] = std::make_unique<SharedTexture>(inputRes.width, inputRes.height, VK_FORMAT_A2B10G10R10_UNORM_PACK32, D3D12Utils::ToDXGIFormat(VK_FORMAT_A2B10G10R10_UNORM_PACK32));
         this->m_textures[i]->d3d12GetTexture()->SetName(L"Layer2D - Color Texture");
     }
@@ -389,9 +570,9 @@ RND_Renderer::Layer2D::Layer2D(VkExtent2D inputRes, VkExtent2D outputRes) {
         ID3D12CommandQueue* d3d12Queue = VRManager::instance().D3D12->GetCommandQueue();
         d3d12Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&cmdAllocator));
 
-        RND_D3D12::CommandContext<true> transitionInitialTextures(d3d12Device, d3d12Queue, cmdAllocator.Get(), [this](RND_D3D12::CommandContext<true>* context) {
+        RND_D3D12::CommandContext<true> transitionInitialTextures(d3d12Device, d3d12Queue, cmdAllocator.Get(), [this, frameCount](RND_D3D12::CommandContext<true>* context) {
             context->GetRecordList()->SetName(L"transitionInitialTextures");
-            for (int i = 0; i < 2; ++i) {
+            for (uint32_t i = 0; i < frameCount; ++i) {
                 this->m_textures[i]->d3d12TransitionLayout(context->GetRecordList(), D3D12_RESOURCE_STATE_COMMON);
             }
         });
@@ -402,7 +583,7 @@ RND_Renderer::Layer2D::~Layer2D() {
     m_swapchain.reset();
 }
 
-SharedTexture* RND_Renderer::Layer2D::CopyColorToLayer(VkCommandBuffer copyCmdBuffer, VkImage image, long frameIdx) {
+SharedTexture* RND_Renderer::Layer2D::CopyColorToLayer(VkCommandBuffer copyCmdBuffer, VkImage image, long frameIdx, bool premultiplied) {
     static uint32_t s_copyCount = 0;
     s_copyCount++;
     if (s_copyCount % 100 == 0) {
@@ -410,7 +591,9 @@ SharedTexture* RND_Renderer::Layer2D::CopyColorToLayer(VkCommandBuffer copyCmdBu
     }
 
     m_currentFrameIdx = frameIdx;
+    VulkanGpuTimer::Scope gpuScope(VRManager::instance().VK->GetGpuTimer(), copyCmdBuffer, VulkanGpuTimer::Pass::COPY_2D);
     m_textures[frameIdx]->CopyFromVkImage(copyCmdBuffer, image);
+    m_texturesPremultiplied[frameIdx] = premultiplied;
     return m_textures[frameIdx].get();
 }
 
@@ -431,21 +614,28 @@ void RND_Renderer::Layer2D::Render(long frameIdx) {
         // fixme: Why do we signal to the global command list instead of the local one?!
         auto& texture = m_textures[frameIdx];
         context->WaitFor(texture.get(), texture->GetD3D12WaitValue());
+        D3D12GpuTimer::Scope gpuScope(VRManager::instance().D3D12->GetGpuTimer(), context->GetRecordList(), D3D12GpuTimer::Pass::PRESENT_2D);
 
-        m_presentPipeline->BindAttachment(0, texture->d3d12GetTexture());
-        m_presentPipeline->BindTarget(0, m_swapchain->GetTexture(), m_swapchain->GetFormat());
-        m_presentPipeline->Render(context->GetRecordList(), m_swapchain->GetTexture());
+        auto& pipeline = m_texturesPremultiplied[frameIdx] ? m_presentPipeline : m_premultiplyPresentPipeline;
+        pipeline->BindAttachment(0, texture->d3d12GetTexture());
+        pipeline->BindTarget(0, m_swapchain->GetTexture(), m_swapchain->GetFormat());
+        pipeline->Render(context->GetRecordList(), m_swapchain->GetTexture());
 
         context->Signal(texture.get(), texture->GetD3D12SignalValue());
     });
 }
 
-std::vector<XrCompositionLayerQuad> RND_Renderer::Layer2D::FinishRendering(XrTime predictedDisplayTime, long frameIdx) {
-    this->m_swapchain->FinishRendering();
+const XrCompositionLayerQuad* RND_Renderer::Layer2D::FinishRendering(XrTime predictedDisplayTime, long frameIdx, bool rendered) {
+    ALLOC_TRACKER_SCOPE("Layer2D::FinishRendering");
+    // without rendering the swapchain isn't acquired, so the runtime keeps showing its last released image
+    if (rendered) {
+        this->m_swapchain->FinishRendering();
+        m_updateDivider.OnUpdated();
+    }
 
     auto poses = VRManager::instance().XR->GetRenderer()->GetPoses(frameIdx);
     if (!poses.has_value()) {
-        return {};
+        return nullptr;
     }
 
     const XrPosef& leftPose = poses->at(OpenXR::EyeSide::LEFT).pose;
@@ -494,10 +684,8 @@ std::vector<XrCompositionLayerQuad> RND_Renderer::Layer2D::FinishRendering(XrTim
     // todo: change space to head space if we want to follow the head
     const float LAYER_SIZE = GetSettings().hudSize.Get();
 
-    std::vector<XrCompositionLayerQuad> layers;
-
     // clang-format off
-    layers.push_back({
+    m_quad = {
         .type = XR_TYPE_COMPOSITION_LAYER_QUAD,
         .layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
         .space = VRManager::instance().XR->m_stageSpace,
@@ -514,15 +702,8 @@ std::vector<XrCompositionLayerQuad> RND_Renderer::Layer2D::FinishRendering(XrTim
         },
         .pose = layerPose,
         .size = { width * LAYER_SIZE, height * LAYER_SIZE }
-    });
+    };
     // clang-format on
 
-    // render layer twice to visualize the controller positions in debug mode
-    auto inputs = VRManager::instance().XR->m_input.load();
-
-    if (!(inputs.shared.in_game && inputs.shared.pose[OpenXR::EyeSide::LEFT].isActive && inputs.shared.pose[OpenXR::EyeSide::RIGHT].isActive)) {
-        return layers;
-    }
-
-    return layers;
+    return &m_quad;
 }
@@ -5,21 +5,36 @@
 #include "openxr.h"
 #include "swapchain.h"
 #include "texture.h"
+#include "present_worker.h"
+#include "utils/dynamic_resolution.h"
+#include "utils/frame_slots.h"
+#include "utils/eye_scheduler.h"
+#include "utils/overlay_visibility.h"
+#include "utils/update_divider.h"
 
 class SharedTexture;
 
 class RND_Renderer {
 public:
-    explicit RND_Renderer(XrSession xrSession);
+    explicit RND_Renderer(XrSession xrSession, XrBackend* backend);
     ~RND_Renderer();
 
     struct RenderFrame {
         std::optional<std::array<XrView, 2>> views;
+        XrTime viewsDisplayTime = 0; // the display time that views (and the inputs of the same StartFrame) were located at
+        // set once the copies are recorded, so that the game's second clear of an image doesn't copy it again
         std::atomic_bool copiedColor[2] = { false, false };
         std::atomic_bool copiedDepth[2] = { false, false };
         std::atomic_bool copied2D = false;
+        // set once the command buffers with the copies got submitted, the timeline values that the present passes wait on
+        // are only assigned in QueueSubmit
+        std::atomic_bool submittedColor[2] = { false, false };
+        std::atomic_bool submittedDepth[2] = { false, false };
+        std::atomic_bool submitted2D = false;
         std::atomic_bool presented3D = false;
         std::atomic_uint8_t cameraIsCapturing3DFramebuffer = 0;
+        // an eye that this frame didn't render is submitted from the last frame that did
+        std::atomic<EyeScheduler::Plan> eyePlan = EyeScheduler::Plan::BOTH;
 
         std::unique_ptr<VulkanTexture> mainFramebuffer;
         std::unique_ptr<VulkanTexture> hudFramebuffer;
@@ -30,55 +45,64 @@ public:
         VkDescriptorSet hudWithoutAlphaFramebufferDS = VK_NULL_HANDLE;
         float mainFramebufferAspectRatio = 1.0f;
 
-        bool ranMotionAnalysis[2] = { false, false };
+        // links the camera update that produced this frame to its copy and submission in the frame trace
+        uint64_t traceFlowId = 0;
 
-        bool Is3DComplete() const { return copiedColor[0] && copiedColor[1] && copiedDepth[0] && copiedDepth[1]; }
-        bool Is2DComplete() const { return copied2D; }
+        bool IsEyeComplete(OpenXR::EyeSide side) const { return EyeScheduler::IsEyeStale(eyePlan, side) || (submittedColor[side] && submittedDepth[side]); }
+        bool Is3DComplete() const { return IsEyeComplete(OpenXR::EyeSide::LEFT) && IsEyeComplete(OpenXR::EyeSide::RIGHT); }
+        bool Is2DComplete() const { return submitted2D; }
 
         void Reset() {
             views = std::nullopt;
+            viewsDisplayTime = 0;
             copiedColor[0] = false;
             copiedColor[1] = false;
             copiedDepth[0] = false;
             copiedDepth[1] = false;
             copied2D = false;
+            submittedColor[0] = false;
+            submittedColor[1] = false;
+            submittedDepth[0] = false;
+            submittedDepth[1] = false;
+            submitted2D = false;
+            eyePlan = EyeScheduler::Plan::BOTH;
             if (cameraIsCapturing3DFramebuffer > 0)
                 --cameraIsCapturing3DFramebuffer;
 
-            ranMotionAnalysis[0] = false;
-            ranMotionAnalysis[1] = false;
+            traceFlowId = 0;
         }
     };
 
     void StartFrame();
     void EndFrame();
+    // Called from Cemu's present, runs the XR frame either right away or on the present worker depending on the settings
+    void OnGamePresent();
     std::optional<std::array<XrView, 2>> UpdateViews(XrTime predictedDisplayTime);
     
-    std::optional<std::array<XrView, 2>> GetPoses(long frameIdx = -1) const { 
+    std::optional<std::array<XrView, 2>> GetPoses(long frameIdx = -1) const {
+        // UpdateViews runs on the XR frame loop's thread, while the game's hooks read the views
+        std::lock_guard lk(m_viewsMutex);
         if (frameIdx != -1 && m_renderFrames[frameIdx].views.has_value()) return m_renderFrames[frameIdx].views;
-        return m_currViews; 
+        return m_currViews;
     }
-    
-    std::optional<XrFovf> GetFOV(OpenXR::EyeSide side, long frameIdx = -1) const { 
-        const auto& views = (frameIdx != -1 && m_renderFrames[frameIdx].views.has_value()) ? m_renderFrames[frameIdx].views : m_currViews;
-        return views.transform([side](auto& views) { return views[side].fov; }); 
+
+    std::optional<XrFovf> GetFOV(OpenXR::EyeSide side, long frameIdx = -1) const {
+        return GetPoses(frameIdx).transform([side](auto& views) { return views[side].fov; });
     }
-    
-    std::optional<XrPosef> GetPose(OpenXR::EyeSide side, long frameIdx = -1) const { 
-        const auto& views = (frameIdx != -1 && m_renderFrames[frameIdx].views.has_value()) ? m_renderFrames[frameIdx].views : m_currViews;
-        return views.transform([side](auto& views) { return views[side].pose; }); 
+
+    std::optional<XrPosef> GetPose(OpenXR::EyeSide side, long frameIdx = -1) const {
+        return GetPoses(frameIdx).transform([side](auto& views) { return views[side].pose; });
     }
-    
+
     std::optional<glm::fmat4> GetPoseAsMatrix(OpenXR::EyeSide side, long frameIdx = -1) const {
-        const auto& views = (frameIdx != -1 && m_renderFrames[frameIdx].views.has_value()) ? m_renderFrames[frameIdx].views : m_currViews;
-        return views.transform([side](auto& views) {
+        return GetPoses(frameIdx).transform([side](auto& views) {
             const XrPosef& pose = views[side].pose;
             return ToMat4(ToGLM(pose.position), ToGLM(pose.orientation));
         });
     };
-    
+
     std::optional<glm::fmat4> GetMiddlePose(long frameIdx = -1) const {
-        const auto& views = (frameIdx != -1 && m_renderFrames[frameIdx].views.has_value()) ? m_renderFrames[frameIdx].views : m_currViews;
+        const auto views = GetPoses(frameIdx);
         if (!views.has_value()) return std::nullopt;
         const XrPosef& leftPose = views->at(OpenXR::EyeSide::LEFT).pose;
         const XrPosef& rightPose = views->at(OpenXR::EyeSide::RIGHT).pose;
@@ -93,24 +117,66 @@ public:
     double GetLastFrameTimeMs() const { return m_lastFrameTimeMs; }
     double GetPredictedDisplayPeriodMs() const { return m_predictedDisplayPeriodMs; }
     double GetLastOverheadMs() const { return m_lastOverheadMs; }
+    // Smoothed GPU time of the work that BetterVR adds on top of Cemu's rendering, measured with timestamp queries
+    struct GpuTimings {
+        bool supported = false;
+        double interopCopyMs = 0.0; // copying the game's images into the shared textures
+        double imguiMs = 0.0;
+        double presentMs = 0.0; // drawing the shared textures into the OpenXR swapchains
+    };
+    GpuTimings GetGpuTimings() const {
+        std::lock_guard lk(m_gpuTimingsMutex);
+        return m_gpuTimings;
+    }
+    // Smoothed time between when the poses of a game frame were sampled and when that frame got displayed
+    XrDuration GetInputToDisplayLag() const { return m_inputToDisplayLag; }
+    // m_dynamicResolution itself is only touched by the thread that runs the XR frame loop
+    float GetDynamicResolutionScale() const { return m_dynamicResolutionScale; }
+
+    // A copy into a frame's shared texture, which is recorded by one of the game's clears and completes the frame once the
+    // command buffer it was recorded into gets submitted
+    struct FrameCopy {
+        enum class Kind : uint8_t {
+            COLOR_3D,
+            DEPTH_3D,
+            HUD_2D,
+        };
+        Kind kind = Kind::COLOR_3D;
+        OpenXR::EyeSide side = OpenXR::EyeSide::LEFT;
+        uint32_t slot = 0;
+        uint64_t sequence = 0; // the slot might've been handed to a newer frame by the time the copy gets submitted
+    };
 
-    void On3DColorCopied(OpenXR::EyeSide side, long frameIdx) {
+    FrameCopy On3DColorCopied(OpenXR::EyeSide side, long frameIdx) {
         m_renderFrames[frameIdx].copiedColor[side] = true;
-        if (!m_renderFrames[frameIdx].views.has_value()) m_renderFrames[frameIdx].views = m_currViews;
+        CaptureViews(frameIdx);
+        return { .kind = FrameCopy::Kind::COLOR_3D, .side = side, .slot = (uint32_t)frameIdx, .sequence = m_frameSlots.GetSequence((uint32_t)frameIdx) };
     }
 
-    void On3DDepthCopied(OpenXR::EyeSide side, long frameIdx) {
+    FrameCopy On3DDepthCopied(OpenXR::EyeSide side, long frameIdx) {
         m_renderFrames[frameIdx].copiedDepth[side] = true;
-        if (!m_renderFrames[frameIdx].views.has_value()) m_renderFrames[frameIdx].views = m_currViews;
+        CaptureViews(frameIdx);
+        return { .kind = FrameCopy::Kind::DEPTH_3D, .side = side, .slot = (uint32_t)frameIdx, .sequence = m_frameSlots.GetSequence((uint32_t)frameIdx) };
     }
 
-    void On2DCopied(long frameIdx) {
+    FrameCopy On2DCopied(long frameIdx) {
         m_renderFrames[frameIdx].copied2D = true;
+        return { .kind = FrameCopy::Kind::HUD_2D, .slot = (uint32_t)frameIdx, .sequence = m_frameSlots.GetSequence((uint32_t)frameIdx) };
     }
 
+    // Called from QueueSubmit once the command buffer that the copy was recorded into got submitted
+    void OnCopySubmitted(const FrameCopy& copy);
+
     RenderFrame& GetFrame(long frameIdx) { return m_renderFrames[frameIdx]; }
     const RenderFrame& GetFrame(long frameIdx) const { return m_renderFrames[frameIdx]; }
 
+    // Number of frames in flight, the frame indices used by the layers and the ImGui overlay go from 0 up to this
+    uint32_t GetFrameCount() const { return m_frameSlots.GetSlotCount(); }
+    // Translates the game's frame counter, which only alternates between 0 and 1, into the index of a frame in flight
+    long AcquireFrameSlot(uint32_t gameFrameCounter);
+    std::optional<long> FindFrameSlot(uint32_t gameFrameCounter) const;
+    const FrameSlotScheduler& GetFrameSlots() const { return m_frameSlots; }
+
     class Layer3D {
     public:
         explicit Layer3D(VkExtent2D inputRes, VkExtent2D outputRes);
@@ -119,27 +185,48 @@ public:
         SharedTexture* CopyColorToLayer(OpenXR::EyeSide side, VkCommandBuffer copyCmdBuffer, VkImage image, long frameIdx);
         SharedTexture* CopyDepthToLayer(OpenXR::EyeSide side, VkCommandBuffer copyCmdBuffer, VkImage image, long frameIdx);
         void PrepareRendering(OpenXR::EyeSide side);
-        void StartRendering();
+        // Only the eyes that the plan renders are acquired and rendered, the swapchains of the other eyes keep their last image
+        void StartRendering(EyeScheduler::Plan eyePlan);
         void Render(OpenXR::EyeSide side, long frameIdx);
-        const std::array<XrCompositionLayerProjectionView, 2>& FinishRendering(long frameIdx);
+        const std::array<XrCompositionLayerProjectionView, 2>& FinishRendering(long frameIdx, EyeScheduler::Plan eyePlan);
+        // A stale eye can only be submitted once that eye has been rendered before
+        bool CanSubmit(EyeScheduler::Plan eyePlan) const;
+
+        // Fraction of the swapchain's width and height that Render draws into and FinishRendering submits
+        void SetRenderScale(float scale) { m_renderScale = scale; }
+        float GetRenderScale() const { return m_renderScale; }
+        XrExtent2Di GetRenderExtent(OpenXR::EyeSide side) const;
 
         float GetAspectRatio(OpenXR::EyeSide side) const { return m_recommendedAspectRatios[side]; }
         long GetCurrentFrameIdx() const { return m_currentFrameIdx; }
         auto& GetSharedTextures() { return m_textures; }
+        // only populated when depth is submitted
         auto& GetDepthSharedTextures() { return m_depthTextures; }
+        bool IsSubmittingDepth() const { return m_submitDepth; }
 
     private:
         std::array<std::unique_ptr<Swapchain<DXGI_FORMAT_R8G8B8A8_UNORM_SRGB>>, 2> m_swapchains;
         std::array<std::unique_ptr<Swapchain<DXGI_FORMAT_D32_FLOAT>>, 2> m_depthSwapchains;
         std::array<std::unique_ptr<RND_D3D12::PresentPipeline<true>>, 2> m_presentPipelines;
-        std::array<std::array<std::unique_ptr<SharedTexture>, 2>, 2> m_textures;
-        std::array<std::array<std::unique_ptr<SharedTexture>, 2>, 2> m_depthTextures;
+        std::array<std::unique_ptr<RND_D3D12::PresentPipeline<false>>, 2> m_colorPresentPipelines;
+        std::array<std::array<std::unique_ptr<SharedTexture>, FrameSlotScheduler::MAX_SLOTS>, 2> m_textures;
+        std::array<std::array<std::unique_ptr<SharedTexture>, FrameSlotScheduler::MAX_SLOTS>, 2> m_depthTextures;
         std::array<float, 2> m_recommendedAspectRatios = { 1.0f, 1.0f };
+        bool m_submitDepth = true;
 
         std::array<XrCompositionLayerProjectionView, 2> m_projectionViews = {};
+        // the pose and sub-image that each eye's swapchain image was last rendered with
+        struct RenderedView {
+            XrPosef pose;
+            XrFovf fov;
+            XrExtent2Di extent;
+        };
+        std::array<std::optional<RenderedView>, 2> m_lastRenderedViews;
         std::array<XrCompositionLayerDepthInfoKHR, 2> m_projectionViewsDepthInfo = {};
 
-        long m_currentFrameIdx = 0;
+        float m_renderScale = 1.0f;
+        // set by the copies that Cemu's thread records, read from the XR frame thread
+        std::atomic<long> m_currentFrameIdx = 0;
     };
 
     class Layer2D {
@@ -147,16 +234,20 @@ public:
         explicit Layer2D(VkExtent2D inputRes, VkExtent2D outputRes);
         ~Layer2D();
 
-        SharedTexture* CopyColorToLayer(VkCommandBuffer copyCmdBuffer, VkImage image, long frameIdx);
+        // premultiplied is false when the HUD is copied without the ImGui pass, its colors are then premultiplied while presenting
+        SharedTexture* CopyColorToLayer(VkCommandBuffer copyCmdBuffer, VkImage image, long frameIdx, bool premultiplied);
         // AMD GPU FIX: With incrementing values, Vulkan signals odd values (1,3,5...), D3D12 signals even values (2,4,6...)
         // Texture is ready for D3D12 when Vulkan has signaled (odd value > 0)
         bool IsTextureReady(long frameIdx) const {
             uint64_t lastSignal = m_textures[frameIdx]->GetLastSignalledValue();
             return lastSignal > 0 && (lastSignal % 2 == 1);
         };
+        // Whether the HUD should be rendered this frame, otherwise only the pose of its last image is refreshed
+        bool ShouldUpdate(uint32_t divider, bool force) { return m_updateDivider.ShouldUpdate(divider, force); }
         void StartRendering() const;
         void Render(long frameIdx);
-        std::vector<XrCompositionLayerQuad> FinishRendering(XrTime predictedDisplayTime, long frameIdx);
+        // The returned quad stays valid until the next call, it's null when there are no poses to place it with
+        const XrCompositionLayerQuad* FinishRendering(XrTime predictedDisplayTime, long frameIdx, bool rendered);
         long GetCurrentFrameIdx() const { return m_currentFrameIdx; }
         auto& GetSharedTextures() { return m_textures; }
 
@@ -167,11 +258,16 @@ public:
         static std::atomic_bool s_isBowAimingActive;
         std::unique_ptr<Swapchain<DXGI_FORMAT_R8G8B8A8_UNORM_SRGB>> m_swapchain;
         std::unique_ptr<RND_D3D12::PresentPipeline<false>> m_presentPipeline;
-        std::array<std::unique_ptr<SharedTexture>, 2> m_textures;
+        std::unique_ptr<RND_D3D12::PresentPipeline<false>> m_premultiplyPresentPipeline;
+        std::array<std::unique_ptr<SharedTexture>, FrameSlotScheduler::MAX_SLOTS> m_textures;
+        std::array<std::atomic_bool, FrameSlotScheduler::MAX_SLOTS> m_texturesPremultiplied = {};
 
         glm::quat m_currentOrientation = glm::identity<glm::fquat>();
+        XrCompositionLayerQuad m_quad = { XR_TYPE_COMPOSITION_LAYER_QUAD };
+        UpdateDivider m_updateDivider;
 
-        long m_currentFrameIdx = 0;
+        // set by the copies that Cemu's thread records, read from the XR frame thread
+        std::atomic<long> m_currentFrameIdx = 0;
     };
 
     class ImGuiOverlay {
@@ -182,6 +278,8 @@ public:
         bool ShouldBlockGameInput() { return ImGui::GetIO().WantCaptureKeyboard; }
 
         void Update();
+        // Whether the ImGui pass has to run for the HUD layer, otherwise the HUD is copied to the headset as is
+        bool ShouldRenderHUDPass(long frameIdx);
         static void Draw3DLayerAsBackground(VkCommandBuffer cb, VkImage srcImage, float aspectRatio, long frameIdx);
         static void DrawHUDLayerAsBackground(VkCommandBuffer cb, VkImage srcImage, long frameIdx);
         void Render(long frameIdx, bool renderBackground);
@@ -191,6 +289,9 @@ public:
         int GetHelpImagePagesCount() const { return m_helpImagePages.size(); };
 
     private:
+        static bool IsHelpNotificationVisible();
+        OverlayVisibility m_hudVisibility;
+
         VkDescriptorPool m_descriptorPool;
         VkRenderPass m_renderPass;
         struct HelpImage {
@@ -222,27 +323,66 @@ public:
     void SignalGameCapturing3DFrameBuffer() {
         m_cameraIsCapturing3DFrameBuffer = 1;
     }
+    uint64_t GetCameraTraceFlowId() const {
+        return m_cameraTraceFlowId;
+    }
+    void SetCameraTraceFlowId(uint64_t flowId) {
+        m_cameraTraceFlowId = flowId;
+    }
 
 protected:
+    void UpdateGpuTimings();
+    void ResetFrame(long frameIdx) {
+        std::lock_guard lk(m_viewsMutex);
+        m_renderFrames[frameIdx].Reset();
+    }
+    void CaptureViews(long frameIdx) {
+        std::lock_guard lk(m_viewsMutex);
+        if (!m_renderFrames[frameIdx].views.has_value()) {
+            m_renderFrames[frameIdx].views = m_currViews;
+            m_renderFrames[frameIdx].viewsDisplayTime = m_currViewsDisplayTime;
+        }
+    }
+
+    XrBackend* m_backend;
     XrSession m_session;
     XrFrameState m_frameState = { XR_TYPE_FRAME_STATE };
+    // guards m_currViews and the views that the frames captured from it
+    mutable std::mutex m_viewsMutex;
     std::optional<std::array<XrView, 2>> m_currViews;
-    std::array<RenderFrame, 2> m_renderFrames;
+    XrTime m_currViewsDisplayTime = 0;
+    // at most the 3D layer and the HUD quad are submitted
+    std::array<const XrCompositionLayerBaseHeader*, 2> m_compositionLayers = {};
+    XrCompositionLayerProjection m_projectionLayer = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
+    // only the first GetFrameCount() frames are used
+    std::array<RenderFrame, FrameSlotScheduler::MAX_SLOTS> m_renderFrames;
+    FrameSlotScheduler m_frameSlots;
 
     std::atomic_bool m_isInitialized = false;
     std::atomic_bool m_presented2DLastFrame = false;
     std::atomic_uint8_t m_cameraIsCapturing3DFrameBuffer = 0;
+    std::atomic_uint64_t m_cameraTraceFlowId = 0;
 
     // Full-frame timing derived from OpenXR timestamps (XrTime is in nanoseconds)
     XrTime m_lastPredictedDisplayTime = 0;
 
     std::chrono::high_resolution_clock::time_point m_frameStartTime;
 
-    double m_lastFrameWorkTimeMs = 0.0;
-    double m_lastWaitTimeMs = 0.0;
+    // written by whichever thread runs the XR frame loop and read by the overlays on Cemu's thread
+    std::atomic<double> m_lastFrameWorkTimeMs = 0.0;
+    std::atomic<double> m_lastWaitTimeMs = 0.0;
 
     // Derived from OpenXR timestamps
-    double m_lastFrameTimeMs = 0.0;
-    double m_predictedDisplayPeriodMs = 0.0;
-    double m_lastOverheadMs = 0.0;
+    std::atomic<double> m_lastFrameTimeMs = 0.0;
+    std::atomic<double> m_predictedDisplayPeriodMs = 0.0;
+    std::atomic<double> m_lastOverheadMs = 0.0;
+    // written after every xrEndFrame and read by the performance overlay
+    mutable std::mutex m_gpuTimingsMutex;
+    GpuTimings m_gpuTimings;
+    std::atomic<XrDuration> m_inputToDisplayLag = 0;
+    DynamicResolution m_dynamicResolution;
+    std::atomic<float> m_dynamicResolutionScale = 1.0f;
+
+    // only exists while the XR frame loop runs on its own thread
+    std::unique_ptr<PresentWorker> m_presentWorker;
 };
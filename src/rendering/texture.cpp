@@ -144,6 +144,41 @@ void BaseVulkanTexture::vkUpload(VkCommandBuffer cmdBuffer, const void* data, si
     m_uploadCommandBuffer = cmdBuffer;
     isStagingUpload = true;
 
+    auto* dispatch = VRManager::instance().VK->GetDeviceDispatch();
+
+    VkBuffer srcBuffer = VK_NULL_HANDLE;
+    VkDeviceSize srcOffset = 0;
+    if (auto staging = VRManager::instance().VK->AllocateStaging(cmdBuffer, size)) {
+        memcpy(staging->data, data, size);
+        srcBuffer = staging->buffer;
+        srcOffset = staging->offset;
+    }
+    else {
+        vkCreateOwnStagingBuffer(data, size);
+        srcBuffer = m_stagingBuffer;
+    }
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = srcOffset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = GetAspectMask();
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = { .x = 0, .y = 0, .z = 0 };
+    region.imageExtent = {
+        .width = m_width,
+        .height = m_height,
+        .depth = 1
+    };
+
+    VulkanUtils::DebugPipelineBarrier(cmdBuffer);
+    dispatch->CmdCopyBufferToImage(cmdBuffer, srcBuffer, m_vkImage, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+    VulkanUtils::DebugPipelineBarrier(cmdBuffer);
+}
+
+void BaseVulkanTexture::vkCreateOwnStagingBuffer(const void* data, size_t size) {
     auto* dispatch = VRManager::instance().VK->GetDeviceDispatch();
     VkDevice device = VRManager::instance().VK->GetDevice();
 
@@ -170,25 +205,6 @@ void BaseVulkanTexture::vkUpload(VkCommandBuffer cmdBuffer, const void* data, si
     checkVkResult(dispatch->MapMemory(device, m_stagingMemory, 0, size, 0, &mappedData), "Failed to map staging buffer memory!");
     memcpy(mappedData, data, size);
     dispatch->UnmapMemory(device, m_stagingMemory);
-
-    VkBufferImageCopy region = {};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.imageSubresource.aspectMask = GetAspectMask();
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = { .x = 0, .y = 0, .z = 0 };
-    region.imageExtent = {
-        .width = m_width,
-        .height = m_height,
-        .depth = 1
-    };
-
-    VulkanUtils::DebugPipelineBarrier(cmdBuffer);
-    dispatch->CmdCopyBufferToImage(cmdBuffer, m_stagingBuffer, m_vkImage, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
-    VulkanUtils::DebugPipelineBarrier(cmdBuffer);
 }
 
 // this relies on Cemu always only having one command buffer in flight
@@ -30,6 +30,8 @@ public:
     VkImage GetImage() const { return m_vkImage; }
 
 protected:
+    void vkCreateOwnStagingBuffer(const void* data, size_t size);
+
     VkImage m_vkImage = VK_NULL_HANDLE;
     VkDeviceMemory m_vkMemory = VK_NULL_HANDLE;
     VkImageLayout m_vkCurrLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -39,9 +41,10 @@ protected:
 
     // for tracking uploads and freeing staging buffers
     bool isStagingUpload = false;
-    VkCommandBuffer m_uploadCommandBuffer;
-    VkBuffer m_stagingBuffer;
-    VkDeviceMemory m_stagingMemory;
+    VkCommandBuffer m_uploadCommandBuffer = VK_NULL_HANDLE;
+    // only used when the upload can't use RND_Vulkan's shared staging buffer
+    VkBuffer m_stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory m_stagingMemory = VK_NULL_HANDLE;
 };
 
 class VulkanTexture : public BaseVulkanTexture {
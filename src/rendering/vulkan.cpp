@@ -27,9 +27,152 @@ RND_Vulkan::RND_Vulkan(VkInstance vkInstance, VkPhysicalDevice vkPhysDevice, VkD
     if (localVramBytes > 0) {
         Log::print<INFO>("GPU VRAM (device local): {:.2f} GiB", double(localVramBytes) / (1024.0 * 1024.0 * 1024.0));
     }
+
+    m_gpuTimer = std::make_unique<VulkanGpuTimer>(vkDevice, vkPhysDevice, m_deviceDispatch, m_instanceDispatch);
+
+    // copies have to start at a multiple of the texel size too, which is at most 16 bytes for the formats that get uploaded
+    m_stagingAlignment = std::max<VkDeviceSize>(props.limits.optimalBufferCopyOffsetAlignment, 16);
 }
 
 RND_Vulkan::~RND_Vulkan() {
+    m_gpuTimer.reset();
+
+    ReleaseStagingBuffer();
+    if (m_stagingSemaphore != VK_NULL_HANDLE) {
+        m_deviceDispatch->DestroySemaphore(m_device, m_stagingSemaphore, nullptr);
+    }
+}
+
+std::optional<RND_Vulkan::StagingAllocation> RND_Vulkan::AllocateStaging(VkCommandBuffer cmdBuffer, VkDeviceSize size) {
+    std::lock_guard lk(m_stagingMutex);
+    if (m_stagingBufferFailed || !m_stagingRing.Fits(size)) {
+        return std::nullopt;
+    }
+    // the regions of one command buffer are retired by the signal after its submission, so a second command buffer that
+    // isn't submitted yet can't share that fence value, and a newer one could get submitted first
+    if (m_unsubmittedStagingCmdBuffer != VK_NULL_HANDLE && m_unsubmittedStagingCmdBuffer != cmdBuffer) {
+        return std::nullopt;
+    }
+
+    if (m_stagingSemaphore == VK_NULL_HANDLE) {
+        VkSemaphoreTypeCreateInfo timelineCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+        timelineCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        timelineCreateInfo.initialValue = m_stagingSubmitValue;
+
+        VkSemaphoreCreateInfo semaphoreCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+        semaphoreCreateInfo.pNext = &timelineCreateInfo;
+        if (m_deviceDispatch->CreateSemaphore(m_device, &semaphoreCreateInfo, nullptr, &m_stagingSemaphore) != VK_SUCCESS) {
+            Log::print<WARNING>("Failed to create the staging buffer's timeline semaphore, uploads will use their own staging buffers");
+            m_stagingSemaphore = VK_NULL_HANDLE;
+            m_stagingBufferFailed = true;
+            return std::nullopt;
+        }
+    }
+
+    // only created once something gets uploaded, and freed again once the GPU is done with all of its regions
+    if (m_stagingBuffer == VK_NULL_HANDLE) {
+        VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        bufferInfo.size = STAGING_BUFFER_SIZE;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VkMemoryRequirements memRequirements;
+        VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+        if (m_deviceDispatch->CreateBuffer(m_device, &bufferInfo, nullptr, &m_stagingBuffer) != VK_SUCCESS) {
+            m_stagingBuffer = VK_NULL_HANDLE;
+        }
+        else {
+            m_deviceDispatch->GetBufferMemoryRequirements(m_device, m_stagingBuffer, &memRequirements);
+            allocInfo.allocationSize = memRequirements.size;
+            allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+
+        bool created = m_stagingBuffer != VK_NULL_HANDLE && m_deviceDispatch->AllocateMemory(m_device, &allocInfo, nullptr, &m_stagingMemory) == VK_SUCCESS;
+        if (!created) {
+            m_stagingMemory = VK_NULL_HANDLE;
+        }
+        created = created &&
+            m_deviceDispatch->BindBufferMemory(m_device, m_stagingBuffer, m_stagingMemory, 0) == VK_SUCCESS &&
+            m_deviceDispatch->MapMemory(m_device, m_stagingMemory, 0, STAGING_BUFFER_SIZE, 0, &m_stagingData) == VK_SUCCESS;
+        if (!created) {
+            Log::print<WARNING>("Failed to create the staging buffer, uploads will use their own staging buffers");
+            m_stagingData = nullptr;
+            ReleaseStagingBuffer();
+            m_stagingBufferFailed = true;
+            return std::nullopt;
+        }
+    }
+
+    const std::optional<uint64_t> offset = m_stagingRing.Allocate(size, m_stagingAlignment, m_stagingSubmitValue + 1);
+    if (!offset) {
+        return std::nullopt;
+    }
+    m_unsubmittedStagingCmdBuffer = cmdBuffer;
+    return StagingAllocation{
+        .buffer = m_stagingBuffer,
+        .offset = *offset,
+        .data = (uint8_t*)m_stagingData + *offset
+    };
+}
+
+void RND_Vulkan::OnQueueSubmitted(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits) {
+    std::lock_guard lk(m_stagingMutex);
+    if (m_stagingBuffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    bool submittedStaging = false;
+    for (uint32_t i = 0; i < submitCount && m_unsubmittedStagingCmdBuffer != VK_NULL_HANDLE && !submittedStaging; i++) {
+        const VkCommandBuffer* cmdBuffers = pSubmits[i].pCommandBuffers;
+        submittedStaging = std::find(cmdBuffers, cmdBuffers + pSubmits[i].commandBufferCount, m_unsubmittedStagingCmdBuffer) != cmdBuffers + pSubmits[i].commandBufferCount;
+    }
+
+    if (submittedStaging) {
+        // a signal in its own batch only happens once everything that was submitted to the queue before it finished
+        const uint64_t signalValue = m_stagingSubmitValue + 1;
+        VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+        timelineSubmitInfo.signalSemaphoreValueCount = 1;
+        timelineSubmitInfo.pSignalSemaphoreValues = &signalValue;
+
+        VkSubmitInfo signalSubmitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+        signalSubmitInfo.pNext = &timelineSubmitInfo;
+        signalSubmitInfo.signalSemaphoreCount = 1;
+        signalSubmitInfo.pSignalSemaphores = &m_stagingSemaphore;
+        if (m_deviceDispatch->QueueSubmit(queue, 1, &signalSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            // without the signal its regions can't be told apart from the ones of the next submission, so they're kept forever
+            Log::print<WARNING>("Failed to signal the staging buffer's timeline semaphore, it won't be reused");
+            m_stagingBufferFailed = true;
+            return;
+        }
+        m_stagingSubmitValue = signalValue;
+        m_unsubmittedStagingCmdBuffer = VK_NULL_HANDLE;
+    }
+
+    uint64_t completedValue = 0;
+    if (m_deviceDispatch->GetSemaphoreCounterValueKHR(m_device, m_stagingSemaphore, &completedValue) != VK_SUCCESS) {
+        return;
+    }
+    m_stagingRing.Retire(completedValue);
+
+    // uploads are rare (the help images are only uploaded once), so the buffer isn't kept mapped in between
+    if (m_stagingRing.GetRegionCount() == 0 && m_unsubmittedStagingCmdBuffer == VK_NULL_HANDLE) {
+        ReleaseStagingBuffer();
+    }
+}
+
+void RND_Vulkan::ReleaseStagingBuffer() {
+    if (m_stagingBuffer != VK_NULL_HANDLE) {
+        m_deviceDispatch->DestroyBuffer(m_device, m_stagingBuffer, nullptr);
+        m_stagingBuffer = VK_NULL_HANDLE;
+    }
+    if (m_stagingData != nullptr) {
+        m_deviceDispatch->UnmapMemory(m_device, m_stagingMemory);
+        m_stagingData = nullptr;
+    }
+    if (m_stagingMemory != VK_NULL_HANDLE) {
+        m_deviceDispatch->FreeMemory(m_device, m_stagingMemory, nullptr);
+        m_stagingMemory = VK_NULL_HANDLE;
+    }
 }
 
 uint32_t RND_Vulkan::FindMemoryType(uint32_t memoryTypeBitsRequirement, VkMemoryPropertyFlags requirementsMask) {
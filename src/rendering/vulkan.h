@@ -1,6 +1,8 @@
 #pragma once
 #include "openxr.h"
 #include "texture.h"
+#include "gpu_timer.h"
+#include "utils/staging_ring.h"
 
 
 class RND_Vulkan {
@@ -17,6 +19,21 @@ public:
     const vkroots::VkPhysicalDeviceDispatch* GetPhysicalDeviceDispatch() const { return m_physicalDeviceDispatch; }
     const vkroots::VkDeviceDispatch* GetDeviceDispatch() const { return m_deviceDispatch; }
 
+    VulkanGpuTimer& GetGpuTimer() { return *m_gpuTimer; }
+
+    struct StagingAllocation {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        void* data = nullptr;
+    };
+    // Suballocates an upload region from the mapped staging buffer that stays reserved until the GPU finished the submission
+    // of cmdBuffer. Returns nullopt when it doesn't fit or another command buffer that wasn't submitted yet holds regions, in
+    // which case the caller has to use its own staging buffer.
+    std::optional<StagingAllocation> AllocateStaging(VkCommandBuffer cmdBuffer, VkDeviceSize size);
+    // Called by QueueSubmit once the command buffers were submitted, retires the regions that the GPU is done with and frees
+    // the staging buffer when none are left
+    void OnQueueSubmitted(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits);
+
 private:
     VkInstance m_instance;
     VkPhysicalDevice m_physicalDevice;
@@ -27,4 +44,22 @@ private:
     const vkroots::VkInstanceDispatch* m_instanceDispatch;
     const vkroots::VkPhysicalDeviceDispatch* m_physicalDeviceDispatch;
     const vkroots::VkDeviceDispatch* m_deviceDispatch;
+
+    std::unique_ptr<VulkanGpuTimer> m_gpuTimer;
+
+    void ReleaseStagingBuffer();
+
+    static constexpr VkDeviceSize STAGING_BUFFER_SIZE = 16 * 1024 * 1024;
+    std::mutex m_stagingMutex;
+    StagingRing m_stagingRing = StagingRing(STAGING_BUFFER_SIZE);
+    VkDeviceSize m_stagingAlignment = 16;
+    VkBuffer m_stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory m_stagingMemory = VK_NULL_HANDLE;
+    void* m_stagingData = nullptr;
+    bool m_stagingBufferFailed = false;
+    // signaled with m_stagingSubmitValue after every submission of a command buffer that uses the staging buffer
+    VkSemaphore m_stagingSemaphore = VK_NULL_HANDLE;
+    uint64_t m_stagingSubmitValue = 0;
+    // the command buffer whose regions wait for it to be submitted, they're tagged with m_stagingSubmitValue + 1
+    VkCommandBuffer m_unsubmittedStagingCmdBuffer = VK_NULL_HANDLE;
 };
\ No newline at end of file
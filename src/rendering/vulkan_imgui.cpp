@@ -5,6 +5,8 @@
 #include "utils/debug_draw.h"
 #include "vulkan.h"
 #include "utils/mod_settings.h"
+#include "utils/alloc_tracker.h"
+#include "utils/frame_trace.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -163,7 +165,7 @@ RND_Renderer::ImGuiOverlay::ImGuiOverlay(VkCommandBuffer cb, VkExtent2D fbRes, V
     checkAssert(ImGui_ImplVulkan_Init(&init_info), "Failed to initialize ImGui");
 
     auto* renderer = VRManager::instance().XR->GetRenderer();
-    for (int i = 0; i < 2; ++i) {
+    for (uint32_t i = 0; i < renderer->GetFrameCount(); ++i) {
         renderer->GetFrame(i).imguiFramebuffer = std::make_unique<VulkanFramebuffer>(fbRes.width, fbRes.height, fbFormat, m_renderPass);
     }
 
@@ -189,7 +191,7 @@ RND_Renderer::ImGuiOverlay::ImGuiOverlay(VkCommandBuffer cb, VkExtent2D fbRes, V
     samplerInfo.maxLod = 1000.0f;
     checkVkResult(VRManager::instance().VK->GetDeviceDispatch()->CreateSampler(VRManager::instance().VK->GetDevice(), &samplerInfo, nullptr, &m_sampler), "Failed to create sampler for ImGui");
 
-    for (int i = 0; i < 2; ++i) {
+    for (uint32_t i = 0; i < renderer->GetFrameCount(); ++i) {
         auto& frame = renderer->GetFrame(i);
 
         frame.mainFramebuffer = std::make_unique<VulkanTexture>(fbRes.width, fbRes.height, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, true);
@@ -243,7 +245,7 @@ RND_Renderer::ImGuiOverlay::ImGuiOverlay(VkCommandBuffer cb, VkExtent2D fbRes, V
 
 RND_Renderer::ImGuiOverlay::~ImGuiOverlay() {
     auto* renderer = VRManager::instance().XR->GetRenderer();
-    for (int i = 0; i < 2; ++i) {
+    for (uint32_t i = 0; i < renderer->GetFrameCount(); ++i) {
         auto& frame = renderer->GetFrame(i);
         if (frame.mainFramebufferDS != VK_NULL_HANDLE)
             ImGui_ImplVulkan_RemoveTexture(frame.mainFramebufferDS);
@@ -284,10 +286,6 @@ RND_Renderer::ImGuiOverlay::~ImGuiOverlay() {
 void RND_Renderer::ImGuiOverlay::Update() {
     ImGui::GetIO().FontGlobalScale = 1.0f;
 
-    POINT p;
-    GetCursorPos(&p);
-    ScreenToClient(CemuHooks::m_cemuRenderWindow, &p);
-
     // calculate how many client side pixels are used on the border since its not a 16:9 aspect ratio
     RECT rect;
     GetClientRect(CemuHooks::m_cemuRenderWindow, &rect);
@@ -323,7 +321,19 @@ void RND_Renderer::ImGuiOverlay::Update() {
     // adjust the framebuffer scale
     ImGui::GetIO().DisplayFramebufferScale = framebufferRes / logicalRes;
 
+    // the cursor and keys are only polled while a window that takes input is open, which the flatscreen pass otherwise does every frame
+    // ImGui ignores events that don't change anything, so releasing the buttons every frame is free and keeps them from getting stuck
+    if (!OverlayVisibility::TakesMouseInput({ .menuOpen = VRManager::instance().XR->m_isMenuOpen, .debugOverlays = GetSettings().ShowDebugOverlay() })) {
+        ImGui::GetIO().AddMouseButtonEvent(0, false);
+        ImGui::GetIO().AddMouseButtonEvent(1, false);
+        ImGui::GetIO().AddMouseButtonEvent(2, false);
+        return;
+    }
+
     // the actual window is centered, so add offsets to both x and y on both sides
+    POINT p;
+    GetCursorPos(&p);
+    ScreenToClient(CemuHooks::m_cemuRenderWindow, &p);
     p.x = p.x - blackBarWidth;
     p.y = p.y - blackBarHeight;
 
@@ -345,6 +355,19 @@ void RND_Renderer::ImGuiOverlay::Update() {
     }
 }
 
+bool RND_Renderer::ImGuiOverlay::ShouldRenderHUDPass(long frameIdx) {
+    const OverlayVisibility::Decision decision = m_hudVisibility.Decide({
+        .menuOpen = VRManager::instance().XR->m_isMenuOpen,
+        .helpNotificationVisible = IsHelpNotificationVisible(),
+        .debugOverlays = GetSettings().ShowDebugOverlay(),
+        .performanceOverlay = GetSettings().performanceOverlay == PerformanceOverlayMode::WINDOW_AND_VR,
+        .gameImageComposited = CemuHooks::UseBlackBarsDuringEvents(),
+        .hudKeepsAlpha = VRManager::instance().XR->GetRenderer()->IsRendering3D(frameIdx),
+    });
+    FrameTrace::Counter("ImGui HUD passes skipped", (double)m_hudVisibility.GetDirectCopyFrames());
+    return decision == OverlayVisibility::Decision::RENDER;
+}
+
 constexpr ImGuiWindowFlags FULLSCREEN_WINDOW_FLAGS = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoBringToFrontOnFocus;
 
 void RND_Renderer::ImGuiOverlay::Render(long frameIdx, bool renderBackground) {
@@ -429,6 +452,12 @@ void RND_Renderer::ImGuiOverlay::Render(long frameIdx, bool renderBackground) {
     if (GetSettings().ShowDebugOverlay()) {
         VRManager::instance().Hooks->m_entityDebugger->DrawEntityInspector();
         VRManager::instance().Hooks->DrawDebugOverlays();
+#if ENABLE_HOOK_PROFILER
+        HookProfiler::DrawOverlay();
+#endif
+#if ENABLE_ALLOC_TRACKER
+        AllocTracker::DrawOverlay();
+#endif
     }
 
 
@@ -578,12 +607,20 @@ void RND_Renderer::ImGuiOverlay::ProcessInputs(OpenXR::InputState& inputs, const
     }
 }
 
+static float GetHelpNotificationTimeLimit() {
+    return GetSettings().tutorialPromptShown ? 14.0f : 60.0f;
+}
+
+bool RND_Renderer::ImGuiOverlay::IsHelpNotificationVisible() {
+    return !VRManager::instance().XR->m_isMenuOpen && ImGui::GetTime() < GetHelpNotificationTimeLimit();
+}
+
 void RND_Renderer::ImGuiOverlay::DrawHelpMenu() {
     auto& isMenuOpen = VRManager::instance().XR->m_isMenuOpen;
     auto& settings = GetSettings();
 
     float alphaForNotify = settings.tutorialPromptShown ? 0.9f : 0.98f;
-    float timeLimit = settings.tutorialPromptShown ? 14.0f : 60.0f;
+    float timeLimit = GetHelpNotificationTimeLimit();
 
     if (!settings.tutorialPromptShown) {
         if (isMenuOpen || ImGui::GetTime() > timeLimit) {
@@ -809,6 +846,10 @@ void RND_Renderer::ImGuiOverlay::DrawHelpMenu() {
                         DrawSettingRow("Stick Direction Threshold", [&]() {
                             settings.axisThreshold.AddToGUI(&changed, windowWidth.x, 0.1f, 0.9f);
                         });
+
+                        DrawSettingRow("Predict Hand Movement", [&]() {
+                            settings.predictHandPoses.AddToGUI(&changed);
+                        });
                     }
                     else {
                         ImGui::Text("");
@@ -819,10 +860,38 @@ void RND_Renderer::ImGuiOverlay::DrawHelpMenu() {
                             settings.cropFlatTo16x9.AddToGUI(&changed);
                         });
 
+                        DrawSettingRow("Lower Resolution When The GPU Falls Behind", [&]() {
+                            settings.dynamicResolution.AddToGUI(&changed);
+                        });
+
+                        DrawSettingRow("Render One Eye Per Frame While Head Is Still", [&]() {
+                            settings.alternateEyeRendering.AddToGUI(&changed);
+                        });
+
+                        DrawSettingRow("Update HUD Every Nth Frame", [&]() {
+                            settings.hudUpdateDivider.AddToGUI(&changed, windowWidth.x, 1, 4, [](float value) { return (int)value == 1 ? std::string("Every frame") : std::format("Every {} frames", (int)value); });
+                        });
+
+                        DrawSettingRow("Send Depth To Headset (Requires Restart)", [&]() {
+                            settings.depthSubmission.AddComboToGUI(&changed, ModSettings::toDisplayString);
+                        });
+
+                        DrawSettingRow("Run Headset Frames On", [&]() {
+                            settings.xrFramePacing.AddComboToGUI(&changed, ModSettings::toDisplayString);
+                        });
+
+                        DrawSettingRow("Frames In Flight (Requires Restart)", [&]() {
+                            settings.framesInFlight.AddToGUI(&changed, windowWidth.x, 2, 4, [](float value) { return std::format("{} frames", (int)value); });
+                        });
+
                         DrawSettingRow("Show Debugging Overlays (for developers)", [&]() {
                             settings.enableDebugOverlay.AddToGUI(&changed);
                         });
 
+                        DrawSettingRow("Log Categories (for developers)", [&]() {
+                            settings.logCategories.AddToGUI(&changed);
+                        });
+
                         if (VRManager::instance().XR->m_capabilities.isOculusLinkRuntime) {
                             DrawSettingRow("Angular Velocity Fixer", [&]() {
                                 settings.buggyAngularVelocity.AddComboToGUI(&changed, ModSettings::toDisplayString);
@@ -988,6 +1057,7 @@ void RND_Renderer::ImGuiOverlay::DrawAndCopyToImage(VkCommandBuffer cb, VkImage
     auto* renderer = VRManager::instance().XR->GetRenderer();
     auto& frame = renderer->GetFrame(frameIdx);
 
+    VulkanGpuTimer::Scope gpuScope(VRManager::instance().VK->GetGpuTimer(), cb, VulkanGpuTimer::Pass::IMGUI);
     frame.imguiFramebuffer->vkClear(cb, { 0.0f, 0.0f, 0.0f, 0.0f });
 
     // try to delete the staging buffer of the controller scheme textures if possible
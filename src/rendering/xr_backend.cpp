@@ -0,0 +1,437 @@
+#include "pch.h"
+#include "xr_backend.h"
+
+#include <fstream>
+#include <sstream>
+
+
+std::unique_ptr<XrBackend> CreateXrBackend() {
+    if (const char* timelinePath = std::getenv("BETTERVR_XR_TIMELINE"); timelinePath != nullptr && timelinePath[0] != '\0') {
+        Log::print<INFO>("Replaying OpenXR input and tracking from {}", timelinePath);
+        std::ifstream file(timelinePath);
+        checkAssert(file.is_open(), (std::string("Couldn't open OpenXR timeline file ") + timelinePath).c_str());
+        return std::make_unique<ScriptedXrBackend>(file, std::make_unique<RuntimeXrBackend>());
+    }
+    return std::make_unique<RuntimeXrBackend>();
+}
+
+// -----------------------------------------------------------------------
+// Timeline parsing
+// -----------------------------------------------------------------------
+
+ScriptedXrBackend::ScriptedXrBackend(std::istream& timeline, std::unique_ptr<XrBackend> runtime): m_runtime(std::move(runtime)) {
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(timeline, line)) {
+        lineNumber++;
+        if (size_t comment = line.find('#'); comment != std::string::npos) {
+            line.resize(comment);
+        }
+
+        std::istringstream stream(line);
+        std::string command;
+        if (!(stream >> command)) {
+            continue;
+        }
+
+        if (command == "frame") {
+            Frame& frame = m_frames.emplace_back();
+            if (!(stream >> frame.displayTime)) {
+                Log::print<WARNING>("OpenXR timeline line {}: frame is missing its display time", lineNumber);
+                frame.displayTime = m_frames.size() > 1 ? m_frames[m_frames.size() - 2].displayTime + m_displayPeriod : m_displayPeriod;
+            }
+            stream >> frame.displayPeriod;
+        }
+        else if (m_frames.empty()) {
+            m_preamble.emplace_back(lineNumber, line);
+        }
+        else {
+            m_frames.back().commands.emplace_back(lineNumber, line);
+        }
+    }
+
+    Log::print<INFO>("Loaded OpenXR timeline with {} frames", m_frames.size());
+    for (const auto& [commandLine, command] : m_preamble) {
+        ApplyCommand(command, commandLine);
+    }
+}
+
+static std::optional<XrSessionState> ParseSessionState(const std::string& name) {
+    static const std::unordered_map<std::string, XrSessionState> s_states = {
+        { "idle", XR_SESSION_STATE_IDLE },
+        { "ready", XR_SESSION_STATE_READY },
+        { "synchronized", XR_SESSION_STATE_SYNCHRONIZED },
+        { "visible", XR_SESSION_STATE_VISIBLE },
+        { "focused", XR_SESSION_STATE_FOCUSED },
+        { "stopping", XR_SESSION_STATE_STOPPING },
+        { "exiting", XR_SESSION_STATE_EXITING },
+        { "loss_pending", XR_SESSION_STATE_LOSS_PENDING },
+    };
+    if (auto it = s_states.find(name); it != s_states.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+void ScriptedXrBackend::ApplyCommand(const std::string& line, uint32_t lineNumber) {
+    std::istringstream stream(line);
+    std::string command;
+    stream >> command;
+
+    auto readPose = [&stream](XrPosef& pose) {
+        return (bool)(stream >> pose.position.x >> pose.position.y >> pose.position.z >> pose.orientation.x >> pose.orientation.y >> pose.orientation.z >> pose.orientation.w);
+    };
+
+    // optional hand argument, actions without one apply to both hands
+    auto readHands = [&stream]() -> std::pair<uint8_t, uint8_t> {
+        auto position = stream.tellg();
+        std::string hand;
+        stream >> hand;
+        if (hand == "left") return { 0, 1 };
+        if (hand == "right") return { 1, 2 };
+        stream.clear();
+        stream.seekg(position);
+        return { 0, 2 };
+    };
+
+    auto setAction = [this](const std::string& name, std::pair<uint8_t, uint8_t> hands, XrVector2f value) {
+        ActionValue& action = m_actions[name];
+        for (uint8_t i = hands.first; i < hands.second; i++) {
+            action.value[i] = value;
+        }
+    };
+
+    bool valid = true;
+    if (command == "ipd") {
+        valid = (bool)(stream >> m_ipd);
+    }
+    else if (command == "fov") {
+        valid = (bool)(stream >> m_fov.angleLeft >> m_fov.angleRight >> m_fov.angleUp >> m_fov.angleDown);
+    }
+    else if (command == "state") {
+        std::string stateName;
+        stream >> stateName;
+        std::optional<XrSessionState> state = ParseSessionState(stateName);
+        valid = state.has_value();
+        if (valid) {
+            m_pendingStates.push(state.value());
+        }
+    }
+    else if (command == "head") {
+        valid = readPose(m_head.pose);
+        m_head.valid = valid;
+    }
+    else if (command == "hand") {
+        std::string side;
+        stream >> side;
+        valid = side == "left" || side == "right";
+        if (valid) {
+            TrackedPose& hand = m_hands[side == "left" ? 0 : 1];
+            auto position = stream.tellg();
+            std::string lost;
+            if (stream >> lost && lost == "lost") {
+                hand.valid = false;
+                hand.hasVelocity = false;
+            }
+            else {
+                stream.clear();
+                stream.seekg(position);
+                valid = readPose(hand.pose);
+                hand.valid = valid;
+                hand.hasVelocity = (bool)(stream >> hand.linearVelocity.x >> hand.linearVelocity.y >> hand.linearVelocity.z >> hand.angularVelocity.x >> hand.angularVelocity.y >> hand.angularVelocity.z);
+            }
+        }
+    }
+    else if (command == "bool" || command == "float") {
+        std::string name;
+        float value = 0.0f;
+        stream >> name;
+        auto hands = readHands();
+        valid = (bool)(stream >> value);
+        if (valid) {
+            setAction(name, hands, { value, 0.0f });
+        }
+    }
+    else if (command == "vec2") {
+        std::string name;
+        XrVector2f value = {};
+        stream >> name;
+        auto hands = readHands();
+        valid = (bool)(stream >> value.x >> value.y);
+        if (valid) {
+            setAction(name, hands, value);
+        }
+    }
+    else {
+        valid = false;
+    }
+
+    if (!valid) {
+        Log::print<WARNING>("OpenXR timeline line {}: couldn't parse \"{}\"", lineNumber, line);
+    }
+}
+
+// -----------------------------------------------------------------------
+// Session and frame loop
+// -----------------------------------------------------------------------
+
+XrResult ScriptedXrBackend::CreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) {
+    XrResult result = m_runtime->CreateSession(instance, createInfo, session);
+    if (XR_SUCCEEDED(result)) {
+        m_session = *session;
+    }
+    return result;
+}
+
+XrResult ScriptedXrBackend::WaitFrame(XrSession session, const XrFrameWaitInfo* waitInfo, XrFrameState* frameState) {
+    // still throttle on the runtime so that the submitted frames line up with its compositor
+    XrResult result = m_runtime->WaitFrame(session, waitInfo, frameState);
+    if (XR_FAILED(result)) {
+        return result;
+    }
+    m_runtimeDisplayTime = frameState->predictedDisplayTime;
+
+    if (m_nextFrame < m_frames.size()) {
+        const Frame& frame = m_frames[m_nextFrame++];
+        if (frame.displayPeriod > 0) {
+            m_displayPeriod = frame.displayPeriod;
+        }
+        m_displayTime = frame.displayTime;
+        for (const auto& [lineNumber, command] : frame.commands) {
+            ApplyCommand(command, lineNumber);
+        }
+    }
+    else {
+        // the timeline ran out, keep the last values and let time continue
+        m_displayTime += m_displayPeriod;
+    }
+
+    frameState->predictedDisplayTime = m_displayTime;
+    frameState->predictedDisplayPeriod = m_displayPeriod;
+    return result;
+}
+
+XrResult ScriptedXrBackend::EndFrame(XrSession session, const XrFrameEndInfo* endInfo) {
+    // the runtime only accepts the display time it predicted itself
+    XrFrameEndInfo runtimeEndInfo = *endInfo;
+    runtimeEndInfo.displayTime = m_runtimeDisplayTime;
+    return m_runtime->EndFrame(session, &runtimeEndInfo);
+}
+
+XrResult ScriptedXrBackend::PollEvent(XrInstance instance, XrEventDataBuffer* eventData) {
+    if (XrResult result = m_runtime->PollEvent(instance, eventData); result != XR_EVENT_UNAVAILABLE) {
+        return result;
+    }
+    if (m_pendingStates.empty()) {
+        return XR_EVENT_UNAVAILABLE;
+    }
+
+    XrEventDataSessionStateChanged* stateChanged = (XrEventDataSessionStateChanged*)eventData;
+    *stateChanged = { XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED, nullptr, m_session, m_pendingStates.front(), m_displayTime };
+    m_pendingStates.pop();
+    return XR_SUCCESS;
+}
+
+// -----------------------------------------------------------------------
+// Actions
+// -----------------------------------------------------------------------
+
+void ScriptedXrBackend::NameSpace(XrSpace space, const char* name) {
+    const std::string_view spaceName = name;
+    if (spaceName == "stage") m_spaces[space] = TrackedSpace::STAGE;
+    else if (spaceName == "head") m_spaces[space] = TrackedSpace::HEAD;
+    else if (spaceName == "left") m_spaces[space] = TrackedSpace::LEFT_HAND;
+    else if (spaceName == "right") m_spaces[space] = TrackedSpace::RIGHT_HAND;
+    else m_spaces[space] = TrackedSpace::UNKNOWN;
+}
+
+void ScriptedXrBackend::NamePath(XrPath path, const char* name) {
+    const std::string_view pathName = name;
+    if (pathName == "left") m_handPaths[0] = path;
+    else if (pathName == "right") m_handPaths[1] = path;
+}
+
+ScriptedXrBackend::ActionValue* ScriptedXrBackend::FindAction(XrAction action) {
+    auto nameIt = m_actionNames.find(action);
+    if (nameIt == m_actionNames.end()) {
+        return nullptr;
+    }
+    auto actionIt = m_actions.find(nameIt->second);
+    return actionIt != m_actions.end() ? &actionIt->second : nullptr;
+}
+
+std::optional<uint8_t> ScriptedXrBackend::GetSubactionIndex(XrPath path) const {
+    if (path != XR_NULL_PATH && path == m_handPaths[0]) return 0;
+    if (path != XR_NULL_PATH && path == m_handPaths[1]) return 1;
+    return std::nullopt;
+}
+
+XrResult ScriptedXrBackend::SyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) {
+    for (auto& [name, action] : m_actions) {
+        for (uint8_t i = 0; i < 2; i++) {
+            action.changed[i] = action.synced[i].x != action.value[i].x || action.synced[i].y != action.value[i].y;
+            if (action.changed[i]) {
+                action.lastChangeTime[i] = m_displayTime;
+            }
+            action.synced[i] = action.value[i];
+        }
+    }
+    return XR_SUCCESS;
+}
+
+XrResult ScriptedXrBackend::GetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateBoolean* state) {
+    const ActionValue* action = FindAction(getInfo->action);
+    state->isActive = XR_TRUE;
+    state->currentState = XR_FALSE;
+    state->changedSinceLastSync = XR_FALSE;
+    state->lastChangeTime = 0;
+    if (action == nullptr) {
+        return XR_SUCCESS;
+    }
+
+    // without a subaction path the runtime combines both hands, with any pressed hand winning
+    std::optional<uint8_t> hand = GetSubactionIndex(getInfo->subactionPath);
+    for (uint8_t i = hand.value_or(0); i < (hand.has_value() ? hand.value() + 1 : 2); i++) {
+        if (action->synced[i].x != 0.0f) {
+            state->currentState = XR_TRUE;
+        }
+        state->changedSinceLastSync |= action->changed[i] ? XR_TRUE : XR_FALSE;
+        state->lastChangeTime = std::max(state->lastChangeTime, action->lastChangeTime[i]);
+    }
+    return XR_SUCCESS;
+}
+
+XrResult ScriptedXrBackend::GetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state) {
+    const ActionValue* action = FindAction(getInfo->action);
+    state->isActive = XR_TRUE;
+    state->currentState = 0.0f;
+    state->changedSinceLastSync = XR_FALSE;
+    state->lastChangeTime = 0;
+    if (action == nullptr) {
+        return XR_SUCCESS;
+    }
+
+    std::optional<uint8_t> hand = GetSubactionIndex(getInfo->subactionPath);
+    for (uint8_t i = hand.value_or(0); i < (hand.has_value() ? hand.value() + 1 : 2); i++) {
+        if (std::abs(action->synced[i].x) > std::abs(state->currentState)) {
+            state->currentState = action->synced[i].x;
+        }
+        state->changedSinceLastSync |= action->changed[i] ? XR_TRUE : XR_FALSE;
+        state->lastChangeTime = std::max(state->lastChangeTime, action->lastChangeTime[i]);
+    }
+    return XR_SUCCESS;
+}
+
+XrResult ScriptedXrBackend::GetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) {
+    const ActionValue* action = FindAction(getInfo->action);
+    state->isActive = XR_TRUE;
+    state->currentState = { 0.0f, 0.0f };
+    state->changedSinceLastSync = XR_FALSE;
+    state->lastChangeTime = 0;
+    if (action == nullptr) {
+        return XR_SUCCESS;
+    }
+
+    // the longest vector wins, same as how runtimes usually combine thumbsticks
+    std::optional<uint8_t> hand = GetSubactionIndex(getInfo->subactionPath);
+    for (uint8_t i = hand.value_or(0); i < (hand.has_value() ? hand.value() + 1 : 2); i++) {
+        if (glm::length(ToGLM(action->synced[i])) > glm::length(ToGLM(state->currentState))) {
+            state->currentState = action->synced[i];
+        }
+        state->changedSinceLastSync |= action->changed[i] ? XR_TRUE : XR_FALSE;
+        state->lastChangeTime = std::max(state->lastChangeTime, action->lastChangeTime[i]);
+    }
+    return XR_SUCCESS;
+}
+
+XrResult ScriptedXrBackend::GetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state) {
+    std::optional<uint8_t> hand = GetSubactionIndex(getInfo->subactionPath);
+    state->isActive = hand.has_value() ? (m_hands[hand.value()].valid ? XR_TRUE : XR_FALSE) : ((m_hands[0].valid || m_hands[1].valid) ? XR_TRUE : XR_FALSE);
+    return XR_SUCCESS;
+}
+
+// -----------------------------------------------------------------------
+// Tracking
+// -----------------------------------------------------------------------
+
+ScriptedXrBackend::TrackedSpace ScriptedXrBackend::GetTrackedSpace(XrSpace space) const {
+    auto it = m_spaces.find(space);
+    return it != m_spaces.end() ? it->second : TrackedSpace::UNKNOWN;
+}
+
+ScriptedXrBackend::TrackedPose ScriptedXrBackend::GetPoseInStage(TrackedSpace space) const {
+    switch (space) {
+        case TrackedSpace::STAGE:
+            return { .valid = true };
+        case TrackedSpace::HEAD:
+            return m_head;
+        case TrackedSpace::LEFT_HAND:
+            return m_hands[0];
+        case TrackedSpace::RIGHT_HAND:
+            return m_hands[1];
+        default:
+            return {};
+    }
+}
+
+XrResult ScriptedXrBackend::LocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
+    const TrackedPose target = GetPoseInStage(GetTrackedSpace(space));
+    const TrackedPose base = GetPoseInStage(GetTrackedSpace(baseSpace));
+
+    XrSpaceVelocity* velocity = nullptr;
+    for (XrBaseOutStructure* next = (XrBaseOutStructure*)location->next; next != nullptr; next = next->next) {
+        if (next->type == XR_TYPE_SPACE_VELOCITY) {
+            velocity = (XrSpaceVelocity*)next;
+        }
+    }
+
+    location->locationFlags = 0;
+    if (velocity) {
+        velocity->velocityFlags = 0;
+    }
+    if (!target.valid || !base.valid) {
+        return XR_SUCCESS;
+    }
+
+    // timeline poses are all relative to the stage
+    const glm::fquat baseRotationInv = glm::inverse(ToGLM(base.pose.orientation));
+    location->pose.orientation = ToXR(baseRotationInv * ToGLM(target.pose.orientation));
+    location->pose.position = ToXR(baseRotationInv * (ToGLM(target.pose.position) - ToGLM(base.pose.position)));
+    location->locationFlags = XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
+
+    if (velocity && target.hasVelocity) {
+        velocity->linearVelocity = ToXR(baseRotationInv * ToGLM(target.linearVelocity));
+        velocity->angularVelocity = ToXR(baseRotationInv * ToGLM(target.angularVelocity));
+        velocity->velocityFlags = XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+    }
+    return XR_SUCCESS;
+}
+
+XrResult ScriptedXrBackend::LocateViews(XrSession session, const XrViewLocateInfo* locateInfo, XrViewState* viewState, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrView* views) {
+    *viewCountOutput = 2;
+    if (viewCapacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (viewCapacityInput < 2) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+
+    XrSpaceLocation headLocation = { XR_TYPE_SPACE_LOCATION, nullptr, 0, {} };
+    XrSpace headSpace = XR_NULL_HANDLE;
+    for (const auto& [space, trackedSpace] : m_spaces) {
+        if (trackedSpace == TrackedSpace::HEAD) {
+            headSpace = space;
+        }
+    }
+    LocateSpace(headSpace, locateInfo->space, locateInfo->displayTime, &headLocation);
+
+    viewState->viewStateFlags = headLocation.locationFlags & (XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_TRACKED_BIT | XR_VIEW_STATE_ORIENTATION_TRACKED_BIT);
+    const glm::fquat headRotation = ToGLM(headLocation.pose.orientation);
+    for (uint32_t i = 0; i < 2; i++) {
+        const float eyeOffset = (i == 0 ? -0.5f : 0.5f) * m_ipd;
+        views[i].pose.orientation = headLocation.pose.orientation;
+        views[i].pose.position = ToXR(ToGLM(headLocation.pose.position) + headRotation * glm::fvec3(eyeOffset, 0.0f, 0.0f));
+        views[i].fov = m_fov;
+    }
+    return XR_SUCCESS;
+}
@@ -0,0 +1,185 @@
+#pragma once
+#include "pch.h"
+
+#include <istream>
+#include <unordered_map>
+
+
+// Thin layer over the OpenXR calls that the mod makes every frame (input, tracking, events, haptics and the frame loop)
+// plus the session lifecycle, which is enough to drive the whole frame loop from a fake backend in the tests.
+// Instance/system setup, action/space creation and swapchains still talk to the loader directly.
+class XrBackend {
+public:
+    virtual ~XrBackend() = default;
+
+    virtual const char* GetName() const = 0;
+
+    // session lifecycle
+    virtual XrResult CreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) = 0;
+    virtual XrResult BeginSession(XrSession session, const XrSessionBeginInfo* beginInfo) = 0;
+    virtual XrResult EndSession(XrSession session) = 0;
+    virtual XrResult RequestExitSession(XrSession session) = 0;
+
+    // frame loop
+    virtual XrResult WaitFrame(XrSession session, const XrFrameWaitInfo* waitInfo, XrFrameState* frameState) = 0;
+    virtual XrResult BeginFrame(XrSession session, const XrFrameBeginInfo* beginInfo) = 0;
+    virtual XrResult EndFrame(XrSession session, const XrFrameEndInfo* endInfo) = 0;
+
+    // input and tracking
+    virtual XrResult SyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) = 0;
+    virtual XrResult GetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateBoolean* state) = 0;
+    virtual XrResult GetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state) = 0;
+    virtual XrResult GetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) = 0;
+    virtual XrResult GetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state) = 0;
+    virtual XrResult LocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) = 0;
+    virtual XrResult LocateViews(XrSession session, const XrViewLocateInfo* locateInfo, XrViewState* viewState, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrView* views) = 0;
+    virtual XrResult PollEvent(XrInstance instance, XrEventDataBuffer* eventData) = 0;
+
+    // haptics
+    virtual XrResult ApplyHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo, const XrHapticBaseHeader* hapticFeedback) = 0;
+    virtual XrResult StopHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo) = 0;
+
+    // Called when handles are created so that backends that don't query the runtime can map them back to the names used in a timeline
+    virtual void NameAction(XrAction action, const char* name) {}
+    virtual void NameSpace(XrSpace space, const char* name) {}
+    virtual void NamePath(XrPath path, const char* name) {}
+};
+
+// Forwards everything to the OpenXR loader
+class RuntimeXrBackend final : public XrBackend {
+public:
+    const char* GetName() const override { return "Runtime"; }
+
+    XrResult CreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) override { return xrCreateSession(instance, createInfo, session); }
+    XrResult BeginSession(XrSession session, const XrSessionBeginInfo* beginInfo) override { return xrBeginSession(session, beginInfo); }
+    XrResult EndSession(XrSession session) override { return xrEndSession(session); }
+    XrResult RequestExitSession(XrSession session) override { return xrRequestExitSession(session); }
+
+    XrResult WaitFrame(XrSession session, const XrFrameWaitInfo* waitInfo, XrFrameState* frameState) override { return xrWaitFrame(session, waitInfo, frameState); }
+    XrResult BeginFrame(XrSession session, const XrFrameBeginInfo* beginInfo) override { return xrBeginFrame(session, beginInfo); }
+    XrResult EndFrame(XrSession session, const XrFrameEndInfo* endInfo) override { return xrEndFrame(session, endInfo); }
+
+    XrResult SyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) override { return xrSyncActions(session, syncInfo); }
+    XrResult GetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateBoolean* state) override { return xrGetActionStateBoolean(session, getInfo, state); }
+    XrResult GetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state) override { return xrGetActionStateFloat(session, getInfo, state); }
+    XrResult GetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) override { return xrGetActionStateVector2f(session, getInfo, state); }
+    XrResult GetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state) override { return xrGetActionStatePose(session, getInfo, state); }
+    XrResult LocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) override { return xrLocateSpace(space, baseSpace, time, location); }
+    XrResult LocateViews(XrSession session, const XrViewLocateInfo* locateInfo, XrViewState* viewState, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrView* views) override { return xrLocateViews(session, locateInfo, viewState, viewCapacityInput, viewCountOutput, views); }
+    XrResult PollEvent(XrInstance instance, XrEventDataBuffer* eventData) override { return xrPollEvent(instance, eventData); }
+
+    XrResult ApplyHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo, const XrHapticBaseHeader* hapticFeedback) override { return xrApplyHapticFeedback(session, hapticActionInfo, hapticFeedback); }
+    XrResult StopHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo) override { return xrStopHapticFeedback(session, hapticActionInfo); }
+};
+
+// Replays a timeline file instead of asking the runtime for input, tracking and predicted display times.
+// The session, frame pacing, frame submission and the runtime's own events still go to the backend it wraps, which is the
+// real runtime in the mod so that the swapchains keep working, and a fake one in the tests. Nothing the game logic sees
+// depends on the headset anymore, which makes input and frame-loop issues reproducible with any runtime (or none at all).
+// Session state changes from the timeline get delivered in addition to the runtime's.
+//
+// Timeline format, one command per line, '#' starts a comment. Values stick until they get changed:
+//   ipd <meters>                                        (before the first frame)
+//   fov <left> <right> <up> <down>                      (radians, before the first frame)
+//   state <idle|ready|synchronized|visible|focused|stopping|exiting|loss_pending>
+//   frame <predictedDisplayTimeNs> [periodNs]           (starts the next frame, everything below applies from then on)
+//   head <px> <py> <pz> <qx> <qy> <qz> <qw>
+//   hand <left|right> <px> <py> <pz> <qx> <qy> <qz> <qw> [<lvx> <lvy> <lvz> <avx> <avy> <avz>]
+//   hand <left|right> lost
+//   bool <action> [left|right] <0|1>
+//   float <action> [left|right] <value>
+//   vec2 <action> [left|right] <x> <y>
+// Actions are referenced by the name they were created with in OpenXR::CreateActions, without a hand they apply to both.
+class ScriptedXrBackend final : public XrBackend {
+public:
+    ScriptedXrBackend(std::istream& timeline, std::unique_ptr<XrBackend> runtime);
+
+    const char* GetName() const override { return "Scripted"; }
+
+    XrResult CreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) override;
+    XrResult BeginSession(XrSession session, const XrSessionBeginInfo* beginInfo) override { return m_runtime->BeginSession(session, beginInfo); }
+    XrResult EndSession(XrSession session) override { return m_runtime->EndSession(session); }
+    XrResult RequestExitSession(XrSession session) override { return m_runtime->RequestExitSession(session); }
+
+    XrResult WaitFrame(XrSession session, const XrFrameWaitInfo* waitInfo, XrFrameState* frameState) override;
+    XrResult BeginFrame(XrSession session, const XrFrameBeginInfo* beginInfo) override { return m_runtime->BeginFrame(session, beginInfo); }
+    XrResult EndFrame(XrSession session, const XrFrameEndInfo* endInfo) override;
+
+    XrResult SyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) override;
+    XrResult GetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateBoolean* state) override;
+    XrResult GetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state) override;
+    XrResult GetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) override;
+    XrResult GetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state) override;
+    XrResult LocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) override;
+    XrResult LocateViews(XrSession session, const XrViewLocateInfo* locateInfo, XrViewState* viewState, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrView* views) override;
+    XrResult PollEvent(XrInstance instance, XrEventDataBuffer* eventData) override;
+
+    XrResult ApplyHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo, const XrHapticBaseHeader* hapticFeedback) override { return XR_SUCCESS; }
+    XrResult StopHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo) override { return XR_SUCCESS; }
+
+    void NameAction(XrAction action, const char* name) override { m_actionNames[action] = name; }
+    void NameSpace(XrSpace space, const char* name) override;
+    void NamePath(XrPath path, const char* name) override;
+
+private:
+    enum class TrackedSpace : uint8_t {
+        STAGE,
+        HEAD,
+        LEFT_HAND,
+        RIGHT_HAND,
+        UNKNOWN
+    };
+
+    struct TrackedPose {
+        bool valid = false;
+        bool hasVelocity = false;
+        XrPosef pose = { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } };
+        XrVector3f linearVelocity = {};
+        XrVector3f angularVelocity = {};
+    };
+
+    // one value per hand, actions queried without a subaction path see the combination of both
+    struct ActionValue {
+        std::array<XrVector2f, 2> value = {};
+        std::array<XrVector2f, 2> synced = {};
+        std::array<bool, 2> changed = {};
+        std::array<XrTime, 2> lastChangeTime = {};
+    };
+
+    struct Frame {
+        XrTime displayTime = 0;
+        XrDuration displayPeriod = 0;
+        std::vector<std::pair<uint32_t, std::string>> commands;
+    };
+
+    void ApplyCommand(const std::string& line, uint32_t lineNumber);
+    ActionValue* FindAction(XrAction action);
+    std::optional<uint8_t> GetSubactionIndex(XrPath path) const;
+    TrackedSpace GetTrackedSpace(XrSpace space) const;
+    TrackedPose GetPoseInStage(TrackedSpace space) const;
+
+    std::unique_ptr<XrBackend> m_runtime;
+
+    std::vector<std::pair<uint32_t, std::string>> m_preamble;
+    std::vector<Frame> m_frames;
+    size_t m_nextFrame = 0;
+    XrTime m_displayTime = 0;
+    XrDuration m_displayPeriod = 11'111'111;
+    XrTime m_runtimeDisplayTime = 0;
+
+    XrSession m_session = XR_NULL_HANDLE;
+    std::queue<XrSessionState> m_pendingStates;
+
+    float m_ipd = 0.064f;
+    XrFovf m_fov = { -0.8f, 0.8f, 0.8f, -0.8f };
+    TrackedPose m_head;
+    std::array<TrackedPose, 2> m_hands;
+
+    std::unordered_map<XrAction, std::string> m_actionNames;
+    std::unordered_map<std::string, ActionValue> m_actions;
+    std::unordered_map<XrSpace, TrackedSpace> m_spaces;
+    std::array<XrPath, 2> m_handPaths = { XR_NULL_PATH, XR_NULL_PATH };
+};
+
+// Uses the scripted backend when BETTERVR_XR_TIMELINE points to a timeline file, otherwise the runtime
+std::unique_ptr<XrBackend> CreateXrBackend();
@@ -69,6 +69,7 @@ cbuffer g_settings : register(b1) {
     float renderHeight;
     float swapchainWidth;
     float swapchainHeight;
+    float premultiplyAlpha;
 };
 
 Texture2D g_colorTexture : register(t0);
@@ -89,6 +90,10 @@ PSOutput PSMain(PSInput input) {
 	float2 samplePosition = input.uv;
 
     float4 colorTexture = g_colorTexture.Sample(g_sampler, samplePosition);
+    // the runtime expects premultiplied colors, which the ImGui pass already outputs but a directly copied HUD doesn't
+    if (premultiplyAlpha != 0.0f) {
+        colorTexture.rgb *= colorTexture.a;
+    }
 
     PSOutput output;
 	//output.Color = float4(0.0f, 0.0f, 0.0f, 0.0f);
@@ -103,6 +108,7 @@ struct presentSettings {
     float renderHeight;
     float swapchainWidth;
     float swapchainHeight;
+    float premultiplyAlpha; // only read by the color-only present shader
     //    float eyeSeparation;
     //    float showWholeScreen;  // this mode could be used to show each display a part of the screen
     //    float showSingleScreen; // this mode shows the same picture in each eye
@@ -0,0 +1,42 @@
+#pragma once
+#include "pch.h"
+
+
+// Decides whether a stage of the input hook has to be re-evaluated, for stages that only depend on a few actions and on some
+// state of their own (the key). OpenXR only reports whether an action changed since the previous sync, so those bits can only
+// be trusted for the sync right after the one the stage last ran for. The hook can run several times per sync or miss syncs,
+// and writing the input state back can race with the next sync, so a gap in the sync indices always re-evaluates the stage.
+// The hook also writes its own changes to the actions back (e.g. the deadzone, or zeroing the sticks while the menu is open),
+// so after the key changed mid-sync the next sync is re-evaluated as well, since the values it saw weren't the runtime's.
+template <typename Key>
+class ActionChangeGate {
+public:
+    bool ShouldRun(uint32_t syncIndex, uint32_t changedActions, uint32_t actions, const Key& key) {
+        bool run;
+        if (!m_key.has_value() || !(*m_key == key)) {
+            run = true;
+            m_keyChangeSyncIndex = syncIndex;
+        }
+        else if (syncIndex == m_syncIndex) {
+            run = false;
+        }
+        else {
+            run = syncIndex != m_syncIndex + 1 || m_syncIndex == m_keyChangeSyncIndex || (changedActions & actions) != 0;
+        }
+        m_key = key;
+        m_syncIndex = syncIndex;
+        if (!run) {
+            m_skipCount++;
+        }
+        return run;
+    }
+
+    void Reset() { m_key.reset(); }
+    uint64_t GetSkipCount() const { return m_skipCount; }
+
+private:
+    std::optional<Key> m_key;
+    uint32_t m_syncIndex = 0;
+    uint32_t m_keyChangeSyncIndex = 0;
+    uint64_t m_skipCount = 0;
+};
@@ -0,0 +1,295 @@
+#include "pch.h"
+#include "alloc_tracker.h"
+#include "hook_profiler.h"
+
+#include <charconv>
+#include <malloc.h>
+
+// -----------------------------------------------------------------------
+// Budget list
+// -----------------------------------------------------------------------
+
+uint64_t AllocTracker::FindBudget(std::string_view budgets, std::string_view scopeName) {
+    std::string_view remaining = budgets;
+    while (!remaining.empty()) {
+        const size_t separator = remaining.find(';');
+        const std::string_view entry = remaining.substr(0, separator);
+        remaining = separator == std::string_view::npos ? std::string_view() : remaining.substr(separator + 1);
+
+        const size_t equals = entry.find('=');
+        if (equals != std::string_view::npos && entry.substr(0, equals) == scopeName) {
+            uint64_t budget = NO_BUDGET;
+            std::from_chars(entry.data() + equals + 1, entry.data() + entry.size(), budget);
+            return budget;
+        }
+    }
+    return NO_BUDGET;
+}
+
+#if ENABLE_ALLOC_TRACKER
+
+// -----------------------------------------------------------------------
+// Scope registry
+// -----------------------------------------------------------------------
+
+// everything here is trivially destructible so that allocations made during static destruction can still be counted safely
+static std::mutex s_scopesMutex;
+static std::array<const char*, AllocTracker::MAX_SCOPES> s_scopeNames = { "(unscoped)" };
+static std::array<std::atomic_uint64_t, AllocTracker::MAX_SCOPES> s_scopeBudgets = {};
+static std::atomic_uint32_t s_scopeCount = 1;
+
+static uint64_t GetBudgetFromEnvironment(const char* name) {
+    const char* budgets = std::getenv("BETTERVR_ALLOC_BUDGETS");
+    return budgets == nullptr ? AllocTracker::NO_BUDGET : AllocTracker::FindBudget(budgets, name);
+}
+
+uint32_t AllocTracker::RegisterScope(const char* name, uint64_t budget) {
+    std::scoped_lock lock(s_scopesMutex);
+    const uint32_t count = s_scopeCount.load();
+    for (uint32_t i = 0; i < count; i++) {
+        if (strcmp(s_scopeNames[i], name) == 0) {
+            return i;
+        }
+    }
+
+    checkAssert(count < MAX_SCOPES, "Too many allocation scopes registered, increase AllocTracker::MAX_SCOPES!");
+    const uint64_t envBudget = GetBudgetFromEnvironment(name);
+    s_scopeNames[count] = name;
+    s_scopeBudgets[count].store(envBudget != NO_BUDGET ? envBudget : budget);
+    s_scopeCount.store(count + 1);
+    return count;
+}
+
+void AllocTracker::SetBudget(uint32_t scopeIndex, uint64_t budget) {
+    s_scopeBudgets[scopeIndex].store(budget);
+}
+
+// the unscoped bucket never has a budget
+static uint64_t GetBudget(uint32_t scopeIndex) {
+    return scopeIndex == 0 ? AllocTracker::NO_BUDGET : s_scopeBudgets[scopeIndex].load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------
+// Per-thread counting
+// -----------------------------------------------------------------------
+
+namespace {
+    struct AtomicCounts {
+        std::atomic_uint64_t allocations = 0;
+        std::atomic_uint64_t bytes = 0;
+
+        AllocTracker::Counts Load() const {
+            return { allocations.load(std::memory_order_relaxed), bytes.load(std::memory_order_relaxed) };
+        }
+        void Add(size_t size) {
+            // single writer, see ThreadCounters
+            allocations.store(allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            bytes.store(bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+        }
+    };
+
+    // Only written by the owning thread, EndFrame keeps what it merged last so that it can work with deltas
+    struct ThreadCounters {
+        uint32_t threadId = 0;
+        AtomicCounts total;
+        std::array<AtomicCounts, AllocTracker::MAX_SCOPES> scopes;
+
+        AllocTracker::Counts mergedTotal;
+        std::array<AllocTracker::Counts, AllocTracker::MAX_SCOPES> mergedScopes = {};
+        AllocTracker::Counts lastFrame;
+    };
+}
+
+static std::array<ThreadCounters*, AllocTracker::MAX_THREADS> s_threads = {};
+static std::atomic_uint32_t s_threadCount = 0;
+
+// set while the tracker itself is running so that its own bookkeeping doesn't recurse into operator new
+static thread_local bool t_isCounting = false;
+static thread_local ThreadCounters* t_counters = nullptr;
+
+static ThreadCounters* GetThreadCounters() {
+    if (t_counters == nullptr) {
+        const uint32_t index = s_threadCount.fetch_add(1);
+        if (index >= AllocTracker::MAX_THREADS) {
+            return nullptr;
+        }
+        // allocated with malloc since this runs from inside operator new, and intentionally never freed
+        ThreadCounters* counters = new (malloc(sizeof(ThreadCounters))) ThreadCounters();
+        counters->threadId = GetCurrentThreadId();
+        t_counters = counters;
+        std::atomic_ref(s_threads[index]).store(counters, std::memory_order_release);
+    }
+    return t_counters;
+}
+
+void AllocTracker::OnAllocation(size_t bytes) {
+    HookProfiler::OnAllocation();
+
+    if (t_isCounting) {
+        return;
+    }
+    t_isCounting = true;
+    if (ThreadCounters* counters = GetThreadCounters()) {
+        counters->total.Add(bytes);
+        counters->scopes[t_currentScope].Add(bytes);
+    }
+    t_isCounting = false;
+}
+
+// -----------------------------------------------------------------------
+// Per-frame merge and budgets
+// -----------------------------------------------------------------------
+
+static std::mutex s_statsMutex;
+static std::array<AllocTracker::Counts, AllocTracker::MAX_SCOPES> s_lastFrame = {};
+static std::array<uint64_t, AllocTracker::MAX_SCOPES> s_lastWarningFrame = {};
+static uint64_t s_frameCount = 0;
+
+// don't flood the log when a scope keeps exceeding its budget
+static constexpr uint64_t WARNING_INTERVAL_FRAMES = 600;
+
+void AllocTracker::EndFrame() {
+    const uint32_t scopeCount = s_scopeCount.load();
+    const uint32_t threadCount = std::min(s_threadCount.load(), MAX_THREADS);
+    std::array<Counts, MAX_SCOPES> frame = {};
+
+    std::unique_lock lock(s_statsMutex);
+    for (uint32_t t = 0; t < threadCount; t++) {
+        ThreadCounters* counters = std::atomic_ref(s_threads[t]).load(std::memory_order_acquire);
+        if (counters == nullptr) {
+            continue;
+        }
+
+        const Counts total = counters->total.Load();
+        counters->lastFrame = { total.allocations - counters->mergedTotal.allocations, total.bytes - counters->mergedTotal.bytes };
+        counters->mergedTotal = total;
+
+        for (uint32_t i = 0; i < scopeCount; i++) {
+            const Counts current = counters->scopes[i].Load();
+            Counts& merged = counters->mergedScopes[i];
+            frame[i] += Counts{ current.allocations - merged.allocations, current.bytes - merged.bytes };
+            merged = current;
+        }
+    }
+    s_lastFrame = frame;
+    s_frameCount++;
+
+    std::vector<uint32_t> overBudget;
+    for (uint32_t i = 0; i < scopeCount; i++) {
+        if (IsOverBudget(frame[i], GetBudget(i)) && (s_lastWarningFrame[i] == 0 || s_frameCount - s_lastWarningFrame[i] >= WARNING_INTERVAL_FRAMES)) {
+            s_lastWarningFrame[i] = s_frameCount;
+            overBudget.emplace_back(i);
+        }
+    }
+    lock.unlock();
+
+    for (uint32_t i : overBudget) {
+        Log::print<WARNING>("Allocation scope {} made {} allocations ({} bytes) in one frame, its budget is {}", s_scopeNames[i], frame[i].allocations, frame[i].bytes, GetBudget(i));
+    }
+}
+
+AllocTracker::Counts AllocTracker::GetFrameCounts(uint32_t scopeIndex) {
+    std::scoped_lock lock(s_statsMutex);
+    return s_lastFrame[scopeIndex];
+}
+
+AllocTracker::Snapshot AllocTracker::GetSnapshot() {
+    Snapshot snapshot;
+    snapshot.scopeCount = s_scopeCount.load();
+    for (uint32_t i = 0; i < snapshot.scopeCount; i++) {
+        snapshot.names[i] = s_scopeNames[i];
+        snapshot.budgets[i] = GetBudget(i);
+    }
+
+    const uint32_t threadCount = std::min(s_threadCount.load(), MAX_THREADS);
+    snapshot.threads.reserve(threadCount);
+    std::scoped_lock lock(s_statsMutex);
+    snapshot.lastFrame = s_lastFrame;
+    snapshot.lastWarningFrame = s_lastWarningFrame;
+    snapshot.frameCount = s_frameCount;
+    for (uint32_t t = 0; t < threadCount; t++) {
+        if (ThreadCounters* counters = std::atomic_ref(s_threads[t]).load(std::memory_order_acquire)) {
+            snapshot.threads.emplace_back(counters->threadId, counters->lastFrame);
+        }
+    }
+    return snapshot;
+}
+
+// -----------------------------------------------------------------------
+// Global allocator replacement
+// -----------------------------------------------------------------------
+
+// The CRT's array, nothrow and sized variants all forward to these, so replacing the scalar and aligned forms is enough.
+// Only allocations made by the layer DLL itself go through here, Cemu's own allocations use its own CRT.
+
+void* operator new(size_t size) {
+    AllocTracker::OnAllocation(size);
+    while (true) {
+        if (void* ptr = malloc(size == 0 ? 1 : size)) {
+            return ptr;
+        }
+        if (std::new_handler handler = std::get_new_handler()) {
+            handler();
+        }
+        else {
+            throw std::bad_alloc();
+        }
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+// the sized deletes forward on their own as well, they're only here since GCC insists on them when the unsized one is replaced
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    AllocTracker::OnAllocation(size);
+    while (true) {
+        if (void* ptr = _aligned_malloc(size == 0 ? 1 : size, (size_t)alignment)) {
+            return ptr;
+        }
+        if (std::new_handler handler = std::get_new_handler()) {
+            handler();
+        }
+        else {
+            throw std::bad_alloc();
+        }
+    }
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    _aligned_free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    _aligned_free(ptr);
+}
+
+#else
+
+uint32_t AllocTracker::RegisterScope(const char* name, uint64_t budget) {
+    return 0;
+}
+
+void AllocTracker::SetBudget(uint32_t scopeIndex, uint64_t budget) {
+}
+
+void AllocTracker::OnAllocation(size_t bytes) {
+}
+
+void AllocTracker::EndFrame() {
+}
+
+AllocTracker::Counts AllocTracker::GetFrameCounts(uint32_t scopeIndex) {
+    return {};
+}
+
+AllocTracker::Snapshot AllocTracker::GetSnapshot() {
+    return {};
+}
+
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+#include "pch.h"
+
+// Enabled through the BETTERVR_ENABLE_ALLOC_TRACKER CMake option, which also replaces the global operator new/delete
+#ifndef ENABLE_ALLOC_TRACKER
+#define ENABLE_ALLOC_TRACKER 0
+#endif
+
+
+// Counts the heap allocations made by this DLL per thread and per named scope.
+// Scopes are exclusive: an allocation is only blamed on the innermost scope, everything outside of a scope lands in "(unscoped)".
+// Budgets are the maximum number of allocations a scope may make per frame (summed over all threads) before a warning gets
+// logged, and can be set from code or with BETTERVR_ALLOC_BUDGETS="QueueSubmit=0;Layer2D::FinishRendering=4".
+class AllocTracker {
+public:
+    static constexpr uint32_t MAX_SCOPES = 64;
+    static constexpr uint32_t MAX_THREADS = 64;
+    static constexpr uint64_t NO_BUDGET = UINT64_MAX;
+
+    struct Counts {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+
+        Counts& operator+=(const Counts& other) {
+            allocations += other.allocations;
+            bytes += other.bytes;
+            return *this;
+        }
+    };
+
+    static uint32_t RegisterScope(const char* name, uint64_t budget = NO_BUDGET);
+    static void SetBudget(uint32_t scopeIndex, uint64_t budget);
+
+    class Scope {
+    public:
+        explicit Scope(uint32_t scopeIndex) {
+#if ENABLE_ALLOC_TRACKER
+            m_previous = t_currentScope;
+            t_currentScope = scopeIndex;
+#endif
+        }
+        ~Scope() {
+#if ENABLE_ALLOC_TRACKER
+            t_currentScope = m_previous;
+#endif
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        uint32_t m_previous = 0;
+    };
+
+    // Called by the replaced operator new for every allocation
+    static void OnAllocation(size_t bytes);
+
+    // Merges the per-thread counters into the last frame's totals and checks the budgets, once per game frame
+    static void EndFrame();
+    static void DrawOverlay();
+
+    // Last frame's counts of a scope over all threads, so that callers can assert that a scope stayed allocation-free
+    static Counts GetFrameCounts(uint32_t scopeIndex);
+
+    // Copy of everything the overlay shows, taken under the lock that EndFrame merges with
+    struct Snapshot {
+        uint32_t scopeCount = 0;
+        std::array<const char*, MAX_SCOPES> names = {};
+        std::array<uint64_t, MAX_SCOPES> budgets = {};
+        std::array<Counts, MAX_SCOPES> lastFrame = {};
+        std::array<uint64_t, MAX_SCOPES> lastWarningFrame = {}; // 0 until the scope went over its budget
+        std::vector<std::pair<uint32_t, Counts>> threads;       // thread id and what it allocated last frame
+        uint64_t frameCount = 0;
+    };
+    static Snapshot GetSnapshot();
+
+    static bool IsOverBudget(const Counts& frameCounts, uint64_t budget) { return budget != NO_BUDGET && frameCounts.allocations > budget; }
+    // Looks up a scope in a list like BETTERVR_ALLOC_BUDGETS, returns NO_BUDGET if it isn't in there
+    static uint64_t FindBudget(std::string_view budgets, std::string_view scopeName);
+
+private:
+    static inline thread_local uint32_t t_currentScope = 0;
+};
+
+#if ENABLE_ALLOC_TRACKER
+#define ALLOC_TRACKER_SCOPE(name) \
+    static const uint32_t s_allocTrackerScope = AllocTracker::RegisterScope(name); \
+    AllocTracker::Scope allocTrackerScope(s_allocTrackerScope)
+#else
+#define ALLOC_TRACKER_SCOPE(name)
+#endif
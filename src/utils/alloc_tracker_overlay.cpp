@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "alloc_tracker.h"
+
+#if ENABLE_ALLOC_TRACKER
+
+// -----------------------------------------------------------------------
+// Overlay
+// -----------------------------------------------------------------------
+
+void AllocTracker::DrawOverlay() {
+    if (!ImGui::Begin("Allocations")) {
+        ImGui::End();
+        return;
+    }
+
+    const Snapshot snapshot = GetSnapshot();
+
+    if (ImGui::BeginTable("##AllocScopes", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Allocs/frame");
+        ImGui::TableSetupColumn("Bytes/frame");
+        ImGui::TableSetupColumn("Budget");
+        ImGui::TableHeadersRow();
+
+        for (uint32_t i = 0; i < snapshot.scopeCount; i++) {
+            const uint64_t budget = snapshot.budgets[i];
+            const Counts& counts = snapshot.lastFrame[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(snapshot.names[i]);
+            ImGui::TableNextColumn();
+            if (IsOverBudget(counts, budget)) {
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%llu", counts.allocations);
+            }
+            else {
+                ImGui::Text("%llu", counts.allocations);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", counts.bytes);
+            ImGui::TableNextColumn();
+            if (budget == NO_BUDGET) {
+                ImGui::TextUnformatted("-");
+            }
+            else {
+                ImGui::Text("%llu", budget);
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::BeginTable("##AllocThreads", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Thread");
+        ImGui::TableSetupColumn("Allocs/frame");
+        ImGui::TableSetupColumn("Bytes/frame");
+        ImGui::TableHeadersRow();
+
+        for (const auto& [threadId, counts] : snapshot.threads) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", threadId);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", counts.allocations);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", counts.bytes);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+#else
+
+void AllocTracker::DrawOverlay() {
+}
+
+#endif
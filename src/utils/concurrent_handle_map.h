@@ -0,0 +1,306 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+
+
+// Open-addressing map from a (Vulkan) handle to a small trivially copyable value.
+// Lookups never take a lock: each slot is guarded by a sequence counter that writers bump to an odd value while they
+// modify it, so a reader that raced with a writer simply retries instead of returning a torn key/value pair.
+// Writers are serialized per shard, so inserts/erases of unrelated handles (e.g. Cemu's texture cache churning images
+// on another thread) don't contend with each other.
+// Handles that don't fit into their (full) shard spill into a mutex-guarded overflow map instead of failing, which is only
+// consulted while it holds any entries, so lookups stay lock-free as long as the shards are sized sensibly.
+template <typename Handle, typename Value, uint32_t ShardCount = 16, uint32_t SlotsPerShard = 256>
+class ConcurrentHandleMap {
+    static_assert(sizeof(Handle) <= sizeof(uint64_t), "Handle must fit into 64 bits");
+    static_assert(sizeof(Value) <= sizeof(uint64_t) && std::is_trivially_copyable_v<Value>, "Value must be trivially copyable and fit into 64 bits");
+    static_assert(std::has_single_bit(ShardCount) && std::has_single_bit(SlotsPerShard), "Shard and slot counts must be powers of two");
+
+public:
+    ConcurrentHandleMap() = default;
+    ConcurrentHandleMap(const ConcurrentHandleMap&) = delete;
+    ConcurrentHandleMap& operator=(const ConcurrentHandleMap&) = delete;
+
+    // Returns false if the handle was already present (or is one of the reserved key values)
+    bool Insert(Handle handle, const Value& value) {
+        const uint64_t key = ToKey(handle);
+        if (key == EMPTY_KEY || key == TOMBSTONE_KEY) {
+            return false;
+        }
+
+        const uint64_t hash = Hash(key);
+        Shard& shard = m_shards[hash & (ShardCount - 1)];
+        std::lock_guard lk(shard.writeMutex);
+
+        Slot* freeSlot = nullptr;
+        for (uint32_t i = 0; i < SlotsPerShard; i++) {
+            Slot& slot = shard.slots[((hash >> SHARD_BITS) + i) & (SlotsPerShard - 1)];
+            const uint64_t slotKey = slot.key.load(std::memory_order_relaxed);
+            if (slotKey == key) {
+                return false;
+            }
+            if (slotKey == TOMBSTONE_KEY && freeSlot == nullptr) {
+                freeSlot = &slot;
+            }
+            else if (slotKey == EMPTY_KEY) {
+                if (freeSlot == nullptr) {
+                    freeSlot = &slot;
+                }
+                break;
+            }
+        }
+
+        // a handle that spilled over earlier stays there, even if its shard got a free slot since then
+        if (freeSlot == nullptr || m_overflowSize.load(std::memory_order_acquire) != 0) {
+            std::lock_guard overflowLock(m_overflowMutex);
+            if (m_overflow.contains(key)) {
+                return false;
+            }
+            if (freeSlot == nullptr) {
+                m_overflow.emplace(key, Encode(value));
+                m_overflowSize.store(m_overflow.size(), std::memory_order_release);
+                return true;
+            }
+        }
+
+        if (freeSlot->key.load(std::memory_order_relaxed) == TOMBSTONE_KEY) {
+            shard.tombstones--;
+        }
+        WriteSlot(*freeSlot, key, Encode(value));
+        shard.size.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Removes the handle so that a future handle with the same value can never observe the old metadata
+    bool Erase(Handle handle) {
+        const uint64_t key = ToKey(handle);
+        const uint64_t hash = Hash(key);
+        Shard& shard = m_shards[hash & (ShardCount - 1)];
+        std::lock_guard lk(shard.writeMutex);
+
+        for (uint32_t i = 0; i < SlotsPerShard; i++) {
+            Slot& slot = shard.slots[((hash >> SHARD_BITS) + i) & (SlotsPerShard - 1)];
+            const uint64_t slotKey = slot.key.load(std::memory_order_relaxed);
+            if (slotKey == EMPTY_KEY) {
+                break;
+            }
+            if (slotKey == key) {
+                WriteSlot(slot, TOMBSTONE_KEY, 0);
+                shard.size.fetch_sub(1, std::memory_order_relaxed);
+                if (++shard.tombstones >= MAX_TOMBSTONES) {
+                    RebuildShard(shard);
+                }
+                return true;
+            }
+        }
+        return EraseOverflow(key);
+    }
+
+    std::optional<Value> Find(Handle handle) const {
+        const uint64_t key = ToKey(handle);
+        if (key == EMPTY_KEY || key == TOMBSTONE_KEY) {
+            return std::nullopt;
+        }
+
+        const uint64_t hash = Hash(key);
+        const Shard& shard = m_shards[hash & (ShardCount - 1)];
+
+        while (true) {
+            const uint32_t rebuildBefore = shard.rebuildSequence.load(std::memory_order_acquire);
+            if (rebuildBefore & 1) {
+                continue; // writer is rehashing this shard
+            }
+            const std::optional<uint64_t> rawValue = ProbeShard(shard, key, hash);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (shard.rebuildSequence.load(std::memory_order_relaxed) != rebuildBefore) {
+                continue; // the key might've been moved past where the probe looked
+            }
+            if (rawValue) {
+                return Decode(*rawValue);
+            }
+            return FindOverflow(key);
+        }
+    }
+
+    bool Contains(Handle handle) const {
+        return Find(handle).has_value();
+    }
+
+    size_t Size() const {
+        size_t total = 0;
+        for (const Shard& shard : m_shards) {
+            total += shard.size.load(std::memory_order_relaxed);
+        }
+        return total + m_overflowSize.load(std::memory_order_relaxed);
+    }
+
+    // Number of handles that didn't fit into their shard, should stay at zero unless the map is undersized
+    size_t OverflowSize() const {
+        return m_overflowSize.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint64_t EMPTY_KEY = 0;
+    static constexpr uint64_t TOMBSTONE_KEY = ~0ull;
+    static constexpr uint32_t SHARD_BITS = std::countr_zero(ShardCount);
+
+    struct Slot {
+        std::atomic_uint32_t sequence = 0;
+        std::atomic_uint64_t key = EMPTY_KEY;
+        std::atomic_uint64_t value = 0;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex writeMutex;
+        std::atomic_uint32_t size = 0;
+        std::atomic_uint32_t rebuildSequence = 0;
+        uint32_t tombstones = 0; // only accessed while holding writeMutex
+        std::array<Slot, SlotsPerShard> slots;
+    };
+
+    // Erasing leaves tombstones behind so that concurrent lookups keep probing past them. Churning images would slowly turn
+    // every empty slot into one, until each insert and each lookup of a missing handle has to scan the whole shard.
+    static constexpr uint32_t MAX_TOMBSTONES = SlotsPerShard / 4;
+
+    static uint64_t ToKey(Handle handle) {
+        if constexpr (std::is_pointer_v<Handle>) {
+            return (uint64_t)(uintptr_t)handle;
+        }
+        else {
+            return (uint64_t)handle;
+        }
+    }
+
+    // splitmix64 finalizer, since driver handles are usually aligned pointers or sequential ids
+    static uint64_t Hash(uint64_t key) {
+        key ^= key >> 30;
+        key *= 0xBF58476D1CE4E5B9ull;
+        key ^= key >> 27;
+        key *= 0x94D049BB133111EBull;
+        key ^= key >> 31;
+        return key;
+    }
+
+    static uint64_t Encode(const Value& value) {
+        uint64_t raw = 0;
+        memcpy(&raw, &value, sizeof(Value));
+        return raw;
+    }
+
+    static Value Decode(uint64_t raw) {
+        Value value;
+        memcpy(&value, &raw, sizeof(Value));
+        return value;
+    }
+
+    static void WriteSlot(Slot& slot, uint64_t key, uint64_t value) {
+        const uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.key.store(key, std::memory_order_relaxed);
+        slot.sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    static std::optional<uint64_t> ProbeShard(const Shard& shard, uint64_t key, uint64_t hash) {
+        for (uint32_t i = 0; i < SlotsPerShard; i++) {
+            const Slot& slot = shard.slots[((hash >> SHARD_BITS) + i) & (SlotsPerShard - 1)];
+            uint64_t slotKey;
+            while (true) {
+                const uint32_t seqBefore = slot.sequence.load(std::memory_order_acquire);
+                if (seqBefore & 1) {
+                    continue; // writer is in the middle of updating this slot
+                }
+                slotKey = slot.key.load(std::memory_order_acquire);
+                const uint64_t slotValue = slot.value.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != seqBefore) {
+                    continue;
+                }
+
+                if (slotKey == key) {
+                    return slotValue;
+                }
+                break;
+            }
+            if (slotKey == EMPTY_KEY) {
+                break;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Reinserts the live entries of a shard without its tombstones, has to be called while holding its write mutex.
+    // Lookups that overlap with this notice the odd rebuild sequence and retry, instead of missing an entry that moved.
+    static void RebuildShard(Shard& shard) {
+        std::array<std::pair<uint64_t, uint64_t>, SlotsPerShard> entries;
+        uint32_t entryCount = 0;
+        for (const Slot& slot : shard.slots) {
+            const uint64_t slotKey = slot.key.load(std::memory_order_relaxed);
+            if (slotKey != EMPTY_KEY && slotKey != TOMBSTONE_KEY) {
+                entries[entryCount++] = { slotKey, slot.value.load(std::memory_order_relaxed) };
+            }
+        }
+
+        const uint32_t rebuildSeq = shard.rebuildSequence.load(std::memory_order_relaxed);
+        shard.rebuildSequence.store(rebuildSeq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (Slot& slot : shard.slots) {
+            if (slot.key.load(std::memory_order_relaxed) != EMPTY_KEY) {
+                WriteSlot(slot, EMPTY_KEY, 0);
+            }
+        }
+        for (uint32_t e = 0; e < entryCount; e++) {
+            const uint64_t hash = Hash(entries[e].first);
+            for (uint32_t i = 0; i < SlotsPerShard; i++) {
+                Slot& slot = shard.slots[((hash >> SHARD_BITS) + i) & (SlotsPerShard - 1)];
+                if (slot.key.load(std::memory_order_relaxed) == EMPTY_KEY) {
+                    WriteSlot(slot, entries[e].first, entries[e].second);
+                    break;
+                }
+            }
+        }
+        shard.tombstones = 0;
+
+        shard.rebuildSequence.store(rebuildSeq + 2, std::memory_order_release);
+    }
+
+    std::optional<Value> FindOverflow(uint64_t key) const {
+        if (m_overflowSize.load(std::memory_order_acquire) == 0) {
+            return std::nullopt;
+        }
+        std::lock_guard lk(m_overflowMutex);
+        auto it = m_overflow.find(key);
+        if (it == m_overflow.end()) {
+            return std::nullopt;
+        }
+        return Decode(it->second);
+    }
+
+    // has to be called while holding the write mutex of the key's shard
+    bool EraseOverflow(uint64_t key) {
+        if (m_overflowSize.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        std::lock_guard lk(m_overflowMutex);
+        if (m_overflow.erase(key) == 0) {
+            return false;
+        }
+        m_overflowSize.store(m_overflow.size(), std::memory_order_release);
+        return true;
+    }
+
+    std::array<Shard, ShardCount> m_shards;
+
+    mutable std::mutex m_overflowMutex;
+    std::unordered_map<uint64_t, uint64_t> m_overflow;
+    std::atomic_size_t m_overflowSize = 0;
+};
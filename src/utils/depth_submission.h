@@ -0,0 +1,31 @@
+#pragma once
+#include "pch.h"
+
+
+enum class DepthSubmissionMode : int32_t {
+    AUTO = 0, // Depth is submitted unless the runtime is known to ignore it
+    FORCED_ON = 1,
+    FORCED_OFF = 2,
+};
+
+// The parts of OpenXR::Capabilities that decide whether the projection layer carries depth
+struct DepthSubmissionRuntime {
+    bool supportsDepthLayer = false;
+    bool isOculusLinkRuntime = false;
+    bool isMetaSimulator = false;
+};
+
+inline bool ShouldSubmitDepth(const DepthSubmissionRuntime& runtime, DepthSubmissionMode mode) {
+    if (!runtime.supportsDepthLayer || mode == DepthSubmissionMode::FORCED_OFF) {
+        return false;
+    }
+    if (mode == DepthSubmissionMode::FORCED_ON) {
+        return true;
+    }
+
+    // Quest Link uses depth for its positional timewarp and spacewarp, while the Meta XR Simulator only shows the color
+    if (runtime.isOculusLinkRuntime) {
+        return true;
+    }
+    return !runtime.isMetaSimulator;
+}
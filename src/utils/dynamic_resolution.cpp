@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "dynamic_resolution.h"
+
+
+float DynamicResolution::Update(const Timing& timing) {
+    const double budgetMs = timing.displayPeriodMs * m_config.gpuBudget;
+    if (budgetMs <= 0.0 || timing.gpuTimeMs <= 0.0) {
+        return m_scale;
+    }
+
+    const float load = (float)(timing.gpuTimeMs / budgetMs);
+
+    if (!m_hasLoad) {
+        m_hasLoad = true;
+        m_smoothedLoad = load;
+        m_previousError = m_config.targetLoad - load;
+    }
+    else {
+        m_smoothedLoad = glm::mix(m_smoothedLoad, load, m_config.errorSmoothing);
+    }
+
+    // positive errors mean that there's headroom to raise the scale
+    const float error = m_config.targetLoad - m_smoothedLoad;
+    const float derivative = error - m_previousError;
+    m_previousError = error;
+
+    // the integral can only pull the scale below the maximum, otherwise a long calm stretch would delay reacting to load
+    const float scaleRange = m_config.maxScale - m_config.minScale;
+    m_integral = glm::clamp(m_integral + error, m_config.kI > 0.0f ? -scaleRange / m_config.kI : 0.0f, 0.0f);
+
+    // the hysteresis compares against the unclamped output, otherwise the last step below the maximum could never be raised
+    const float unclamped = m_config.maxScale + m_config.kP * error + m_config.kI * m_integral + m_config.kD * derivative;
+    const float desired = glm::clamp(unclamped, m_config.minScale, m_config.maxScale);
+    const float quantized = glm::clamp(std::floor(desired / m_config.step + 0.5f) * m_config.step, m_config.minScale, m_config.maxScale);
+
+    m_framesSinceChange++;
+    if (quantized < m_scale) {
+        m_scale = quantized;
+        m_framesSinceChange = 0;
+    }
+    else if (quantized > m_scale && unclamped - m_scale >= m_config.raiseHysteresis && m_framesSinceChange >= m_config.raiseHoldFrames) {
+        // only one step at a time, the next step has to wait for the timings of this one
+        m_scale = std::min(m_scale + m_config.step, m_config.maxScale);
+        m_framesSinceChange = 0;
+    }
+    return m_scale;
+}
+
+void DynamicResolution::Reset() {
+    m_scale = m_config.maxScale;
+    m_hasLoad = false;
+    m_smoothedLoad = 0.0f;
+    m_previousError = 0.0f;
+    m_integral = 0.0f;
+    m_framesSinceChange = 0;
+}
+
+XrExtent2Di DynamicResolution::GetScaledExtent(uint32_t width, uint32_t height, float scale) {
+    return {
+        .width = std::max(1, (int32_t)std::lround((double)width * scale)),
+        .height = std::max(1, (int32_t)std::lround((double)height * scale))
+    };
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "pch.h"
+
+
+// Picks the render scale of the projection layer from the GPU time of the passes that the scale applies to.
+// Only the present passes that draw the game's image into the OpenXR swapchains render at the scaled size, so the load is
+// their GPU time as a fraction of the budget they get from the display period, and a PID controller steers it towards a
+// target that leaves some headroom. Dropping the scale happens as soon as the controller asks for it since a missed frame is
+// worse than a blurrier one, while raising it again needs a minimum change and a number of calm frames so that the scale
+// doesn't oscillate between two steps.
+class DynamicResolution {
+public:
+    struct Config {
+        float minScale = 0.6f;
+        float maxScale = 1.0f;
+        float step = 0.05f;         // scales are quantized to this so that the sub-rectangle doesn't change every frame
+        float gpuBudget = 0.25f;    // fraction of the display period that the scaled passes may take on the GPU
+        float targetLoad = 0.85f;   // fraction of that budget that they should take
+        float kP = 0.6f;
+        float kI = 0.05f;
+        float kD = 0.1f;
+        float errorSmoothing = 0.2f; // weight of the newest load sample
+        float raiseHysteresis = 0.1f; // the controller has to ask for this much more before the scale is raised
+        uint32_t raiseHoldFrames = 45;
+    };
+
+    struct Timing {
+        double gpuTimeMs = 0.0;       // GPU time of the passes that render at the scaled size
+        double displayPeriodMs = 0.0;
+    };
+
+    DynamicResolution() = default;
+    explicit DynamicResolution(const Config& config): m_config(config), m_scale(config.maxScale) {}
+
+    // Feeds the timings of one frame and returns the scale to render the next frame with, frames without GPU timings are ignored
+    float Update(const Timing& timing);
+    void Reset();
+
+    float GetScale() const { return m_scale; }
+    float GetLoad() const { return m_smoothedLoad; }
+    const Config& GetConfig() const { return m_config; }
+
+    // The sub-rectangle extent of a swapchain image at the given scale, never smaller than one pixel
+    static XrExtent2Di GetScaledExtent(uint32_t width, uint32_t height, float scale);
+
+private:
+    Config m_config = {};
+    float m_scale = 1.0f;
+
+    bool m_hasLoad = false;
+    float m_smoothedLoad = 0.0f;
+    float m_previousError = 0.0f;
+    float m_integral = 0.0f;
+    uint32_t m_framesSinceChange = 0;
+};
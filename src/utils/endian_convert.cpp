@@ -0,0 +1,239 @@
+#include "pch.h"
+#include "endian_convert.h"
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+// MSVC allows using any intrinsic without changing the target architecture, clang(-cl) and GCC need to be told per function
+#if defined(__clang__) || defined(__GNUC__)
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSSE3
+#define TARGET_AVX2
+#endif
+
+namespace EndianConvert {
+
+// -----------------------------------------------------------------------
+// Scalar
+// -----------------------------------------------------------------------
+
+static void SwapWordsScalar(const uint32_t* src, uint32_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = std::byteswap(src[i]);
+    }
+}
+
+// 3x4 row-major <-> 4x3 column-major, element i of one layout is element TRANSPOSE[i] of the other
+static constexpr std::array<uint32_t, 12> ROW_TO_COLUMN = { 0, 4, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11 };
+
+// copies each matrix first so that converting in place works just like with the SIMD paths
+static void MatricesToLEScalar(const uint32_t* src, uint32_t* dst, size_t count) {
+    for (size_t m = 0; m < count; m++, src += 12, dst += 12) {
+        std::array<uint32_t, 12> rows;
+        memcpy(rows.data(), src, sizeof(rows));
+        for (uint32_t i = 0; i < 12; i++) {
+            dst[i] = std::byteswap(rows[ROW_TO_COLUMN[i]]);
+        }
+    }
+}
+
+static void MatricesToBEScalar(const uint32_t* src, uint32_t* dst, size_t count) {
+    for (size_t m = 0; m < count; m++, src += 12, dst += 12) {
+        std::array<uint32_t, 12> columns;
+        memcpy(columns.data(), src, sizeof(columns));
+        for (uint32_t i = 0; i < 12; i++) {
+            dst[ROW_TO_COLUMN[i]] = std::byteswap(columns[i]);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+// SSSE3
+// -----------------------------------------------------------------------
+
+TARGET_SSSE3 static inline __m128 LoadSwapped(const uint32_t* src) {
+    const __m128i swapMask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    return _mm_castsi128_ps(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), swapMask));
+}
+
+TARGET_SSSE3 static void SwapWordsSSSE3(const uint32_t* src, uint32_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps((float*)(dst + i), LoadSwapped(src + i));
+    }
+    SwapWordsScalar(src + i, dst + i, count - i);
+}
+
+// Only uses shuffles on the swapped lanes so that no float arithmetic can quieten a signaling NaN
+TARGET_SSSE3 static void MatricesToLESSSE3(const uint32_t* src, uint32_t* dst, size_t count) {
+    for (size_t m = 0; m < count; m++, src += 12, dst += 12) {
+        // rows: r0 = (a0 a1 a2 a3), r1 = (b0 b1 b2 b3), r2 = (c0 c1 c2 c3)
+        const __m128 r0 = LoadSwapped(src + 0);
+        const __m128 r1 = LoadSwapped(src + 4);
+        const __m128 r2 = LoadSwapped(src + 8);
+
+        const __m128 ab01 = _mm_unpacklo_ps(r0, r1);                            // a0 b0 a1 b1
+        const __m128 ab23 = _mm_unpackhi_ps(r0, r1);                            // a2 b2 a3 b3
+        const __m128 c0a1 = _mm_shuffle_ps(r2, ab01, _MM_SHUFFLE(3, 2, 0, 0));  // c0 c0 a1 b1
+        const __m128 b1c1 = _mm_shuffle_ps(ab01, r2, _MM_SHUFFLE(1, 1, 3, 3));  // b1 b1 c1 c1
+        const __m128 c2c3 = _mm_shuffle_ps(r2, ab23, _MM_SHUFFLE(3, 2, 3, 2));  // c2 c3 a3 b3
+
+        // columns: (a0 b0 c0) (a1 b1 c1) (a2 b2 c2) (a3 b3 c3)
+        _mm_storeu_ps((float*)(dst + 0), _mm_shuffle_ps(ab01, c0a1, _MM_SHUFFLE(2, 0, 1, 0)));  // a0 b0 c0 a1
+        _mm_storeu_ps((float*)(dst + 4), _mm_shuffle_ps(b1c1, ab23, _MM_SHUFFLE(1, 0, 2, 0)));  // b1 c1 a2 b2
+        _mm_storeu_ps((float*)(dst + 8), _mm_shuffle_ps(c2c3, c2c3, _MM_SHUFFLE(1, 3, 2, 0)));  // c2 a3 b3 c3
+    }
+}
+
+TARGET_SSSE3 static void MatricesToBESSSE3(const uint32_t* src, uint32_t* dst, size_t count) {
+    for (size_t m = 0; m < count; m++, src += 12, dst += 12) {
+        // columns packed as (a0 b0 c0 a1) (b1 c1 a2 b2) (c2 a3 b3 c3)
+        const __m128 in0 = LoadSwapped(src + 0);
+        const __m128 in1 = LoadSwapped(src + 4);
+        const __m128 in2 = LoadSwapped(src + 8);
+
+        const __m128 a23 = _mm_shuffle_ps(in1, in2, _MM_SHUFFLE(1, 1, 2, 2));  // a2 a2 a3 a3
+        const __m128 b01 = _mm_shuffle_ps(in0, in1, _MM_SHUFFLE(0, 0, 1, 1));  // b0 b0 b1 b1
+        const __m128 b23 = _mm_shuffle_ps(in1, in2, _MM_SHUFFLE(2, 2, 3, 3));  // b2 b2 b3 b3
+        const __m128 c01 = _mm_shuffle_ps(in0, in1, _MM_SHUFFLE(1, 1, 2, 2));  // c0 c0 c1 c1
+        const __m128 c23 = _mm_shuffle_ps(in2, in2, _MM_SHUFFLE(3, 3, 0, 0));  // c2 c2 c3 c3
+
+        _mm_storeu_ps((float*)(dst + 0), _mm_shuffle_ps(in0, a23, _MM_SHUFFLE(2, 0, 3, 0)));  // a0 a1 a2 a3
+        _mm_storeu_ps((float*)(dst + 4), _mm_shuffle_ps(b01, b23, _MM_SHUFFLE(2, 0, 2, 0)));  // b0 b1 b2 b3
+        _mm_storeu_ps((float*)(dst + 8), _mm_shuffle_ps(c01, c23, _MM_SHUFFLE(2, 0, 2, 0)));  // c0 c1 c2 c3
+    }
+}
+
+// -----------------------------------------------------------------------
+// AVX2 (only helps the flat word swaps, the matrix transposes stay on SSSE3)
+// -----------------------------------------------------------------------
+
+TARGET_AVX2 static void SwapWordsAVX2(const uint32_t* src, uint32_t* dst, size_t count) {
+    const __m256i swapMask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i words = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_shuffle_epi8(words, swapMask));
+    }
+    SwapWordsSSSE3(src + i, dst + i, count - i);
+}
+
+// -----------------------------------------------------------------------
+// Dispatch
+// -----------------------------------------------------------------------
+
+static void CpuId(int regs[4], int leaf, int subleaf) {
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subleaf);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t ReadXCR0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax = 0, edx = 0;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (uint64_t)edx << 32 | eax;
+#endif
+}
+
+static Implementation DetectImplementation() {
+    int regs[4] = {};
+    CpuId(regs, 0, 0);
+    const int maxLeaf = regs[0];
+
+    CpuId(regs, 1, 0);
+    const bool hasSSSE3 = (regs[2] & (1 << 9)) != 0;
+    const bool hasOSXSAVE = (regs[2] & (1 << 27)) != 0;
+    const bool hasAVX = (regs[2] & (1 << 28)) != 0;
+
+    bool hasAVX2 = false;
+    if (maxLeaf >= 7 && hasOSXSAVE && hasAVX) {
+        // the OS also needs to save the YMM registers on context switches
+        const bool osSavesYMM = (ReadXCR0() & 0x6) == 0x6;
+        CpuId(regs, 7, 0);
+        hasAVX2 = osSavesYMM && (regs[1] & (1 << 5)) != 0;
+    }
+
+    if (hasAVX2) return Implementation::AVX2;
+    if (hasSSSE3) return Implementation::SSSE3;
+    return Implementation::SCALAR;
+}
+
+struct Dispatch {
+    Implementation implementation;
+    void (*swapWords)(const uint32_t* src, uint32_t* dst, size_t count);
+    void (*matricesToLE)(const uint32_t* src, uint32_t* dst, size_t count);
+    void (*matricesToBE)(const uint32_t* src, uint32_t* dst, size_t count);
+};
+
+static constexpr std::array<Dispatch, 3> DISPATCHES = {
+    Dispatch{ Implementation::SCALAR, &SwapWordsScalar, &MatricesToLEScalar, &MatricesToBEScalar },
+    Dispatch{ Implementation::SSSE3, &SwapWordsSSSE3, &MatricesToLESSSE3, &MatricesToBESSSE3 },
+    Dispatch{ Implementation::AVX2, &SwapWordsAVX2, &MatricesToLESSSE3, &MatricesToBESSSE3 },
+};
+
+static Implementation GetBestImplementation() {
+    static const Implementation s_best = DetectImplementation();
+    return s_best;
+}
+
+static std::atomic<const Dispatch*>& GetDispatchPtr() {
+    static std::atomic<const Dispatch*> s_dispatch = &DISPATCHES[(size_t)GetBestImplementation()];
+    return s_dispatch;
+}
+
+static const Dispatch& GetDispatch() {
+    return *GetDispatchPtr().load(std::memory_order_relaxed);
+}
+
+Implementation GetImplementation() {
+    return GetDispatch().implementation;
+}
+
+const char* GetImplementationName() {
+    switch (GetImplementation()) {
+        case Implementation::AVX2:
+            return "AVX2";
+        case Implementation::SSSE3:
+            return "SSSE3";
+        default:
+            return "Scalar";
+    }
+}
+
+bool IsSupported(Implementation implementation) {
+    // every implementation only needs a subset of what the ones after it use
+    return implementation <= GetBestImplementation();
+}
+
+bool SetImplementation(Implementation implementation) {
+    if (!IsSupported(implementation)) {
+        return false;
+    }
+    GetDispatchPtr().store(&DISPATCHES[(size_t)implementation], std::memory_order_relaxed);
+    return true;
+}
+
+void MatricesToLE(const uint32_t* src, uint32_t* dst, size_t count) {
+    GetDispatch().matricesToLE(src, dst, count);
+}
+
+void MatricesToBE(const uint32_t* src, uint32_t* dst, size_t count) {
+    GetDispatch().matricesToBE(src, dst, count);
+}
+
+void SwapWords(const uint32_t* src, uint32_t* dst, size_t count) {
+    GetDispatch().swapWords(src, dst, count);
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "pch.h"
+
+
+// Bulk conversion between the guest's big-endian 32-bit words and the host's little-endian ones, see endian_convert_glm.h for
+// the forms that take the guest's math types. Picks an AVX2, SSSE3 or scalar implementation once at startup based on what the
+// CPU supports. Conversions only move bytes around, so NaN/Inf bit patterns survive a round trip unchanged.
+// Every function works in place too, i.e. when src and dst are the same.
+namespace EndianConvert {
+    enum class Implementation {
+        SCALAR,
+        SSSE3,
+        AVX2
+    };
+
+    Implementation GetImplementation();
+    const char* GetImplementationName();
+    bool IsSupported(Implementation implementation);
+    // Switches to another implementation, e.g. to compare them. Returns false if the CPU doesn't support it
+    bool SetImplementation(Implementation implementation);
+
+    // A matrix is 12 words, the big-endian one is stored row-major (x_x, y_x, z_x, pos_x, ...) while the little-endian one is
+    // column-major like glm::mat4x3, so these also transpose
+    void MatricesToLE(const uint32_t* src, uint32_t* dst, size_t count);
+    void MatricesToBE(const uint32_t* src, uint32_t* dst, size_t count);
+
+    void SwapWords(const uint32_t* src, uint32_t* dst, size_t count);
+
+    // Swaps every 32-bit word in place, useful for raw guest arrays of floats or integers
+    inline void SwapWords(uint32_t* data, size_t count) {
+        SwapWords(data, data, count);
+    }
+}
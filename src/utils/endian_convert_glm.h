@@ -0,0 +1,37 @@
+#pragma once
+#include "endian_convert.h"
+
+
+// EndianConvert for the guest's math types and their glm counterparts
+namespace EndianConvert {
+    static_assert(sizeof(BEMatrix34) == sizeof(glm::mat4x3), "BEMatrix34 and glm::mat4x3 must both be 12 floats");
+    static_assert(sizeof(BEVec3) == sizeof(glm::fvec3), "BEVec3 and glm::fvec3 must both be 3 floats");
+
+    inline void ToLE(const BEMatrix34* src, glm::mat4x3* dst, size_t count) {
+        MatricesToLE((const uint32_t*)src, (uint32_t*)dst, count);
+    }
+
+    inline void ToBE(const glm::mat4x3* src, BEMatrix34* dst, size_t count) {
+        MatricesToBE((const uint32_t*)src, (uint32_t*)dst, count);
+    }
+
+    inline void ToLE(const BEVec3* src, glm::fvec3* dst, size_t count) {
+        SwapWords((const uint32_t*)src, (uint32_t*)dst, count * 3);
+    }
+
+    inline void ToBE(const glm::fvec3* src, BEVec3* dst, size_t count) {
+        SwapWords((const uint32_t*)src, (uint32_t*)dst, count * 3);
+    }
+
+    inline glm::mat4x3 ToLE(const BEMatrix34& src) {
+        glm::mat4x3 dst;
+        ToLE(&src, &dst, 1);
+        return dst;
+    }
+
+    inline BEMatrix34 ToBE(const glm::mat4x3& src) {
+        BEMatrix34 dst;
+        ToBE(&src, &dst, 1);
+        return dst;
+    }
+}
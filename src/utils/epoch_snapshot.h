@@ -0,0 +1,77 @@
+#pragma once
+#include "pch.h"
+
+
+// Publishes a value that's rebuilt at most a few times per frame but read many times per frame from several threads, e.g. by
+// a hook that runs for every bone. Readers get a reference to the latest version with a single atomic load, publishing copies
+// the latest version into the next slot, lets the writer modify it and then swaps it in. Writers are serialized by a mutex.
+// A reference stays valid until SLOTS - 1 more versions were published, so readers mustn't keep it past the hook that got it.
+template <typename T, uint32_t SLOTS = 3>
+class EpochSnapshot {
+    static_assert(SLOTS >= 2);
+
+public:
+    EpochSnapshot() = default;
+    EpochSnapshot(const EpochSnapshot&) = delete;
+    EpochSnapshot& operator=(const EpochSnapshot&) = delete;
+
+    const T& GetLatest() const { return m_slots[m_current.load(std::memory_order_acquire)].value; }
+    uint32_t GetLatestEpoch() const { return m_slots[m_current.load(std::memory_order_acquire)].epoch; }
+
+    // Returns the version of the given epoch, building it first with refresh(T&) if nothing was published for it yet.
+    // If several threads get here at once only the first one refreshes, the others wait for it and reuse its version.
+    template <typename Refresh>
+    const T& Get(uint32_t epoch, Refresh&& refresh) {
+        const Slot& latest = m_slots[m_current.load(std::memory_order_acquire)];
+        if (latest.epoch == epoch) {
+            return latest.value;
+        }
+
+        std::lock_guard lk(m_writeMutex);
+        const Slot& recheck = m_slots[m_current.load(std::memory_order_relaxed)];
+        if (recheck.epoch == epoch) {
+            return recheck.value;
+        }
+        return PublishLocked(epoch, std::forward<Refresh>(refresh));
+    }
+
+    // Publishes a new version for the given epoch, modify(T&) gets a copy of the latest version
+    template <typename Modify>
+    const T& Publish(uint32_t epoch, Modify&& modify) {
+        std::lock_guard lk(m_writeMutex);
+        return PublishLocked(epoch, std::forward<Modify>(modify));
+    }
+
+    // Publishes a new version without moving it to another epoch, e.g. to update a part of it mid-frame
+    template <typename Modify>
+    const T& Update(Modify&& modify) {
+        std::lock_guard lk(m_writeMutex);
+        return PublishLocked(m_slots[m_current.load(std::memory_order_relaxed)].epoch, std::forward<Modify>(modify));
+    }
+
+    uint64_t GetPublishCount() const { return m_publishCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        uint32_t epoch = 0;
+        T value = {};
+    };
+
+    template <typename Modify>
+    const T& PublishLocked(uint32_t epoch, Modify&& modify) {
+        const uint32_t current = m_current.load(std::memory_order_relaxed);
+        const uint32_t next = (current + 1) % SLOTS;
+        Slot& slot = m_slots[next];
+        slot.value = m_slots[current].value;
+        modify(slot.value);
+        slot.epoch = epoch;
+        m_current.store(next, std::memory_order_release);
+        m_publishCount.fetch_add(1, std::memory_order_relaxed);
+        return slot.value;
+    }
+
+    std::array<Slot, SLOTS> m_slots = {};
+    std::atomic_uint32_t m_current = 0;
+    std::atomic_uint64_t m_publishCount = 0;
+    std::mutex m_writeMutex;
+};
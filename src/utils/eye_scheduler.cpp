@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "eye_scheduler.h"
+
+
+const char* EyeScheduler::GetPlanName(Plan plan) {
+    switch (plan) {
+        case Plan::BOTH:
+            return "both eyes";
+        case Plan::LEFT_ONLY:
+            return "left eye only";
+        case Plan::RIGHT_ONLY:
+            return "right eye only";
+        default:
+            return "unknown";
+    }
+}
+
+EyeScheduler::Plan EyeScheduler::Next(const Input& input) {
+    if (m_hasLastInput && input.timeSeconds > m_lastTimeSeconds) {
+        // q and -q are the same rotation, so the absolute dot product gives the shortest angle between both orientations
+        const float cosHalfAngle = std::min(std::abs(glm::dot(m_lastOrientation, input.headOrientation)), 1.0f);
+        m_angularSpeed = (float)(2.0 * std::acos(cosHalfAngle) / (input.timeSeconds - m_lastTimeSeconds));
+    }
+    m_hasLastInput = true;
+    m_lastOrientation = input.headOrientation;
+    m_lastTimeSeconds = input.timeSeconds;
+
+    // both eyes also have to be rendered at least once before either of them can be reused
+    if (!input.allowed || m_angularSpeed > m_config.maxAngularSpeed) {
+        m_calmFrames = 0;
+        return Plan::BOTH;
+    }
+    if (m_calmFrames < m_config.calmFrames) {
+        m_calmFrames++;
+        return Plan::BOTH;
+    }
+
+    m_lastSingleEye = m_lastSingleEye == 0 ? 1 : 0;
+    return m_lastSingleEye == 0 ? Plan::LEFT_ONLY : Plan::RIGHT_ONLY;
+}
+
+void EyeScheduler::Reset() {
+    m_hasLastInput = false;
+    m_lastOrientation = glm::identity<glm::fquat>();
+    m_lastTimeSeconds = 0.0;
+    m_angularSpeed = 0.0f;
+    m_calmFrames = 0;
+    m_lastSingleEye = 1;
+}
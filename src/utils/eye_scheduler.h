@@ -0,0 +1,58 @@
+#pragma once
+#include "pch.h"
+
+
+// Decides which eyes the game renders each frame when alternate-eye rendering is enabled.
+// With BOTH the game runs its two rendering passes like normal. With LEFT_ONLY or RIGHT_ONLY only the first pass runs, using
+// that eye's camera, and the other eye is submitted with the image and pose from the last frame that rendered it so that the
+// runtime reprojects it. A stale eye looks wrong while the head turns quickly, so fast head motion falls back to BOTH until
+// the head has been calm for a couple of frames.
+// Sides are 0 for the left eye and 1 for the right eye, like OpenXR::EyeSide.
+class EyeScheduler {
+public:
+    enum class Plan : uint8_t {
+        BOTH,
+        LEFT_ONLY,
+        RIGHT_ONLY,
+    };
+    static const char* GetPlanName(Plan plan);
+
+    struct Config {
+        float maxAngularSpeed = 1.0f; // radians per second of head rotation above which both eyes are rendered
+        uint32_t calmFrames = 15;     // frames below that speed before alternating again
+    };
+
+    struct Input {
+        bool allowed = false; // false in scenes where a stale eye would stand out, e.g. menus and cutscenes
+        glm::fquat headOrientation = glm::identity<glm::fquat>();
+        double timeSeconds = 0.0;
+    };
+
+    EyeScheduler() = default;
+    explicit EyeScheduler(const Config& config): m_config(config) {}
+
+    Plan Next(const Input& input);
+    void Reset();
+
+    float GetAngularSpeed() const { return m_angularSpeed; }
+
+    static bool RendersBothEyes(Plan plan) { return plan == Plan::BOTH; }
+    static bool IsEyeStale(Plan plan, uint8_t side) {
+        return (plan == Plan::LEFT_ONLY && side == 1) || (plan == Plan::RIGHT_ONLY && side == 0);
+    }
+    // The eye that the game's rendering pass with this index draws, only the first pass runs when a single eye is rendered
+    static uint8_t GetPassEye(Plan plan, uint8_t pass) {
+        return (pass == 0 && plan == Plan::RIGHT_ONLY) ? 1 : pass;
+    }
+
+private:
+    Config m_config = {};
+
+    bool m_hasLastInput = false;
+    glm::fquat m_lastOrientation = glm::identity<glm::fquat>();
+    double m_lastTimeSeconds = 0.0;
+    float m_angularSpeed = 0.0f;
+
+    uint32_t m_calmFrames = 0;
+    uint8_t m_lastSingleEye = 1;
+};
@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "frame_slots.h"
+
+
+const char* FrameSlotScheduler::GetStateName(State state) {
+    switch (state) {
+        case State::FREE:
+            return "free";
+        case State::PRODUCING:
+            return "producing";
+        case State::COPIED:
+            return "copied";
+        case State::SUBMITTED:
+            return "submitted";
+        default:
+            return "unknown";
+    }
+}
+
+FrameSlotScheduler::FrameSlotScheduler(uint32_t slotCount): m_slotCount(std::clamp(slotCount, MIN_SLOTS, MAX_SLOTS)) {
+}
+
+FrameSlotScheduler::Acquired FrameSlotScheduler::AcquireForGame(uint32_t gameCounter) {
+    std::lock_guard lk(m_mutex);
+
+    if (m_producingSlot) {
+        Slot& current = m_slots[*m_producingSlot];
+        if (current.state == State::PRODUCING && current.gameCounter == gameCounter) {
+            return { .slot = *m_producingSlot, .recycled = false };
+        }
+        // the XR frame loop might've already picked up the slot, in which case it's no longer ours to change
+        if (current.state == State::PRODUCING) {
+            current.state = State::COPIED;
+        }
+        m_producingSlot.reset();
+    }
+
+    // prefer the free slot that was used the longest time ago, otherwise drop the oldest frame that wasn't submitted yet
+    std::optional<uint32_t> freeSlot;
+    std::optional<uint32_t> staleSlot;
+    for (uint32_t i = 0; i < m_slotCount; ++i) {
+        const Slot& slot = m_slots[i];
+        if (slot.state == State::FREE) {
+            if (!freeSlot || slot.sequence < m_slots[*freeSlot].sequence) {
+                freeSlot = i;
+            }
+        }
+        else if (slot.state != State::SUBMITTED) {
+            if (!staleSlot || slot.sequence < m_slots[*staleSlot].sequence) {
+                staleSlot = i;
+            }
+        }
+    }
+
+    // only one slot is ever submitted at a time and there are at least two, so one of them is always available
+    checkAssert(freeSlot.has_value() || staleSlot.has_value(), "Every frame slot is being submitted, can't start a new frame!");
+    const bool recycled = !freeSlot.has_value();
+    const uint32_t index = recycled ? *staleSlot : *freeSlot;
+    if (recycled) {
+        m_recycledFrames++;
+    }
+
+    m_slots[index] = {
+        .state = State::PRODUCING,
+        .gameCounter = gameCounter,
+        .sequence = m_nextSequence++
+    };
+    m_producingSlot = index;
+    return { .slot = index, .recycled = recycled };
+}
+
+std::optional<uint32_t> FrameSlotScheduler::FindForGame(uint32_t gameCounter) const {
+    std::lock_guard lk(m_mutex);
+    std::optional<uint32_t> newest;
+    for (uint32_t i = 0; i < m_slotCount; ++i) {
+        const Slot& slot = m_slots[i];
+        if (slot.state == State::FREE || slot.gameCounter != gameCounter) {
+            continue;
+        }
+        if (!newest || slot.sequence > m_slots[*newest].sequence) {
+            newest = i;
+        }
+    }
+    return newest;
+}
+
+bool FrameSlotScheduler::Release(uint32_t slot) {
+    std::lock_guard lk(m_mutex);
+    if (slot >= m_slotCount || m_slots[slot].state != State::SUBMITTED) {
+        return false;
+    }
+    m_slots[slot].state = State::FREE;
+    if (m_producingSlot == slot) {
+        m_producingSlot.reset();
+    }
+    return true;
+}
+
+FrameSlotScheduler::State FrameSlotScheduler::GetState(uint32_t slot) const {
+    std::lock_guard lk(m_mutex);
+    return slot < m_slotCount ? m_slots[slot].state : State::FREE;
+}
+
+uint64_t FrameSlotScheduler::GetSequence(uint32_t slot) const {
+    std::lock_guard lk(m_mutex);
+    return slot < m_slotCount ? m_slots[slot].sequence : 0;
+}
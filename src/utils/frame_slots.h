@@ -0,0 +1,99 @@
+#pragma once
+#include "pch.h"
+
+
+// Hands out the slots (shared textures, ImGui framebuffers and RenderFrame bookkeeping) that game frames are rendered into.
+// The game only tells the frames apart with a counter that alternates between 0 and 1, so every time that counter changes a
+// new frame starts and gets the oldest free slot. A slot goes FREE -> PRODUCING while the game copies into it, COPIED once
+// the game moved on to the next frame, SUBMITTED while the XR frame loop renders it and back to FREE after xrEndFrame.
+class FrameSlotScheduler {
+public:
+    static constexpr uint32_t MIN_SLOTS = 2;
+    static constexpr uint32_t MAX_SLOTS = 4;
+
+    enum class State : uint8_t {
+        FREE,
+        PRODUCING,
+        COPIED,
+        SUBMITTED,
+    };
+    static const char* GetStateName(State state);
+
+    explicit FrameSlotScheduler(uint32_t slotCount);
+
+    struct Acquired {
+        uint32_t slot = 0;
+        // the slot still held an older frame that never got submitted, its state has to be thrown away before reusing it
+        bool recycled = false;
+    };
+    // Returns the slot that the game frame with this counter copies into, starting a new frame if the counter changed
+    Acquired AcquireForGame(uint32_t gameCounter);
+    // Returns the newest slot that holds a frame with this counter without starting a new frame
+    std::optional<uint32_t> FindForGame(uint32_t gameCounter) const;
+
+    // Marks the oldest slot for which isReady returns true as SUBMITTED, PRODUCING and COPIED slots are considered. Only use
+    // this for frames that are complete, since the game still copies into a PRODUCING slot until its counter changes.
+    template <typename F>
+    std::optional<uint32_t> AcquireForSubmit(F&& isReady) {
+        return AcquireOldestForSubmit(true, std::forward<F>(isReady));
+    }
+    // Same as AcquireForSubmit, but only considers COPIED slots whose frame the game moved on from
+    template <typename F>
+    std::optional<uint32_t> AcquireCopiedForSubmit(F&& isReady) {
+        return AcquireOldestForSubmit(false, std::forward<F>(isReady));
+    }
+    // SUBMITTED -> FREE, returns false and leaves the slot alone if it wasn't submitted
+    bool Release(uint32_t slot);
+
+    // Runs update if the slot still holds the unsubmitted frame that it was acquired for with this sequence. The slot can't
+    // be submitted or handed to a newer frame while update runs, which AcquireForSubmit's isReady relies on.
+    template <typename F>
+    bool UpdateIfUnsubmitted(uint32_t slot, uint64_t sequence, F&& update) {
+        std::lock_guard lk(m_mutex);
+        if (slot >= m_slotCount || m_slots[slot].sequence != sequence || (m_slots[slot].state != State::PRODUCING && m_slots[slot].state != State::COPIED)) {
+            return false;
+        }
+        update();
+        return true;
+    }
+
+    State GetState(uint32_t slot) const;
+    // Tells the frames that were rendered into the same slot apart, every AcquireForGame that starts a new frame increments it
+    uint64_t GetSequence(uint32_t slot) const;
+    uint32_t GetSlotCount() const { return m_slotCount; }
+    uint64_t GetRecycledFrames() const { return m_recycledFrames; }
+
+private:
+    template <typename F>
+    std::optional<uint32_t> AcquireOldestForSubmit(bool includeProducing, F&& isReady) {
+        std::lock_guard lk(m_mutex);
+        std::optional<uint32_t> oldest;
+        for (uint32_t i = 0; i < m_slotCount; ++i) {
+            const Slot& slot = m_slots[i];
+            if (slot.state != State::COPIED && (!includeProducing || slot.state != State::PRODUCING)) {
+                continue;
+            }
+            if ((!oldest || slot.sequence < m_slots[*oldest].sequence) && isReady(i)) {
+                oldest = i;
+            }
+        }
+        if (oldest) {
+            m_slots[*oldest].state = State::SUBMITTED;
+        }
+        return oldest;
+    }
+
+    struct Slot {
+        State state = State::FREE;
+        uint32_t gameCounter = 0;
+        uint64_t sequence = 0; // order in which the slots were acquired, lower is older
+    };
+
+    const uint32_t m_slotCount;
+
+    mutable std::mutex m_mutex;
+    std::array<Slot, MAX_SLOTS> m_slots = {};
+    std::optional<uint32_t> m_producingSlot;
+    uint64_t m_nextSequence = 1;
+    std::atomic_uint64_t m_recycledFrames = 0;
+};
@@ -0,0 +1,249 @@
+#include "pch.h"
+#include "frame_trace.h"
+
+#include <charconv>
+#include <fstream>
+
+
+// -----------------------------------------------------------------------
+// JSON export
+// -----------------------------------------------------------------------
+
+// The dump formats tens of thousands of events, so the numbers get appended in place instead of going through std::format
+
+static void AppendUnsigned(std::string& out, uint64_t value) {
+    char buffer[24];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+static void AppendTimestamp(std::string& out, double microseconds) {
+    char buffer[64];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), microseconds, std::chars_format::fixed, 3);
+    out.append(buffer, result.ptr);
+}
+
+// JSON has no literal for NaN or infinity, so those counters are written as 0 instead of breaking the whole file
+static void AppendCounterValue(std::string& out, double value) {
+    char buffer[64];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), std::isfinite(value) ? value : 0.0);
+    out.append(buffer, result.ptr);
+}
+
+static void AppendEscaped(std::string& out, const char* str) {
+    for (const char* c = str ? str : "(null)"; *c != '\0'; c++) {
+        switch (*c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                if ((unsigned char)*c < 0x20) {
+                    constexpr const char* HEX_DIGITS = "0123456789abcdef";
+                    out += "\\u00";
+                    out += HEX_DIGITS[(unsigned char)*c >> 4];
+                    out += HEX_DIGITS[(unsigned char)*c & 0xF];
+                }
+                else {
+                    out += *c;
+                }
+                break;
+        }
+    }
+}
+
+std::string FrameTrace::ToJson(std::span<const ThreadEvents> threads, double ticksPerMicrosecond, uint64_t baseTicks) {
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+
+    auto beginEvent = [&](const char* phase, const char* name, uint32_t threadId, uint64_t ticks) {
+        out += first ? "\n" : ",\n";
+        first = false;
+        const double timestamp = ticksPerMicrosecond > 0.0 ? (double)((int64_t)(ticks - baseTicks)) / ticksPerMicrosecond : 0.0;
+        out += "{\"ph\":\"";
+        out += phase;
+        out += "\",\"pid\":1,\"tid\":";
+        AppendUnsigned(out, threadId);
+        out += ",\"ts\":";
+        AppendTimestamp(out, timestamp);
+        out += ",\"name\":\"";
+        AppendEscaped(out, name);
+        out += "\"";
+    };
+
+    for (const ThreadEvents& thread : threads) {
+        if (thread.threadName) {
+            beginEvent("M", "thread_name", thread.threadId, baseTicks);
+            out += ",\"args\":{\"name\":\"";
+            AppendEscaped(out, thread.threadName);
+            out += "\"}}";
+        }
+
+        // names of the spans that are still open, used to close them if the trace ends in the middle of one
+        std::vector<const char*> openSpans;
+        uint64_t lastTicks = baseTicks;
+
+        for (const Event& event : thread.events) {
+            lastTicks = event.ticks;
+            switch (event.type) {
+                case EventType::BEGIN:
+                    openSpans.emplace_back(event.name);
+                    beginEvent("B", event.name, thread.threadId, event.ticks);
+                    out += "}";
+                    break;
+                case EventType::END:
+                    // the matching begin was overwritten when the ring wrapped around
+                    if (openSpans.empty()) {
+                        break;
+                    }
+                    beginEvent("E", openSpans.back(), thread.threadId, event.ticks);
+                    out += "}";
+                    openSpans.pop_back();
+                    break;
+                case EventType::INSTANT:
+                    beginEvent("i", event.name, thread.threadId, event.ticks);
+                    out += ",\"s\":\"t\"}";
+                    break;
+                case EventType::COUNTER:
+                    beginEvent("C", event.name, thread.threadId, event.ticks);
+                    out += ",\"args\":{\"value\":";
+                    AppendCounterValue(out, std::bit_cast<double>(event.value));
+                    out += "}}";
+                    break;
+                case EventType::FLOW_START:
+                case EventType::FLOW_STEP:
+                case EventType::FLOW_END: {
+                    const char* phase = event.type == EventType::FLOW_START ? "s" : (event.type == EventType::FLOW_STEP ? "t" : "f");
+                    beginEvent(phase, event.name, thread.threadId, event.ticks);
+                    out += ",\"cat\":\"flow\",\"id\":";
+                    AppendUnsigned(out, event.value);
+                    // bind the end to the enclosing span instead of the next one
+                    out += event.type == EventType::FLOW_END ? ",\"bp\":\"e\"}" : "}";
+                    break;
+                }
+            }
+        }
+
+        while (!openSpans.empty()) {
+            beginEvent("E", openSpans.back(), thread.threadId, lastTicks);
+            out += "}";
+            openSpans.pop_back();
+        }
+    }
+
+    out += "\n]}\n";
+    return out;
+}
+
+#if ENABLE_FRAME_TRACE
+
+// -----------------------------------------------------------------------
+// Recording
+// -----------------------------------------------------------------------
+
+std::mutex FrameTrace::s_buffersMutex;
+std::vector<std::unique_ptr<FrameTrace::ThreadBuffer>> FrameTrace::s_buffers;
+
+static uint64_t s_startTicks = 0;
+static std::chrono::steady_clock::time_point s_startTime;
+
+FrameTrace::ThreadBuffer& FrameTrace::GetThreadBuffer() {
+    static thread_local ThreadBuffer* t_buffer = nullptr;
+    if (t_buffer == nullptr) {
+        std::scoped_lock lock(s_buffersMutex);
+        if (s_buffers.empty()) {
+            s_startTicks = __rdtsc();
+            s_startTime = std::chrono::steady_clock::now();
+        }
+        auto& buffer = s_buffers.emplace_back(std::make_unique<ThreadBuffer>());
+        buffer->threadId = (uint32_t)s_buffers.size();
+        t_buffer = buffer.get();
+    }
+    return *t_buffer;
+}
+
+void FrameTrace::RecordEvent(EventType type, const char* name, uint64_t value) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    const uint64_t index = buffer.writeIndex++;
+    Slot& slot = buffer.slots[index % EVENTS_PER_THREAD];
+
+    // invalidate the slot first so that a dump copying it at the same time discards it
+    slot.sequence.store(UINT64_MAX, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = { .ticks = __rdtsc(), .name = name, .value = value, .type = type };
+    slot.sequence.store(index, std::memory_order_release);
+    buffer.published.store(index + 1, std::memory_order_release);
+}
+
+void FrameTrace::SetThreadName(const char* name) {
+    GetThreadBuffer().threadName.store(name, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------
+// Dumping
+// -----------------------------------------------------------------------
+
+std::vector<FrameTrace::ThreadEvents> FrameTrace::GetEvents() {
+    std::vector<ThreadEvents> threads;
+    {
+        std::scoped_lock lock(s_buffersMutex);
+        for (const auto& buffer : s_buffers) {
+            ThreadEvents& thread = threads.emplace_back();
+            thread.threadId = buffer->threadId;
+            thread.threadName = buffer->threadName.load(std::memory_order_relaxed);
+
+            const uint64_t end = buffer->published.load(std::memory_order_acquire);
+            const uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+            thread.events.reserve(end - begin);
+            for (uint64_t i = begin; i < end; i++) {
+                const Slot& slot = buffer->slots[i % EVENTS_PER_THREAD];
+                if (slot.sequence.load(std::memory_order_acquire) != i) {
+                    continue;
+                }
+                const Event event = slot.event;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != i) {
+                    continue;
+                }
+                thread.events.emplace_back(event);
+            }
+        }
+    }
+    return threads;
+}
+
+bool FrameTrace::Dump(const std::filesystem::path& path) {
+    const std::vector<ThreadEvents> threads = GetEvents();
+    const double elapsedMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_startTime).count();
+    const double ticksPerMicrosecond = elapsedMicroseconds > 0.0 ? (double)(__rdtsc() - s_startTicks) / elapsedMicroseconds : 0.0;
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open()) {
+        Log::print<ERROR>("Couldn't open {} to write the frame trace to", path.string());
+        return false;
+    }
+    file << ToJson(threads, ticksPerMicrosecond, s_startTicks);
+
+    Log::print<INFO>("Wrote frame trace of {} threads to {}", threads.size(), path.string());
+    return true;
+}
+
+#else
+
+void FrameTrace::SetThreadName(const char* name) {
+}
+
+std::vector<FrameTrace::ThreadEvents> FrameTrace::GetEvents() {
+    return {};
+}
+
+bool FrameTrace::Dump(const std::filesystem::path& path) {
+    return false;
+}
+
+#endif
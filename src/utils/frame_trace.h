@@ -0,0 +1,111 @@
+#pragma once
+#include "pch.h"
+
+#include <filesystem>
+#include <intrin.h>
+
+// Enabled through the BETTERVR_ENABLE_FRAME_TRACE CMake option, otherwise every call below compiles to nothing
+#ifndef ENABLE_FRAME_TRACE
+#define ENABLE_FRAME_TRACE 0
+#endif
+
+
+// Flight recorder for the interplay between Cemu's GPU thread, the OpenXR frame loop and the PPC hooks.
+// Every thread writes into its own ring of events without taking locks, and the last EVENTS_PER_THREAD events of
+// each thread get written as Chrome trace-event JSON (chrome://tracing or ui.perfetto.dev) when pressing F10 or
+// once BETTERVR_TRACE_FRAMES frames have been presented.
+class FrameTrace {
+public:
+    static constexpr uint32_t EVENTS_PER_THREAD = 1 << 14;
+
+    enum class EventType : uint8_t {
+        BEGIN,
+        END,
+        INSTANT,
+        COUNTER,
+        FLOW_START,
+        FLOW_STEP,
+        FLOW_END
+    };
+
+    // names have to be string literals (or otherwise outlive the trace) since only the pointer gets stored
+    struct Event {
+        uint64_t ticks = 0;
+        const char* name = nullptr;
+        uint64_t value = 0; // flow id, or the bits of the double for counters
+        EventType type = EventType::INSTANT;
+    };
+
+    struct ThreadEvents {
+        uint32_t threadId = 0;
+        const char* threadName = nullptr;
+        std::vector<Event> events;
+    };
+
+    static void Begin(const char* name) { Record(EventType::BEGIN, name, 0); }
+    static void End() { Record(EventType::END, nullptr, 0); }
+    static void Instant(const char* name) { Record(EventType::INSTANT, name, 0); }
+    static void Counter(const char* name, double value) { Record(EventType::COUNTER, name, std::bit_cast<uint64_t>(value)); }
+
+    // Flows draw arrows between the spans that enclose these calls, even across threads
+    static uint64_t NewFlowId() {
+#if ENABLE_FRAME_TRACE
+        return s_nextFlowId.fetch_add(1, std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+    static void FlowStart(const char* name, uint64_t id) { Record(EventType::FLOW_START, name, id); }
+    static void FlowStep(const char* name, uint64_t id) { Record(EventType::FLOW_STEP, name, id); }
+    static void FlowEnd(const char* name, uint64_t id) { Record(EventType::FLOW_END, name, id); }
+
+    static void SetThreadName(const char* name);
+
+    // Called once per presented frame, checks the hotkey and the frame limit (see frame_trace_hotkey.cpp)
+    static void OnFrame();
+    static bool Dump(const std::filesystem::path& path);
+    // Copies the events that are currently in every thread's ring, skipping the slots that get overwritten while copying
+    static std::vector<ThreadEvents> GetEvents();
+
+    // Converts the recorded events into Chrome's JSON format. Spans that got cut off by the ring wrapping around are
+    // repaired so that every thread's spans still nest: orphaned ends get dropped and spans that are still open get closed.
+    static std::string ToJson(std::span<const ThreadEvents> threads, double ticksPerMicrosecond, uint64_t baseTicks);
+
+    class Scope {
+    public:
+        explicit Scope(const char* name) { Begin(name); }
+        ~Scope() { End(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    static void Record(EventType type, const char* name, uint64_t value) {
+#if ENABLE_FRAME_TRACE
+        RecordEvent(type, name, value);
+#endif
+    }
+
+#if ENABLE_FRAME_TRACE
+    // Each slot carries the index it was written for, which lets the dump detect slots that were overwritten while copying
+    struct Slot {
+        std::atomic_uint64_t sequence = UINT64_MAX;
+        Event event;
+    };
+
+    struct ThreadBuffer {
+        uint32_t threadId = 0;
+        std::atomic<const char*> threadName = nullptr;
+        uint64_t writeIndex = 0;
+        std::atomic_uint64_t published = 0;
+        std::array<Slot, EVENTS_PER_THREAD> slots;
+    };
+
+    static void RecordEvent(EventType type, const char* name, uint64_t value);
+    static ThreadBuffer& GetThreadBuffer();
+
+    static std::mutex s_buffersMutex;
+    static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+    static inline std::atomic_uint64_t s_nextFlowId = 1;
+#endif
+};
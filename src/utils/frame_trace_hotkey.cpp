@@ -0,0 +1,37 @@
+#include "pch.h"
+#include "frame_trace.h"
+
+#if ENABLE_FRAME_TRACE
+
+// -----------------------------------------------------------------------
+// Dump trigger
+// -----------------------------------------------------------------------
+
+void FrameTrace::OnFrame() {
+    static const uint64_t s_dumpAfterFrames = []() -> uint64_t {
+        if (const char* frames = std::getenv("BETTERVR_TRACE_FRAMES"); frames != nullptr && frames[0] != '\0') {
+            return std::strtoull(frames, nullptr, 10);
+        }
+        return 0;
+    }();
+    static uint64_t s_frameCount = 0;
+    static uint32_t s_dumpCount = 0;
+    static bool s_wasHotkeyDown = false;
+
+    s_frameCount++;
+
+    const bool isHotkeyDown = GetAsyncKeyState(VK_F10) & 0x8000;
+    const bool hotkeyPressed = isHotkeyDown && !s_wasHotkeyDown;
+    s_wasHotkeyDown = isHotkeyDown;
+
+    if (hotkeyPressed || (s_dumpAfterFrames != 0 && s_frameCount == s_dumpAfterFrames)) {
+        Dump(std::format("BetterVR_Trace_{}.json", s_dumpCount++));
+    }
+}
+
+#else
+
+void FrameTrace::OnFrame() {
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include "pch.h"
+#include "gpu_timestamps.h"
+
+
+GpuTimestampRing::GpuTimestampRing(uint32_t rangeCount, uint32_t frameCount, Calibration calibration): m_rangeCount(std::clamp(rangeCount, 1u, MAX_RANGES)), m_frameCount(std::max(frameCount, 2u)), m_calibration(calibration) {
+    m_frames.resize(m_frameCount);
+}
+
+uint32_t GpuTimestampRing::BeginRange(uint32_t range) {
+    checkAssert(range < m_rangeCount, "GPU timestamp range is out of bounds!");
+    const uint32_t rangeBit = 1u << range;
+
+    std::lock_guard lk(m_mutex);
+    if (m_frames[m_currentFrame].writtenMask & rangeBit) {
+        m_frames[m_currentFrame].pending = true;
+        m_currentFrame = (m_currentFrame + 1) % m_frameCount;
+
+        // the GPU fell this far behind, or the work was never submitted, so its queries get reused
+        Frame& next = m_frames[m_currentFrame];
+        if (next.pending) {
+            m_droppedFrames++;
+        }
+        next = {};
+    }
+
+    m_frames[m_currentFrame].writtenMask |= rangeBit;
+    return GetFirstQuery(m_currentFrame, range);
+}
+
+void GpuTimestampRing::Resolve(const ReadQueries& read) {
+    // Exponential moving average, about the last ten frames
+    constexpr double SMOOTHING = 0.1;
+
+    std::lock_guard lk(m_mutex);
+    for (uint32_t offset = 1; offset < m_frameCount; ++offset) {
+        const uint32_t frameIdx = (m_currentFrame + offset) % m_frameCount;
+        Frame& frame = m_frames[frameIdx];
+        if (!frame.pending) {
+            continue;
+        }
+
+        std::array<double, MAX_RANGES> frameMs = {};
+        for (uint32_t range = 0; range < m_rangeCount; ++range) {
+            if ((frame.writtenMask & (1u << range)) == 0) {
+                continue;
+            }
+            std::array<uint64_t, 2> ticks = {};
+            // frames finish in order, so there's no point in looking at the newer ones either
+            if (!read(GetFirstQuery(frameIdx, range), 2, ticks.data())) {
+                return;
+            }
+            frameMs[range] = TicksToMs(ticks[0], ticks[1], m_calibration);
+        }
+
+        for (uint32_t range = 0; range < m_rangeCount; ++range) {
+            if ((frame.writtenMask & (1u << range)) == 0) {
+                continue;
+            }
+            const bool firstResult = (m_resolvedRangesMask & (1u << range)) == 0;
+            m_averageMs[range] = firstResult ? frameMs[range] : m_averageMs[range] + (frameMs[range] - m_averageMs[range]) * SMOOTHING;
+            m_lastMs[range] = frameMs[range];
+            m_resolvedRangesMask |= 1u << range;
+        }
+        frame = {};
+        m_resolvedFrames++;
+    }
+}
+
+double GpuTimestampRing::GetLastMs(uint32_t range) const {
+    std::lock_guard lk(m_mutex);
+    return range < m_rangeCount ? m_lastMs[range] : 0.0;
+}
+
+double GpuTimestampRing::GetAverageMs(uint32_t range) const {
+    std::lock_guard lk(m_mutex);
+    return range < m_rangeCount ? m_averageMs[range] : 0.0;
+}
+
+double GpuTimestampRing::TicksToMs(uint64_t beginTicks, uint64_t endTicks, const Calibration& calibration) {
+    // unsigned subtraction followed by the mask also gives the right difference when the counter wrapped around in between
+    const uint64_t mask = calibration.validBits >= 64 ? ~0ull : ((1ull << calibration.validBits) - 1);
+    const uint64_t elapsedTicks = (endTicks - beginTicks) & mask;
+    return (double)elapsedTicks * calibration.nanosecondsPerTick / 1000000.0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "pch.h"
+
+
+// Hands out the timestamp query indices for GPU work that gets timed, and turns the ticks that are read back into milliseconds.
+// It doesn't know about any graphics API: every range is timed with a begin and end query, and a frame holds each range at most
+// once. Starting a range that the current frame already holds closes that frame and moves on to the next one in the ring. Closed
+// frames are resolved oldest first as soon as the backend reports that their queries are available, so nothing ever waits on the
+// GPU. A frame that still wasn't resolved once the ring wraps around to it is dropped.
+class GpuTimestampRing {
+public:
+    static constexpr uint32_t MAX_RANGES = 8;
+
+    struct Calibration {
+        double nanosecondsPerTick = 1.0;
+        uint32_t validBits = 64; // timestamps wrap around after this many bits
+    };
+
+    // Reads the ticks of queryCount queries starting at firstQuery, returns false if they aren't available yet
+    using ReadQueries = std::function<bool(uint32_t firstQuery, uint32_t queryCount, uint64_t* ticks)>;
+
+    GpuTimestampRing(uint32_t rangeCount, uint32_t frameCount, Calibration calibration);
+
+    uint32_t GetQueryCount() const { return m_rangeCount * 2 * m_frameCount; }
+
+    // Returns the query that starts the range, the query after it ends the range
+    uint32_t BeginRange(uint32_t range);
+    void Resolve(const ReadQueries& read);
+
+    // Both are 0 until the range got resolved at least once
+    double GetLastMs(uint32_t range) const;
+    double GetAverageMs(uint32_t range) const;
+    uint64_t GetResolvedFrames() const { return m_resolvedFrames; }
+    uint64_t GetDroppedFrames() const { return m_droppedFrames; }
+
+    static double TicksToMs(uint64_t beginTicks, uint64_t endTicks, const Calibration& calibration);
+
+private:
+    struct Frame {
+        uint32_t writtenMask = 0;
+        bool pending = false; // closed, but not resolved yet
+    };
+
+    uint32_t GetFirstQuery(uint32_t frame, uint32_t range) const { return (frame * m_rangeCount + range) * 2; }
+
+    const uint32_t m_rangeCount;
+    const uint32_t m_frameCount;
+    const Calibration m_calibration;
+
+    mutable std::mutex m_mutex;
+    std::vector<Frame> m_frames;
+    uint32_t m_currentFrame = 0;
+    std::array<double, MAX_RANGES> m_lastMs = {};
+    std::array<double, MAX_RANGES> m_averageMs = {};
+    uint32_t m_resolvedRangesMask = 0;
+    std::atomic_uint64_t m_resolvedFrames = 0;
+    std::atomic_uint64_t m_droppedFrames = 0;
+};
@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "hook_profiler.h"
+
+
+void HookProfiler::Accumulate(std::span<HookStats> totals, std::span<const HookStats> frame) {
+    const size_t count = std::min(totals.size(), frame.size());
+    for (size_t i = 0; i < count; i++) {
+        totals[i] += frame[i];
+    }
+}
+
+#if ENABLE_HOOK_PROFILER
+
+// -----------------------------------------------------------------------
+// Registration and per-thread recording
+// -----------------------------------------------------------------------
+
+static std::array<const char*, HookProfiler::MAX_HOOKS> s_hookNames = {};
+static std::atomic_uint32_t s_hookCount = 0;
+
+static uint64_t s_startTicks = 0;
+static std::chrono::steady_clock::time_point s_startTime;
+static double s_ticksPerSecond = 0.0;
+
+std::mutex HookProfiler::s_threadsMutex;
+std::vector<HookProfiler::RegisteredThread> HookProfiler::s_threads;
+
+static std::mutex s_statsMutex;
+static std::array<HookProfiler::HookStats, HookProfiler::MAX_HOOKS> s_lastFrame = {};
+static std::array<HookProfiler::HookStats, HookProfiler::MAX_HOOKS> s_totals = {};
+static std::array<float, HookProfiler::HISTORY_FRAMES> s_frameHistoryMs = {};
+static uint32_t s_historyOffset = 0;
+static uint64_t s_frameCount = 0;
+
+uint32_t HookProfiler::RegisterHook(const char* name) {
+    const uint32_t index = s_hookCount.load();
+    checkAssert(index < MAX_HOOKS, "Too many hooks registered for the hook profiler, increase HookProfiler::MAX_HOOKS!");
+    if (index == 0) {
+        s_startTicks = __rdtsc();
+        s_startTime = std::chrono::steady_clock::now();
+    }
+    s_hookNames[index] = name;
+    s_hookCount.store(index + 1);
+    return index;
+}
+
+HookProfiler::ThreadSlots& HookProfiler::GetThreadSlots() {
+    static thread_local ThreadSlots* t_slots = nullptr;
+    if (t_slots == nullptr) {
+        std::scoped_lock lock(s_threadsMutex);
+        auto& thread = s_threads.emplace_back(RegisteredThread{ std::make_unique<ThreadSlots>() });
+        t_slots = thread.slots.get();
+    }
+    return *t_slots;
+}
+
+void HookProfiler::Record(uint32_t index, uint64_t ticks, uint64_t allocations) {
+    // counters only grow and have a single writer, so plain load+store is enough and the merge works with deltas
+    ThreadSlot& slot = GetThreadSlots().hooks[index];
+    slot.calls.store(slot.calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slot.totalTicks.store(slot.totalTicks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    slot.allocations.store(slot.allocations.load(std::memory_order_relaxed) + allocations, std::memory_order_relaxed);
+    if (ticks > slot.maxTicks.load(std::memory_order_relaxed)) {
+        slot.maxTicks.store(ticks, std::memory_order_relaxed);
+    }
+}
+
+// -----------------------------------------------------------------------
+// Per-frame merge
+// -----------------------------------------------------------------------
+
+void HookProfiler::EndFrame() {
+    const uint32_t hookCount = s_hookCount.load();
+    std::array<HookStats, MAX_HOOKS> frame = {};
+
+    {
+        std::scoped_lock lock(s_threadsMutex);
+        for (RegisteredThread& thread : s_threads) {
+            for (uint32_t i = 0; i < hookCount; i++) {
+                ThreadSlot& slot = thread.slots->hooks[i];
+                HookStats current = {
+                    .calls = slot.calls.load(std::memory_order_relaxed),
+                    .totalTicks = slot.totalTicks.load(std::memory_order_relaxed),
+                    // the max is the only value that gets reset, a sample racing with this just lands in the next frame
+                    .maxTicks = slot.maxTicks.exchange(0, std::memory_order_relaxed),
+                    .allocations = slot.allocations.load(std::memory_order_relaxed),
+                };
+
+                HookStats& merged = thread.merged[i];
+                frame[i] += HookStats{
+                    .calls = current.calls - merged.calls,
+                    .totalTicks = current.totalTicks - merged.totalTicks,
+                    .maxTicks = current.maxTicks,
+                    .allocations = current.allocations - merged.allocations,
+                };
+                merged = current;
+            }
+        }
+    }
+
+    const double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - s_startTime).count();
+
+    std::scoped_lock lock(s_statsMutex);
+    if (elapsedSeconds > 0.5) {
+        s_ticksPerSecond = (double)(__rdtsc() - s_startTicks) / elapsedSeconds;
+    }
+
+    uint64_t frameTicks = 0;
+    for (uint32_t i = 0; i < hookCount; i++) {
+        frameTicks += frame[i].totalTicks;
+    }
+    s_lastFrame = frame;
+    Accumulate(s_totals, frame);
+    s_frameHistoryMs[s_historyOffset] = (float)TicksToMs(frameTicks, s_ticksPerSecond);
+    s_historyOffset = (s_historyOffset + 1) % HISTORY_FRAMES;
+    s_frameCount++;
+}
+
+HookProfiler::Snapshot HookProfiler::GetSnapshot() {
+    Snapshot snapshot;
+    snapshot.hookCount = s_hookCount.load();
+    snapshot.names = s_hookNames;
+
+    std::scoped_lock lock(s_statsMutex);
+    snapshot.lastFrame = s_lastFrame;
+    snapshot.totals = s_totals;
+    snapshot.frameHistoryMs = s_frameHistoryMs;
+    snapshot.historyOffset = s_historyOffset;
+    snapshot.frameCount = s_frameCount;
+    snapshot.ticksPerSecond = s_ticksPerSecond;
+    return snapshot;
+}
+
+#endif
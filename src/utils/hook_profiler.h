@@ -0,0 +1,129 @@
+#pragma once
+#include "pch.h"
+
+#include "frame_trace.h"
+
+#include <filesystem>
+#include <intrin.h>
+
+// Enabled through the BETTERVR_ENABLE_HOOK_PROFILER CMake option, otherwise the hooks get registered directly
+#ifndef ENABLE_HOOK_PROFILER
+#define ENABLE_HOOK_PROFILER 0
+#endif
+
+
+// Measures how long each registered HLE hook takes using rdtsc.
+// Each thread that runs hooks writes into its own slots without any synchronization besides relaxed atomics, and the
+// slots get merged into per-frame statistics once per game frame from hook_UpdateSettings.
+class HookProfiler {
+public:
+    static constexpr uint32_t MAX_HOOKS = 128;
+    static constexpr uint32_t HISTORY_FRAMES = 120;
+
+    using HookFunction = void (*)(PPCInterpreter_t* hCPU);
+
+    struct HookStats {
+        uint64_t calls = 0;
+        uint64_t totalTicks = 0;
+        uint64_t maxTicks = 0;
+        uint64_t allocations = 0;
+
+        HookStats& operator+=(const HookStats& other) {
+            calls += other.calls;
+            totalTicks += other.totalTicks;
+            maxTicks = std::max(maxTicks, other.maxTicks);
+            allocations += other.allocations;
+            return *this;
+        }
+    };
+
+    // Returns the function to register with Cemu, which is either the hook itself or a trampoline that times it and/or
+    // records it as a span in the frame trace
+    template <HookFunction Hook>
+    static HookFunction Wrap(const char* name) {
+#if ENABLE_HOOK_PROFILER || ENABLE_FRAME_TRACE
+        Trampoline<Hook>::s_name = name;
+#if ENABLE_HOOK_PROFILER
+        Trampoline<Hook>::s_index = RegisterHook(name);
+#endif
+        return &Trampoline<Hook>::Call;
+#else
+        return Hook;
+#endif
+    }
+
+    // Copy of the merged statistics, which the overlay and the CSV export work from
+    struct Snapshot {
+        uint32_t hookCount = 0;
+        std::array<const char*, MAX_HOOKS> names = {};
+        std::array<HookStats, MAX_HOOKS> lastFrame = {};
+        std::array<HookStats, MAX_HOOKS> totals = {};
+        std::array<float, HISTORY_FRAMES> frameHistoryMs = {};
+        uint32_t historyOffset = 0;
+        uint64_t frameCount = 0;
+        double ticksPerSecond = 0.0;
+    };
+
+    static void EndFrame();
+    static Snapshot GetSnapshot();
+    static void DrawOverlay();
+    static bool DumpCSV(const std::filesystem::path& path);
+
+    // Called by the global allocator replacement so that hooks can be blamed for the allocations they make
+    static void OnAllocation() {
+#if ENABLE_HOOK_PROFILER
+        t_allocations++;
+#endif
+    }
+
+    // Pure aggregation helpers, split out so that they don't depend on any thread state
+    static void Accumulate(std::span<HookStats> totals, std::span<const HookStats> frame);
+    static double TicksToMs(uint64_t ticks, double ticksPerSecond) { return ticksPerSecond > 0.0 ? (double)ticks * 1000.0 / ticksPerSecond : 0.0; }
+
+private:
+    // Only ever written by the owning thread, the per-frame merge reads and resets them
+    struct ThreadSlot {
+        std::atomic_uint64_t calls = 0;
+        std::atomic_uint64_t totalTicks = 0;
+        std::atomic_uint64_t maxTicks = 0;
+        std::atomic_uint64_t allocations = 0;
+    };
+
+    struct ThreadSlots {
+        std::array<ThreadSlot, MAX_HOOKS> hooks;
+    };
+
+    // threads are never unregistered since their last samples still need to be merged, and Cemu's threads live as long as the game anyway
+    struct RegisteredThread {
+        std::unique_ptr<ThreadSlots> slots;
+        std::array<HookStats, MAX_HOOKS> merged = {};
+    };
+    static std::mutex s_threadsMutex;
+    static std::vector<RegisteredThread> s_threads;
+
+    static uint32_t RegisterHook(const char* name);
+    static ThreadSlots& GetThreadSlots();
+    static void Record(uint32_t index, uint64_t ticks, uint64_t allocations);
+
+    template <HookFunction Hook>
+    struct Trampoline {
+        static inline uint32_t s_index = 0;
+        static inline const char* s_name = nullptr;
+
+        static void Call(PPCInterpreter_t* hCPU) {
+#if ENABLE_FRAME_TRACE
+            FrameTrace::Scope scope(s_name);
+#endif
+#if ENABLE_HOOK_PROFILER
+            const uint64_t allocationsBefore = t_allocations;
+            const uint64_t start = __rdtsc();
+            Hook(hCPU);
+            Record(s_index, __rdtsc() - start, t_allocations - allocationsBefore);
+#else
+            Hook(hCPU);
+#endif
+        }
+    };
+
+    static inline thread_local uint64_t t_allocations = 0;
+};
@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "hook_profiler.h"
+
+#include <fstream>
+
+#if ENABLE_HOOK_PROFILER
+
+// -----------------------------------------------------------------------
+// Overlay and CSV export
+// -----------------------------------------------------------------------
+
+void HookProfiler::DrawOverlay() {
+    if (!ImGui::Begin("Hook Profiler")) {
+        ImGui::End();
+        return;
+    }
+
+    const Snapshot snapshot = GetSnapshot();
+    const uint32_t hookCount = snapshot.hookCount;
+    const double ticksPerSecond = snapshot.ticksPerSecond;
+
+    ImGui::Text("TSC: %.3f GHz", ticksPerSecond / 1e9);
+    ImGui::SameLine();
+    if (ImGui::Button("Dump CSV")) {
+        DumpCSV("BetterVR_HookProfile.csv");
+    }
+
+    if (ImPlot::BeginPlot("##HookTime", ImVec2(-1, 120), ImPlotFlags_NoTitle | ImPlotFlags_NoMenus | ImPlotFlags_NoBoxSelect | ImPlotFlags_NoLegend)) {
+        ImPlot::SetupAxes(nullptr, "ms", ImPlotAxisFlags_NoDecorations, ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxisLimits(ImAxis_X1, 0, HISTORY_FRAMES, ImPlotCond_Always);
+        ImPlot::PlotShaded("Hooks", snapshot.frameHistoryMs.data(), HISTORY_FRAMES, 0.0, 1.0, 0.0, 0, snapshot.historyOffset);
+        ImPlot::EndPlot();
+    }
+
+    std::array<uint32_t, MAX_HOOKS> order;
+    for (uint32_t i = 0; i < hookCount; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.begin() + hookCount, [&](uint32_t a, uint32_t b) { return snapshot.lastFrame[a].totalTicks > snapshot.lastFrame[b].totalTicks; });
+
+    if (ImGui::BeginTable("##Hooks", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Hook");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Total (ms)");
+        ImGui::TableSetupColumn("Avg (us)");
+        ImGui::TableSetupColumn("Max (us)");
+        ImGui::TableSetupColumn("Allocs");
+        ImGui::TableHeadersRow();
+
+        for (uint32_t i = 0; i < hookCount; i++) {
+            const HookStats& stats = snapshot.lastFrame[order[i]];
+            const double totalMs = TicksToMs(stats.totalTicks, ticksPerSecond);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(snapshot.names[order[i]]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", stats.calls);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", totalMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats.calls ? totalMs * 1000.0 / (double)stats.calls : 0.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", TicksToMs(stats.maxTicks, ticksPerSecond) * 1000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", stats.allocations);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+bool HookProfiler::DumpCSV(const std::filesystem::path& path) {
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        Log::print<ERROR>("Couldn't open {} to write the hook profile to", path.string());
+        return false;
+    }
+
+    const Snapshot snapshot = GetSnapshot();
+    file << "hook,calls,calls_per_frame,total_ms,ms_per_frame,avg_us,max_us,allocations\n";
+    for (uint32_t i = 0; i < snapshot.hookCount; i++) {
+        const HookStats& stats = snapshot.totals[i];
+        const double totalMs = TicksToMs(stats.totalTicks, snapshot.ticksPerSecond);
+        const double frames = (double)std::max<uint64_t>(snapshot.frameCount, 1);
+        file << std::format("{},{},{:.2f},{:.3f},{:.4f},{:.3f},{:.3f},{}\n",
+            snapshot.names[i], stats.calls, (double)stats.calls / frames, totalMs, totalMs / frames,
+            stats.calls ? totalMs * 1000.0 / (double)stats.calls : 0.0, TicksToMs(stats.maxTicks, snapshot.ticksPerSecond) * 1000.0, stats.allocations);
+    }
+
+    Log::print<INFO>("Wrote hook profile of {} frames to {}", snapshot.frameCount, path.string());
+    return true;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+// included by logger.h from the precompiled header, so this one only pulls in what it uses itself
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+
+enum class LogType {
+    // verbose logging types
+    RENDERING,
+    INTEROP,
+    CONTROLS,
+    PPC,
+    XR_DEBUGUTILS,
+
+    // generic types
+    INFO,
+    WARNING,
+    ERROR,
+    VERBOSE
+};
+
+using enum LogType;
+
+// The part of the logger that decides whether a message gets printed at all, kept apart from the Windows console and file
+// output so that the host tests can use the same filtering as the layer.
+class LogFilter {
+public:
+    // Categories that are compiled in at all, which ones of these get printed is decided at runtime by the enabled mask
+    template <LogType L>
+    static inline bool consteval isLogTypeEnabled() {
+        if constexpr (L == XR_DEBUGUTILS) {
+            return false;
+        }
+        return true;
+    }
+
+    static constexpr uint32_t getTypeBit(LogType type) {
+        return 1u << std::to_underlying(type);
+    }
+
+    static constexpr uint32_t getDefaultEnabledMask() {
+#if defined(_DEBUG)
+        return getTypeBit(ERROR) | getTypeBit(WARNING) | getTypeBit(INFO) | getTypeBit(VERBOSE);
+#else
+        return getTypeBit(ERROR) | getTypeBit(WARNING) | getTypeBit(INFO);
+#endif
+    }
+
+    static const char* getTypeName(LogType type) {
+        switch (type) {
+            case RENDERING:
+                return "Rendering";
+            case INTEROP:
+                return "Interop";
+            case CONTROLS:
+                return "Controls";
+            case PPC:
+                return "PPC";
+            case XR_DEBUGUTILS:
+                return "XR Debug Utils";
+            case INFO:
+                return "Info";
+            case WARNING:
+                return "Warning";
+            case ERROR:
+                return "Error";
+            case VERBOSE:
+                return "Verbose";
+            default:
+                return "";
+        }
+    }
+
+    // errors can't be turned off
+    static void setEnabledMask(uint32_t mask) {
+        enabledMask.store(mask | getTypeBit(ERROR), std::memory_order_relaxed);
+    }
+
+    static uint32_t getEnabledMask() {
+        return enabledMask.load(std::memory_order_relaxed);
+    }
+
+    template <LogType L>
+    static inline bool isEnabled() {
+        if constexpr (!isLogTypeEnabled<L>()) {
+            return false;
+        }
+        else {
+            return (enabledMask.load(std::memory_order_relaxed) & getTypeBit(L)) != 0;
+        }
+    }
+
+private:
+    static inline std::atomic_uint32_t enabledMask = getDefaultEnabledMask();
+};
+
+// Skips evaluating the arguments and formatting entirely unless the category is enabled, e.g.
+// LOG_LAZY(CONTROLS, "{} is dropping weapon {}", readActorName(actorPtr), weaponIdx);
+#define LOG_LAZY(type, ...)                \
+    do {                                   \
+        if (Log::isEnabled<type>()) {      \
+            Log::print<type>(__VA_ARGS__); \
+        }                                  \
+    } while (0)
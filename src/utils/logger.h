@@ -1,5 +1,6 @@
 #pragma once
 #include "vkroots.h"
+#include "log_filter.h"
 #include <fstream>
 
 template <>
@@ -206,60 +207,16 @@ struct std::formatter<D3D_FEATURE_LEVEL> : std::formatter<string> {
     }
 };
 
-enum class LogType {
-    // verbose logging types
-    RENDERING,
-    INTEROP,
-    CONTROLS,
-    PPC,
-    XR_DEBUGUTILS,
-
-    // generic types
-    INFO,
-    WARNING,
-    ERROR,
-    VERBOSE
-};
-
-using enum LogType;
 ENABLE_BITMASK_OPERATORS(LogType);
 
-class Log {
+class Log : public LogFilter {
 public:
     Log();
     ~Log();
 
-    template <typename LogType L>
-    static inline bool consteval isLogTypeEnabled() {
-        if constexpr (L == ERROR) {
-            return true;
-        }
-        if constexpr (L == WARNING) {
-            return true;
-        }
-        if constexpr (L == INFO) {
-            return true;
-        }
-#if defined(_DEBUG)
-        if constexpr (L == VERBOSE) {
-            return true;
-        }
-        //if constexpr (L == RENDERING) {
-        //    return true;
-        //}
-        //if constexpr (L == CONTROLS) {
-        //    return true;
-        //}
-        //if constexpr (L == PPC) {
-        //    return true;
-        //}
-#endif
-        return false;
-    }
-
     template <typename LogType L>
     static inline void print(const char* message) {
-        if constexpr (!isLogTypeEnabled<L>()) {
+        if (!isEnabled<L>()) {
             return;
         }
         std::lock_guard<std::mutex> lock(logMutex);
@@ -284,9 +241,10 @@ public:
 #endif
     }
 
+    // Arguments are still evaluated when the category is disabled, use LOG_LAZY when that is expensive
     template <typename LogType L, class... Args>
     static inline void print(const char* format, Args&&... args) {
-        if constexpr (!isLogTypeEnabled<L>()) {
+        if (!isEnabled<L>()) {
             return;
         }
         Log::print<L>(std::vformat(format, std::make_format_args(args...)).c_str());
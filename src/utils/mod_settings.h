@@ -1,4 +1,5 @@
 #pragma once
+#include "depth_submission.h"
 
 class ModSettingBase {
 public:
@@ -372,6 +373,39 @@ public:
     }
 };
 
+// Bitmask of the enabled log categories, every change gets pushed to the logger right away
+class LogCategoriesSetting : public UIntSetting<uint32_t> {
+public:
+    LogCategoriesSetting(const char* name): UIntSetting<uint32_t>(name, Log::getDefaultEnabledMask()) {
+        Log::setEnabledMask(this->defaultValue);
+    }
+
+    void Set(const uint32_t value) override {
+        UIntSetting<uint32_t>::Set(value);
+        Log::setEnabledMask(this->Get());
+    }
+
+    void AddToGUI(bool* changed) {
+        constexpr auto categories = std::to_array<LogType>({ INFO, WARNING, VERBOSE, RENDERING, INTEROP, CONTROLS, PPC });
+        bool first = true;
+        for (LogType category : categories) {
+            if (first) {
+                first = false;
+            }
+            else {
+                ImGui::SameLine();
+            }
+            const uint32_t bit = Log::getTypeBit(category);
+            bool enabled = (this->Get() & bit) != 0;
+            std::string idStr = std::format("{}##{}", Log::getTypeName(category), this->name);
+            if (ImGui::Checkbox(idStr.c_str(), &enabled)) {
+                this->Set(enabled ? (this->Get() | bit) : (this->Get() & ~bit));
+                *changed = true;
+            }
+        }
+    }
+};
+
 template <typename T>
 concept IsEnum = std::is_enum_v<T>;
 
@@ -502,6 +536,12 @@ enum class AngularVelocityFixerMode : int32_t {
     FORCED_OFF = 2,
 };
 
+enum class XrFramePacingMode : int32_t {
+    INLINE = 0, // The XR frame runs on Cemu's thread when it presents
+    STRICT = 1, // Separate thread, every game frame gets submitted
+    LATEST_WINS = 2, // Separate thread, only the newest game frame gets submitted
+};
+
 enum class PerformanceOverlayMode : int32_t {
     DISABLE = 0,
     WINDOW_ONLY = 1,
@@ -607,6 +647,58 @@ struct ModSettings {
         }
     }
 
+    static const char* toString(DepthSubmissionMode depthSubmission) {
+        switch (depthSubmission) {
+            case DepthSubmissionMode::AUTO:
+                return "AUTO";
+            case DepthSubmissionMode::FORCED_ON:
+                return "FORCED_ON";
+            case DepthSubmissionMode::FORCED_OFF:
+                return "FORCED_OFF";
+            default:
+                return "";
+        }
+    }
+
+    static const char* toDisplayString(DepthSubmissionMode depthSubmission) {
+        switch (depthSubmission) {
+            case DepthSubmissionMode::AUTO:
+                return "Auto (When The Runtime Uses It)";
+            case DepthSubmissionMode::FORCED_ON:
+                return "Always";
+            case DepthSubmissionMode::FORCED_OFF:
+                return "Never";
+            default:
+                return "";
+        }
+    }
+
+    static const char* toString(XrFramePacingMode framePacing) {
+        switch (framePacing) {
+            case XrFramePacingMode::INLINE:
+                return "INLINE";
+            case XrFramePacingMode::STRICT:
+                return "STRICT";
+            case XrFramePacingMode::LATEST_WINS:
+                return "LATEST_WINS";
+            default:
+                return "";
+        }
+    }
+
+    static const char* toDisplayString(XrFramePacingMode framePacing) {
+        switch (framePacing) {
+            case XrFramePacingMode::INLINE:
+                return "On Cemu's Thread";
+            case XrFramePacingMode::STRICT:
+                return "Separate Thread (Every Frame)";
+            case XrFramePacingMode::LATEST_WINS:
+                return "Separate Thread (Newest Frame)";
+            default:
+                return "";
+        }
+    }
+
     static const char* toString(PerformanceOverlayMode performanceOverlay) {
         switch (performanceOverlay) {
             case PerformanceOverlayMode::DISABLE:
@@ -650,12 +742,22 @@ struct ModSettings {
     FloatSetting<float> hudDistance = FloatSetting<float>("HudDistance", 1.85f, 0.5f, 2.5f);
     FloatSetting<float> hudSize = FloatSetting<float>("HudSize", 0.85f, 0.4f, 1.75f);
     BoolSetting cropFlatTo16x9 = BoolSetting("CropFlatTo16x9", true);
+    BoolSetting predictHandPoses = BoolSetting("PredictHandPoses", true);
 
     // advanced settings
     BoolSetting enableDebugOverlay = BoolSetting("EnableDebugOverlay", false);
+    BoolSetting dynamicResolution = BoolSetting("DynamicResolution", false);
+    BoolSetting alternateEyeRendering = BoolSetting("AlternateEyeRendering", false);
+    // the HUD is only rendered to the headset every Nth frame outside of menus, its position is still updated every frame
+    UIntSetting<uint32_t> hudUpdateDivider = UIntSetting<uint32_t>("HudUpdateDivider", 1, 1, 4);
     EnumSetting<AngularVelocityFixerMode> buggyAngularVelocity = EnumSetting<AngularVelocityFixerMode>("BuggyAngularVelocity", AngularVelocityFixerMode::AUTO, ModSettings::toString, { AngularVelocityFixerMode::AUTO, AngularVelocityFixerMode::FORCED_ON, AngularVelocityFixerMode::FORCED_OFF });
+    EnumSetting<DepthSubmissionMode> depthSubmission = EnumSetting<DepthSubmissionMode>("DepthSubmission", DepthSubmissionMode::AUTO, ModSettings::toString, { DepthSubmissionMode::AUTO, DepthSubmissionMode::FORCED_ON, DepthSubmissionMode::FORCED_OFF });
+    EnumSetting<XrFramePacingMode> xrFramePacing = EnumSetting<XrFramePacingMode>("XrFramePacing", XrFramePacingMode::INLINE, ModSettings::toString, { XrFramePacingMode::INLINE, XrFramePacingMode::STRICT, XrFramePacingMode::LATEST_WINS });
+    // how many game frames can be copied to the headset's textures before the oldest one has to be submitted, 2 to 4
+    UIntSetting<uint32_t> framesInFlight = UIntSetting<uint32_t>("FramesInFlight", 2, 2, 4);
     EnumSetting<PerformanceOverlayMode> performanceOverlay = EnumSetting<PerformanceOverlayMode>("PerformanceOverlay", PerformanceOverlayMode::DISABLE, ModSettings::toString, { PerformanceOverlayMode::DISABLE, PerformanceOverlayMode::WINDOW_ONLY, PerformanceOverlayMode::WINDOW_AND_VR });
     UIntSetting<uint32_t> performanceOverlayFrequency = UIntSetting<uint32_t>("PerformanceOverlayFrequency", 90);
+    LogCategoriesSetting logCategories = LogCategoriesSetting("LogCategories");
     BoolSetting tutorialPromptShown = BoolSetting("TutorialPromptShown", false);
 
     // Input settings
@@ -675,10 +777,18 @@ struct ModSettings {
             &hudDistance,
             &hudSize,
             &cropFlatTo16x9,
+            &predictHandPoses,
             &enableDebugOverlay,
+            &dynamicResolution,
+            &alternateEyeRendering,
+            &hudUpdateDivider,
             &buggyAngularVelocity,
+            &depthSubmission,
+            &xrFramePacing,
+            &framesInFlight,
             &performanceOverlay,
             &performanceOverlayFrequency,
+            &logCategories,
             &tutorialPromptShown,
             &axisThreshold,
             &stickDeadzone 
@@ -707,9 +817,16 @@ struct ModSettings {
     }
     bool UseBlackBarsForCutscenes() const { return useBlackBarsForCutscenes; }
     bool ShouldFlatPreviewBeCroppedTo16x9() const { return cropFlatTo16x9 == 1; }
+    bool ShouldPredictHandPoses() const { return predictHandPoses; }
 
     bool ShowDebugOverlay() const { return enableDebugOverlay; }
+    bool UseDynamicResolution() const { return dynamicResolution; }
+    bool UseAlternateEyeRendering() const { return alternateEyeRendering; }
+    uint32_t GetHudUpdateDivider() const { return hudUpdateDivider; }
     AngularVelocityFixerMode AngularVelocityFixer_GetMode() const { return buggyAngularVelocity; }
+    DepthSubmissionMode GetDepthSubmissionMode() const { return depthSubmission; }
+    XrFramePacingMode GetXrFramePacingMode() const { return xrFramePacing; }
+    uint32_t GetFramesInFlight() const { return framesInFlight; }
 
     // By default BotW's camera uses 0.1f for near plane and 25000.0f for far plane, except maybe some indoor areas? But for simplicity, we'll use the default values everywhere.
     float GetZNear() const { return 0.1f; }
@@ -723,12 +840,19 @@ struct ModSettings {
         std::format_to(std::back_inserter(buffer), " - Player Height: {} meters\n", GetPlayerHeightOffset());
         std::format_to(std::back_inserter(buffer), " - Crop Flat to 16:9: {}\n", ShouldFlatPreviewBeCroppedTo16x9() ? "Yes" : "No");
         std::format_to(std::back_inserter(buffer), " - Debug Overlay: {}\n", ShowDebugOverlay() ? "Enabled" : "Disabled");
+        std::format_to(std::back_inserter(buffer), " - Dynamic Resolution: {}\n", UseDynamicResolution() ? "Enabled" : "Disabled");
+        std::format_to(std::back_inserter(buffer), " - Alternate Eye Rendering: {}\n", UseAlternateEyeRendering() ? "Enabled" : "Disabled");
+        std::format_to(std::back_inserter(buffer), " - HUD Update Divider: {}\n", GetHudUpdateDivider());
         std::format_to(std::back_inserter(buffer), " - Cutscene Camera Mode: {}\n", toDisplayString(GetCutsceneCameraMode()));
         std::format_to(std::back_inserter(buffer), " - Show Black Bars for Third-Person Cutscenes: {}\n", UseBlackBarsForCutscenes() ? "Yes" : "No");
+        std::format_to(std::back_inserter(buffer), " - Depth Submission: {}\n", toDisplayString(GetDepthSubmissionMode()));
+        std::format_to(std::back_inserter(buffer), " - XR Frame Loop: {}\n", toDisplayString(GetXrFramePacingMode()));
+        std::format_to(std::back_inserter(buffer), " - Frames In Flight: {}\n", GetFramesInFlight());
         std::format_to(std::back_inserter(buffer), " - Performance Overlay: {}\n", toDisplayString(performanceOverlay));
         std::format_to(std::back_inserter(buffer), " - Performance Overlay Frequency: {} Hz\n", performanceOverlayFrequency.Get());
         std::format_to(std::back_inserter(buffer), " - Stick Direction Threshold: {}\n", axisThreshold.Get());
         std::format_to(std::back_inserter(buffer), " - Thumbstick Deadzone: {}\n", stickDeadzone.Get());
+        std::format_to(std::back_inserter(buffer), " - Predict Hand Movement: {}\n", ShouldPredictHandPoses() ? "Yes" : "No");
         return buffer;
     }
 };
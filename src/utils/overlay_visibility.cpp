@@ -0,0 +1,18 @@
+#include "pch.h"
+#include "overlay_visibility.h"
+
+
+OverlayVisibility::Decision OverlayVisibility::Decide(const State& state) {
+    if (IsAnythingVisible(state) || !state.hudKeepsAlpha) {
+        m_settleFrames = SETTLE_FRAMES;
+        m_renderedFrames++;
+        return Decision::RENDER;
+    }
+    if (m_settleFrames > 0) {
+        m_settleFrames--;
+        m_renderedFrames++;
+        return Decision::RENDER;
+    }
+    m_directCopyFrames++;
+    return Decision::DIRECT_COPY;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "pch.h"
+
+
+// Decides whether the ImGui pass that composites BetterVR's windows onto the headset's HUD layer has to run. When none of
+// them are visible, that pass would only redraw the game's HUD onto itself, so the HUD image can be submitted directly.
+// This only works while the 3D layer is behind the HUD, since the HUD's alpha is replaced with an opaque one otherwise.
+// After the last window disappears a couple more frames are rendered, so that ImGui can finish closing its windows.
+class OverlayVisibility {
+public:
+    static constexpr uint32_t SETTLE_FRAMES = 2;
+
+    enum class Decision : uint8_t {
+        RENDER,
+        DIRECT_COPY,
+    };
+
+    struct State {
+        bool menuOpen = false;
+        bool helpNotificationVisible = false;
+        bool debugOverlays = false;
+        bool performanceOverlay = false; // only counts when it's also shown in the headset
+        bool gameImageComposited = false; // e.g. the black bars during events, which draw the 3D image onto the HUD
+        bool hudKeepsAlpha = false;       // the 3D layer is rendered behind the HUD
+    };
+
+    static bool IsAnythingVisible(const State& state) {
+        return state.menuOpen || state.helpNotificationVisible || state.debugOverlays || state.performanceOverlay || state.gameImageComposited;
+    }
+
+    // Only the menu and the debug windows take mouse input, the other overlays are drawn with ImGuiWindowFlags_NoInputs.
+    static bool TakesMouseInput(const State& state) {
+        return state.menuOpen || state.debugOverlays;
+    }
+
+    Decision Decide(const State& state);
+
+    uint64_t GetRenderedFrames() const { return m_renderedFrames; }
+    uint64_t GetDirectCopyFrames() const { return m_directCopyFrames; }
+
+private:
+    uint32_t m_settleFrames = SETTLE_FRAMES; // ImGui hasn't rendered anything yet at startup either
+    std::atomic_uint64_t m_renderedFrames = 0;
+    std::atomic_uint64_t m_directCopyFrames = 0;
+};
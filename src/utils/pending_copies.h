@@ -0,0 +1,99 @@
+#pragma once
+#include "pch.h"
+
+
+// Tracks the interop copies that were recorded into command buffers, but weren't submitted yet. Every command buffer owns a
+// Buffer (stored in its vkroots user data), so that QueueSubmit only looks at the buffers it's actually submitting. The
+// buffers that hold copies are also registered here, which is what lets a command pool reset or destruction drop the copies
+// of all of its buffers, since Vulkan resets those implicitly without passing the command buffers along.
+// Recording into and submitting a command buffer are externally synchronized by Vulkan, and so is resetting its pool, so
+// only the registry itself needs a lock. It's only taken when a buffer gets its first copy or loses its last one.
+template <typename Pool, typename Copy>
+class PendingCopyTracker {
+public:
+    class Buffer {
+    public:
+        explicit Buffer(Pool pool): m_pool(pool) {}
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        Pool GetPool() const { return m_pool; }
+        const std::vector<Copy>& GetCopies() const { return m_copies; }
+
+    private:
+        friend class PendingCopyTracker;
+        const Pool m_pool;
+        std::vector<Copy> m_copies;
+        size_t m_registryIndex = 0; // only valid while there are copies
+    };
+
+    PendingCopyTracker() = default;
+    PendingCopyTracker(const PendingCopyTracker&) = delete;
+    PendingCopyTracker& operator=(const PendingCopyTracker&) = delete;
+
+    void Add(Buffer& buffer, const Copy& copy) {
+        if (buffer.m_copies.empty()) {
+            std::lock_guard lk(m_mutex);
+            buffer.m_registryIndex = m_buffers.size();
+            m_buffers.emplace_back(&buffer);
+            m_bufferCount.store((uint32_t)m_buffers.size(), std::memory_order_relaxed);
+        }
+        buffer.m_copies.emplace_back(copy);
+    }
+
+    // Drops the copies of a command buffer that got reset, freed or re-recorded before it was submitted
+    void Clear(Buffer& buffer) {
+        if (buffer.m_copies.empty()) {
+            return;
+        }
+        std::lock_guard lk(m_mutex);
+        Unregister(buffer);
+    }
+
+    // Calls onCopy for every copy of a submitted command buffer in the order they were recorded and then clears them
+    template <typename OnCopy>
+    void Consume(Buffer& buffer, OnCopy&& onCopy) {
+        for (const Copy& copy : buffer.m_copies) {
+            onCopy(copy);
+        }
+        Clear(buffer);
+    }
+
+    // Drops the copies of every command buffer that was allocated from the pool, returns how many buffers had copies
+    uint32_t ClearPool(Pool pool) {
+        if (!HasPendingCopies()) {
+            return 0;
+        }
+        std::lock_guard lk(m_mutex);
+        uint32_t cleared = 0;
+        for (size_t i = 0; i < m_buffers.size();) {
+            if (m_buffers[i]->m_pool == pool) {
+                // the last buffer is swapped into this index, so it has to be checked again
+                Unregister(*m_buffers[i]);
+                cleared++;
+            }
+            else {
+                i++;
+            }
+        }
+        return cleared;
+    }
+
+    // Cheap enough to check on every QueueSubmit, before looking at any of the submitted command buffers
+    bool HasPendingCopies() const { return m_bufferCount.load(std::memory_order_relaxed) != 0; }
+    uint32_t GetBufferCount() const { return m_bufferCount.load(std::memory_order_relaxed); }
+
+private:
+    void Unregister(Buffer& buffer) {
+        buffer.m_copies.clear();
+        Buffer* last = m_buffers.back();
+        m_buffers[buffer.m_registryIndex] = last;
+        last->m_registryIndex = buffer.m_registryIndex;
+        m_buffers.pop_back();
+        m_bufferCount.store((uint32_t)m_buffers.size(), std::memory_order_relaxed);
+    }
+
+    std::mutex m_mutex;
+    std::vector<Buffer*> m_buffers;
+    std::atomic_uint32_t m_bufferCount = 0;
+};
@@ -0,0 +1,135 @@
+#include "pch.h"
+#include "pose_history.h"
+
+
+// -----------------------------------------------------------------------
+// Ring
+// -----------------------------------------------------------------------
+
+void PoseHistory::Reset() {
+    m_head = 0;
+    m_count = 0;
+}
+
+void PoseHistory::Add(XrTime time, const glm::fvec3& position, const glm::fquat& orientation) {
+    if (m_count > 0) {
+        const XrTime latestTime = GetLatest().time;
+        if (time <= latestTime) {
+            return;
+        }
+        if (time - latestTime > MAX_GAP_NS) {
+            Reset();
+        }
+    }
+
+    m_samples[m_head] = { .time = time, .position = position, .orientation = glm::normalize(orientation) };
+    m_head = (m_head + 1) % CAPACITY;
+    m_count = std::min(m_count + 1, CAPACITY);
+}
+
+// -----------------------------------------------------------------------
+// Least-squares estimation
+// -----------------------------------------------------------------------
+
+// axis * angle of a rotation, taking the short way around
+static glm::dvec3 ToRotationVector(glm::dquat q) {
+    if (q.w < 0.0) {
+        q = -q;
+    }
+    const glm::dvec3 axis = { q.x, q.y, q.z };
+    const double sinHalfAngle = glm::length(axis);
+    if (sinHalfAngle < 1e-12) {
+        return axis * 2.0;
+    }
+    return axis * (2.0 * std::atan2(sinHalfAngle, q.w) / sinHalfAngle);
+}
+
+namespace {
+    // First and second derivative at t = 0 of the polynomial that fits the values best
+    struct Derivatives {
+        glm::dvec3 first = {};
+        glm::dvec3 second = {};
+    };
+
+    // Fits y = a + b*t + c*t^2, or a line when there aren't enough (distinct) samples for a quadratic.
+    // Times are expected to be scaled to roughly [-1, 0] so that the normal equations stay well conditioned.
+    Derivatives FitQuadratic(std::span<const double> times, std::span<const glm::dvec3> values) {
+        double s[5] = {};
+        glm::dvec3 ty[3] = {};
+        for (size_t i = 0; i < times.size(); i++) {
+            const double t = times[i];
+            const double t2 = t * t;
+            s[0] += 1.0;
+            s[1] += t;
+            s[2] += t2;
+            s[3] += t2 * t;
+            s[4] += t2 * t2;
+            ty[0] += values[i];
+            ty[1] += values[i] * t;
+            ty[2] += values[i] * t2;
+        }
+
+        if (times.size() >= 3) {
+            // glm matrices are column-major, but the normal matrix is symmetric anyway
+            const glm::dmat3 normal = { s[0], s[1], s[2], s[1], s[2], s[3], s[2], s[3], s[4] };
+            if (std::abs(glm::determinant(normal)) > 1e-9) {
+                const glm::dmat3 inverse = glm::inverse(normal);
+                Derivatives result;
+                for (int axis = 0; axis < 3; axis++) {
+                    const glm::dvec3 coefficients = inverse * glm::dvec3(ty[0][axis], ty[1][axis], ty[2][axis]);
+                    result.first[axis] = coefficients[1];
+                    result.second[axis] = 2.0 * coefficients[2];
+                }
+                return result;
+            }
+        }
+
+        const double denominator = s[0] * s[2] - s[1] * s[1];
+        if (std::abs(denominator) < 1e-12) {
+            return {};
+        }
+        return { .first = (s[0] * ty[1] - s[1] * ty[0]) / denominator };
+    }
+}
+
+PoseHistory::Motion PoseHistory::Estimate(XrTime at, XrDuration window) const {
+    Motion motion;
+    if (m_count < 2 || window <= 0) {
+        return motion;
+    }
+
+    const Sample& latest = GetLatest();
+    const glm::dquat inverseReference = glm::inverse(glm::dquat(latest.orientation));
+    const double windowSeconds = (double)window * 1e-9;
+
+    std::array<double, CAPACITY> times;
+    std::array<glm::dvec3, CAPACITY> positions;
+    std::array<glm::dvec3, CAPACITY> rotations;
+    uint32_t count = 0;
+    for (uint32_t age = 0; age < m_count; age++) {
+        const Sample& sample = GetFromLatest(age);
+        if (latest.time - sample.time > window) {
+            break;
+        }
+        times[count] = (double)(sample.time - at) * 1e-9 / windowSeconds;
+        positions[count] = glm::dvec3(sample.position - latest.position);
+        // the rotations are small relative to the latest sample, so their rotation vectors can be fitted component-wise
+        rotations[count] = ToRotationVector(glm::dquat(sample.orientation) * inverseReference);
+        count++;
+    }
+    if (count < 2) {
+        return motion;
+    }
+
+    const Derivatives linear = FitQuadratic(std::span(times.data(), count), std::span(positions.data(), count));
+    const Derivatives angular = FitQuadratic(std::span(times.data(), count), std::span(rotations.data(), count));
+
+    // undo the scaling of the times
+    motion.valid = true;
+    motion.sampleCount = count;
+    motion.linearVelocity = glm::fvec3(linear.first / windowSeconds);
+    motion.linearAcceleration = glm::fvec3(linear.second / (windowSeconds * windowSeconds));
+    motion.angularVelocity = glm::fvec3(angular.first / windowSeconds);
+    motion.angularAcceleration = glm::fvec3(angular.second / (windowSeconds * windowSeconds));
+    return motion;
+}
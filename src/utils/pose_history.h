@@ -0,0 +1,50 @@
+#pragma once
+#include "pch.h"
+
+
+// Timestamped ring of the last poses of one tracked device (the headset or a controller).
+// Velocities and accelerations get estimated by least-squares fitting a quadratic over the samples in a time window,
+// which smooths the jitter of single frame differences and doesn't care about irregular spacing or dropped frames.
+// Positions and velocities are in the space the poses were located in (stage space), angular velocities are world space.
+class PoseHistory {
+public:
+    static constexpr uint32_t CAPACITY = 32;
+    static constexpr XrDuration DEFAULT_WINDOW_NS = 60'000'000;
+    // gaps longer than this (tracking loss, pauses) drop the older samples instead of fitting across them
+    static constexpr XrDuration MAX_GAP_NS = 250'000'000;
+
+    struct Sample {
+        XrTime time = 0;
+        glm::fvec3 position = {};
+        glm::fquat orientation = glm::identity<glm::fquat>();
+    };
+
+    struct Motion {
+        bool valid = false;
+        uint32_t sampleCount = 0; // a single sample gives no motion, two only give velocities
+        glm::fvec3 linearVelocity = {};
+        glm::fvec3 linearAcceleration = {};
+        glm::fvec3 angularVelocity = {};
+        glm::fvec3 angularAcceleration = {};
+    };
+
+    void Reset();
+
+    // Samples that aren't newer than the latest one are ignored
+    void Add(XrTime time, const glm::fvec3& position, const glm::fquat& orientation);
+    void Add(XrTime time, const XrPosef& pose) { Add(time, ToGLM(pose.position), ToGLM(pose.orientation)); }
+
+    // Fits the samples from the window that ends at the latest sample and evaluates the fit at the given time
+    Motion Estimate(XrTime at, XrDuration window = DEFAULT_WINDOW_NS) const;
+
+    uint32_t Size() const { return m_count; }
+    bool IsEmpty() const { return m_count == 0; }
+    const Sample& GetLatest() const { return m_samples[(m_head + CAPACITY - 1) % CAPACITY]; }
+    // 0 is the latest sample
+    const Sample& GetFromLatest(uint32_t age) const { return m_samples[(m_head + CAPACITY - 1 - age) % CAPACITY]; }
+
+private:
+    std::array<Sample, CAPACITY> m_samples = {};
+    uint32_t m_head = 0;
+    uint32_t m_count = 0;
+};
@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "pose_predictor.h"
+
+
+static glm::fvec3 ClampLength(const glm::fvec3& vec, float maxLength) {
+    const float length = glm::length(vec);
+    return length > maxLength ? vec * (maxLength / length) : vec;
+}
+
+float PosePredictor::GetConfidence(const PoseHistory::Motion& motion) {
+    if (!motion.valid || motion.sampleCount < 2) {
+        return 0.0f;
+    }
+
+    float confidence = std::min(1.0f, (float)(motion.sampleCount - 1) / (float)(FULL_CONFIDENCE_SAMPLES - 1));
+
+    // accelerations beyond what a hand can do come from jitter or a tracking glitch, the further beyond the less trustworthy
+    const float linearAcceleration = glm::length(motion.linearAcceleration);
+    if (linearAcceleration > MAX_LINEAR_ACCELERATION) {
+        confidence *= MAX_LINEAR_ACCELERATION / linearAcceleration;
+    }
+    const float angularAcceleration = glm::length(motion.angularAcceleration);
+    if (angularAcceleration > MAX_ANGULAR_ACCELERATION) {
+        confidence *= MAX_ANGULAR_ACCELERATION / angularAcceleration;
+    }
+    return confidence;
+}
+
+XrPosef PosePredictor::Predict(const XrPosef& pose, const PoseHistory::Motion& motion, XrDuration horizon) {
+    const float confidence = GetConfidence(motion);
+    if (confidence <= 0.0f || horizon <= 0) {
+        return pose;
+    }
+
+    const float seconds = (float)std::min(horizon, MAX_HORIZON_NS) * 1e-9f;
+    const glm::fvec3 linearAcceleration = ClampLength(motion.linearAcceleration, MAX_LINEAR_ACCELERATION);
+    const glm::fvec3 angularAcceleration = ClampLength(motion.angularAcceleration, MAX_ANGULAR_ACCELERATION);
+
+    const glm::fvec3 translation = motion.linearVelocity * seconds + 0.5f * linearAcceleration * seconds * seconds;
+    const glm::fvec3 rotationVector = ClampLength(motion.angularVelocity * seconds + 0.5f * angularAcceleration * seconds * seconds, MAX_ROTATION);
+
+    // the angular velocity is in world space, so the extra rotation gets applied on the left
+    const glm::fquat orientation = ToGLM(pose.orientation);
+    glm::fquat predictedOrientation = orientation;
+    const float angle = glm::length(rotationVector);
+    if (angle > 1e-6f) {
+        predictedOrientation = glm::normalize(glm::angleAxis(angle, rotationVector / angle) * orientation);
+    }
+
+    const glm::fvec3 position = ToGLM(pose.position);
+    const glm::fvec3 blendedPosition = position + translation * confidence;
+    const glm::fquat blendedOrientation = glm::slerp(orientation, predictedOrientation, confidence);
+
+    XrPosef predicted;
+    predicted.position = { blendedPosition.x, blendedPosition.y, blendedPosition.z };
+    predicted.orientation = { blendedOrientation.x, blendedOrientation.y, blendedOrientation.z, blendedOrientation.w };
+    return predicted;
+}
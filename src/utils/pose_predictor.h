@@ -0,0 +1,24 @@
+#pragma once
+#include "pch.h"
+#include "pose_history.h"
+
+
+// Extrapolates a tracked pose along the motion estimated by PoseHistory.
+// The extrapolation length is clamped, and the result is blended back towards the measured pose when the estimate is
+// based on too few samples or reports implausible accelerations, so that a bad estimate degrades into the raw pose
+// instead of making the hands overshoot.
+class PosePredictor {
+public:
+    static constexpr XrDuration MAX_HORIZON_NS = 50'000'000;
+    // number of fitted samples needed before the prediction is fully trusted
+    static constexpr uint32_t FULL_CONFIDENCE_SAMPLES = 4;
+    // fast sword swings peak at around 100 m/s^2, anything far above that is tracking noise
+    static constexpr float MAX_LINEAR_ACCELERATION = 150.0f;
+    static constexpr float MAX_ANGULAR_ACCELERATION = 400.0f;
+    static constexpr float MAX_ROTATION = 1.0471976f; // 60 degrees
+
+    // 0 means that the measured pose should be used as is, 1 that the prediction can be used as is
+    static float GetConfidence(const PoseHistory::Motion& motion);
+
+    static XrPosef Predict(const XrPosef& pose, const PoseHistory::Motion& motion, XrDuration horizon);
+};
@@ -0,0 +1,53 @@
+#include "pch.h"
+#include "staging_ring.h"
+
+
+StagingRing::StagingRing(uint64_t capacity): m_capacity(capacity) {
+}
+
+std::optional<uint64_t> StagingRing::Allocate(uint64_t size, uint64_t alignment, uint64_t fenceValue) {
+    if (!Fits(size)) {
+        return std::nullopt;
+    }
+
+    // the head only catches up with the oldest region from behind after wrapping around, equal means that the ring is full
+    const uint64_t tail = m_regions.empty() ? 0 : m_regions.front().begin;
+    const bool wrapped = !m_regions.empty() && m_head <= tail;
+
+    const uint64_t offset = AlignUp(m_head, alignment);
+    if (!wrapped && offset + size <= m_capacity) {
+        m_regions.push_back({ .begin = m_head, .end = offset + size, .fenceValue = fenceValue });
+        m_head = offset + size;
+        return offset;
+    }
+    if (!wrapped && size <= tail) {
+        // the rest of the buffer is skipped and gets freed along with this region
+        m_regions.push_back({ .begin = m_head, .end = size, .fenceValue = fenceValue });
+        m_head = size;
+        return 0;
+    }
+    if (wrapped && offset + size <= tail) {
+        m_regions.push_back({ .begin = m_head, .end = offset + size, .fenceValue = fenceValue });
+        m_head = offset + size;
+        return offset;
+    }
+    return std::nullopt;
+}
+
+void StagingRing::Retire(uint64_t completedFenceValue) {
+    while (!m_regions.empty() && m_regions.front().fenceValue <= completedFenceValue) {
+        m_regions.pop_front();
+    }
+    // starting over at the beginning gives the next allocations the whole buffer without wrapping around
+    if (m_regions.empty()) {
+        m_head = 0;
+    }
+}
+
+uint64_t StagingRing::GetUsedBytes() const {
+    if (m_regions.empty()) {
+        return 0;
+    }
+    const uint64_t tail = m_regions.front().begin;
+    return m_head > tail ? m_head - tail : m_capacity - tail + m_head;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "pch.h"
+
+
+// Suballocates upload regions from one fixed-size staging buffer, in the order they're recorded. Every region is tagged with
+// the fence value of the work that reads from it, and Retire frees the oldest regions once their fence value completed. Space
+// is only reused after everything allocated before it got retired, so a region that the GPU might still read from is never
+// handed out again. A region that doesn't fit at the end of the buffer wraps around to the start and the skipped bytes are
+// freed along with it.
+class StagingRing {
+public:
+    explicit StagingRing(uint64_t capacity);
+
+    // Returns the offset of the region, or nullopt if the free space can't fit it right now (or ever, see Fits)
+    std::optional<uint64_t> Allocate(uint64_t size, uint64_t alignment, uint64_t fenceValue);
+    void Retire(uint64_t completedFenceValue);
+
+    // Whether a region of this size fits into the ring once it's empty, offset 0 satisfies every alignment
+    bool Fits(uint64_t size) const { return size > 0 && size <= m_capacity; }
+    uint64_t GetCapacity() const { return m_capacity; }
+    // includes the bytes that were skipped for alignment and wrapping around
+    uint64_t GetUsedBytes() const;
+    size_t GetRegionCount() const { return m_regions.size(); }
+
+    static uint64_t AlignUp(uint64_t value, uint64_t alignment) { return alignment <= 1 ? value : (value + alignment - 1) / alignment * alignment; }
+
+private:
+    struct Region {
+        uint64_t begin = 0; // where the previous region ended, so the padding in front of it belongs to this region
+        uint64_t end = 0;
+        uint64_t fenceValue = 0;
+    };
+
+    const uint64_t m_capacity;
+    std::deque<Region> m_regions; // oldest first
+    uint64_t m_head = 0;          // where the next region starts
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include "pch.h"
+
+
+// Turns a VR controller stick into the digital stick directions of the gamepad. A direction is pressed once the stick passes
+// the axis threshold and stays pressed until it drops below half of it. Pressing is a pure function of the stick and the
+// directions that were already held, and feeding its result back in gives the same result again, so the input hook can keep
+// the previous directions for as long as the stick didn't change (see ActionChangeGate).
+namespace StickEmulation {
+    enum Direction : uint8_t {
+        NONE = 0,
+        LEFT = 1 << 0,
+        RIGHT = 1 << 1,
+        DOWN = 1 << 2,
+        UP = 1 << 3,
+    };
+
+    inline float ApplyDeadzone(float value, float deadzone) {
+        return std::abs(value) < deadzone ? 0.0f : value;
+    }
+
+    inline uint8_t EmulateDirections(float x, float y, uint8_t held, float axisThreshold) {
+        const float holdThreshold = axisThreshold * 0.5f;
+        uint8_t directions = NONE;
+        if (x <= -axisThreshold || ((held & LEFT) != 0 && x <= -holdThreshold))
+            directions |= LEFT;
+        else if (x >= axisThreshold || ((held & RIGHT) != 0 && x >= holdThreshold))
+            directions |= RIGHT;
+
+        if (y <= -axisThreshold || ((held & DOWN) != 0 && y <= -holdThreshold))
+            directions |= DOWN;
+        else if (y >= axisThreshold || ((held & UP) != 0 && y >= holdThreshold))
+            directions |= UP;
+        return directions;
+    }
+}
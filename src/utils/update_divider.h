@@ -0,0 +1,24 @@
+#pragma once
+#include "pch.h"
+
+
+// Decides which frames a layer that doesn't have to change every frame gets re-rendered on, e.g. the HUD quad with the
+// HudUpdateDivider setting. Skipped frames keep submitting the layer with its last image, so until an update was actually
+// presented every frame updates. A forced update renders right away and restarts the count.
+class UpdateDivider {
+public:
+    bool ShouldUpdate(uint32_t divider, bool force) {
+        m_framesSinceUpdate++;
+        if (!m_hasUpdated || force || m_framesSinceUpdate >= divider) {
+            m_framesSinceUpdate = 0;
+            return true;
+        }
+        return false;
+    }
+
+    void OnUpdated() { m_hasUpdated = true; }
+
+private:
+    bool m_hasUpdated = false;
+    uint32_t m_framesSinceUpdate = 0;
+};
@@ -0,0 +1,113 @@
+#include "pch.h"
+#include "fake_openxr_loader.h"
+#include "rendering/xr_backend.h"
+#include "utils/action_change_gate.h"
+#include "utils/stick_emulation.h"
+
+#include <cstdio>
+
+
+// Polls both sticks every frame like OpenXR::UpdateActions, collecting the changed bits, and then runs the stick stage of
+// hook_InjectXRInput, with the left stick evaluated either for every frame or only when ActionChangeGate asks for it. The
+// player only moves a stick every few frames, which is about what the gate sees during normal play.
+
+constexpr uint32_t FRAMES = 2'000'000;
+constexpr uint32_t STICKS = 2;
+constexpr uint32_t FRAMES_PER_CHANGE = 8;
+
+class PollingBackend final : public XrBackend {
+public:
+    const char* GetName() const override { return "Polling"; }
+
+    XrResult CreateSession(XrInstance, const XrSessionCreateInfo*, XrSession*) override { return XR_SUCCESS; }
+    XrResult BeginSession(XrSession, const XrSessionBeginInfo*) override { return XR_SUCCESS; }
+    XrResult EndSession(XrSession) override { return XR_SUCCESS; }
+    XrResult RequestExitSession(XrSession) override { return XR_SUCCESS; }
+    XrResult WaitFrame(XrSession, const XrFrameWaitInfo*, XrFrameState*) override { return XR_SUCCESS; }
+    XrResult BeginFrame(XrSession, const XrFrameBeginInfo*) override { return XR_SUCCESS; }
+    XrResult EndFrame(XrSession, const XrFrameEndInfo*) override { return XR_SUCCESS; }
+
+    XrResult SyncActions(XrSession, const XrActionsSyncInfo*) override {
+        for (uint32_t i = 0; i < STICKS; i++) {
+            changed[i] = synced[i].x != physical[i].x || synced[i].y != physical[i].y;
+            synced[i] = physical[i];
+        }
+        return XR_SUCCESS;
+    }
+    XrResult GetActionStateBoolean(XrSession, const XrActionStateGetInfo*, XrActionStateBoolean*) override { return XR_SUCCESS; }
+    XrResult GetActionStateFloat(XrSession, const XrActionStateGetInfo*, XrActionStateFloat*) override { return XR_SUCCESS; }
+    XrResult GetActionStateVector2f(XrSession, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) override {
+        const uint32_t index = (uint32_t)(uintptr_t)getInfo->action;
+        state->currentState = synced[index];
+        state->changedSinceLastSync = changed[index] ? XR_TRUE : XR_FALSE;
+        state->isActive = XR_TRUE;
+        return XR_SUCCESS;
+    }
+    XrResult GetActionStatePose(XrSession, const XrActionStateGetInfo*, XrActionStatePose*) override { return XR_SUCCESS; }
+    XrResult LocateSpace(XrSpace, XrSpace, XrTime, XrSpaceLocation*) override { return XR_SUCCESS; }
+    XrResult LocateViews(XrSession, const XrViewLocateInfo*, XrViewState*, uint32_t, uint32_t*, XrView*) override { return XR_SUCCESS; }
+    XrResult PollEvent(XrInstance, XrEventDataBuffer*) override { return XR_EVENT_UNAVAILABLE; }
+    XrResult ApplyHapticFeedback(XrSession, const XrHapticActionInfo*, const XrHapticBaseHeader*) override { return XR_SUCCESS; }
+    XrResult StopHapticFeedback(XrSession, const XrHapticActionInfo*) override { return XR_SUCCESS; }
+
+    std::array<XrVector2f, STICKS> physical = {};
+    std::array<XrVector2f, STICKS> synced = {};
+    std::array<bool, STICKS> changed = {};
+};
+
+struct Key {
+    bool blocked;
+    float axisThreshold;
+    bool operator==(const Key&) const = default;
+};
+
+static double Run(bool gated, uint64_t& directionSum) {
+    PollingBackend backend;
+    ActionChangeGate<Key> gate;
+    uint8_t leftDirections = StickEmulation::NONE;
+    uint8_t rightDirections = StickEmulation::NONE;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        if (frame % FRAMES_PER_CHANGE == 0) {
+            const float t = (float)frame * 0.001f;
+            backend.physical[frame / FRAMES_PER_CHANGE % 2] = { std::sin(t), std::cos(t) };
+        }
+
+        XrActionsSyncInfo syncInfo = MakeXrStruct<XrActionsSyncInfo>(XR_TYPE_ACTIONS_SYNC_INFO);
+        backend.SyncActions(XR_NULL_HANDLE, &syncInfo);
+        uint32_t changedActions = 0;
+        std::array<XrActionStateVector2f, 2> sticks;
+        for (uint32_t i = 0; i < 2; i++) {
+            XrActionStateGetInfo getInfo = MakeXrStruct<XrActionStateGetInfo>(XR_TYPE_ACTION_STATE_GET_INFO);
+            getInfo.action = (XrAction)(uintptr_t)i;
+            sticks[i] = MakeXrStruct<XrActionStateVector2f>(XR_TYPE_ACTION_STATE_VECTOR2F);
+            backend.GetActionStateVector2f(XR_NULL_HANDLE, &getInfo, &sticks[i]);
+            if (sticks[i].changedSinceLastSync == XR_TRUE) {
+                changedActions |= 1u << i;
+            }
+        }
+
+        for (XrActionStateVector2f& stick : sticks) {
+            stick.currentState.x = StickEmulation::ApplyDeadzone(stick.currentState.x, 0.15f);
+            stick.currentState.y = StickEmulation::ApplyDeadzone(stick.currentState.y, 0.15f);
+        }
+        if (!gated || gate.ShouldRun(frame + 1, changedActions, 0b01, { false, 0.6f })) {
+            leftDirections = StickEmulation::EmulateDirections(sticks[0].currentState.x, sticks[0].currentState.y, leftDirections, 0.6f);
+        }
+        rightDirections = StickEmulation::EmulateDirections(sticks[1].currentState.x, sticks[1].currentState.y, rightDirections, 0.6f);
+        directionSum += leftDirections + rightDirections;
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+}
+
+int main() {
+    uint64_t ungatedSum = 0;
+    uint64_t gatedSum = 0;
+    const double ungated = Run(false, ungatedSum);
+    const double gated = Run(true, gatedSum);
+
+    std::printf("poll + stick stage, every frame: %.2f ns per frame\n", ungated);
+    std::printf("poll + stick stage, gated:       %.2f ns per frame (%s)\n", gated, ungatedSum == gatedSum ? "same directions" : "DIFFERENT DIRECTIONS");
+    return 0;
+}
@@ -0,0 +1,282 @@
+#include "test_framework.h"
+#include "fake_openxr_loader.h"
+#include "rendering/xr_backend.h"
+#include "utils/action_change_gate.h"
+#include "utils/stick_emulation.h"
+
+#include <random>
+
+
+// Replays the left stick path of hook_InjectXRInput against a mock backend, once re-evaluating the stick emulation for every
+// hook and once only when ActionChangeGate asks for it, and checks that both always press the same directions. The right
+// stick is polled as well, so that its changes show up in the bits without concerning the left stick.
+
+enum StickAction : uint32_t {
+    MOVE,
+    CAMERA,
+    NAVIGATE,
+    SCROLL,
+    STICK_ACTION_COUNT
+};
+
+constexpr float DEADZONE = 0.15f;
+constexpr float AXIS_THRESHOLD = 0.6f;
+
+template <typename Handle>
+static Handle MakeHandle(uint64_t value) {
+    return (Handle)(uintptr_t)value;
+}
+
+// Reports changedSinceLastSync like a runtime does: relative to the value the action had during the previous sync
+class MockBackend final : public XrBackend {
+public:
+    const char* GetName() const override { return "Mock"; }
+
+    XrResult CreateSession(XrInstance, const XrSessionCreateInfo*, XrSession*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult BeginSession(XrSession, const XrSessionBeginInfo*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult EndSession(XrSession) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult RequestExitSession(XrSession) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult WaitFrame(XrSession, const XrFrameWaitInfo*, XrFrameState*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult BeginFrame(XrSession, const XrFrameBeginInfo*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult EndFrame(XrSession, const XrFrameEndInfo*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+
+    XrResult SyncActions(XrSession, const XrActionsSyncInfo*) override {
+        for (uint32_t i = 0; i < STICK_ACTION_COUNT; i++) {
+            changed[i] = synced[i].x != physical[i].x || synced[i].y != physical[i].y;
+            synced[i] = physical[i];
+        }
+        syncCount++;
+        return XR_SUCCESS;
+    }
+    XrResult GetActionStateBoolean(XrSession, const XrActionStateGetInfo*, XrActionStateBoolean*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult GetActionStateFloat(XrSession, const XrActionStateGetInfo*, XrActionStateFloat*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult GetActionStateVector2f(XrSession, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) override {
+        const uint32_t index = (uint32_t)(uintptr_t)getInfo->action - 1;
+        state->currentState = synced[index];
+        state->changedSinceLastSync = changed[index] ? XR_TRUE : XR_FALSE;
+        state->isActive = XR_TRUE;
+        return XR_SUCCESS;
+    }
+    XrResult GetActionStatePose(XrSession, const XrActionStateGetInfo*, XrActionStatePose*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult LocateSpace(XrSpace, XrSpace, XrTime, XrSpaceLocation*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult LocateViews(XrSession, const XrViewLocateInfo*, XrViewState*, uint32_t, uint32_t*, XrView*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult PollEvent(XrInstance, XrEventDataBuffer*) override { return XR_EVENT_UNAVAILABLE; }
+    XrResult ApplyHapticFeedback(XrSession, const XrHapticActionInfo*, const XrHapticBaseHeader*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+    XrResult StopHapticFeedback(XrSession, const XrHapticActionInfo*) override { return XR_ERROR_FUNCTION_UNSUPPORTED; }
+
+    std::array<XrVector2f, STICK_ACTION_COUNT> physical = {};
+    std::array<XrVector2f, STICK_ACTION_COUNT> synced = {};
+    std::array<bool, STICK_ACTION_COUNT> changed = {};
+    uint32_t syncCount = 0;
+};
+
+// The parts of OpenXR::InputState that the stick path reads
+struct StickInputState {
+    bool inGame = true;
+    std::array<XrActionStateVector2f, STICK_ACTION_COUNT> sticks = {};
+    uint32_t changedActions = 0;
+    uint32_t syncIndex = 0;
+};
+
+// The same steps as OpenXR::UpdateActions for the sticks of the active action set
+static void UpdateActions(XrBackend& backend, uint32_t& syncCount, StickInputState& stored, bool inMenu) {
+    XrActionsSyncInfo syncInfo = MakeXrStruct<XrActionsSyncInfo>(XR_TYPE_ACTIONS_SYNC_INFO);
+    backend.SyncActions(XR_NULL_HANDLE, &syncInfo);
+
+    StickInputState newState = stored;
+    newState.syncIndex = ++syncCount;
+    newState.inGame = !inMenu;
+    newState.changedActions = 0;
+    for (StickAction action : inMenu ? std::array{ NAVIGATE, SCROLL } : std::array{ MOVE, CAMERA }) {
+        XrActionStateGetInfo getInfo = MakeXrStruct<XrActionStateGetInfo>(XR_TYPE_ACTION_STATE_GET_INFO);
+        getInfo.action = MakeHandle<XrAction>(action + 1);
+        XrActionStateVector2f& state = newState.sticks[action];
+        state = MakeXrStruct<XrActionStateVector2f>(XR_TYPE_ACTION_STATE_VECTOR2F);
+        backend.GetActionStateVector2f(XR_NULL_HANDLE, &getInfo, &state);
+        if (state.changedSinceLastSync == XR_TRUE) {
+            newState.changedActions |= 1u << action;
+        }
+    }
+    stored = newState;
+}
+
+struct StickKey {
+    bool inGame;
+    bool blocked;
+    float deadzone;
+    float axisThreshold;
+    bool operator==(const StickKey&) const = default;
+};
+
+// The left stick path of hook_InjectXRInput, returns the state that it writes back, so another sync can land in between
+struct Hook {
+    bool gated = false;
+    ActionChangeGate<StickKey> gate;
+    uint8_t directions = StickEmulation::NONE;
+    uint32_t evaluations = 0;
+
+    StickInputState Begin(const StickInputState& stored, bool blocked, float deadzone, float axisThreshold) {
+        StickInputState inputs = stored;
+        const StickAction action = inputs.inGame ? MOVE : NAVIGATE;
+        XrVector2f& stick = inputs.sticks[action].currentState;
+        stick.x = StickEmulation::ApplyDeadzone(stick.x, deadzone);
+        stick.y = StickEmulation::ApplyDeadzone(stick.y, deadzone);
+        if (blocked) {
+            stick = { 0.0f, 0.0f };
+        }
+
+        if (!gated || gate.ShouldRun(inputs.syncIndex, inputs.changedActions, 1u << action, { inputs.inGame, blocked, deadzone, axisThreshold })) {
+            directions = StickEmulation::EmulateDirections(stick.x, stick.y, directions, axisThreshold);
+            evaluations++;
+        }
+        return inputs;
+    }
+};
+
+// One side of the comparison, the gated and the ungated world see exactly the same events
+struct World {
+    MockBackend backend;
+    StickInputState stored;
+    uint32_t syncCount = 0;
+    Hook hook;
+};
+
+static float RandomStickValue(std::minstd_rand& rng) {
+    // mostly values near the deadzone and the thresholds, where the hysteresis matters
+    constexpr std::array<float, 12> INTERESTING = { 0.0f, 0.1f, 0.15f, 0.29f, 0.3f, 0.31f, 0.59f, 0.6f, 0.61f, 1.0f, 0.45f, 0.2f };
+    const float value = INTERESTING[rng() % INTERESTING.size()];
+    return (rng() & 1) ? -value : value;
+}
+
+static void RunEquivalence(uint32_t seed, uint32_t steps, uint32_t& hooks, uint32_t& skipped) {
+    std::minstd_rand rng(seed);
+    std::array<World, 2> worlds;
+    worlds[1].hook.gated = true;
+
+    bool inMenu = false;
+    bool blocked = false;
+    float deadzone = DEADZONE;
+    float axisThreshold = AXIS_THRESHOLD;
+    for (uint32_t step = 0; step < steps; step++) {
+        const uint32_t event = rng() % 100;
+        if (event < 25) {
+            // the player moves a stick, the runtime only reports it with the next sync
+            const uint32_t action = rng() % STICK_ACTION_COUNT;
+            const XrVector2f value = { RandomStickValue(rng), RandomStickValue(rng) };
+            for (World& world : worlds) {
+                world.backend.physical[action] = value;
+            }
+        }
+        else if (event < 55) {
+            // some frames sync several times between two hooks, which the gate has to notice from the sync index
+            if (rng() % 20 == 0) {
+                inMenu = !inMenu;
+            }
+            for (World& world : worlds) {
+                UpdateActions(world.backend, world.syncCount, world.stored, inMenu);
+            }
+        }
+        else if (event < 90) {
+            if (rng() % 30 == 0) {
+                blocked = !blocked;
+            }
+            // the settings change rarely, but the hook writes the values with the old deadzone back
+            if (rng() % 200 == 0) {
+                axisThreshold = axisThreshold == AXIS_THRESHOLD ? 0.5f : AXIS_THRESHOLD;
+            }
+            if (rng() % 200 == 0) {
+                deadzone = deadzone == DEADZONE ? 0.3f : DEADZONE;
+            }
+            const bool raceWithNextSync = rng() % 8 == 0;
+            std::array<StickInputState, 2> writeBack;
+            for (uint32_t i = 0; i < worlds.size(); i++) {
+                writeBack[i] = worlds[i].hook.Begin(worlds[i].stored, blocked, deadzone, axisThreshold);
+                if (!raceWithNextSync) {
+                    worlds[i].stored = writeBack[i];
+                }
+            }
+            CHECK(worlds[0].hook.directions == worlds[1].hook.directions);
+            if (raceWithNextSync) {
+                // a sync lands between the hook reading and writing back the state, the write back loses it
+                for (uint32_t i = 0; i < worlds.size(); i++) {
+                    UpdateActions(worlds[i].backend, worlds[i].syncCount, worlds[i].stored, inMenu);
+                    worlds[i].stored = writeBack[i];
+                }
+            }
+        }
+        else {
+            // the hook doesn't run for a few syncs while the game is loading
+            const uint32_t syncs = 1 + rng() % 3;
+            for (uint32_t sync = 0; sync < syncs; sync++) {
+                for (World& world : worlds) {
+                    UpdateActions(world.backend, world.syncCount, world.stored, inMenu);
+                }
+            }
+        }
+    }
+    hooks += worlds[0].hook.evaluations;
+    skipped += (uint32_t)worlds[1].hook.gate.GetSkipCount();
+    CHECK(worlds[1].hook.evaluations + worlds[1].hook.gate.GetSkipCount() == worlds[0].hook.evaluations);
+}
+
+TEST_CASE(GatedStickEmulationMatchesEvaluatingEveryHook) {
+    uint32_t hooks = 0;
+    uint32_t skipped = 0;
+    for (uint32_t seed = 1; seed <= 200; seed++) {
+        RunEquivalence(seed, 2000, hooks, skipped);
+    }
+    // syncs, misses and races are far more frequent here than in the game, but the gate still has to skip a good part
+    CHECK(skipped * 3 > hooks);
+}
+
+TEST_CASE(GateRunsOnlyForRelevantChangesOnTheNextSync) {
+    ActionChangeGate<int> gate;
+    CHECK(gate.ShouldRun(1, 0, 0b0011, 0));
+    CHECK(!gate.ShouldRun(1, 0, 0b0011, 0));
+    // the sync after the key changed always runs, the hook might have changed the values of the first one
+    CHECK(gate.ShouldRun(2, 0, 0b0011, 0));
+    CHECK(!gate.ShouldRun(3, 0b0100, 0b0011, 0));
+    CHECK(gate.ShouldRun(4, 0b0001, 0b0011, 0));
+    CHECK(!gate.ShouldRun(4, 0b0001, 0b0011, 0));
+    CHECK(gate.GetSkipCount() == 3);
+}
+
+TEST_CASE(GateRunsAfterMissedSyncsAndKeyChanges) {
+    ActionChangeGate<int> gate;
+    CHECK(gate.ShouldRun(1, 0, 0b0011, 0));
+    CHECK(gate.ShouldRun(2, 0, 0b0011, 0));
+    // the bits of sync 4 don't say anything about what changed during sync 3
+    CHECK(gate.ShouldRun(4, 0, 0b0011, 0));
+    // a write back that lost a sync makes the next index skip one as well
+    CHECK(gate.ShouldRun(6, 0, 0b0011, 0));
+    CHECK(gate.ShouldRun(6, 0, 0b0011, 1));
+    CHECK(!gate.ShouldRun(6, 0, 0b0011, 1));
+    CHECK(gate.ShouldRun(7, 0, 0b0011, 1));
+    CHECK(!gate.ShouldRun(8, 0, 0b0011, 1));
+    gate.Reset();
+    CHECK(gate.ShouldRun(9, 0, 0b0011, 1));
+}
+
+TEST_CASE(EmulatedDirectionsAreStableWhenFedBack) {
+    // the gate relies on this: evaluating the same stick again with its own result doesn't change the directions
+    for (float x = -1.0f; x <= 1.0f; x += 0.01f) {
+        for (float y = -1.0f; y <= 1.0f; y += 0.05f) {
+            for (uint8_t held = 0; held < 16; held++) {
+                const uint8_t once = StickEmulation::EmulateDirections(x, y, held, AXIS_THRESHOLD);
+                CHECK(StickEmulation::EmulateDirections(x, y, once, AXIS_THRESHOLD) == once);
+            }
+        }
+    }
+}
+
+TEST_CASE(EmulatedDirectionsHoldUntilHalfTheThreshold) {
+    using namespace StickEmulation;
+    CHECK(EmulateDirections(0.59f, 0.0f, NONE, AXIS_THRESHOLD) == NONE);
+    CHECK(EmulateDirections(0.6f, 0.0f, NONE, AXIS_THRESHOLD) == RIGHT);
+    CHECK(EmulateDirections(0.31f, 0.0f, RIGHT, AXIS_THRESHOLD) == RIGHT);
+    CHECK(EmulateDirections(0.29f, 0.0f, RIGHT, AXIS_THRESHOLD) == NONE);
+    CHECK(EmulateDirections(0.0f, -0.6f, NONE, AXIS_THRESHOLD) == DOWN);
+    CHECK(EmulateDirections(-0.4f, 0.4f, LEFT | UP, AXIS_THRESHOLD) == (LEFT | UP));
+    CHECK(ApplyDeadzone(0.14f, DEADZONE) == 0.0f);
+    CHECK(ApplyDeadzone(-0.15f, DEADZONE) == -0.15f);
+}
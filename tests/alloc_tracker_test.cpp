@@ -0,0 +1,181 @@
+#include "test_framework.h"
+#include "utils/alloc_tracker.h"
+#include "utils/pending_copies.h"
+
+
+// The tracker replaces the global operator new of this test, so everything the tests allocate is counted. Its counters are
+// global, so every test registers its own scopes and only looks at the frames it ended itself.
+
+static void* volatile s_sink = nullptr;
+
+// calls operator new directly, since new expressions that are deleted right away may be optimized out
+static void Allocate(uint32_t count, size_t bytes = 16) {
+    for (uint32_t i = 0; i < count; i++) {
+        void* ptr = ::operator new(bytes);
+        s_sink = ptr;
+        ::operator delete(ptr);
+    }
+}
+
+TEST_CASE(SteadyStateSubmitFrameMakesNoAllocations) {
+    // the per-frame work of QueueSubmit: copies get recorded into a few command buffers, which are then submitted
+    using Tracker = PendingCopyTracker<uint32_t, uint64_t>;
+    Tracker tracker;
+    std::array<Tracker::Buffer, 3> buffers = { Tracker::Buffer(1), Tracker::Buffer(1), Tracker::Buffer(2) };
+    uint64_t consumed = 0;
+
+    const uint32_t scope = AllocTracker::RegisterScope("Test::SubmitFrame", 0);
+    auto runFrame = [&](uint64_t frame) {
+        AllocTracker::Scope allocScope(scope);
+        for (Tracker::Buffer& buffer : buffers) {
+            for (uint64_t copy = 0; copy < 4; copy++) {
+                tracker.Add(buffer, frame * 4 + copy);
+            }
+        }
+        if (tracker.HasPendingCopies()) {
+            for (Tracker::Buffer& buffer : buffers) {
+                tracker.Consume(buffer, [&](uint64_t copy) { consumed += copy; });
+            }
+        }
+    };
+
+    // the first frame grows the vectors, after that their capacity gets reused
+    runFrame(0);
+    AllocTracker::EndFrame();
+    CHECK(AllocTracker::GetFrameCounts(scope).allocations > 0);
+
+    for (uint64_t frame = 1; frame < 100; frame++) {
+        runFrame(frame);
+        AllocTracker::EndFrame();
+        const AllocTracker::Counts counts = AllocTracker::GetFrameCounts(scope);
+        CHECK(counts.allocations == 0);
+        CHECK(counts.bytes == 0);
+    }
+    CHECK(consumed > 0);
+    CHECK(!tracker.HasPendingCopies());
+
+    // and the zero above isn't just the tracker missing allocations
+    {
+        AllocTracker::Scope allocScope(scope);
+        std::vector<uint32_t> rebuilt(16);
+        s_sink = rebuilt.data();
+    }
+    AllocTracker::EndFrame();
+    CHECK(AllocTracker::GetFrameCounts(scope).allocations == 1);
+    CHECK(AllocTracker::GetFrameCounts(scope).bytes == 16 * sizeof(uint32_t));
+}
+
+TEST_CASE(AllocationsAreBlamedOnTheInnermostScope) {
+    const uint32_t outer = AllocTracker::RegisterScope("Test::Outer");
+    const uint32_t inner = AllocTracker::RegisterScope("Test::Inner");
+    // registering a name again returns the same scope
+    CHECK(AllocTracker::RegisterScope("Test::Outer") == outer);
+    CHECK(inner != outer);
+
+    AllocTracker::EndFrame();
+    {
+        AllocTracker::Scope outerScope(outer);
+        Allocate(1, 100);
+        {
+            AllocTracker::Scope innerScope(inner);
+            Allocate(2, 10);
+        }
+        Allocate(3, 1);
+    }
+    AllocTracker::EndFrame();
+
+    CHECK(AllocTracker::GetFrameCounts(outer).allocations == 4);
+    CHECK(AllocTracker::GetFrameCounts(outer).bytes == 103);
+    CHECK(AllocTracker::GetFrameCounts(inner).allocations == 2);
+    CHECK(AllocTracker::GetFrameCounts(inner).bytes == 20);
+
+    // the counts only cover the last frame
+    AllocTracker::EndFrame();
+    CHECK(AllocTracker::GetFrameCounts(outer).allocations == 0);
+    CHECK(AllocTracker::GetFrameCounts(inner).allocations == 0);
+}
+
+TEST_CASE(BudgetOverrunsAreFlagged) {
+    const uint32_t scope = AllocTracker::RegisterScope("Test::Budgeted", 2);
+    AllocTracker::EndFrame();
+
+    auto runFrame = [&](uint32_t allocations) {
+        {
+            AllocTracker::Scope allocScope(scope);
+            Allocate(allocations);
+        }
+        AllocTracker::EndFrame();
+        return AllocTracker::GetSnapshot();
+    };
+
+    // reaching the budget is fine
+    AllocTracker::Snapshot snapshot = runFrame(2);
+    CHECK(snapshot.budgets[scope] == 2);
+    CHECK(!AllocTracker::IsOverBudget(snapshot.lastFrame[scope], snapshot.budgets[scope]));
+    CHECK(snapshot.lastWarningFrame[scope] == 0);
+
+    // going over it gets flagged and warned about in the frame it happened
+    snapshot = runFrame(3);
+    CHECK(AllocTracker::IsOverBudget(snapshot.lastFrame[scope], snapshot.budgets[scope]));
+    CHECK(snapshot.lastWarningFrame[scope] == snapshot.frameCount);
+    const uint64_t warningFrame = snapshot.lastWarningFrame[scope];
+
+    // a scope that stays over its budget is still flagged every frame, but doesn't flood the log
+    snapshot = runFrame(5);
+    CHECK(AllocTracker::IsOverBudget(snapshot.lastFrame[scope], snapshot.budgets[scope]));
+    CHECK(snapshot.lastWarningFrame[scope] == warningFrame);
+
+    snapshot = runFrame(0);
+    CHECK(!AllocTracker::IsOverBudget(snapshot.lastFrame[scope], snapshot.budgets[scope]));
+
+    // without a budget nothing is flagged
+    AllocTracker::SetBudget(scope, AllocTracker::NO_BUDGET);
+    snapshot = runFrame(50);
+    CHECK(snapshot.lastFrame[scope].allocations == 50);
+    CHECK(!AllocTracker::IsOverBudget(snapshot.lastFrame[scope], snapshot.budgets[scope]));
+
+    // the unscoped bucket never has a budget
+    CHECK(snapshot.budgets[0] == AllocTracker::NO_BUDGET);
+    CHECK(std::strcmp(snapshot.names[0], "(unscoped)") == 0);
+    CHECK(std::strcmp(snapshot.names[scope], "Test::Budgeted") == 0);
+}
+
+TEST_CASE(AllocationsOfEveryThreadAreSummed) {
+    constexpr uint32_t THREADS = 4;
+    constexpr uint32_t ALLOCATIONS = 25;
+    const uint32_t scope = AllocTracker::RegisterScope("Test::Threaded", THREADS * ALLOCATIONS);
+    AllocTracker::EndFrame();
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&]() {
+            AllocTracker::Scope allocScope(scope);
+            Allocate(ALLOCATIONS, 8);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    AllocTracker::EndFrame();
+
+    const AllocTracker::Snapshot snapshot = AllocTracker::GetSnapshot();
+    CHECK(snapshot.lastFrame[scope].allocations == THREADS * ALLOCATIONS);
+    CHECK(snapshot.lastFrame[scope].bytes == THREADS * ALLOCATIONS * 8);
+    CHECK(!AllocTracker::IsOverBudget(snapshot.lastFrame[scope], snapshot.budgets[scope]));
+    // every thread that allocated shows up on its own
+    const size_t busyThreads = std::ranges::count_if(snapshot.threads, [](const auto& thread) { return thread.second.allocations >= ALLOCATIONS; });
+    CHECK(busyThreads >= THREADS);
+}
+
+TEST_CASE(FindBudgetReadsTheBudgetList) {
+    constexpr std::string_view BUDGETS = "QueueSubmit=0;Layer2D::FinishRendering=4;Broken=;Huge=18446744073709551614";
+    CHECK(AllocTracker::FindBudget(BUDGETS, "QueueSubmit") == 0);
+    CHECK(AllocTracker::FindBudget(BUDGETS, "Layer2D::FinishRendering") == 4);
+    CHECK(AllocTracker::FindBudget(BUDGETS, "Huge") == UINT64_MAX - 1);
+    // names have to match exactly
+    CHECK(AllocTracker::FindBudget(BUDGETS, "Queue") == AllocTracker::NO_BUDGET);
+    CHECK(AllocTracker::FindBudget(BUDGETS, "Layer2D") == AllocTracker::NO_BUDGET);
+    CHECK(AllocTracker::FindBudget(BUDGETS, "Broken") == AllocTracker::NO_BUDGET);
+    CHECK(AllocTracker::FindBudget("", "QueueSubmit") == AllocTracker::NO_BUDGET);
+    CHECK(AllocTracker::FindBudget(";;QueueSubmit=1;", "QueueSubmit") == 1);
+}
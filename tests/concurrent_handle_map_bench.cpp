@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "utils/concurrent_handle_map.h"
+
+#include <cstdio>
+#include <shared_mutex>
+#include <unordered_map>
+
+
+// Compares the handle map against the mutex-guarded std::unordered_map it replaced, while writer threads churn images like
+// Cemu's texture cache does and reader threads look them up like the vkCmdClear*Image hooks do.
+
+struct ImageInfo {
+    uint16_t width;
+    uint16_t height;
+    uint32_t format;
+};
+
+class LockedMap {
+public:
+    bool Insert(uint64_t handle, const ImageInfo& info) {
+        std::unique_lock lk(m_mutex);
+        return m_map.emplace(handle, info).second;
+    }
+    bool Erase(uint64_t handle) {
+        std::unique_lock lk(m_mutex);
+        return m_map.erase(handle) != 0;
+    }
+    std::optional<ImageInfo> Find(uint64_t handle) const {
+        std::shared_lock lk(m_mutex);
+        auto it = m_map.find(handle);
+        return it == m_map.end() ? std::nullopt : std::optional(it->second);
+    }
+
+private:
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<uint64_t, ImageInfo> m_map;
+};
+
+constexpr uint32_t LIVE_IMAGES = 1024;
+constexpr uint32_t CHURN_PER_WRITER = 200000;
+constexpr uint32_t LOOKUPS_PER_READER = 2000000;
+
+template <typename Map>
+static void RunBenchmark(const char* name, uint32_t writerCount, uint32_t readerCount) {
+    Map map;
+    for (uint64_t i = 1; i <= LIVE_IMAGES; i++) {
+        map.Insert(i << 12, { 1920, 1080, (uint32_t)i });
+    }
+
+    std::atomic_uint64_t found = 0;
+    std::atomic_int64_t writerNanoseconds = 0;
+    std::atomic_int64_t readerNanoseconds = 0;
+
+    std::vector<std::thread> threads;
+    for (uint32_t writer = 0; writer < writerCount; writer++) {
+        threads.emplace_back([&, writer] {
+            const auto start = std::chrono::steady_clock::now();
+            uint64_t next = (uint64_t)(LIVE_IMAGES + 1 + writer * CHURN_PER_WRITER);
+            for (uint32_t i = 0; i < CHURN_PER_WRITER; i++, next++) {
+                map.Insert(next << 12, { 1280, 720, i });
+                map.Erase(next << 12);
+            }
+            writerNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        });
+    }
+    for (uint32_t reader = 0; reader < readerCount; reader++) {
+        threads.emplace_back([&, reader] {
+            const auto start = std::chrono::steady_clock::now();
+            uint64_t hits = 0;
+            for (uint32_t i = 0; i < LOOKUPS_PER_READER; i++) {
+                const uint64_t handle = (uint64_t)((i * 7 + reader) % LIVE_IMAGES + 1) << 12;
+                hits += map.Find(handle).has_value() ? 1 : 0;
+            }
+            found += hits;
+            readerNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    const double insertEraseNs = writerCount == 0 ? 0.0 : (double)writerNanoseconds / ((double)writerCount * CHURN_PER_WRITER);
+    const double lookupNs = readerCount == 0 ? 0.0 : (double)readerNanoseconds / ((double)readerCount * LOOKUPS_PER_READER);
+    std::printf("%-20s %u writers, %u readers: %7.1f ns per insert+erase, %6.1f ns per lookup (%llu hits)\n", name, writerCount, readerCount, insertEraseNs, lookupNs, (unsigned long long)found.load());
+}
+
+int main() {
+    for (const auto& [writers, readers] : { std::pair(1u, 0u), std::pair(0u, 1u), std::pair(1u, 1u), std::pair(1u, 4u), std::pair(4u, 4u) }) {
+        RunBenchmark<LockedMap>("shared_mutex + map", writers, readers);
+        RunBenchmark<ConcurrentHandleMap<uint64_t, ImageInfo>>("ConcurrentHandleMap", writers, readers);
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "test_framework.h"
+#include "utils/concurrent_handle_map.h"
+
+
+struct ImageInfo {
+    uint16_t width;
+    uint16_t height;
+    uint32_t format;
+};
+
+// the value a handle maps to is derived from the handle, so a reader can tell a torn or stale value apart from a valid one
+static ImageInfo ExpectedInfo(uint64_t handle, uint32_t generation) {
+    return { (uint16_t)handle, (uint16_t)(handle >> 16), generation };
+}
+
+TEST_CASE(InsertFindErase) {
+    ConcurrentHandleMap<uint64_t, ImageInfo> map;
+    CHECK(map.Insert(0x1000, { 1920, 1080, 37 }));
+    CHECK(map.Contains(0x1000));
+    CHECK(!map.Contains(0x2000));
+    CHECK(map.Size() == 1);
+
+    const auto info = map.Find(0x1000);
+    CHECK(info.has_value() && info->width == 1920 && info->height == 1080 && info->format == 37);
+
+    CHECK(map.Erase(0x1000));
+    CHECK(!map.Erase(0x1000));
+    CHECK(!map.Find(0x1000).has_value());
+    CHECK(map.Size() == 0);
+}
+
+TEST_CASE(DuplicateAndReservedHandlesAreRejected) {
+    ConcurrentHandleMap<uint64_t, ImageInfo> map;
+    CHECK(map.Insert(0x1000, { 1, 1, 1 }));
+    CHECK(!map.Insert(0x1000, { 2, 2, 2 }));
+    CHECK(map.Find(0x1000)->format == 1);
+
+    CHECK(!map.Insert(0, { 1, 1, 1 }));
+    CHECK(!map.Insert(~0ull, { 1, 1, 1 }));
+    CHECK(!map.Contains(0));
+    CHECK(map.Size() == 1);
+}
+
+TEST_CASE(RecycledHandleDoesNotInheritStaleMetadata) {
+    ConcurrentHandleMap<uint64_t, ImageInfo> map;
+    // the driver hands out the same handle again after the image got destroyed
+    CHECK(map.Insert(0xABCD0000, { 1280, 720, 1 }));
+    CHECK(map.Erase(0xABCD0000));
+    CHECK(!map.Contains(0xABCD0000));
+
+    CHECK(map.Insert(0xABCD0000, { 2560, 1440, 2 }));
+    const auto info = map.Find(0xABCD0000);
+    CHECK(info.has_value() && info->width == 2560 && info->format == 2);
+
+    // a destroyed handle that never got recycled stays gone even after its tombstone is reused by other handles
+    for (uint64_t handle = 1; handle <= 64; handle++) {
+        CHECK(map.Insert(handle << 12, ExpectedInfo(handle, 3)));
+    }
+    CHECK(map.Erase(0xABCD0000));
+    for (uint64_t handle = 65; handle <= 128; handle++) {
+        CHECK(map.Insert(handle << 12, ExpectedInfo(handle, 3)));
+    }
+    CHECK(!map.Contains(0xABCD0000));
+    CHECK(map.Size() == 128);
+}
+
+TEST_CASE(FullShardsSpillIntoTheOverflowMap) {
+    ConcurrentHandleMap<uint64_t, ImageInfo, 1, 4> map;
+    for (uint64_t handle = 1; handle <= 10; handle++) {
+        CHECK(map.Insert(handle, ExpectedInfo(handle, 1)));
+    }
+    CHECK(map.Size() == 10);
+    CHECK(map.OverflowSize() == 6);
+    for (uint64_t handle = 1; handle <= 10; handle++) {
+        const auto info = map.Find(handle);
+        CHECK(info.has_value() && info->width == (uint16_t)handle);
+        CHECK(!map.Insert(handle, ExpectedInfo(handle, 2)));
+    }
+
+    // freeing a slot must not let a handle that already lives in the overflow map get inserted a second time
+    uint64_t slotHandle = 0;
+    uint64_t overflowHandle = 0;
+    for (uint64_t handle = 1; handle <= 10; handle++) {
+        map.Erase(handle);
+        if (map.OverflowSize() == 6) {
+            slotHandle = handle;
+            break;
+        }
+        map.Insert(handle, ExpectedInfo(handle, 1));
+    }
+    CHECK(slotHandle != 0);
+    for (uint64_t handle = 1; handle <= 10 && overflowHandle == 0; handle++) {
+        if (handle != slotHandle && !map.Insert(handle, ExpectedInfo(handle, 2))) {
+            overflowHandle = handle;
+        }
+    }
+    CHECK(overflowHandle != 0);
+    CHECK(map.Size() == 9);
+
+    for (uint64_t handle = 1; handle <= 10; handle++) {
+        map.Erase(handle);
+    }
+    CHECK(map.Size() == 0);
+    CHECK(map.OverflowSize() == 0);
+}
+
+TEST_CASE(ConcurrentChurnNeverReturnsTornOrStaleValues) {
+    constexpr uint32_t WRITER_COUNT = 4;
+    constexpr uint32_t HANDLES_PER_WRITER = 512; // more than fit into the shards, so the overflow map is churned too
+    constexpr uint32_t ROUNDS = 200;
+
+    ConcurrentHandleMap<uint64_t, ImageInfo, 4, 64> map;
+    std::atomic_bool stop = false;
+    std::atomic_uint32_t badReads = 0;
+
+    std::vector<std::thread> readers;
+    for (uint32_t i = 0; i < 2; i++) {
+        readers.emplace_back([&, i] {
+            uint64_t handle = i;
+            while (!stop.load(std::memory_order_relaxed)) {
+                handle = (handle * 6364136223846793005ull + 1442695040888963407ull);
+                const uint64_t key = ((handle >> 33) % (WRITER_COUNT * HANDLES_PER_WRITER) + 1) << 8;
+                if (const auto info = map.Find(key)) {
+                    // the generation is allowed to be anything, but the rest has to belong to this handle
+                    if (info->width != (uint16_t)key || info->height != (uint16_t)(key >> 16)) {
+                        badReads++;
+                    }
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for (uint32_t writer = 0; writer < WRITER_COUNT; writer++) {
+        writers.emplace_back([&, writer] {
+            for (uint32_t round = 0; round < ROUNDS; round++) {
+                for (uint32_t i = 0; i < HANDLES_PER_WRITER; i++) {
+                    const uint64_t key = (uint64_t)(writer * HANDLES_PER_WRITER + i + 1) << 8;
+                    if (!map.Insert(key, ExpectedInfo(key, round))) {
+                        badReads++;
+                    }
+                }
+                for (uint32_t i = 0; i < HANDLES_PER_WRITER; i++) {
+                    const uint64_t key = (uint64_t)(writer * HANDLES_PER_WRITER + i + 1) << 8;
+                    if (!map.Erase(key)) {
+                        badReads++;
+                    }
+                }
+            }
+        });
+    }
+
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    stop = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    CHECK(badReads == 0);
+    CHECK(map.Size() == 0);
+    CHECK(map.OverflowSize() == 0);
+}
@@ -0,0 +1,79 @@
+#include "test_framework.h"
+#include "utils/depth_submission.h"
+
+
+// Every combination of the runtime's capabilities and the setting, spelled out so that a change to the policy has to change
+// this table as well. A runtime can't be both Quest Link and the simulator, but the rows are kept to pin down the precedence.
+struct DepthSubmissionRow {
+    bool supportsDepthLayer;
+    bool isOculusLinkRuntime;
+    bool isMetaSimulator;
+    DepthSubmissionMode mode;
+    bool expected;
+};
+
+constexpr DepthSubmissionMode AUTO = DepthSubmissionMode::AUTO;
+constexpr DepthSubmissionMode ON = DepthSubmissionMode::FORCED_ON;
+constexpr DepthSubmissionMode OFF = DepthSubmissionMode::FORCED_OFF;
+
+constexpr std::array<DepthSubmissionRow, 24> DECISION_TABLE = { {
+    // without the depth extension nothing can be submitted, whatever the setting says
+    { false, false, false, AUTO, false },
+    { false, false, false, ON, false },
+    { false, false, false, OFF, false },
+    { false, true, false, AUTO, false },
+    { false, true, false, ON, false },
+    { false, true, false, OFF, false },
+    { false, false, true, AUTO, false },
+    { false, false, true, ON, false },
+    { false, false, true, OFF, false },
+    { false, true, true, AUTO, false },
+    { false, true, true, ON, false },
+    { false, true, true, OFF, false },
+    // other runtimes get depth unless it's turned off
+    { true, false, false, AUTO, true },
+    { true, false, false, ON, true },
+    { true, false, false, OFF, false },
+    // Quest Link uses depth for its timewarp
+    { true, true, false, AUTO, true },
+    { true, true, false, ON, true },
+    { true, true, false, OFF, false },
+    // the simulator ignores it unless forced
+    { true, false, true, AUTO, false },
+    { true, false, true, ON, true },
+    { true, false, true, OFF, false },
+    // Quest Link wins over the simulator
+    { true, true, true, AUTO, true },
+    { true, true, true, ON, true },
+    { true, true, true, OFF, false },
+} };
+
+TEST_CASE(ShouldSubmitDepthMatchesTheDecisionTable) {
+    for (const DepthSubmissionRow& row : DECISION_TABLE) {
+        const DepthSubmissionRuntime runtime = {
+            .supportsDepthLayer = row.supportsDepthLayer,
+            .isOculusLinkRuntime = row.isOculusLinkRuntime,
+            .isMetaSimulator = row.isMetaSimulator
+        };
+        const bool submitted = ShouldSubmitDepth(runtime, row.mode);
+        if (submitted != row.expected) {
+            std::printf("  depth layer %d, link %d, simulator %d, mode %d: expected %d\n", row.supportsDepthLayer, row.isOculusLinkRuntime, row.isMetaSimulator, (int)row.mode, row.expected);
+        }
+        CHECK(submitted == row.expected);
+    }
+}
+
+TEST_CASE(DecisionTableCoversEveryCombination) {
+    std::array<bool, 24> seen = {};
+    for (const DepthSubmissionRow& row : DECISION_TABLE) {
+        const uint32_t index = ((uint32_t)row.supportsDepthLayer * 4 + (uint32_t)row.isOculusLinkRuntime * 2 + (uint32_t)row.isMetaSimulator) * 3 + (uint32_t)row.mode;
+        CHECK(!seen[index]);
+        seen[index] = true;
+    }
+    CHECK(std::ranges::all_of(seen, [](bool s) { return s; }));
+}
+
+TEST_CASE(DefaultRuntimeDoesntSubmitDepth) {
+    CHECK(!ShouldSubmitDepth({}, DepthSubmissionMode::AUTO));
+    CHECK(!ShouldSubmitDepth({}, DepthSubmissionMode::FORCED_ON));
+}
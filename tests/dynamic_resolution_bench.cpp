@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "utils/dynamic_resolution.h"
+
+#include <cstdio>
+
+
+// Runs the controller once per frame like the XR frame loop does, followed by the sub-rectangle of both eyes, for a light
+// load that stays at the full scale, a heavy one that settles below it and one that swings between the two every second.
+// The baseline is a fixed scale, which only computes the sub-rectangles.
+
+constexpr uint32_t FRAMES = 5'000'000;
+constexpr double DISPLAY_PERIOD_MS = 1000.0 / 90.0;
+constexpr uint32_t EYE_WIDTH = 2064;
+constexpr uint32_t EYE_HEIGHT = 2208;
+
+// the present passes shade one pixel per output pixel, so their GPU time grows with the square of the scale
+static double FullScaleGpuMs(const char* load, uint32_t frame) {
+    const double budgetMs = DISPLAY_PERIOD_MS * DynamicResolution::Config().gpuBudget;
+    if (std::strcmp(load, "light") == 0) {
+        return budgetMs * 0.5;
+    }
+    if (std::strcmp(load, "heavy") == 0) {
+        return budgetMs * 1.44;
+    }
+    return frame / 90 % 2 == 0 ? budgetMs * 0.5 : budgetMs * 1.6;
+}
+
+static double Run(const char* load, bool dynamic, uint64_t& pixelSum) {
+    DynamicResolution resolution;
+    std::vector<double> fullScaleGpuMs(90 * 2);
+    for (uint32_t frame = 0; frame < fullScaleGpuMs.size(); frame++) {
+        fullScaleGpuMs[frame] = FullScaleGpuMs(load, frame);
+    }
+
+    float scale = 1.0f;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        if (dynamic) {
+            const double gpuTimeMs = fullScaleGpuMs[frame % fullScaleGpuMs.size()] * scale * scale;
+            scale = resolution.Update({ .gpuTimeMs = gpuTimeMs, .displayPeriodMs = DISPLAY_PERIOD_MS });
+        }
+        for (uint32_t eye = 0; eye < 2; eye++) {
+            const XrExtent2Di extent = DynamicResolution::GetScaledExtent(EYE_WIDTH, EYE_HEIGHT, scale);
+            pixelSum += (uint64_t)extent.width * (uint64_t)extent.height;
+        }
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+}
+
+int main() {
+    uint64_t pixelSum = 0;
+    const double fixed = Run("light", false, pixelSum);
+    std::printf("fixed scale:              %.2f ns per frame\n", fixed);
+    for (const char* load : { "light", "heavy", "swinging" }) {
+        pixelSum = 0;
+        const double dynamic = Run(load, true, pixelSum);
+        std::printf("dynamic, %-8s load:    %.2f ns per frame (%.2f ns for Update, %.0f%% of the pixels)\n", load, dynamic, dynamic - fixed,
+            100.0 * (double)pixelSum / ((double)FRAMES * 2.0 * EYE_WIDTH * EYE_HEIGHT));
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "test_framework.h"
+#include "utils/dynamic_resolution.h"
+
+
+constexpr double DISPLAY_PERIOD_MS = 1000.0 / 90.0;
+
+// the present passes shade one pixel per output pixel, so their GPU time grows with the square of the scale
+static float RunFrames(DynamicResolution& resolution, double fullScaleGpuMs, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; i++) {
+        const double scale = resolution.GetScale();
+        resolution.Update({ .gpuTimeMs = fullScaleGpuMs * scale * scale, .displayPeriodMs = DISPLAY_PERIOD_MS });
+    }
+    return resolution.GetScale();
+}
+
+TEST_CASE(LightLoadKeepsTheFullScale) {
+    DynamicResolution resolution;
+    CHECK(RunFrames(resolution, 1.0, 300) == resolution.GetConfig().maxScale);
+}
+
+TEST_CASE(MissingTimingsAreIgnored) {
+    DynamicResolution resolution;
+    CHECK(resolution.Update({ .gpuTimeMs = 0.0, .displayPeriodMs = DISPLAY_PERIOD_MS }) == 1.0f);
+    CHECK(resolution.Update({ .gpuTimeMs = 50.0, .displayPeriodMs = 0.0 }) == 1.0f);
+    CHECK(resolution.GetLoad() == 0.0f);
+}
+
+TEST_CASE(OverloadDropsTheScaleRightAway) {
+    DynamicResolution resolution;
+    const float scale = resolution.Update({ .gpuTimeMs = DISPLAY_PERIOD_MS, .displayPeriodMs = DISPLAY_PERIOD_MS });
+    CHECK(scale < resolution.GetConfig().maxScale);
+    CHECK(scale >= resolution.GetConfig().minScale);
+}
+
+TEST_CASE(ScaleSettlesNearTheTargetLoad) {
+    DynamicResolution resolution;
+    // 1.44 times the budget at full scale, which needs a scale of about 0.77 to reach the target load
+    const double fullScaleGpuMs = DISPLAY_PERIOD_MS * resolution.GetConfig().gpuBudget * 1.44;
+    RunFrames(resolution, fullScaleGpuMs, 1000);
+
+    float lowest = resolution.GetConfig().maxScale;
+    float highest = resolution.GetConfig().minScale;
+    for (uint32_t i = 0; i < 200; i++) {
+        const float scale = RunFrames(resolution, fullScaleGpuMs, 1);
+        lowest = std::min(lowest, scale);
+        highest = std::max(highest, scale);
+    }
+    CHECK(lowest >= 0.7f);
+    CHECK(highest <= 0.85f);
+    // it may step back and forth between two neighbouring steps, but not more
+    CHECK(highest - lowest <= resolution.GetConfig().step + 1e-4f);
+    CHECK_NEAR(resolution.GetLoad(), resolution.GetConfig().targetLoad, 0.1);
+}
+
+TEST_CASE(ScaleIsRaisedOneStepAtATime) {
+    DynamicResolution resolution;
+    CHECK(RunFrames(resolution, DISPLAY_PERIOD_MS, 50) == resolution.GetConfig().minScale);
+
+    // raising has to wait for the hold frames after every step
+    const DynamicResolution::Config& config = resolution.GetConfig();
+    float previous = resolution.GetScale();
+    uint32_t framesSinceRaise = 50; // the minimum was already reached on the first overloaded frame
+    for (uint32_t i = 0; i < 1000; i++) {
+        const float scale = RunFrames(resolution, 0.5, 1);
+        framesSinceRaise++;
+        if (scale != previous) {
+            CHECK(scale > previous);
+            CHECK(scale - previous <= config.step + 1e-4f);
+            CHECK(framesSinceRaise >= config.raiseHoldFrames);
+            framesSinceRaise = 0;
+            previous = scale;
+        }
+    }
+    CHECK(resolution.GetScale() == config.maxScale);
+}
+
+TEST_CASE(ResetRestoresTheFullScale) {
+    DynamicResolution resolution;
+    RunFrames(resolution, DISPLAY_PERIOD_MS, 10);
+    CHECK(resolution.GetScale() < 1.0f);
+    resolution.Reset();
+    CHECK(resolution.GetScale() == 1.0f);
+    CHECK(resolution.GetLoad() == 0.0f);
+}
+
+TEST_CASE(ScaledExtentIsRoundedAndNeverEmpty) {
+    const XrExtent2Di half = DynamicResolution::GetScaledExtent(2064, 2208, 0.5f);
+    CHECK(half.width == 1032 && half.height == 1104);
+
+    const XrExtent2Di odd = DynamicResolution::GetScaledExtent(101, 99, 0.75f);
+    CHECK(odd.width == 76 && odd.height == 74);
+
+    const XrExtent2Di tiny = DynamicResolution::GetScaledExtent(1, 1, 0.1f);
+    CHECK(tiny.width == 1 && tiny.height == 1);
+}
@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "utils/endian_convert.h"
+
+#include <cstdio>
+
+
+// Converts 100k bone matrices per pass to little-endian and back with every implementation the CPU supports, which is a few
+// hundred frames worth of skeleton updates, so that the SIMD paths can be compared against the scalar one.
+
+constexpr size_t MATRICES = 100'000;
+constexpr uint32_t PASSES = 50;
+
+int main() {
+    std::vector<uint32_t> rows(MATRICES * 12), columns(MATRICES * 12);
+    uint32_t seed = 1;
+    for (uint32_t& word : rows) {
+        word = seed = seed * 1664525u + 1013904223u;
+    }
+
+    const EndianConvert::Implementation best = EndianConvert::GetImplementation();
+    for (EndianConvert::Implementation implementation : { EndianConvert::Implementation::SCALAR, EndianConvert::Implementation::SSSE3, EndianConvert::Implementation::AVX2 }) {
+        if (!EndianConvert::SetImplementation(implementation)) {
+            std::printf("implementation %d isn't supported by this CPU\n", (int)implementation);
+            continue;
+        }
+
+        uint64_t checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t pass = 0; pass < PASSES; ++pass) {
+            EndianConvert::MatricesToLE(rows.data(), columns.data(), MATRICES);
+            checksum += columns[pass % columns.size()];
+            EndianConvert::MatricesToBE(columns.data(), rows.data(), MATRICES);
+            checksum += rows[pass % rows.size()];
+        }
+        const double nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        // both directions count, so every pass converts the matrices twice
+        std::printf("%-6s %7.3f ms per 100k matrices, %5.2f ns per matrix (checksum %llu)\n", EndianConvert::GetImplementationName(),
+                    nanoseconds / (PASSES * 2) / 1e6, nanoseconds / ((double)PASSES * 2 * MATRICES), (unsigned long long)checksum);
+    }
+    EndianConvert::SetImplementation(best);
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "test_framework.h"
+#include "utils/endian_convert.h"
+
+
+using Implementation = EndianConvert::Implementation;
+
+constexpr std::array IMPLEMENTATIONS = { Implementation::SCALAR, Implementation::SSSE3, Implementation::AVX2 };
+
+// Runs the test once per implementation that this CPU supports and switches back to the best one afterwards
+template <typename Function>
+static void ForEachImplementation(Function&& function) {
+    const Implementation best = EndianConvert::GetImplementation();
+    for (Implementation implementation : IMPLEMENTATIONS) {
+        if (!EndianConvert::SetImplementation(implementation)) {
+            std::printf("  implementation %d isn't supported by this CPU, skipping it\n", (int)implementation);
+            continue;
+        }
+        function(implementation);
+    }
+    EndianConvert::SetImplementation(best);
+}
+
+static uint32_t ReferenceSwap(uint32_t word) {
+    return (word >> 24) | ((word >> 8) & 0xFF00) | ((word << 8) & 0xFF0000) | (word << 24);
+}
+
+// row-major big-endian (a0 a1 a2 a3 / b0 b1 b2 b3 / c0 c1 c2 c3) to column-major little-endian (a0 b0 c0 / a1 b1 c1 / ...)
+static std::array<uint32_t, 12> ReferenceToLE(const uint32_t* rows) {
+    std::array<uint32_t, 12> columns;
+    for (uint32_t column = 0; column < 4; column++) {
+        for (uint32_t row = 0; row < 3; row++) {
+            columns[column * 3 + row] = ReferenceSwap(rows[row * 4 + column]);
+        }
+    }
+    return columns;
+}
+
+// the float bit patterns that arithmetic or a careless conversion would change
+constexpr std::array SPECIAL_FLOATS = {
+    0x00000000u, 0x80000000u,             // +0, -0
+    0x7F800000u, 0xFF800000u,             // +Inf, -Inf
+    0x7FC00000u, 0xFFC00000u,             // quiet NaNs
+    0x7F800001u, 0x7FA00000u, 0xFF800001u, // signaling NaNs, which become quiet ones when they go through an FPU
+    0x7FFFFFFFu, 0x00000001u, 0x807FFFFFu, // NaN with all payload bits, smallest and largest denormals
+    0x3F800000u, 0x12345678u,
+};
+
+static std::vector<uint32_t> MakeWords(size_t count, uint32_t seed) {
+    std::vector<uint32_t> words(count);
+    for (size_t i = 0; i < count; i++) {
+        words[i] = i < SPECIAL_FLOATS.size() ? SPECIAL_FLOATS[i] : (seed = seed * 1664525u + 1013904223u);
+    }
+    return words;
+}
+
+TEST_CASE(ScalarIsAlwaysSupported) {
+    CHECK(EndianConvert::IsSupported(Implementation::SCALAR));
+    CHECK(EndianConvert::IsSupported(EndianConvert::GetImplementation()));
+}
+
+TEST_CASE(SwapWordsMatchesTheReferenceForEveryByteInEveryLane) {
+    ForEachImplementation([](Implementation) {
+        // the shuffles don't depend on the data, so every byte value in every byte of the word covers all the bit patterns
+        // they can see. The words use different values in the other bytes so that a byte moving to the wrong lane shows up
+        std::vector<uint32_t> src, dst, back;
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            for (uint32_t value = 0; value < 256; value++) {
+                const uint32_t others = 0x01020304u + (uint32_t)src.size() * 0x00010101u;
+                src.emplace_back((others & ~(0xFFu << (lane * 8))) | (value << (lane * 8)));
+            }
+        }
+        // plus a strided sweep over the whole 32-bit range, with a prime stride so that every nibble value shows up
+        for (uint64_t word = 0; word <= 0xFFFFFFFFull; word += 4099) {
+            src.emplace_back((uint32_t)word);
+        }
+        src.insert(src.end(), SPECIAL_FLOATS.begin(), SPECIAL_FLOATS.end());
+        dst.resize(src.size());
+        back.resize(src.size());
+
+        EndianConvert::SwapWords(src.data(), dst.data(), src.size());
+        EndianConvert::SwapWords(dst.data(), back.data(), dst.size());
+        size_t mismatches = 0;
+        for (size_t i = 0; i < src.size(); i++) {
+            mismatches += (dst[i] != ReferenceSwap(src[i]) || back[i] != src[i]) ? 1 : 0;
+        }
+        CHECK(mismatches == 0);
+    });
+}
+
+TEST_CASE(SwapWordsHandlesEveryTailLength) {
+    ForEachImplementation([](Implementation) {
+        for (size_t count = 0; count <= 33; count++) {
+            const std::vector<uint32_t> src = MakeWords(count + 1, (uint32_t)count);
+            std::vector<uint32_t> dst(count + 1, 0xCDCDCDCD);
+            EndianConvert::SwapWords(src.data(), dst.data(), count);
+            for (size_t i = 0; i < count; i++) {
+                CHECK(dst[i] == ReferenceSwap(src[i]));
+            }
+            // nothing past the end gets written
+            CHECK(dst[count] == 0xCDCDCDCD);
+        }
+    });
+}
+
+TEST_CASE(SwapWordsWorksInPlace) {
+    ForEachImplementation([](Implementation) {
+        const std::vector<uint32_t> original = MakeWords(37, 7);
+        std::vector<uint32_t> words = original;
+        EndianConvert::SwapWords(words.data(), words.size());
+        for (size_t i = 0; i < words.size(); i++) {
+            CHECK(words[i] == ReferenceSwap(original[i]));
+        }
+        EndianConvert::SwapWords(words.data(), words.size());
+        CHECK(words == original);
+    });
+}
+
+TEST_CASE(MatricesMatchTheReferenceTranspose) {
+    ForEachImplementation([](Implementation) {
+        constexpr size_t MATRICES = 9;
+        const std::vector<uint32_t> rows = MakeWords(MATRICES * 12, 3);
+        std::vector<uint32_t> columns(MATRICES * 12);
+        EndianConvert::MatricesToLE(rows.data(), columns.data(), MATRICES);
+        for (size_t m = 0; m < MATRICES; m++) {
+            const std::array<uint32_t, 12> expected = ReferenceToLE(rows.data() + m * 12);
+            CHECK(std::equal(expected.begin(), expected.end(), columns.begin() + m * 12));
+        }
+
+        std::vector<uint32_t> back(MATRICES * 12);
+        EndianConvert::MatricesToBE(columns.data(), back.data(), MATRICES);
+        CHECK(back == rows);
+    });
+}
+
+TEST_CASE(MatricesKeepSpecialFloatsInEveryElement) {
+    ForEachImplementation([](Implementation) {
+        // every special pattern goes through every one of the 12 positions, since each lands in a different shuffle
+        for (uint32_t special : SPECIAL_FLOATS) {
+            for (uint32_t element = 0; element < 12; element++) {
+                std::array<uint32_t, 12> rows;
+                for (uint32_t i = 0; i < 12; i++) {
+                    rows[i] = ReferenceSwap(0x3F800000u + i);
+                }
+                rows[element] = special;
+
+                std::array<uint32_t, 12> columns, back;
+                EndianConvert::MatricesToLE(rows.data(), columns.data(), 1);
+                CHECK(columns == ReferenceToLE(rows.data()));
+                EndianConvert::MatricesToBE(columns.data(), back.data(), 1);
+                CHECK(back == rows);
+            }
+        }
+    });
+}
+
+TEST_CASE(MatricesConvertInPlace) {
+    ForEachImplementation([](Implementation) {
+        const std::vector<uint32_t> original = MakeWords(5 * 12, 11);
+        std::vector<uint32_t> words = original;
+        EndianConvert::MatricesToLE(words.data(), words.data(), 5);
+        for (size_t m = 0; m < 5; m++) {
+            const std::array<uint32_t, 12> expected = ReferenceToLE(original.data() + m * 12);
+            CHECK(std::equal(expected.begin(), expected.end(), words.begin() + m * 12));
+        }
+        EndianConvert::MatricesToBE(words.data(), words.data(), 5);
+        CHECK(words == original);
+    });
+}
+
+TEST_CASE(UnsupportedImplementationsAreRejected) {
+    const Implementation best = EndianConvert::GetImplementation();
+    for (Implementation implementation : IMPLEMENTATIONS) {
+        CHECK(EndianConvert::SetImplementation(implementation) == EndianConvert::IsSupported(implementation));
+    }
+    EndianConvert::SetImplementation(best);
+    CHECK(EndianConvert::GetImplementation() == best);
+}
@@ -0,0 +1,147 @@
+#include "test_framework.h"
+#include "utils/epoch_snapshot.h"
+
+#include <barrier>
+
+
+// Stands in for CemuHooks::FrameSnapshot, with a counter instead of the decoded player matrix
+struct Snapshot {
+    bool hasPlayer = false;
+    uint32_t playerFrame = 0;
+    uint32_t cameraFrame = 0;
+    std::array<float, 80> padding = {}; // roughly the size of the real one
+};
+
+// Replays the order that camera.cpp and skeleton.cpp run in: hook_UpdateSettings bumps the epoch, hook_UpdateCameraForGameplay
+// updates the camera and refreshes the player, sometimes updates the camera again, and every bone calls GetFrameSnapshot()
+struct FakeHooks {
+    EpochSnapshot<Snapshot> snapshot;
+    uint32_t frameEpoch = 1;
+    uint32_t guestFrame = 0; // what's currently in guest memory
+    bool playerSpawned = true;
+    uint32_t guestReads = 0;
+
+    void ReadPlayer(Snapshot& s) {
+        guestReads++;
+        s.hasPlayer = playerSpawned;
+        if (s.hasPlayer) {
+            s.playerFrame = guestFrame;
+        }
+    }
+
+    void UpdateSettings() {
+        ++frameEpoch;
+        ++guestFrame;
+    }
+
+    void UpdateCamera(uint32_t cameraFrame) {
+        snapshot.Update([&](Snapshot& s) { s.cameraFrame = cameraFrame; });
+    }
+
+    const Snapshot& Refresh() {
+        return snapshot.Publish(frameEpoch, [this](Snapshot& s) { ReadPlayer(s); });
+    }
+
+    const Snapshot& Get() {
+        return snapshot.Get(frameEpoch, [this](Snapshot& s) { ReadPlayer(s); });
+    }
+};
+
+TEST_CASE(BonesReuseTheSnapshotOfTheCameraHook) {
+    FakeHooks hooks;
+    for (uint32_t frame = 0; frame < 10; frame++) {
+        hooks.UpdateSettings();
+        hooks.UpdateCamera(hooks.guestFrame);
+        const Snapshot& refreshed = hooks.Refresh();
+        const uint32_t readsAfterRefresh = hooks.guestReads;
+        for (uint32_t bone = 0; bone < 100; bone++) {
+            const Snapshot& boneSnapshot = hooks.Get();
+            CHECK(&boneSnapshot == &refreshed);
+            CHECK(boneSnapshot.playerFrame == hooks.guestFrame);
+            CHECK(boneSnapshot.cameraFrame == hooks.guestFrame);
+        }
+        CHECK(hooks.guestReads == readsAfterRefresh);
+    }
+    CHECK(hooks.guestReads == 10);
+    CHECK(hooks.snapshot.GetPublishCount() == 20);
+}
+
+TEST_CASE(BonesRefreshOnceWhenTheCameraHookDidntRun) {
+    FakeHooks hooks;
+    hooks.UpdateSettings();
+    hooks.UpdateCamera(7);
+    hooks.Refresh();
+
+    // e.g. a menu is open and only the bones get updated
+    for (uint32_t frame = 0; frame < 5; frame++) {
+        hooks.UpdateSettings();
+        const uint32_t readsBefore = hooks.guestReads;
+        for (uint32_t bone = 0; bone < 100; bone++) {
+            const Snapshot& boneSnapshot = hooks.Get();
+            CHECK(boneSnapshot.playerFrame == hooks.guestFrame);
+            // the camera is kept from the last frame that had a gameplay camera
+            CHECK(boneSnapshot.cameraFrame == 7);
+        }
+        CHECK(hooks.guestReads == readsBefore + 1);
+    }
+}
+
+TEST_CASE(CameraUpdatesKeepTheEpochAndThePlayer) {
+    FakeHooks hooks;
+    hooks.UpdateSettings();
+    hooks.UpdateCamera(1);
+    const Snapshot& refreshed = hooks.Refresh();
+    // first person events override the camera rotation after the refresh
+    hooks.UpdateCamera(2);
+
+    const uint32_t readsBefore = hooks.guestReads;
+    const Snapshot& boneSnapshot = hooks.Get();
+    CHECK(hooks.guestReads == readsBefore);
+    CHECK(boneSnapshot.cameraFrame == 2);
+    CHECK(boneSnapshot.playerFrame == refreshed.playerFrame);
+    // the version that the camera hook is still holding wasn't overwritten
+    CHECK(refreshed.cameraFrame == 1);
+    CHECK(hooks.snapshot.GetLatestEpoch() == hooks.frameEpoch);
+}
+
+TEST_CASE(DespawnedPlayerIsFlagged) {
+    FakeHooks hooks;
+    hooks.UpdateSettings();
+    hooks.Refresh();
+    CHECK(hooks.Get().hasPlayer);
+
+    hooks.playerSpawned = false;
+    hooks.UpdateSettings();
+    CHECK(!hooks.Get().hasPlayer);
+}
+
+TEST_CASE(ConcurrentReadersRefreshOncePerEpoch) {
+    constexpr uint32_t THREADS = 4;
+    constexpr uint32_t EPOCHS = 500;
+
+    EpochSnapshot<Snapshot> snapshot;
+    std::atomic_uint32_t refreshes = 0;
+    std::atomic_uint32_t mismatches = 0;
+    std::barrier sync(THREADS);
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&] {
+            for (uint32_t epoch = 1; epoch <= EPOCHS; epoch++) {
+                for (uint32_t bone = 0; bone < 20; bone++) {
+                    const Snapshot& s = snapshot.Get(epoch, [&](Snapshot& next) {
+                        refreshes++;
+                        next.playerFrame = epoch;
+                    });
+                    mismatches += s.playerFrame == epoch ? 0 : 1;
+                }
+                sync.arrive_and_wait();
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK(refreshes == EPOCHS);
+    CHECK(mismatches == 0);
+}
@@ -0,0 +1,97 @@
+#include "test_framework.h"
+#include "utils/eye_scheduler.h"
+
+
+using Plan = EyeScheduler::Plan;
+
+constexpr double FRAME_SECONDS = 1.0 / 60.0;
+
+static EyeScheduler::Input MakeInput(uint32_t frame, glm::fquat orientation = glm::identity<glm::fquat>(), bool allowed = true) {
+    return { .allowed = allowed, .headOrientation = orientation, .timeSeconds = frame * FRAME_SECONDS };
+}
+
+TEST_CASE(PlanHelpersMatchTheRenderedEyes) {
+    CHECK(EyeScheduler::RendersBothEyes(Plan::BOTH));
+    CHECK(!EyeScheduler::RendersBothEyes(Plan::LEFT_ONLY));
+    CHECK(!EyeScheduler::RendersBothEyes(Plan::RIGHT_ONLY));
+
+    CHECK(!EyeScheduler::IsEyeStale(Plan::BOTH, 0) && !EyeScheduler::IsEyeStale(Plan::BOTH, 1));
+    CHECK(!EyeScheduler::IsEyeStale(Plan::LEFT_ONLY, 0) && EyeScheduler::IsEyeStale(Plan::LEFT_ONLY, 1));
+    CHECK(EyeScheduler::IsEyeStale(Plan::RIGHT_ONLY, 0) && !EyeScheduler::IsEyeStale(Plan::RIGHT_ONLY, 1));
+
+    // the first pass draws the picked eye, the second pass only runs when both eyes are rendered
+    CHECK(EyeScheduler::GetPassEye(Plan::BOTH, 0) == 0 && EyeScheduler::GetPassEye(Plan::BOTH, 1) == 1);
+    CHECK(EyeScheduler::GetPassEye(Plan::LEFT_ONLY, 0) == 0);
+    CHECK(EyeScheduler::GetPassEye(Plan::RIGHT_ONLY, 0) == 1);
+}
+
+TEST_CASE(NotAllowedRendersBothEyes) {
+    EyeScheduler scheduler({ .maxAngularSpeed = 1.0f, .calmFrames = 0 });
+    for (uint32_t i = 0; i < 10; ++i) {
+        CHECK(scheduler.Next(MakeInput(i, glm::identity<glm::fquat>(), false)) == Plan::BOTH);
+    }
+}
+
+TEST_CASE(AlternatesOnceTheHeadIsCalm) {
+    EyeScheduler scheduler({ .maxAngularSpeed = 1.0f, .calmFrames = 3 });
+    uint32_t frame = 0;
+    for (; frame < 3; ++frame) {
+        CHECK(scheduler.Next(MakeInput(frame)) == Plan::BOTH);
+    }
+    CHECK(scheduler.Next(MakeInput(frame++)) == Plan::LEFT_ONLY);
+    CHECK(scheduler.Next(MakeInput(frame++)) == Plan::RIGHT_ONLY);
+    CHECK(scheduler.Next(MakeInput(frame++)) == Plan::LEFT_ONLY);
+    CHECK(scheduler.GetAngularSpeed() == 0.0f);
+}
+
+TEST_CASE(FastHeadMotionRendersBothEyes) {
+    EyeScheduler scheduler({ .maxAngularSpeed = 1.0f, .calmFrames = 2 });
+    uint32_t frame = 0;
+    for (; frame < 3; ++frame) {
+        scheduler.Next(MakeInput(frame));
+    }
+
+    // 0.1 radians in one frame is 6 radians per second
+    const glm::fquat turned = glm::angleAxis(0.1f, glm::fvec3(0.0f, 1.0f, 0.0f));
+    CHECK(scheduler.Next(MakeInput(frame++, turned)) == Plan::BOTH);
+    CHECK_NEAR(scheduler.GetAngularSpeed(), 6.0, 1e-3);
+
+    // the head stopped, but the calm frames have to pass again before alternating
+    CHECK(scheduler.Next(MakeInput(frame++, turned)) == Plan::BOTH);
+    CHECK(scheduler.Next(MakeInput(frame++, turned)) == Plan::BOTH);
+    CHECK(scheduler.Next(MakeInput(frame++, turned)) != Plan::BOTH);
+}
+
+TEST_CASE(OppositeQuaternionsAreTheSameOrientation) {
+    EyeScheduler scheduler({ .maxAngularSpeed = 1.0f, .calmFrames = 0 });
+    const glm::fquat orientation = glm::angleAxis(1.0f, glm::fvec3(1.0f, 0.0f, 0.0f));
+    scheduler.Next(MakeInput(0, orientation));
+    CHECK(scheduler.Next(MakeInput(1, -orientation)) != Plan::BOTH);
+    CHECK_NEAR(scheduler.GetAngularSpeed(), 0.0, 1e-2);
+}
+
+TEST_CASE(RepeatedTimestampsKeepTheSpeed) {
+    EyeScheduler scheduler({ .maxAngularSpeed = 1.0f, .calmFrames = 0 });
+    scheduler.Next(MakeInput(0));
+    scheduler.Next(MakeInput(1, glm::angleAxis(0.1f, glm::fvec3(0.0f, 0.0f, 1.0f))));
+    const float speed = scheduler.GetAngularSpeed();
+    CHECK(speed > 1.0f);
+
+    // no time passed, so there's nothing to divide the rotation by
+    scheduler.Next(MakeInput(1, glm::angleAxis(0.5f, glm::fvec3(0.0f, 0.0f, 1.0f))));
+    CHECK(scheduler.GetAngularSpeed() == speed);
+}
+
+TEST_CASE(ResetForgetsTheHeadMotion) {
+    EyeScheduler scheduler({ .maxAngularSpeed = 1.0f, .calmFrames = 1 });
+    scheduler.Next(MakeInput(0));
+    scheduler.Next(MakeInput(1, glm::angleAxis(0.5f, glm::fvec3(0.0f, 1.0f, 0.0f))));
+    CHECK(scheduler.GetAngularSpeed() > 1.0f);
+
+    scheduler.Reset();
+    CHECK(scheduler.GetAngularSpeed() == 0.0f);
+    // the first orientation after a reset has nothing to compare against, and the calm frames start over
+    CHECK(scheduler.Next(MakeInput(2)) == Plan::BOTH);
+    CHECK(scheduler.GetAngularSpeed() == 0.0f);
+    CHECK(scheduler.Next(MakeInput(3)) == Plan::LEFT_ONLY);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "pch.h"
+
+
+// A stand-in for Cemu's guest memory, which the hooks read through CemuHooks::s_memoryBaseAddress. Only covers one window of
+// the guest's address space, and stores everything big-endian like the Wii U does.
+class FakeGuestMemory {
+public:
+    FakeGuestMemory(uint32_t baseAddress, uint32_t size): m_baseAddress(baseAddress), m_bytes(size) {}
+
+    void WriteBE32(uint32_t address, uint32_t value) {
+        uint8_t* bytes = At(address, 4);
+        bytes[0] = (uint8_t)(value >> 24);
+        bytes[1] = (uint8_t)(value >> 16);
+        bytes[2] = (uint8_t)(value >> 8);
+        bytes[3] = (uint8_t)value;
+    }
+
+    void Read(uint32_t address, void* destination, size_t size) {
+        memcpy(destination, At(address, size), size);
+    }
+
+    auto Reader() {
+        return [this](uint32_t address, void* destination, size_t size) { Read(address, destination, size); };
+    }
+
+private:
+    uint8_t* At(uint32_t address, size_t size) {
+        checkAssert(address >= m_baseAddress && address - m_baseAddress + size <= m_bytes.size(), "Guest address is outside of the fake memory!");
+        return m_bytes.data() + (address - m_baseAddress);
+    }
+
+    uint32_t m_baseAddress;
+    std::vector<uint8_t> m_bytes;
+};
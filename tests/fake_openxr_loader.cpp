@@ -0,0 +1,31 @@
+#include "fake_openxr_loader.h"
+
+
+static std::atomic_uint32_t s_callCount = 0;
+
+uint32_t FakeOpenXRLoader::GetCallCount() {
+    return s_callCount.load();
+}
+
+static XrResult NoRuntime() {
+    s_callCount++;
+    return XR_ERROR_RUNTIME_UNAVAILABLE;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrCreateSession(XrInstance, const XrSessionCreateInfo*, XrSession*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrBeginSession(XrSession, const XrSessionBeginInfo*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrEndSession(XrSession) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrRequestExitSession(XrSession) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrWaitFrame(XrSession, const XrFrameWaitInfo*, XrFrameState*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrBeginFrame(XrSession, const XrFrameBeginInfo*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrEndFrame(XrSession, const XrFrameEndInfo*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrSyncActions(XrSession, const XrActionsSyncInfo*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrGetActionStateBoolean(XrSession, const XrActionStateGetInfo*, XrActionStateBoolean*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrGetActionStateFloat(XrSession, const XrActionStateGetInfo*, XrActionStateFloat*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrGetActionStateVector2f(XrSession, const XrActionStateGetInfo*, XrActionStateVector2f*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrGetActionStatePose(XrSession, const XrActionStateGetInfo*, XrActionStatePose*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrLocateSpace(XrSpace, XrSpace, XrTime, XrSpaceLocation*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrLocateViews(XrSession, const XrViewLocateInfo*, XrViewState*, uint32_t, uint32_t*, XrView*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrPollEvent(XrInstance, XrEventDataBuffer*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrApplyHapticFeedback(XrSession, const XrHapticActionInfo*, const XrHapticBaseHeader*) { return NoRuntime(); }
+XRAPI_ATTR XrResult XRAPI_CALL xrStopHapticFeedback(XrSession, const XrHapticActionInfo*) { return NoRuntime(); }
@@ -0,0 +1,18 @@
+#pragma once
+#include "pch.h"
+
+
+// Stands in for the OpenXR loader so that the code that can fall back to the runtime (RuntimeXrBackend) links without one.
+// Every entry point fails like it would without an installed runtime and counts the call, so that the tests can check that
+// nothing reached for the runtime.
+namespace FakeOpenXRLoader {
+    uint32_t GetCallCount();
+}
+
+// Same as `T value = { type };`, but without the missing-field-initializers warning that -Wextra gives for that
+template <typename T>
+T MakeXrStruct(XrStructureType type) {
+    T value = {};
+    value.type = type;
+    return value;
+}
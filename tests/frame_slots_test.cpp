@@ -0,0 +1,181 @@
+#include "test_framework.h"
+#include "utils/frame_slots.h"
+
+
+using State = FrameSlotScheduler::State;
+
+static auto Always() {
+    return [](uint32_t) { return true; };
+}
+
+TEST_CASE(SlotCountIsClamped) {
+    CHECK(FrameSlotScheduler(0).GetSlotCount() == FrameSlotScheduler::MIN_SLOTS);
+    CHECK(FrameSlotScheduler(3).GetSlotCount() == 3);
+    CHECK(FrameSlotScheduler(16).GetSlotCount() == FrameSlotScheduler::MAX_SLOTS);
+}
+
+TEST_CASE(SameCounterKeepsTheSlot) {
+    FrameSlotScheduler slots(2);
+    const auto first = slots.AcquireForGame(0);
+    const auto again = slots.AcquireForGame(0);
+    CHECK(first.slot == again.slot);
+    CHECK(!first.recycled && !again.recycled);
+    CHECK(slots.GetState(first.slot) == State::PRODUCING);
+}
+
+TEST_CASE(CounterChangeMovesToTheNextSlot) {
+    FrameSlotScheduler slots(3);
+    const auto first = slots.AcquireForGame(0);
+    const uint64_t firstSequence = slots.GetSequence(first.slot);
+    const auto second = slots.AcquireForGame(1);
+    CHECK(first.slot != second.slot);
+    CHECK(slots.GetState(first.slot) == State::COPIED);
+    CHECK(slots.GetState(second.slot) == State::PRODUCING);
+    CHECK(slots.GetSequence(second.slot) > firstSequence);
+
+    CHECK(slots.FindForGame(0) == first.slot);
+    CHECK(slots.FindForGame(1) == second.slot);
+}
+
+TEST_CASE(FindReturnsTheNewestFrameWithTheCounter) {
+    FrameSlotScheduler slots(4);
+    const auto older = slots.AcquireForGame(0);
+    slots.AcquireForGame(1);
+    const auto newer = slots.AcquireForGame(0);
+    CHECK(older.slot != newer.slot);
+    CHECK(slots.FindForGame(0) == newer.slot);
+}
+
+TEST_CASE(SubmitPicksTheOldestReadySlot) {
+    FrameSlotScheduler slots(4);
+    const auto first = slots.AcquireForGame(0);
+    const auto second = slots.AcquireForGame(1);
+    const auto third = slots.AcquireForGame(0);
+
+    // the oldest one isn't ready, so the next oldest is submitted even though a newer one is ready too
+    const auto submitted = slots.AcquireForSubmit([&](uint32_t slot) { return slot != first.slot; });
+    CHECK(submitted == second.slot);
+    CHECK(slots.GetState(second.slot) == State::SUBMITTED);
+    CHECK(slots.GetState(third.slot) == State::PRODUCING);
+
+    CHECK(slots.Release(second.slot));
+    CHECK(!slots.Release(second.slot));
+    CHECK(slots.GetState(second.slot) == State::FREE);
+    CHECK(!slots.FindForGame(1).has_value());
+}
+
+TEST_CASE(CopiedSubmitSkipsTheProducingSlot) {
+    FrameSlotScheduler slots(2);
+    const auto producing = slots.AcquireForGame(0);
+    CHECK(!slots.AcquireCopiedForSubmit(Always()).has_value());
+    CHECK(slots.GetState(producing.slot) == State::PRODUCING);
+
+    slots.AcquireForGame(1);
+    CHECK(slots.AcquireCopiedForSubmit(Always()) == producing.slot);
+}
+
+TEST_CASE(FreeSlotsAreReusedBeforeRecyclingFrames) {
+    FrameSlotScheduler slots(2);
+    const auto first = slots.AcquireForGame(0);
+    slots.AcquireForGame(1);
+    CHECK(slots.AcquireForSubmit(Always()) == first.slot);
+    CHECK(slots.Release(first.slot));
+
+    const auto third = slots.AcquireForGame(0);
+    CHECK(third.slot == first.slot);
+    CHECK(!third.recycled);
+    CHECK(slots.GetRecycledFrames() == 0);
+}
+
+TEST_CASE(OldestUnsubmittedFrameIsRecycled) {
+    FrameSlotScheduler slots(2);
+    const auto first = slots.AcquireForGame(0);
+    const auto second = slots.AcquireForGame(1);
+    const auto third = slots.AcquireForGame(0);
+    CHECK(third.slot == first.slot);
+    CHECK(third.recycled);
+    CHECK(slots.GetRecycledFrames() == 1);
+    CHECK(slots.GetState(second.slot) == State::COPIED);
+}
+
+TEST_CASE(SubmittedSlotIsNeverRecycled) {
+    FrameSlotScheduler slots(2);
+    const auto first = slots.AcquireForGame(0);
+    const auto second = slots.AcquireForGame(1);
+    CHECK(slots.AcquireForSubmit(Always()) == first.slot);
+
+    // the XR frame loop still renders the first slot, so the game can only take over the second one
+    for (uint32_t counter = 0; counter < 6; counter++) {
+        const auto acquired = slots.AcquireForGame(counter % 2);
+        CHECK(acquired.slot == second.slot);
+    }
+    CHECK(slots.GetState(first.slot) == State::SUBMITTED);
+}
+
+TEST_CASE(UpdatesOnlyReachTheFrameTheyWereRecordedFor) {
+    FrameSlotScheduler slots(2);
+    const auto first = slots.AcquireForGame(0);
+    const uint64_t sequence = slots.GetSequence(first.slot);
+
+    uint32_t updates = 0;
+    CHECK(slots.UpdateIfUnsubmitted(first.slot, sequence, [&]() { updates++; }));
+    CHECK(!slots.UpdateIfUnsubmitted(first.slot, sequence + 1, [&]() { updates++; }));
+    CHECK(!slots.UpdateIfUnsubmitted(FrameSlotScheduler::MAX_SLOTS, sequence, [&]() { updates++; }));
+
+    // recycled for a newer frame
+    slots.AcquireForGame(1);
+    slots.AcquireForGame(0);
+    CHECK(slots.GetSequence(first.slot) != sequence);
+    CHECK(!slots.UpdateIfUnsubmitted(first.slot, sequence, [&]() { updates++; }));
+
+    // submitted frames are owned by the XR frame loop
+    const uint64_t recycledSequence = slots.GetSequence(first.slot);
+    slots.AcquireForGame(1);
+    slots.AcquireForGame(0);
+    const auto submitted = slots.AcquireForSubmit(Always());
+    CHECK(submitted.has_value());
+    CHECK(!slots.UpdateIfUnsubmitted(*submitted, slots.GetSequence(*submitted), [&]() { updates++; }));
+    CHECK(recycledSequence != 0);
+    CHECK(updates == 1);
+}
+
+TEST_CASE(ConcurrentGameAndFrameLoopConsumeEveryFrameOnce) {
+    constexpr uint32_t FRAMES = 20000;
+    FrameSlotScheduler slots(3);
+    std::atomic_bool stop = false;
+    std::atomic_uint32_t submittedFrames = 0;
+    std::atomic_bool releaseFailed = false;
+
+    std::thread frameLoop([&]() {
+        while (!stop) {
+            if (const auto slot = slots.AcquireForSubmit(Always())) {
+                submittedFrames++;
+                if (!slots.Release(*slot)) {
+                    releaseFailed = true;
+                }
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    // the counter changes on every call, so each of them starts a new frame
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        slots.AcquireForGame(frame % 2);
+        if (frame % 16 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    stop = true;
+    frameLoop.join();
+
+    // every frame was either submitted, dropped for a newer one or is still waiting in its slot
+    uint32_t waitingFrames = 0;
+    for (uint32_t slot = 0; slot < slots.GetSlotCount(); slot++) {
+        const State state = slots.GetState(slot);
+        CHECK(state != State::SUBMITTED);
+        waitingFrames += (state == State::PRODUCING || state == State::COPIED) ? 1 : 0;
+    }
+    CHECK(!releaseFailed);
+    CHECK(submittedFrames > 0);
+    CHECK(submittedFrames + slots.GetRecycledFrames() + waitingFrames == FRAMES);
+}
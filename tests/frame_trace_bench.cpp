@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "utils/frame_trace.h"
+
+#include <cstdio>
+
+
+// Measures what a traced span costs the thread that records it, i.e. one Begin and one End (or a Scope), against the budget
+// of 30 ns per span that keeps tracing every hook call affordable. Also times converting a full ring to JSON, which only
+// happens when dumping but shouldn't stall the GPU thread for long either.
+// Every span reads the TSC twice, which is cheap on real hardware but can trap in a VM, so that cost is measured on its own.
+
+constexpr uint32_t SPANS = 10'000'000;
+constexpr double BUDGET_NS = 30.0;
+
+static double RunClockReads() {
+    uint64_t sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < SPANS; i++) {
+        sum += __rdtsc();
+    }
+    const double elapsed = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return sum == 0 ? 0.0 : elapsed / SPANS;
+}
+
+static double RunSpans() {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < SPANS; i++) {
+        FrameTrace::Scope scope("Span");
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / SPANS;
+}
+
+static double RunNestedSpans() {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < SPANS / 4; i++) {
+        FrameTrace::Scope outer("Outer");
+        FrameTrace::Scope middle("Middle");
+        FrameTrace::Scope inner("Inner");
+        FrameTrace::Scope innermost("Innermost");
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / SPANS;
+}
+
+int main() {
+    FrameTrace::SetThreadName("Bench");
+    const double clockRead = RunClockReads();
+    const double spans = RunSpans();
+    const double nestedSpans = RunNestedSpans();
+
+    const std::vector<FrameTrace::ThreadEvents> threads = FrameTrace::GetEvents();
+    const auto start = std::chrono::steady_clock::now();
+    const std::string json = FrameTrace::ToJson(threads, 1000.0, threads[0].events[0].ticks);
+    const double toJsonMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("__rdtsc:               %.2f ns per read\n", clockRead);
+    std::printf("Begin + End:           %.2f ns per span (%s the %.0f ns budget)\n", spans, spans <= BUDGET_NS ? "within" : "OVER", BUDGET_NS);
+    std::printf("Begin + End, nested 4: %.2f ns per span (%s the %.0f ns budget)\n", nestedSpans, nestedSpans <= BUDGET_NS ? "within" : "OVER", BUDGET_NS);
+    std::printf("without the 2 reads:   %.2f ns per span\n", spans - 2.0 * clockRead);
+    std::printf("ToJson of %zu events:  %.2f ms (%zu bytes)\n", threads[0].events.size(), toJsonMs, json.size());
+    return 0;
+}
@@ -0,0 +1,518 @@
+#include "test_framework.h"
+#include "utils/frame_trace.h"
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+
+// -----------------------------------------------------------------------
+// A strict JSON parser, so that the tests fail on anything chrome://tracing would refuse to load
+// -----------------------------------------------------------------------
+
+struct JsonValue {
+    enum class Type {
+        NUL,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    Type type = Type::NUL;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    bool Has(const std::string& key) const { return type == Type::OBJECT && object.contains(key); }
+    const JsonValue& operator[](const std::string& key) const { return object.at(key); }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text): m_text(text) {}
+
+    // returns nothing if the text isn't exactly one valid JSON value
+    std::optional<JsonValue> Parse() {
+        JsonValue value;
+        if (!ParseValue(value)) {
+            return std::nullopt;
+        }
+        SkipWhitespace();
+        if (m_pos != m_text.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+private:
+    void SkipWhitespace() {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r' || m_text[m_pos] == '\t')) {
+            m_pos++;
+        }
+    }
+
+    bool Consume(char c) {
+        SkipWhitespace();
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            m_pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool ConsumeLiteral(const char* literal) {
+        const size_t length = std::strlen(literal);
+        if (m_text.compare(m_pos, length, literal) != 0) {
+            return false;
+        }
+        m_pos += length;
+        return true;
+    }
+
+    bool ParseValue(JsonValue& value) {
+        SkipWhitespace();
+        if (m_pos >= m_text.size()) {
+            return false;
+        }
+        switch (m_text[m_pos]) {
+            case '{':
+                return ParseObject(value);
+            case '[':
+                return ParseArray(value);
+            case '"':
+                value.type = JsonValue::Type::STRING;
+                return ParseString(value.string);
+            case 't':
+                value.type = JsonValue::Type::BOOLEAN;
+                value.boolean = true;
+                return ConsumeLiteral("true");
+            case 'f':
+                value.type = JsonValue::Type::BOOLEAN;
+                return ConsumeLiteral("false");
+            case 'n':
+                return ConsumeLiteral("null");
+            default:
+                value.type = JsonValue::Type::NUMBER;
+                return ParseNumber(value.number);
+        }
+    }
+
+    bool ParseObject(JsonValue& value) {
+        value.type = JsonValue::Type::OBJECT;
+        m_pos++;
+        if (Consume('}')) {
+            return true;
+        }
+        do {
+            SkipWhitespace();
+            std::string key;
+            JsonValue member;
+            if (!ParseString(key) || !Consume(':') || !ParseValue(member)) {
+                return false;
+            }
+            // duplicate keys are technically allowed, but always a bug in the writer
+            if (!value.object.emplace(std::move(key), std::move(member)).second) {
+                return false;
+            }
+        } while (Consume(','));
+        return Consume('}');
+    }
+
+    bool ParseArray(JsonValue& value) {
+        value.type = JsonValue::Type::ARRAY;
+        m_pos++;
+        if (Consume(']')) {
+            return true;
+        }
+        do {
+            if (!ParseValue(value.array.emplace_back())) {
+                return false;
+            }
+        } while (Consume(','));
+        return Consume(']');
+    }
+
+    bool ParseString(std::string& out) {
+        if (m_pos >= m_text.size() || m_text[m_pos] != '"') {
+            return false;
+        }
+        m_pos++;
+        while (m_pos < m_text.size()) {
+            const char c = m_text[m_pos++];
+            if (c == '"') {
+                return true;
+            }
+            if ((unsigned char)c < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (m_pos >= m_text.size()) {
+                return false;
+            }
+            switch (m_text[m_pos++]) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    if (m_pos + 4 > m_text.size()) {
+                        return false;
+                    }
+                    uint32_t codePoint = 0;
+                    for (uint32_t i = 0; i < 4; i++) {
+                        const char digit = m_text[m_pos++];
+                        if (!std::isxdigit((unsigned char)digit)) {
+                            return false;
+                        }
+                        codePoint = codePoint * 16 + (uint32_t)(std::isdigit((unsigned char)digit) ? digit - '0' : std::tolower(digit) - 'a' + 10);
+                    }
+                    // the trace only escapes control characters, which are all single bytes
+                    if (codePoint >= 0x80) {
+                        return false;
+                    }
+                    out += (char)codePoint;
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool ParseNumber(double& out) {
+        // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+        const size_t start = m_pos;
+        auto digits = [&]() {
+            const size_t before = m_pos;
+            while (m_pos < m_text.size() && std::isdigit((unsigned char)m_text[m_pos])) {
+                m_pos++;
+            }
+            return m_pos - before;
+        };
+        if (m_pos < m_text.size() && m_text[m_pos] == '-') {
+            m_pos++;
+        }
+        if (m_pos < m_text.size() && m_text[m_pos] == '0') {
+            m_pos++;
+        }
+        else if (digits() == 0) {
+            return false;
+        }
+        if (m_pos < m_text.size() && m_text[m_pos] == '.') {
+            m_pos++;
+            if (digits() == 0) {
+                return false;
+            }
+        }
+        if (m_pos < m_text.size() && (m_text[m_pos] == 'e' || m_text[m_pos] == 'E')) {
+            m_pos++;
+            if (m_pos < m_text.size() && (m_text[m_pos] == '+' || m_text[m_pos] == '-')) {
+                m_pos++;
+            }
+            if (digits() == 0) {
+                return false;
+            }
+        }
+        out = std::strtod(m_text.substr(start, m_pos - start).c_str(), nullptr);
+        return true;
+    }
+
+    const std::string& m_text;
+    size_t m_pos = 0;
+};
+
+// -----------------------------------------------------------------------
+// Trace checks
+// -----------------------------------------------------------------------
+
+using EventType = FrameTrace::EventType;
+
+static std::vector<JsonValue> ParseTraceEvents(const std::string& json) {
+    std::optional<JsonValue> root = JsonParser(json).Parse();
+    CHECK(root.has_value());
+    if (!root.has_value() || !root->Has("traceEvents") || (*root)["traceEvents"].type != JsonValue::Type::ARRAY) {
+        CHECK(false);
+        return {};
+    }
+    CHECK((*root)["displayTimeUnit"].string == "ms");
+    return (*root)["traceEvents"].array;
+}
+
+// Checks the fields every event needs, and that every thread's spans nest, with each end naming the span it closes
+static bool EventsNest(const std::vector<JsonValue>& events) {
+    std::map<uint32_t, std::vector<std::string>> openSpans;
+    std::map<uint32_t, double> lastTimestamps;
+    for (const JsonValue& event : events) {
+        if (!event.Has("ph") || !event.Has("pid") || !event.Has("tid") || !event.Has("ts") || !event.Has("name")) {
+            return false;
+        }
+        const uint32_t tid = (uint32_t)event["tid"].number;
+        const std::string& phase = event["ph"].string;
+        if (phase == "M") {
+            continue;
+        }
+        // events of one thread are written in the order they were recorded
+        if (lastTimestamps.contains(tid) && event["ts"].number < lastTimestamps[tid]) {
+            return false;
+        }
+        lastTimestamps[tid] = event["ts"].number;
+
+        if (phase == "B") {
+            openSpans[tid].emplace_back(event["name"].string);
+        }
+        else if (phase == "E") {
+            if (openSpans[tid].empty() || openSpans[tid].back() != event["name"].string) {
+                return false;
+            }
+            openSpans[tid].pop_back();
+        }
+    }
+    return std::ranges::all_of(openSpans, [](const auto& thread) { return thread.second.empty(); });
+}
+
+static std::vector<std::string> Phases(const std::vector<JsonValue>& events) {
+    std::vector<std::string> phases;
+    for (const JsonValue& event : events) {
+        phases.emplace_back(event["ph"].string + ":" + event["name"].string);
+    }
+    return phases;
+}
+
+static FrameTrace::Event MakeEvent(EventType type, uint64_t ticks, const char* name = nullptr, uint64_t value = 0) {
+    return { .ticks = ticks, .name = name, .value = value, .type = type };
+}
+
+TEST_CASE(ToJsonEscapesNamesIntoValidJson) {
+    const char* const names[] = { "plain", "\"quoted\"", "back\\slash", "line\nbreak", "tab\tand\x01control", "\x1f" };
+    FrameTrace::ThreadEvents thread = { .threadId = 3, .threadName = "thread \"with\" quotes\\", .events = {} };
+    uint64_t ticks = 100;
+    for (const char* name : names) {
+        thread.events.emplace_back(MakeEvent(EventType::BEGIN, ticks++, name));
+        thread.events.emplace_back(MakeEvent(EventType::INSTANT, ticks++, name));
+        thread.events.emplace_back(MakeEvent(EventType::END, ticks++));
+    }
+    // names that weren't set shouldn't produce a null either
+    thread.events.emplace_back(MakeEvent(EventType::INSTANT, ticks++, nullptr));
+
+    const std::vector<JsonValue> events = ParseTraceEvents(FrameTrace::ToJson({ &thread, 1 }, 1.0, 100));
+    CHECK(events.size() == 1 + std::size(names) * 3 + 1);
+    CHECK(EventsNest(events));
+
+    CHECK(events[0]["ph"].string == "M");
+    CHECK(events[0]["args"]["name"].string == thread.threadName);
+    for (size_t i = 0; i < std::size(names); i++) {
+        CHECK(events[1 + i * 3]["name"].string == names[i]);
+        CHECK(events[2 + i * 3]["name"].string == names[i]);
+        CHECK(events[3 + i * 3]["name"].string == names[i]);
+    }
+    CHECK(events.back()["name"].string == "(null)");
+}
+
+TEST_CASE(ToJsonRepairsSpansCutOffByTheRing) {
+    // the ring wrapped in the middle of a span, and the trace ended while two spans were still open
+    FrameTrace::ThreadEvents thread = { .threadId = 1, .threadName = nullptr, .events = {} };
+    thread.events = {
+        MakeEvent(EventType::END, 10),
+        MakeEvent(EventType::END, 11),
+        MakeEvent(EventType::BEGIN, 12, "Outer"),
+        MakeEvent(EventType::BEGIN, 13, "Inner"),
+        MakeEvent(EventType::INSTANT, 14, "Mark"),
+        MakeEvent(EventType::END, 15),
+        MakeEvent(EventType::BEGIN, 16, "Open"),
+        MakeEvent(EventType::INSTANT, 17, "Last"),
+    };
+
+    const std::vector<JsonValue> events = ParseTraceEvents(FrameTrace::ToJson({ &thread, 1 }, 1.0, 10));
+    CHECK(EventsNest(events));
+    const std::vector<std::string> expected = { "B:Outer", "B:Inner", "i:Mark", "E:Inner", "B:Open", "i:Last", "E:Open", "E:Outer" };
+    CHECK(Phases(events) == expected);
+    // the closed spans end at the last event of their thread
+    CHECK_NEAR(events[6]["ts"].number, 7.0, 1e-9);
+    CHECK_NEAR(events[7]["ts"].number, 7.0, 1e-9);
+}
+
+TEST_CASE(ToJsonKeepsEveryThreadsSpansSeparate) {
+    // both threads open a span and close it in the other order, which only nests when looked at per thread
+    std::array<FrameTrace::ThreadEvents, 2> threads = {
+        FrameTrace::ThreadEvents{ .threadId = 1, .threadName = "A", .events = { MakeEvent(EventType::BEGIN, 1, "A1"), MakeEvent(EventType::END, 4) } },
+        FrameTrace::ThreadEvents{ .threadId = 2, .threadName = "B", .events = { MakeEvent(EventType::BEGIN, 2, "B1"), MakeEvent(EventType::BEGIN, 3, "B2"), MakeEvent(EventType::END, 5) } },
+    };
+
+    const std::vector<JsonValue> events = ParseTraceEvents(FrameTrace::ToJson(threads, 1.0, 0));
+    CHECK(EventsNest(events));
+    const std::vector<std::string> expected = { "M:thread_name", "B:A1", "E:A1", "M:thread_name", "B:B1", "B:B2", "E:B2", "E:B1" };
+    CHECK(Phases(events) == expected);
+    CHECK(events[4]["tid"].number == 2.0);
+}
+
+TEST_CASE(ToJsonWritesCountersFlowsAndTimestamps) {
+    FrameTrace::ThreadEvents thread = { .threadId = 7, .threadName = nullptr, .events = {} };
+    const double values[] = { 1.5, -2.25, 0.1, 1e300, -0.0, std::nan(""), std::numeric_limits<double>::infinity() };
+    uint64_t ticks = 1000;
+    for (double value : values) {
+        thread.events.emplace_back(MakeEvent(EventType::COUNTER, ticks, "counter", std::bit_cast<uint64_t>(value)));
+        ticks += 2500;
+    }
+    thread.events.emplace_back(MakeEvent(EventType::BEGIN, ticks, "Span"));
+    thread.events.emplace_back(MakeEvent(EventType::FLOW_START, ticks, "flow", 42));
+    thread.events.emplace_back(MakeEvent(EventType::FLOW_STEP, ticks, "flow", 42));
+    thread.events.emplace_back(MakeEvent(EventType::FLOW_END, ticks, "flow", UINT32_MAX + 1ull));
+    thread.events.emplace_back(MakeEvent(EventType::END, ticks));
+    // recorded before the trace's start, e.g. by a thread that was registered while the dump was being taken
+    thread.events.emplace_back(MakeEvent(EventType::INSTANT, 0, "early"));
+
+    const std::vector<JsonValue> events = ParseTraceEvents(FrameTrace::ToJson({ &thread, 1 }, 2.5, 1000));
+    CHECK(events.size() == std::size(values) + 6);
+
+    for (size_t i = 0; i < std::size(values); i++) {
+        CHECK(events[i]["ph"].string == "C");
+        CHECK_NEAR(events[i]["ts"].number, (double)i * 1000.0, 1e-9);
+        // counters round-trip exactly, JSON has no NaN or infinity so those become 0
+        const double expected = std::isfinite(values[i]) ? values[i] : 0.0;
+        CHECK(events[i]["args"]["value"].number == expected);
+    }
+
+    const size_t flows = std::size(values) + 1;
+    CHECK(events[flows]["ph"].string == "s");
+    CHECK(events[flows + 1]["ph"].string == "t");
+    CHECK(events[flows + 2]["ph"].string == "f");
+    CHECK(events[flows]["id"].number == 42.0);
+    CHECK(events[flows + 2]["id"].number == (double)(UINT32_MAX + 1ull));
+    CHECK(events[flows + 2]["bp"].string == "e");
+    CHECK(events[flows]["cat"].string == "flow");
+    CHECK_NEAR(events.back()["ts"].number, -400.0, 1e-9);
+}
+
+TEST_CASE(ToJsonOfNothingIsStillValid) {
+    CHECK(ParseTraceEvents(FrameTrace::ToJson({}, 1.0, 0)).empty());
+    const FrameTrace::ThreadEvents idle = { .threadId = 1, .threadName = "idle", .events = {} };
+    CHECK(ParseTraceEvents(FrameTrace::ToJson({ &idle, 1 }, 0.0, 0)).size() == 1);
+}
+
+// -----------------------------------------------------------------------
+// Recording
+// -----------------------------------------------------------------------
+
+// Every thread keeps its ring for the whole process, so the recording tests use their own threads and find them by name
+static const FrameTrace::ThreadEvents* FindThread(const std::vector<FrameTrace::ThreadEvents>& threads, const char* name) {
+    for (const FrameTrace::ThreadEvents& thread : threads) {
+        if (thread.threadName != nullptr && std::strcmp(thread.threadName, name) == 0) {
+            return &thread;
+        }
+    }
+    return nullptr;
+}
+
+static void RecordFrame(uint32_t frame) {
+    FrameTrace::Scope frameScope("Frame");
+    FrameTrace::Counter("frame", (double)frame);
+    const uint64_t flowId = FrameTrace::NewFlowId();
+    {
+        FrameTrace::Scope scope("Render");
+        FrameTrace::FlowStart("submit", flowId);
+        {
+            FrameTrace::Scope innerScope("Copy");
+            FrameTrace::Instant("copied");
+        }
+    }
+    FrameTrace::Scope scope("Present");
+    FrameTrace::FlowEnd("submit", flowId);
+}
+
+TEST_CASE(RecordedSpansNestOnEveryThread) {
+    constexpr uint32_t THREADS = 4;
+    constexpr uint32_t FRAMES = 50;
+    constexpr uint32_t EVENTS_PER_FRAME = 12;
+    const char* const names[THREADS] = { "Recorder 0", "Recorder 1", "Recorder 2", "Recorder 3" };
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            FrameTrace::SetThreadName(names[t]);
+            for (uint32_t frame = 0; frame < FRAMES; frame++) {
+                RecordFrame(frame);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    const std::vector<FrameTrace::ThreadEvents> recorded = FrameTrace::GetEvents();
+    std::vector<FrameTrace::ThreadEvents> ours;
+    for (const char* name : names) {
+        const FrameTrace::ThreadEvents* thread = FindThread(recorded, name);
+        CHECK(thread != nullptr);
+        if (thread == nullptr) {
+            return;
+        }
+        CHECK(thread->events.size() == FRAMES * EVENTS_PER_FRAME);
+        CHECK(std::ranges::is_sorted(thread->events, {}, &FrameTrace::Event::ticks));
+        ours.emplace_back(*thread);
+    }
+
+    const std::vector<JsonValue> events = ParseTraceEvents(FrameTrace::ToJson(ours, 1000.0, ours[0].events[0].ticks));
+    CHECK(events.size() == THREADS * (1 + FRAMES * EVENTS_PER_FRAME));
+    CHECK(EventsNest(events));
+}
+
+TEST_CASE(WrappedRingStillProducesNestedSpans) {
+    // enough frames to wrap the ring a few times, at a point that isn't a frame boundary
+    constexpr uint32_t FRAMES = FrameTrace::EVENTS_PER_THREAD / 12 * 3 + 5;
+    std::thread([]() {
+        FrameTrace::SetThreadName("Wrapping");
+        for (uint32_t frame = 0; frame < FRAMES; frame++) {
+            RecordFrame(frame);
+        }
+        // left open on purpose, the dump has to close them
+        FrameTrace::Begin("Frame");
+        FrameTrace::Begin("Unfinished");
+    }).join();
+
+    const std::vector<FrameTrace::ThreadEvents> recorded = FrameTrace::GetEvents();
+    const FrameTrace::ThreadEvents* thread = FindThread(recorded, "Wrapping");
+    CHECK(thread != nullptr);
+    if (thread == nullptr) {
+        return;
+    }
+    CHECK(thread->events.size() == FrameTrace::EVENTS_PER_THREAD);
+    CHECK(thread->events.back().type == EventType::BEGIN);
+
+    const std::vector<JsonValue> events = ParseTraceEvents(FrameTrace::ToJson({ thread, 1 }, 1000.0, thread->events[0].ticks));
+    CHECK(EventsNest(events));
+    CHECK(events[events.size() - 1]["name"].string == "Frame");
+    CHECK(events[events.size() - 2]["name"].string == "Unfinished");
+}
+
+TEST_CASE(DumpWritesTheRecordedThreads) {
+    std::thread([]() {
+        FrameTrace::SetThreadName("Dumped");
+        RecordFrame(0);
+    }).join();
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "bettervr_frame_trace_test.json";
+    CHECK(FrameTrace::Dump(path));
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    file.close();
+    std::filesystem::remove(path);
+
+    const std::vector<JsonValue> events = ParseTraceEvents(contents.str());
+    CHECK(EventsNest(events));
+    CHECK(std::ranges::any_of(events, [](const JsonValue& event) { return event["ph"].string == "M" && event["args"]["name"].string == "Dumped"; }));
+}
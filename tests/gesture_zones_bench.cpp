@@ -0,0 +1,88 @@
+#include "pch.h"
+#include "hooking/gesture_zones.h"
+
+#include <cstdio>
+
+
+// Classifies both hands against all zones once per input update, like hook_InjectXRInput. The baseline is the stateless
+// distance checks that calculateHandGesture did before the zones were data-driven, which had no dwell or hysteresis.
+// The hands sweep through the shoulder, mouth and waist zones while the head slowly turns.
+
+constexpr uint32_t FRAMES = 2'000'000;
+constexpr XrDuration FRAME_DURATION = 11'111'111;
+
+struct Poses {
+    glm::fmat4 headsetMtx;
+    std::array<glm::fvec3, 2> hands;
+};
+
+static Poses MakePoses(uint32_t frame) {
+    const float yaw = (float)frame * 0.002f;
+    const float sweep = (float)frame * 0.013f;
+    Poses poses;
+    poses.headsetMtx = glm::fmat4(1.0f);
+    poses.headsetMtx[0] = glm::fvec4(std::cos(yaw), 0.0f, -std::sin(yaw), 0.0f);
+    poses.headsetMtx[2] = glm::fvec4(std::sin(yaw), 0.0f, std::cos(yaw), 0.0f);
+    poses.headsetMtx[3] = glm::fvec4(0.0f, 1.6f, 0.0f, 1.0f);
+    poses.hands[0] = glm::fvec3(-0.2f + 0.1f * std::sin(sweep), 1.6f - 0.6f * (0.5f + 0.5f * std::sin(sweep * 0.7f)), 0.3f * std::cos(sweep));
+    poses.hands[1] = glm::fvec3(0.2f + 0.1f * std::cos(sweep), 1.6f - 0.6f * (0.5f + 0.5f * std::cos(sweep * 0.9f)), 0.3f * std::sin(sweep));
+    return poses;
+}
+
+static GestureZones::ZoneMask ClassifyLikeBefore(const glm::fvec3& handPos, const glm::fmat4& headsetMatrix) {
+    const glm::fvec3 headsetPos(headsetMatrix[3]);
+    glm::fvec3 headsetForward = -glm::normalize(glm::fvec3(headsetMatrix[2]));
+    headsetForward.y = 0.0f;
+    headsetForward = glm::normalize(headsetForward);
+    const glm::fvec3 headsetRight = glm::normalize(glm::fvec3(headsetMatrix[0]));
+    const glm::fvec3 headToHand = handPos - headsetPos;
+
+    const bool isBehindHead = glm::dot(headsetForward, headToHand) < 0.0f;
+    const bool isBehindHeadWithWaistOffset = glm::dot(headsetForward, glm::fvec3(headToHand.x, 0.0f, headToHand.z)) - 0.05f < 0.0f;
+    const bool isOnLeftSide = glm::dot(headsetRight, headToHand) < 0.0f;
+    const bool isCloseToHead = glm::length2(headToHand) < 0.35f * 0.35f;
+    const bool isCloseToMouth = glm::length2(headToHand) < 0.2f * 0.2f;
+    const bool isCloseToWaist = handPos.y < headsetPos.y - 0.45f;
+    const bool isNearChestHeight = handPos.y > headsetPos.y - 0.3f;
+
+    using Zone = GestureZones::Zone;
+    GestureZones::ZoneMask mask = 0;
+    mask |= isBehindHead && isCloseToHead && isOnLeftSide ? GestureZones::Bit(Zone::LEFT_SHOULDER) : 0;
+    mask |= isBehindHead && isCloseToHead && !isOnLeftSide ? GestureZones::Bit(Zone::RIGHT_SHOULDER) : 0;
+    mask |= isBehindHeadWithWaistOffset && isCloseToWaist && isOnLeftSide ? GestureZones::Bit(Zone::LEFT_WAIST) : 0;
+    mask |= isBehindHeadWithWaistOffset && isCloseToWaist && !isOnLeftSide ? GestureZones::Bit(Zone::RIGHT_WAIST) : 0;
+    mask |= isCloseToMouth && !isBehindHead ? GestureZones::Bit(Zone::MOUTH) : 0;
+    mask |= !isBehindHead && !isBehindHeadWithWaistOffset && !isCloseToMouth ? GestureZones::Bit(Zone::FRONT) : 0;
+    mask |= isNearChestHeight ? GestureZones::Bit(Zone::CHEST_HEIGHT) : 0;
+    return mask;
+}
+
+int main() {
+    std::vector<Poses> poses;
+    poses.reserve(4096);
+    for (uint32_t frame = 0; frame < 4096; frame++) {
+        poses.emplace_back(MakePoses(frame));
+    }
+
+    uint64_t beforeBits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        const Poses& pose = poses[frame % poses.size()];
+        beforeBits += std::popcount(ClassifyLikeBefore(pose.hands[0], pose.headsetMtx)) + std::popcount(ClassifyLikeBefore(pose.hands[1], pose.headsetMtx));
+    }
+    const double beforeNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+
+    GestureZones zones;
+    uint64_t zoneBits = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        const Poses& pose = poses[frame % poses.size()];
+        const auto masks = zones.Update({ pose.hands[0], pose.hands[1] }, pose.headsetMtx, (XrTime)(frame + 1) * FRAME_DURATION);
+        zoneBits += std::popcount(masks[0]) + std::popcount(masks[1]);
+    }
+    const double zonesNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+
+    std::printf("distance checks (before):  %.2f ns per update of both hands (%.2f zones active)\n", beforeNs, (double)beforeBits / FRAMES);
+    std::printf("GestureZones::Update:      %.2f ns per update of both hands (%.2f zones active)\n", zonesNs, (double)zoneBits / FRAMES);
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "test_framework.h"
+#include "hooking/gesture_zones.h"
+
+
+// Every test replaces one zone with a simple slab along X and only looks at that zone's bit, the other zones keep their
+// defaults. The headset sits at the origin looking down -Z, so the body frame matches stage space unless a test turns it.
+
+constexpr XrDuration MS = 1'000'000;
+constexpr XrTime START = 1'000 * MS;
+constexpr GestureZones::Zone ZONE = GestureZones::Zone::LEFT_WAIST;
+constexpr float SLAB_MIN = 0.1f;
+constexpr float SLAB_MAX = 0.3f;
+constexpr float HYSTERESIS = 0.05f;
+constexpr XrDuration DWELL = 20 * MS;
+
+static GestureZones MakeSlabZones(float hysteresis = HYSTERESIS, XrDuration dwell = DWELL) {
+    GestureZones zones;
+    GestureZones::ZoneShape slab;
+    slab.boxMin.x = SLAB_MIN;
+    slab.boxMax.x = SLAB_MAX;
+    slab.hysteresis = hysteresis;
+    slab.dwell = dwell;
+    zones.SetShape(ZONE, slab);
+    return zones;
+}
+
+static bool IsActive(GestureZones& zones, std::optional<float> x, XrTime time, size_t hand = 0, const glm::fmat4& headsetMtx = glm::fmat4(1.0f)) {
+    std::array<std::optional<glm::fvec3>, 2> handPositions;
+    if (x.has_value()) {
+        handPositions[hand] = glm::fvec3(*x, 0.0f, 0.0f);
+    }
+    return (zones.Update(handPositions, headsetMtx, time)[hand] & GestureZones::Bit(ZONE)) != 0;
+}
+
+TEST_CASE(ZoneOnlyActivatesAfterItsDwellTime) {
+    GestureZones zones = MakeSlabZones();
+    CHECK(!IsActive(zones, 0.2f, START));
+    CHECK(!IsActive(zones, 0.2f, START + DWELL / 2));
+    CHECK(!IsActive(zones, 0.2f, START + DWELL - 1));
+    CHECK(IsActive(zones, 0.2f, START + DWELL));
+    CHECK(IsActive(zones, 0.2f, START + DWELL * 10));
+
+    // without a dwell time the first update inside of the zone activates it
+    GestureZones instant = MakeSlabZones(HYSTERESIS, 0);
+    CHECK(IsActive(instant, 0.2f, START));
+}
+
+TEST_CASE(LeavingTheZoneRestartsTheDwell) {
+    GestureZones zones = MakeSlabZones();
+    CHECK(!IsActive(zones, 0.2f, START));
+    CHECK(!IsActive(zones, 0.2f, START + DWELL - MS));
+    // a single update outside of the zone throws away the time that was already spent in it
+    CHECK(!IsActive(zones, 0.5f, START + DWELL));
+    CHECK(!IsActive(zones, 0.2f, START + DWELL + MS));
+    CHECK(!IsActive(zones, 0.2f, START + DWELL * 2));
+    CHECK(IsActive(zones, 0.2f, START + DWELL * 2 + MS));
+
+    // losing tracking counts as leaving
+    CHECK(!IsActive(zones, std::nullopt, START + DWELL * 3));
+    CHECK(!IsActive(zones, 0.2f, START + DWELL * 4));
+    CHECK(IsActive(zones, 0.2f, START + DWELL * 5));
+
+    // and so does a reset
+    zones.Reset();
+    CHECK(!IsActive(zones, 0.2f, START + DWELL * 6));
+}
+
+TEST_CASE(ActiveZoneIsGrownByItsHysteresis) {
+    GestureZones zones = MakeSlabZones();
+    CHECK(!IsActive(zones, 0.2f, START));
+    CHECK(IsActive(zones, 0.2f, START + DWELL));
+
+    // past the box but within the margin stays active, on both sides
+    CHECK(IsActive(zones, SLAB_MAX + HYSTERESIS * 0.5f, START + DWELL + MS));
+    CHECK(IsActive(zones, SLAB_MIN - HYSTERESIS * 0.9f, START + DWELL + 2 * MS));
+    // past the margin deactivates right away, without waiting for anything
+    CHECK(!IsActive(zones, SLAB_MAX + HYSTERESIS * 1.1f, START + DWELL + 3 * MS));
+
+    // an inactive zone isn't grown, so coming back into the margin doesn't activate it no matter how long the hand stays
+    for (XrTime time = START + DWELL + 4 * MS; time < START + DWELL * 4; time += MS) {
+        CHECK(!IsActive(zones, SLAB_MAX + HYSTERESIS * 0.5f, time));
+    }
+}
+
+TEST_CASE(HoveringAtTheEdgeDoesntFlicker) {
+    // the hand shakes by a couple of centimeters around the edge of the box, which the default margins are sized for
+    auto countToggles = [](GestureZones zones) {
+        uint32_t toggles = 0;
+        bool wasActive = false;
+        XrTime time = START;
+        for (uint32_t i = 0; i < 30; i++, time += MS) {
+            wasActive = IsActive(zones, 0.2f, time);
+        }
+        CHECK(wasActive);
+        for (uint32_t i = 0; i < 200; i++, time += 11 * MS) {
+            const float jitter = (i % 3 == 0 ? 0.02f : -0.01f) * (i % 2 == 0 ? 1.0f : -1.0f);
+            const bool active = IsActive(zones, SLAB_MAX + jitter, time);
+            toggles += active != wasActive ? 1 : 0;
+            wasActive = active;
+        }
+        return toggles;
+    };
+
+    CHECK(countToggles(MakeSlabZones(HYSTERESIS, 0)) == 0);
+    CHECK(countToggles(MakeSlabZones(HYSTERESIS, DWELL)) == 0);
+    // without the margin the same motion keeps toggling the zone
+    CHECK(countToggles(MakeSlabZones(0.0f, 0)) > 50);
+    // and the dwell alone doesn't hide that, it only delays each activation
+    CHECK(countToggles(MakeSlabZones(0.0f, DWELL)) > 10);
+}
+
+TEST_CASE(HandsAreTrackedSeparately) {
+    GestureZones zones = MakeSlabZones();
+    const auto update = [&](std::optional<float> left, std::optional<float> right, XrTime time) {
+        std::array<std::optional<glm::fvec3>, 2> handPositions;
+        if (left.has_value()) {
+            handPositions[0] = glm::fvec3(*left, 0.0f, 0.0f);
+        }
+        if (right.has_value()) {
+            handPositions[1] = glm::fvec3(*right, 0.0f, 0.0f);
+        }
+        const auto masks = zones.Update(handPositions, glm::fmat4(1.0f), time);
+        return std::array<bool, 2>{ (masks[0] & GestureZones::Bit(ZONE)) != 0, (masks[1] & GestureZones::Bit(ZONE)) != 0 };
+    };
+
+    update(0.2f, std::nullopt, START);
+    update(0.2f, 0.2f, START + DWELL / 2);
+    CHECK((update(0.2f, 0.2f, START + DWELL) == std::array<bool, 2>{ true, false }));
+    CHECK((update(0.2f, 0.2f, START + DWELL + DWELL / 2) == std::array<bool, 2>{ true, true }));
+    // the right hand leaving doesn't affect the left one
+    CHECK((update(0.2f, 0.9f, START + DWELL * 2) == std::array<bool, 2>{ true, false }));
+    CHECK((update(0.2f, std::nullopt, START + DWELL * 3) == std::array<bool, 2>{ true, false }));
+}
+
+TEST_CASE(BodyFrameOnlyFollowsTheHeadsetsYaw) {
+    GestureZones zones;
+    const glm::fvec3 headsetPos = { 1.0f, 1.6f, -2.0f };
+
+    // turned 90 degrees to the left, so the body's forward is -X and its right is -Z
+    glm::fmat4 turnedLeft(1.0f);
+    turnedLeft[0] = glm::fvec4(0.0f, 0.0f, -1.0f, 0.0f);
+    turnedLeft[2] = glm::fvec4(1.0f, 0.0f, 0.0f, 0.0f);
+    turnedLeft[3] = glm::fvec4(headsetPos, 1.0f);
+    const glm::fvec3 right = zones.ToBodyFrame(headsetPos + glm::fvec3(0.0f, 0.0f, -0.2f), turnedLeft);
+    CHECK_NEAR(right.x, 0.2f, 1e-5f);
+    CHECK_NEAR(right.z, 0.0f, 1e-5f);
+    const glm::fvec3 behind = zones.ToBodyFrame(headsetPos + glm::fvec3(0.3f, -0.5f, 0.0f), turnedLeft);
+    CHECK_NEAR(behind.x, 0.0f, 1e-5f);
+    CHECK_NEAR(behind.y, -0.5f, 1e-5f);
+    CHECK_NEAR(behind.z, 0.3f, 1e-5f);
+
+    // looking straight down has no yaw, the last one is kept instead of the zones spinning around
+    glm::fmat4 lookingDown(1.0f);
+    lookingDown[1] = glm::fvec4(0.0f, 0.0f, -1.0f, 0.0f);
+    lookingDown[2] = glm::fvec4(0.0f, 1.0f, 0.0f, 0.0f);
+    lookingDown[3] = glm::fvec4(headsetPos, 1.0f);
+    const glm::fvec3 stillRight = zones.ToBodyFrame(headsetPos + glm::fvec3(0.0f, 0.0f, -0.2f), lookingDown);
+    CHECK_NEAR(stillRight.x, 0.2f, 1e-5f);
+    CHECK_NEAR(zones.GetBodyForward().x, -1.0f, 1e-5f);
+}
+
+TEST_CASE(CapsuleMarginGrowsItsRadius) {
+    GestureZones::ZoneShape sphere;
+    sphere.capsuleRadius = 0.2f;
+    sphere.hysteresis = 0.05f;
+    CHECK(GestureZones::IsInside(sphere, { 0.19f, 0.0f, 0.0f }, 0.0f));
+    CHECK(!GestureZones::IsInside(sphere, { 0.22f, 0.0f, 0.0f }, 0.0f));
+    CHECK(GestureZones::IsInside(sphere, { 0.22f, 0.0f, 0.0f }, sphere.hysteresis));
+    CHECK(!GestureZones::IsInside(sphere, { 0.26f, 0.0f, 0.0f }, sphere.hysteresis));
+
+    // the box still clips the capsule, grown by the same margin
+    sphere.boxMax.z = 0.0f;
+    CHECK(!GestureZones::IsInside(sphere, { 0.0f, 0.0f, 0.1f }, 0.0f));
+    CHECK(GestureZones::IsInside(sphere, { 0.0f, 0.0f, 0.04f }, sphere.hysteresis));
+}
@@ -0,0 +1,116 @@
+#include "test_framework.h"
+#include "utils/gpu_timestamps.h"
+
+
+// Stands in for the query pool, a query only becomes readable once the fake GPU wrote its timestamp
+struct FakeQueries {
+    std::vector<std::optional<uint64_t>> ticks;
+    std::vector<uint32_t> reads;
+
+    explicit FakeQueries(uint32_t count): ticks(count) {}
+
+    void WriteRange(uint32_t firstQuery, uint64_t begin, uint64_t end) {
+        ticks[firstQuery] = begin;
+        ticks[firstQuery + 1] = end;
+    }
+
+    GpuTimestampRing::ReadQueries Reader() {
+        return [this](uint32_t firstQuery, uint32_t queryCount, uint64_t* out) {
+            reads.push_back(firstQuery);
+            for (uint32_t i = 0; i < queryCount; ++i) {
+                if (!ticks[firstQuery + i]) {
+                    return false;
+                }
+                out[i] = *ticks[firstQuery + i];
+            }
+            return true;
+        };
+    }
+};
+
+// one tick per microsecond keeps the expected milliseconds readable
+constexpr GpuTimestampRing::Calibration MICROSECOND_TICKS = { .nanosecondsPerTick = 1000.0, .validBits = 64 };
+
+TEST_CASE(EveryFrameHasItsOwnQueries) {
+    GpuTimestampRing ring(3, 4, MICROSECOND_TICKS);
+    CHECK(ring.GetQueryCount() == 3 * 2 * 4);
+
+    CHECK(ring.BeginRange(0) == 0);
+    CHECK(ring.BeginRange(2) == 4);
+    CHECK(ring.BeginRange(1) == 2);
+    // the range repeats, so the next frame starts
+    CHECK(ring.BeginRange(0) == 6);
+    CHECK(ring.BeginRange(1) == 8);
+
+    CHECK_THROWS(ring.BeginRange(3));
+}
+
+TEST_CASE(FrameCountIsClamped) {
+    GpuTimestampRing ring(1, 0, MICROSECOND_TICKS);
+    CHECK(ring.GetQueryCount() == 2 * 2);
+}
+
+TEST_CASE(OnlyClosedFramesAreResolved) {
+    GpuTimestampRing ring(2, 4, MICROSECOND_TICKS);
+    FakeQueries queries(ring.GetQueryCount());
+
+    const uint32_t first = ring.BeginRange(0);
+    queries.WriteRange(first, 1000, 3000);
+    ring.Resolve(queries.Reader());
+    // the frame is still recorded into, even if its queries were written already
+    CHECK(queries.reads.empty());
+    CHECK(ring.GetLastMs(0) == 0.0);
+
+    ring.BeginRange(0);
+    ring.Resolve(queries.Reader());
+    CHECK(queries.reads.size() == 1 && queries.reads[0] == first);
+    CHECK_NEAR(ring.GetLastMs(0), 2.0, 1e-9);
+    CHECK_NEAR(ring.GetAverageMs(0), 2.0, 1e-9);
+    CHECK(ring.GetLastMs(1) == 0.0);
+    CHECK(ring.GetResolvedFrames() == 1);
+}
+
+TEST_CASE(UnavailableQueriesStopTheResolve) {
+    GpuTimestampRing ring(1, 4, MICROSECOND_TICKS);
+    FakeQueries queries(ring.GetQueryCount());
+
+    const uint32_t first = ring.BeginRange(0);
+    const uint32_t second = ring.BeginRange(0);
+    ring.BeginRange(0);
+
+    // the newer frame finished, but frames are resolved in order so it waits for the older one
+    queries.WriteRange(second, 0, 4000);
+    ring.Resolve(queries.Reader());
+    CHECK(queries.reads.size() == 1 && queries.reads[0] == first);
+    CHECK(ring.GetResolvedFrames() == 0);
+
+    queries.WriteRange(first, 0, 2000);
+    ring.Resolve(queries.Reader());
+    CHECK(ring.GetResolvedFrames() == 2);
+    CHECK_NEAR(ring.GetLastMs(0), 4.0, 1e-9);
+    // the average starts at the first result and then moves a tenth of the way towards every new one
+    CHECK_NEAR(ring.GetAverageMs(0), 2.2, 1e-9);
+}
+
+TEST_CASE(UnresolvedFramesAreDroppedWhenTheRingWraps) {
+    GpuTimestampRing ring(1, 2, MICROSECOND_TICKS);
+    FakeQueries queries(ring.GetQueryCount());
+
+    const uint32_t first = ring.BeginRange(0);
+    ring.BeginRange(0);
+    CHECK(ring.GetDroppedFrames() == 0);
+    // the first frame was never resolved, so its queries are handed out again
+    CHECK(ring.BeginRange(0) == first);
+    CHECK(ring.GetDroppedFrames() == 1);
+
+    queries.WriteRange(first, 0, 1000);
+    ring.Resolve(queries.Reader());
+    CHECK(ring.GetResolvedFrames() == 0);
+}
+
+TEST_CASE(TicksWrapAroundAtTheValidBits) {
+    const GpuTimestampRing::Calibration calibration = { .nanosecondsPerTick = 1000.0, .validBits = 32 };
+    CHECK_NEAR(GpuTimestampRing::TicksToMs(0xFFFFFFF0ull, 0x10ull, calibration), 0.032, 1e-9);
+    CHECK_NEAR(GpuTimestampRing::TicksToMs(100, 1100, MICROSECOND_TICKS), 1.0, 1e-9);
+    CHECK_NEAR(GpuTimestampRing::TicksToMs(~0ull, 999, MICROSECOND_TICKS), 1.0, 1e-9);
+}
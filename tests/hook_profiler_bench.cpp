@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "utils/hook_profiler.h"
+
+#include <cstdio>
+
+
+// Compares calling a hook directly, which is what Wrap returns when the profiler is disabled, with calling it through the
+// profiler's trampoline. The hook itself does next to nothing, so the difference is the profiler's overhead per call.
+
+constexpr uint32_t CALLS = 10'000'000;
+constexpr uint32_t CALLS_PER_FRAME = 2000; // roughly the number of hook calls per game frame
+
+static uint64_t s_sink = 0;
+static void Hook(PPCInterpreter_t* hCPU) {
+    s_sink += (uintptr_t)hCPU;
+}
+
+static double Run(HookProfiler::HookFunction function, bool endFrames) {
+    // called through a volatile pointer so that the direct call can't be inlined either
+    volatile HookProfiler::HookFunction hook = function;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < CALLS; i++) {
+        hook((PPCInterpreter_t*)(uintptr_t)(i & 1));
+        if (endFrames && i % CALLS_PER_FRAME == CALLS_PER_FRAME - 1) {
+            HookProfiler::EndFrame();
+        }
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / CALLS;
+}
+
+int main() {
+    const HookProfiler::HookFunction wrapped = HookProfiler::Wrap<Hook>("Hook");
+
+    const double disabled = Run(&Hook, false);
+    const double enabled = Run(wrapped, false);
+    const double enabledWithMerge = Run(wrapped, true);
+
+    std::printf("disabled (direct call):          %.2f ns per call\n", disabled);
+    std::printf("enabled (trampoline):            %.2f ns per call\n", enabled);
+    std::printf("enabled + EndFrame every %u:   %.2f ns per call (sink %llu)\n", CALLS_PER_FRAME, enabledWithMerge, (unsigned long long)s_sink);
+    return 0;
+}
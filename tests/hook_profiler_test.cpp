@@ -0,0 +1,184 @@
+#include "test_framework.h"
+#include "utils/hook_profiler.h"
+
+#include <barrier>
+
+
+// The profiler's statistics are global, so every test wraps its own hooks and looks them up by name.
+// Wrapping a hook again registers it again, the trampoline then records into the latest index.
+
+static uint32_t FindHook(const HookProfiler::Snapshot& snapshot, const char* name) {
+    for (uint32_t i = snapshot.hookCount; i > 0; i--) {
+        if (std::strcmp(snapshot.names[i - 1], name) == 0) {
+            return i - 1;
+        }
+    }
+    return UINT32_MAX;
+}
+
+static std::atomic_uint32_t s_countedCalls = 0;
+static void CountingHook(PPCInterpreter_t* hCPU) {
+    s_countedCalls++;
+}
+
+static void OtherHook(PPCInterpreter_t* hCPU) {
+}
+
+static void AllocatingHook(PPCInterpreter_t* hCPU) {
+    HookProfiler::OnAllocation();
+    HookProfiler::OnAllocation();
+}
+
+static void SpinningHook(PPCInterpreter_t* hCPU) {
+    // spins for longer with every call, so that the last call of a frame is the slowest one
+    static uint32_t s_spins = 0;
+    s_spins += 2000;
+    volatile uint32_t sink = 0;
+    for (uint32_t i = 0; i < s_spins; i++) {
+        sink = sink + i;
+    }
+}
+
+static void ThreadedHook(PPCInterpreter_t* hCPU) {
+}
+
+TEST_CASE(WrapReturnsATrampolineThatCallsTheHook) {
+    constexpr const char* NAME = "CountingHook";
+    const HookProfiler::HookFunction wrapped = HookProfiler::Wrap<CountingHook>(NAME);
+    CHECK(wrapped != &CountingHook);
+
+    const uint32_t before = s_countedCalls;
+    wrapped(nullptr);
+    wrapped(nullptr);
+    CHECK(s_countedCalls == before + 2);
+    CHECK(FindHook(HookProfiler::GetSnapshot(), NAME) != UINT32_MAX);
+}
+
+TEST_CASE(EndFrameAggregatesTheCallsOfEachHook) {
+    constexpr const char* COUNTING = "CountingHook";
+    constexpr const char* OTHER = "OtherHook";
+    const HookProfiler::HookFunction counting = HookProfiler::Wrap<CountingHook>(COUNTING);
+    const HookProfiler::HookFunction other = HookProfiler::Wrap<OtherHook>(OTHER);
+    HookProfiler::EndFrame();
+
+    for (uint32_t i = 0; i < 5; i++) {
+        counting(nullptr);
+    }
+    other(nullptr);
+    HookProfiler::EndFrame();
+
+    const HookProfiler::Snapshot snapshot = HookProfiler::GetSnapshot();
+    const HookProfiler::HookStats& countingStats = snapshot.lastFrame[FindHook(snapshot, COUNTING)];
+    const HookProfiler::HookStats& otherStats = snapshot.lastFrame[FindHook(snapshot, OTHER)];
+    CHECK(countingStats.calls == 5);
+    CHECK(otherStats.calls == 1);
+    CHECK(countingStats.maxTicks <= countingStats.totalTicks);
+    CHECK(countingStats.maxTicks * 5 >= countingStats.totalTicks);
+}
+
+TEST_CASE(PerFrameStatsResetButTotalsKeepGrowing) {
+    constexpr const char* NAME = "SpinningHook";
+    const HookProfiler::HookFunction spinning = HookProfiler::Wrap<SpinningHook>(NAME);
+    HookProfiler::EndFrame();
+    const HookProfiler::Snapshot start = HookProfiler::GetSnapshot();
+    const uint32_t index = FindHook(start, NAME);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        spinning(nullptr);
+    }
+    HookProfiler::EndFrame();
+    const HookProfiler::Snapshot busy = HookProfiler::GetSnapshot();
+    CHECK(busy.lastFrame[index].calls == 3);
+    CHECK(busy.lastFrame[index].maxTicks > 0);
+    CHECK(busy.totals[index].calls == start.totals[index].calls + 3);
+    CHECK(busy.frameCount == start.frameCount + 1);
+
+    // a frame without calls reports nothing, including the max that's the only counter getting reset on the threads
+    HookProfiler::EndFrame();
+    const HookProfiler::Snapshot idle = HookProfiler::GetSnapshot();
+    CHECK(idle.lastFrame[index].calls == 0);
+    CHECK(idle.lastFrame[index].totalTicks == 0);
+    CHECK(idle.lastFrame[index].maxTicks == 0);
+    CHECK(idle.totals[index].calls == busy.totals[index].calls);
+    CHECK(idle.totals[index].totalTicks == busy.totals[index].totalTicks);
+
+    // the max of a frame only looks at the calls of that frame, even though earlier frames had slower calls
+    spinning(nullptr);
+    HookProfiler::EndFrame();
+    const HookProfiler::Snapshot single = HookProfiler::GetSnapshot();
+    CHECK(single.lastFrame[index].calls == 1);
+    CHECK(single.lastFrame[index].maxTicks == single.lastFrame[index].totalTicks);
+    CHECK(single.totals[index].maxTicks >= single.lastFrame[index].maxTicks);
+}
+
+TEST_CASE(AllocationsAreBlamedOnTheHookThatMadeThem) {
+    constexpr const char* NAME = "AllocatingHook";
+    const HookProfiler::HookFunction allocating = HookProfiler::Wrap<AllocatingHook>(NAME);
+    HookProfiler::EndFrame();
+
+    allocating(nullptr);
+    allocating(nullptr);
+    // allocations outside of a hook aren't blamed on anything
+    HookProfiler::OnAllocation();
+    HookProfiler::EndFrame();
+
+    const HookProfiler::Snapshot snapshot = HookProfiler::GetSnapshot();
+    CHECK(snapshot.lastFrame[FindHook(snapshot, NAME)].allocations == 4);
+}
+
+TEST_CASE(CallsFromSeveralThreadsAreMergedIntoOneFrame) {
+    constexpr const char* NAME = "ThreadedHook";
+    constexpr uint32_t THREADS = 4;
+    constexpr uint32_t CALLS = 1000;
+    constexpr uint32_t FRAMES = 3;
+    const HookProfiler::HookFunction threaded = HookProfiler::Wrap<ThreadedHook>(NAME);
+    HookProfiler::EndFrame();
+    const uint32_t index = FindHook(HookProfiler::GetSnapshot(), NAME);
+
+    // the threads keep running between frames, only the barrier makes sure a frame's calls are done before merging it
+    std::vector<uint64_t> callsPerFrame;
+    std::barrier frameDone(THREADS + 1, []() noexcept {});
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&]() {
+            for (uint32_t frame = 0; frame < FRAMES; frame++) {
+                for (uint32_t i = 0; i < CALLS; i++) {
+                    threaded(nullptr);
+                }
+                frameDone.arrive_and_wait();
+                frameDone.arrive_and_wait();
+            }
+        });
+    }
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        frameDone.arrive_and_wait();
+        HookProfiler::EndFrame();
+        callsPerFrame.emplace_back(HookProfiler::GetSnapshot().lastFrame[index].calls);
+        frameDone.arrive_and_wait();
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (uint64_t calls : callsPerFrame) {
+        CHECK(calls == THREADS * CALLS);
+    }
+    CHECK(HookProfiler::GetSnapshot().totals[index].calls == THREADS * CALLS * FRAMES);
+}
+
+TEST_CASE(AccumulateOnlyAddsTheOverlappingHooks) {
+    std::array<HookProfiler::HookStats, 2> totals = { HookProfiler::HookStats{ .calls = 1, .totalTicks = 10, .maxTicks = 10, .allocations = 1 } };
+    const std::array<HookProfiler::HookStats, 3> frame = {
+        HookProfiler::HookStats{ .calls = 2, .totalTicks = 6, .maxTicks = 4, .allocations = 0 },
+        HookProfiler::HookStats{ .calls = 1, .totalTicks = 5, .maxTicks = 5, .allocations = 2 },
+        HookProfiler::HookStats{ .calls = 9, .totalTicks = 9, .maxTicks = 9, .allocations = 9 },
+    };
+    HookProfiler::Accumulate(totals, frame);
+    CHECK(totals[0].calls == 3);
+    CHECK(totals[0].totalTicks == 16);
+    CHECK(totals[0].maxTicks == 10);
+    CHECK(totals[0].allocations == 1);
+    CHECK(totals[1].calls == 1);
+    CHECK(totals[1].maxTicks == 5);
+    CHECK(totals[1].allocations == 2);
+}
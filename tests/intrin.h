@@ -0,0 +1,4 @@
+#pragma once
+
+// Stand-in for MSVC's <intrin.h>, the utilities only use __rdtsc from it
+#include <x86intrin.h>
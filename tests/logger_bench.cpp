@@ -0,0 +1,41 @@
+#include "pch.h"
+
+#include <cstdio>
+
+
+// Compares a log line of a disabled category written with Log::print, which still builds its arguments, with the same line
+// written with LOG_LAZY. The argument is a name that's copied out of (fake) guest memory, like the weapon hooks do.
+
+constexpr uint32_t CALLS = 10'000'000;
+
+static const char s_guestName[] = "Weapon_Sword_070 (Master Sword)";
+static volatile uint32_t s_nameLength = sizeof(s_guestName) - 1;
+
+static std::string ReadActorName() {
+    return std::string(s_guestName, s_nameLength);
+}
+
+template <bool LAZY>
+static double Run() {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < CALLS; i++) {
+        if constexpr (LAZY) {
+            LOG_LAZY(CONTROLS, "{} is dropping weapon with idx={}", ReadActorName(), i);
+        }
+        else {
+            Log::print<CONTROLS>("{} is dropping weapon with idx={}", ReadActorName(), i);
+        }
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / CALLS;
+}
+
+int main() {
+    Log::setEnabledMask(Log::getTypeBit(INFO));
+
+    const double eager = Run<false>();
+    const double lazy = Run<true>();
+
+    std::printf("disabled category, Log::print: %.2f ns per line\n", eager);
+    std::printf("disabled category, LOG_LAZY:   %.2f ns per line\n", lazy);
+    return Log::printedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#include "test_framework.h"
+
+
+// The enabled mask is global, so every test puts the default back when it's done
+struct ScopedEnabledMask {
+    explicit ScopedEnabledMask(uint32_t mask) { Log::setEnabledMask(mask); }
+    ~ScopedEnabledMask() { Log::setEnabledMask(Log::getDefaultEnabledMask()); }
+};
+
+static uint32_t s_evaluations = 0;
+
+// stands in for the guest memory reads and string building that the hooks do for their log lines
+static std::string ReadActorName() {
+    s_evaluations++;
+    return "Weapon_Sword_070 (Master Sword)";
+}
+
+TEST_CASE(LazyLogSkipsTheArgumentsOfDisabledCategories) {
+    ScopedEnabledMask mask(Log::getTypeBit(INFO));
+    s_evaluations = 0;
+    const uint32_t printed = Log::printedCount;
+
+    LOG_LAZY(CONTROLS, "{} is dropping weapon {}", ReadActorName(), 3);
+    CHECK(s_evaluations == 0);
+    CHECK(Log::printedCount == printed);
+
+    // the plain print still evaluates its arguments, it only skips formatting them
+    Log::print<CONTROLS>("{} is dropping weapon {}", ReadActorName(), 3);
+    CHECK(s_evaluations == 1);
+    CHECK(Log::printedCount == printed);
+
+    // once the category is enabled the arguments are evaluated exactly once
+    Log::setEnabledMask(Log::getTypeBit(INFO) | Log::getTypeBit(CONTROLS));
+    LOG_LAZY(CONTROLS, "{} is dropping weapon {}", ReadActorName(), 3);
+    CHECK(s_evaluations == 2);
+    CHECK(Log::printedCount == printed + 1);
+
+    // other categories stay filtered
+    LOG_LAZY(RENDERING, "{}", ReadActorName());
+    CHECK(s_evaluations == 2);
+    CHECK(Log::printedCount == printed + 1);
+}
+
+#if defined(__cpp_lib_format)
+struct CountedName {
+    static inline uint32_t formatted = 0;
+};
+
+template <>
+struct std::formatter<CountedName> : std::formatter<std::string> {
+    auto format(const CountedName&, std::format_context& ctx) const {
+        CountedName::formatted++;
+        return std::format_to(ctx.out(), "name");
+    }
+};
+
+TEST_CASE(DisabledCategoriesAreNeverFormatted) {
+    ScopedEnabledMask mask(Log::getTypeBit(INFO));
+    CountedName::formatted = 0;
+
+    LOG_LAZY(PPC, "{}", CountedName{});
+    Log::print<PPC>("{}", CountedName{});
+    CHECK(CountedName::formatted == 0);
+
+    LOG_LAZY(INFO, "{}", CountedName{});
+    CHECK(CountedName::formatted == 1);
+}
+#endif
+
+TEST_CASE(LazyLogIsASingleStatement) {
+    ScopedEnabledMask mask(Log::getTypeBit(CONTROLS));
+    s_evaluations = 0;
+
+    // has to work as the body of an if/else without braces
+    const bool condition = false;
+    if (condition)
+        LOG_LAZY(CONTROLS, "{}", ReadActorName());
+    else
+        LOG_LAZY(CONTROLS, "{} {}", ReadActorName(), ReadActorName());
+    CHECK(s_evaluations == 2);
+}
+
+TEST_CASE(ErrorsCantBeDisabled) {
+    ScopedEnabledMask mask(0);
+    CHECK(Log::isEnabled<ERROR>());
+    CHECK(!Log::isEnabled<WARNING>());
+    CHECK(Log::getEnabledMask() == Log::getTypeBit(ERROR));
+
+    s_evaluations = 0;
+    LOG_LAZY(ERROR, "{}", ReadActorName());
+    CHECK(s_evaluations == 1);
+}
+
+TEST_CASE(CompiledOutCategoriesIgnoreTheMask) {
+    ScopedEnabledMask mask(UINT32_MAX);
+    static_assert(!Log::isLogTypeEnabled<XR_DEBUGUTILS>());
+    CHECK(!Log::isEnabled<XR_DEBUGUTILS>());
+    CHECK(Log::isEnabled<RENDERING>());
+    CHECK(Log::isEnabled<VERBOSE>());
+
+    s_evaluations = 0;
+    LOG_LAZY(XR_DEBUGUTILS, "{}", ReadActorName());
+    CHECK(s_evaluations == 0);
+}
+
+TEST_CASE(DefaultMaskOnlyShowsTheGenericCategories) {
+    const uint32_t mask = Log::getDefaultEnabledMask();
+    CHECK((mask & Log::getTypeBit(ERROR)) != 0);
+    CHECK((mask & Log::getTypeBit(WARNING)) != 0);
+    CHECK((mask & Log::getTypeBit(INFO)) != 0);
+    CHECK((mask & Log::getTypeBit(RENDERING)) == 0);
+    CHECK((mask & Log::getTypeBit(CONTROLS)) == 0);
+    CHECK((mask & Log::getTypeBit(PPC)) == 0);
+    CHECK(std::strcmp(Log::getTypeName(CONTROLS), "Controls") == 0);
+}
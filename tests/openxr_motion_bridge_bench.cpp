@@ -0,0 +1,45 @@
+#include "pch.h"
+#include "hooking/openxr_motion_bridge.h"
+
+#include <cstdio>
+
+
+// Feeds a controller that keeps turning and swinging into the bridge at the poll rates the game runs at. The bridge runs one
+// fixed step per 5 ms in between the samples, so the cost per sample grows with the poll interval while the cost per step
+// should stay flat.
+
+constexpr uint32_t SAMPLES = 2'000'000;
+
+static double Run(XrDuration interval, double& nsPerStep, float& sink) {
+    OpenXRMotionBridge bridge;
+    const glm::fvec3 axis = glm::normalize(glm::fvec3(0.3f, 1.0f, 0.2f));
+    XrTime time = 1'000'000'000;
+    const XrTime start = time;
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        const float t = (float)i * 0.01f;
+        const WiiUMotionData motion = bridge.AddSample(time, glm::angleAxis(t, axis), glm::fvec3(std::sin(t), 0.0f, std::cos(t)));
+        sink += motion.gyro.x + motion.acc.y + motion.jerk;
+        time += interval;
+    }
+    const double elapsed = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+    nsPerStep = elapsed / (double)((time - interval - start) / OpenXRMotionBridge::STEP_NS);
+    return elapsed / SAMPLES;
+}
+
+int main() {
+    float sink = 0.0f;
+    const std::pair<const char*, XrDuration> rates[] = {
+        { "90 Hz", 11'111'111 },
+        { "30 Hz", 33'333'333 },
+        { "20 Hz", 50'000'000 },
+    };
+    for (const auto& [name, interval] : rates) {
+        double nsPerStep = 0.0;
+        const double nsPerSample = Run(interval, nsPerStep, sink);
+        std::printf("%s polling: %.2f ns per sample, %.2f ns per fixed step\n", name, nsPerSample, nsPerStep);
+    }
+    std::printf("(sink %f)\n", sink);
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "test_framework.h"
+#include "hooking/openxr_motion_bridge.h"
+
+#include <random>
+
+
+// Property tests for the fixed-step resampling: whatever the poll interval, a still controller reads as still and a steady
+// rotation reads as the same angular velocity.
+
+constexpr XrDuration MS = 1'000'000;
+constexpr uint32_t SEEDS = 50;
+
+static glm::fquat RandomOrientation(std::mt19937& rng) {
+    std::normal_distribution<float> normal;
+    return glm::normalize(glm::fquat(normal(rng), normal(rng), normal(rng), normal(rng)));
+}
+
+static glm::fvec3 RandomAxis(std::mt19937& rng) {
+    std::normal_distribution<float> normal;
+    return glm::normalize(glm::fvec3(normal(rng), normal(rng), normal(rng)));
+}
+
+// Poll intervals of a game that targets 30 fps but stutters, from 1 ms up to 45 ms
+static XrDuration JitteredInterval(std::mt19937& rng) {
+    return std::uniform_int_distribution<XrDuration>(1 * MS, 45 * MS)(rng);
+}
+
+// the bridge's gyro output flips Y and Z, see GetOutput
+static glm::fvec3 ToOutputGyro(const glm::fvec3& bodyAngularVelocity) {
+    return { bodyAngularVelocity.x, -bodyAngularVelocity.y, -bodyAngularVelocity.z };
+}
+
+TEST_CASE(ConstantOrientationHasNoAngularVelocity) {
+    for (uint32_t seed = 0; seed < SEEDS; seed++) {
+        std::mt19937 rng(seed);
+        const glm::fquat orientation = RandomOrientation(rng);
+        OpenXRMotionBridge bridge;
+
+        XrTime time = 1'000'000'000;
+        for (uint32_t i = 0; i < 200; i++) {
+            // the runtime may hand out either sign of the same rotation
+            const glm::fquat sample = (i % 3 == 0) ? -orientation : orientation;
+            const WiiUMotionData motion = bridge.AddSample(time, sample, glm::fvec3(0.0f));
+            CHECK(glm::length(motion.gyro) < 1e-3f);
+            CHECK(motion.jerk < 1e-4f);
+
+            // only gravity is left, in the controller's frame
+            const glm::fvec3 gravity = glm::inverse(orientation) * OpenXRMotionBridge::GRAVITY;
+            CHECK_NEAR(motion.acc.x, -gravity.x, 1e-3);
+            CHECK_NEAR(motion.acc.y, gravity.y, 1e-3);
+            CHECK_NEAR(motion.acc.z, gravity.z, 1e-3);
+            time += JitteredInterval(rng);
+        }
+    }
+}
+
+TEST_CASE(StepsStayOnTheFixedGridUnderJitter) {
+    for (uint32_t seed = 0; seed < SEEDS; seed++) {
+        std::mt19937 rng(seed);
+        OpenXRMotionBridge bridge;
+
+        const XrTime start = 1'000'000'000 + seed * 12345;
+        XrTime time = start;
+        for (uint32_t i = 0; i < 500; i++) {
+            bridge.AddSample(time, RandomOrientation(rng), glm::fvec3(0.0f));
+            const XrTime stepTime = bridge.GetStepTime();
+            // the steps trail the newest sample by less than one step, and never drift off the grid they started on
+            CHECK(stepTime <= time);
+            CHECK(time - stepTime < OpenXRMotionBridge::STEP_NS);
+            CHECK((stepTime - start) % OpenXRMotionBridge::STEP_NS == 0);
+            time += JitteredInterval(rng);
+        }
+    }
+}
+
+TEST_CASE(SteadyRotationReadsTheSameUnderJitter) {
+    for (uint32_t seed = 0; seed < SEEDS; seed++) {
+        std::mt19937 rng(seed);
+        const glm::fquat start = RandomOrientation(rng);
+        const glm::fvec3 axis = RandomAxis(rng);
+        const float speed = std::uniform_real_distribution<float>(0.5f, 10.0f)(rng); // radians per second
+        const glm::fvec3 expected = ToOutputGyro(axis * speed);
+
+        // rotating around an axis of the controller itself, so the body space angular velocity is constant
+        auto orientationAt = [&](XrTime elapsed) {
+            return start * glm::angleAxis(speed * (float)((double)elapsed * 1e-9), axis);
+        };
+
+        OpenXRMotionBridge regular;
+        OpenXRMotionBridge jittered;
+        const XrTime base = 1'000'000'000;
+        XrTime regularTime = 0;
+        XrTime jitteredTime = 0;
+        float worstError = 0.0f;
+        for (uint32_t i = 0; i < 300; i++) {
+            const WiiUMotionData regularMotion = regular.AddSample(base + regularTime, orientationAt(regularTime), glm::fvec3(0.0f));
+            const WiiUMotionData jitteredMotion = jittered.AddSample(base + jitteredTime, orientationAt(jitteredTime), glm::fvec3(0.0f));
+            // the first sample restarts and the first interval may be shorter than a step
+            if (regularTime >= 2 * OpenXRMotionBridge::STEP_NS && jitteredTime >= 2 * OpenXRMotionBridge::STEP_NS) {
+                worstError = std::max(worstError, glm::length(regularMotion.gyro - expected));
+                worstError = std::max(worstError, glm::length(jitteredMotion.gyro - expected));
+            }
+            regularTime += 11 * MS;
+            jitteredTime += JitteredInterval(rng);
+        }
+        // slerping between the samples of a steady rotation reproduces it, so only float rounding is left
+        CHECK(worstError < 0.01f * speed + 1e-3f);
+    }
+}
+
+TEST_CASE(ConstantVelocityOnlyReadsGravity) {
+    std::mt19937 rng(7);
+    const glm::fquat orientation = RandomOrientation(rng);
+    const glm::fvec3 velocity = { 1.0f, -2.0f, 0.5f };
+    OpenXRMotionBridge bridge;
+
+    XrTime time = 1'000'000'000;
+    WiiUMotionData motion = {};
+    for (uint32_t i = 0; i < 100; i++) {
+        motion = bridge.AddSample(time, orientation, velocity);
+        time += JitteredInterval(rng);
+    }
+    CHECK_NEAR(glm::length(motion.acc), 9.81, 1e-3);
+}
+
+TEST_CASE(OrientationKeepsGrowingPastAFullTurn) {
+    // two full turns around the world's up axis, the angles mustn't wrap back around like the Euler angles they come from
+    OpenXRMotionBridge bridge;
+    const glm::fvec3 up = { 0.0f, 1.0f, 0.0f };
+    glm::fvec3 first = {};
+    glm::fvec3 previous = {};
+    for (uint32_t i = 0; i <= 400; i++) {
+        const float angle = glm::two_pi<float>() * 2.0f * (float)i / 400.0f;
+        const glm::fvec3 orientation = bridge.AddSample(1'000'000'000 + i * 10 * MS, glm::angleAxis(angle, up), glm::fvec3(0.0f)).orientation;
+        if (i == 0) {
+            first = orientation;
+        }
+        else {
+            CHECK(glm::length(orientation - previous) < 0.01f);
+        }
+        previous = orientation;
+    }
+    // in revolutions
+    CHECK_NEAR(glm::length(previous - first), 2.0, 1e-3);
+}
+
+TEST_CASE(GapsAndTimeGoingBackwardsRestart) {
+    const glm::fvec3 axis = { 0.0f, 0.0f, 1.0f };
+    OpenXRMotionBridge bridge;
+    bridge.AddSample(1'000'000'000, glm::identity<glm::fquat>(), glm::fvec3(0.0f));
+    WiiUMotionData motion = bridge.AddSample(1'000'000'000 + 10 * MS, glm::angleAxis(0.1f, axis), glm::fvec3(0.0f));
+    CHECK(glm::length(motion.gyro) > 1.0f);
+
+    // a long tracking loss isn't integrated across, even though the controller turned in between
+    const XrTime afterGap = 1'000'000'000 + 10 * MS + OpenXRMotionBridge::MAX_GAP_NS + 1;
+    motion = bridge.AddSample(afterGap, glm::angleAxis(2.0f, axis), glm::fvec3(0.0f));
+    CHECK(glm::length(motion.gyro) == 0.0f);
+    CHECK(bridge.GetStepTime() == afterGap);
+
+    motion = bridge.AddSample(afterGap - MS, glm::angleAxis(2.5f, axis), glm::fvec3(0.0f));
+    CHECK(glm::length(motion.gyro) == 0.0f);
+    CHECK(bridge.GetStepTime() == afterGap - MS);
+
+    // and neither is a reset
+    bridge.Reset();
+    motion = bridge.AddSample(afterGap, glm::angleAxis(3.0f, axis), glm::fvec3(0.0f));
+    CHECK(glm::length(motion.gyro) == 0.0f);
+}
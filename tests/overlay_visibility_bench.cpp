@@ -0,0 +1,57 @@
+#include "pch.h"
+#include "utils/overlay_visibility.h"
+
+#include <cstdio>
+
+
+// Plays a 10 minute session at 90 fps through the decisions of both ImGui passes: the help notification shows for the first
+// 14 seconds, the menu is opened for 20 seconds every 2 minutes and an event with black bars plays for 30 seconds every 3
+// minutes. The HUD layer's pass and the flatscreen pass's mouse polling both ran on every frame before. What a skipped frame
+// saves is the ImGui GPU time of the performance overlay and the Win32 cursor and key queries, which need the game running,
+// so this measures how often they're skipped and what deciding that costs per frame.
+
+constexpr uint32_t FPS = 90;
+constexpr uint32_t FRAMES = FPS * 60 * 10;
+constexpr uint32_t REPEATS = 200;
+
+static volatile uint64_t s_sink = 0;
+
+static OverlayVisibility::State SessionState(uint32_t frame) {
+    const uint32_t second = frame / FPS;
+    return {
+        .menuOpen = second % 120 >= 100,
+        .helpNotificationVisible = second < 14,
+        .gameImageComposited = second % 180 < 30 && second >= 60,
+        .hudKeepsAlpha = true,
+    };
+}
+
+int main() {
+    std::vector<OverlayVisibility::State> states;
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        states.emplace_back(SessionState(frame));
+    }
+
+    uint64_t hudPasses = 0;
+    uint64_t mousePolls = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t repeat = 0; repeat < REPEATS; repeat++) {
+        OverlayVisibility visibility;
+        for (const OverlayVisibility::State& state : states) {
+            if (visibility.Decide(state) == OverlayVisibility::Decision::RENDER) {
+                hudPasses++;
+            }
+            if (OverlayVisibility::TakesMouseInput(state)) {
+                mousePolls++;
+            }
+        }
+    }
+    const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / ((double)FRAMES * REPEATS);
+    s_sink = hudPasses + mousePolls;
+
+    const double frames = (double)FRAMES * REPEATS;
+    std::printf("both decisions: %.2f ns per frame\n", ns);
+    std::printf("HUD layer ImGui pass: every frame before, now on %.1f%% of the frames\n", 100.0 * (double)hudPasses / frames);
+    std::printf("flatscreen mouse polling: every frame before, now on %.1f%% of the frames\n", 100.0 * (double)mousePolls / frames);
+    return 0;
+}
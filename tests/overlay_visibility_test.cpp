@@ -0,0 +1,100 @@
+#include "test_framework.h"
+#include "utils/overlay_visibility.h"
+
+
+using Decision = OverlayVisibility::Decision;
+
+static OverlayVisibility::State HiddenState() {
+    return { .hudKeepsAlpha = true };
+}
+
+// runs through the frames that are still rendered at startup
+static void Settle(OverlayVisibility& visibility) {
+    for (uint32_t i = 0; i < OverlayVisibility::SETTLE_FRAMES; ++i) {
+        visibility.Decide(HiddenState());
+    }
+}
+
+TEST_CASE(StartupRendersTheSettleFramesFirst) {
+    OverlayVisibility visibility;
+    for (uint32_t i = 0; i < OverlayVisibility::SETTLE_FRAMES; ++i) {
+        CHECK(visibility.Decide(HiddenState()) == Decision::RENDER);
+    }
+    CHECK(visibility.Decide(HiddenState()) == Decision::DIRECT_COPY);
+    CHECK(visibility.GetRenderedFrames() == OverlayVisibility::SETTLE_FRAMES);
+    CHECK(visibility.GetDirectCopyFrames() == 1);
+}
+
+TEST_CASE(EveryVisibleOverlayRenders) {
+    const auto check = [](bool OverlayVisibility::State::*field) {
+        OverlayVisibility visibility;
+        Settle(visibility);
+        OverlayVisibility::State state = HiddenState();
+        state.*field = true;
+        CHECK(OverlayVisibility::IsAnythingVisible(state));
+        CHECK(visibility.Decide(state) == Decision::RENDER);
+    };
+    check(&OverlayVisibility::State::menuOpen);
+    check(&OverlayVisibility::State::helpNotificationVisible);
+    check(&OverlayVisibility::State::debugOverlays);
+    check(&OverlayVisibility::State::performanceOverlay);
+    check(&OverlayVisibility::State::gameImageComposited);
+    CHECK(!OverlayVisibility::IsAnythingVisible(HiddenState()));
+}
+
+TEST_CASE(OpaqueHUDAlwaysRenders) {
+    OverlayVisibility visibility;
+    Settle(visibility);
+    // without the 3D layer behind it the ImGui pass is what makes the HUD opaque
+    for (uint32_t i = 0; i < 5; ++i) {
+        CHECK(visibility.Decide({ .hudKeepsAlpha = false }) == Decision::RENDER);
+    }
+    CHECK(visibility.GetDirectCopyFrames() == 0);
+}
+
+TEST_CASE(ClosedOverlaysSettleBeforeTheDirectCopy) {
+    OverlayVisibility visibility;
+    Settle(visibility);
+    CHECK(visibility.Decide(HiddenState()) == Decision::DIRECT_COPY);
+
+    OverlayVisibility::State menu = HiddenState();
+    menu.menuOpen = true;
+    CHECK(visibility.Decide(menu) == Decision::RENDER);
+    CHECK(visibility.Decide(menu) == Decision::RENDER);
+
+    // ImGui needs a couple of frames to close the menu's window
+    for (uint32_t i = 0; i < OverlayVisibility::SETTLE_FRAMES; ++i) {
+        CHECK(visibility.Decide(HiddenState()) == Decision::RENDER);
+    }
+    CHECK(visibility.Decide(HiddenState()) == Decision::DIRECT_COPY);
+
+    // an overlay that shows up during the settle frames starts them over
+    CHECK(visibility.Decide(menu) == Decision::RENDER);
+    CHECK(visibility.Decide(HiddenState()) == Decision::RENDER);
+    CHECK(visibility.Decide(menu) == Decision::RENDER);
+    for (uint32_t i = 0; i < OverlayVisibility::SETTLE_FRAMES; ++i) {
+        CHECK(visibility.Decide(HiddenState()) == Decision::RENDER);
+    }
+    CHECK(visibility.Decide(HiddenState()) == Decision::DIRECT_COPY);
+}
+
+TEST_CASE(CountersAddUpToTheDecidedFrames) {
+    OverlayVisibility visibility;
+    OverlayVisibility::State menu = HiddenState();
+    menu.menuOpen = true;
+    uint64_t frames = 0;
+    for (uint32_t i = 0; i < 20; ++i, ++frames) {
+        visibility.Decide(i % 7 == 0 ? menu : HiddenState());
+    }
+    CHECK(visibility.GetRenderedFrames() + visibility.GetDirectCopyFrames() == frames);
+    // frames 0, 7 and 14 show the menu and are each followed by the settle frames
+    CHECK(visibility.GetRenderedFrames() == 3 * (1 + OverlayVisibility::SETTLE_FRAMES));
+}
+
+TEST_CASE(OnlyTheMenuAndDebugWindowsTakeMouseInput) {
+    CHECK(!OverlayVisibility::TakesMouseInput(HiddenState()));
+    CHECK(OverlayVisibility::TakesMouseInput({ .menuOpen = true }));
+    CHECK(OverlayVisibility::TakesMouseInput({ .debugOverlays = true }));
+    // these are visible, but drawn without inputs
+    CHECK(!OverlayVisibility::TakesMouseInput({ .helpNotificationVisible = true, .performanceOverlay = true, .gameImageComposited = true, .hudKeepsAlpha = true }));
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+// Stand-in for include/pch.h, so that the platform independent utilities can be built and tested on any host.
+// The Windows, D3D12 and ImGui parts of the real precompiled header are left out, the others are only pulled in when the
+// tests that need them were configured (see tests/CMakeLists.txt).
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if __has_include(<format>)
+#include <format>
+#endif
+
+#if BETTERVR_TESTS_HAVE_VULKAN
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan_core.h>
+#endif
+
+#if BETTERVR_TESTS_HAVE_OPENXR
+#include <openxr/openxr.h>
+#endif
+
+#if BETTERVR_TESTS_HAVE_GLM
+#define GLM_FORCE_XYZW_ONLY
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/norm.hpp>
+#undef GLM_ENABLE_EXPERIMENTAL
+#endif
+
+#if BETTERVR_TESTS_HAVE_GLM && BETTERVR_TESTS_HAVE_OPENXR
+inline glm::fvec3 ToGLM(const XrVector3f& vec) {
+    return glm::make_vec3(&vec.x);
+}
+
+inline glm::fquat ToGLM(const XrQuaternionf& quat) {
+    return glm::fquat(quat.w, quat.x, quat.y, quat.z);
+}
+
+inline XrVector3f ToXR(const glm::fvec3& vec) {
+    return { vec.x, vec.y, vec.z };
+}
+
+inline XrQuaternionf ToXR(const glm::fquat& quat) {
+    return { quat.x, quat.y, quat.z, quat.w };
+}
+
+inline glm::fvec2 ToGLM(const XrVector2f& vec) {
+    return glm::make_vec2(&vec.x);
+}
+
+inline XrVector2f ToXR(const glm::fvec2& vec) {
+    return { vec.x, vec.y };
+}
+#endif
+
+// The Win32 and CRT functions that the allocation tracker calls from its operator new
+#if !defined(_WIN32)
+inline uint32_t GetCurrentThreadId() {
+    return (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+inline void* _aligned_malloc(size_t size, size_t alignment) {
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+inline void _aligned_free(void* ptr) {
+    std::free(ptr);
+}
+#endif
+
+// Cemu's interpreter state, the utilities only pass it through to the hooks they wrap
+struct PPCInterpreter_t;
+
+// the real logger writes to the Windows console and a log file, the tests only print the messages (unformatted when the
+// standard library doesn't have std::format yet) but filter them the same way
+#include "utils/log_filter.h"
+
+class Log : public LogFilter {
+public:
+    template <LogType L, class... Args>
+    static void print(const char* format, Args&&... args) {
+        if (!isEnabled<L>()) {
+            return;
+        }
+        printedCount++;
+#if defined(__cpp_lib_format)
+        std::printf("  [log] %s\n", std::vformat(format, std::make_format_args(args...)).c_str());
+#else
+        std::printf("  [log] %s\n", format);
+#endif
+    }
+
+    // lets the tests see whether a message made it past the filter
+    static inline std::atomic_uint32_t printedCount = 0;
+};
+
+// the real one logs, shows a message box and then throws, the tests only care about the throw
+inline void checkAssert(const bool assert, const char* errorMessage) {
+    if (!assert) {
+        throw std::runtime_error(errorMessage == nullptr ? "Unexpected assertion occurred!" : errorMessage);
+    }
+}
@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "utils/pending_copies.h"
+
+#include <cstdio>
+
+
+// Cemu records and submits hundreds of command buffers per frame, but only a couple of them contain interop copies. Compares
+// the per-buffer tracker against the mutex-guarded global list it replaced, which was locked for every submit and scanned
+// every pending copy for each submitted buffer. Cemu submits one command buffer at a time, so every buffer is its own submit.
+
+constexpr uint32_t BUFFERS_PER_FRAME = 500;
+constexpr uint32_t COPIES_PER_FRAME = 3; // both eyes and the HUD
+constexpr uint32_t FRAMES = 2000;
+
+struct Copy {
+    uint64_t waitValue;
+    uint64_t signalValue;
+};
+
+struct GlobalCopy {
+    uint32_t buffer;
+    Copy copy;
+};
+
+template <typename Function>
+static double MeasureNsPerBuffer(Function&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t checksum = function();
+    const double nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if (checksum == 0) {
+        std::printf("unexpected checksum\n");
+    }
+    return nanoseconds / ((double)FRAMES * BUFFERS_PER_FRAME);
+}
+
+int main() {
+    const double globalNs = MeasureNsPerBuffer([] {
+        std::mutex mutex;
+        std::vector<GlobalCopy> pending;
+        uint64_t checksum = 0;
+        for (uint32_t frame = 0; frame < FRAMES; ++frame) {
+            for (uint32_t i = 0; i < COPIES_PER_FRAME; ++i) {
+                std::lock_guard lk(mutex);
+                pending.push_back({ BUFFERS_PER_FRAME / COPIES_PER_FRAME * i, { frame, frame + 1ull } });
+            }
+            for (uint32_t buffer = 0; buffer < BUFFERS_PER_FRAME; ++buffer) {
+                std::lock_guard lk(mutex);
+                for (auto it = pending.begin(); it != pending.end();) {
+                    if (it->buffer == buffer) {
+                        checksum += it->copy.signalValue;
+                        it = pending.erase(it);
+                    }
+                    else {
+                        ++it;
+                    }
+                }
+            }
+        }
+        return checksum;
+    });
+
+    const double trackerNs = MeasureNsPerBuffer([] {
+        PendingCopyTracker<uint32_t, Copy> tracker;
+        std::vector<std::unique_ptr<PendingCopyTracker<uint32_t, Copy>::Buffer>> buffers;
+        for (uint32_t buffer = 0; buffer < BUFFERS_PER_FRAME; ++buffer) {
+            buffers.emplace_back(std::make_unique<PendingCopyTracker<uint32_t, Copy>::Buffer>(buffer % 8));
+        }
+        uint64_t checksum = 0;
+        for (uint32_t frame = 0; frame < FRAMES; ++frame) {
+            for (uint32_t buffer = 0; buffer < BUFFERS_PER_FRAME; ++buffer) {
+                tracker.Clear(*buffers[buffer]); // vkBeginCommandBuffer
+            }
+            for (uint32_t i = 0; i < COPIES_PER_FRAME; ++i) {
+                tracker.Add(*buffers[BUFFERS_PER_FRAME / COPIES_PER_FRAME * i], { frame, frame + 1ull });
+            }
+            if (!tracker.HasPendingCopies()) {
+                continue;
+            }
+            for (uint32_t buffer = 0; buffer < BUFFERS_PER_FRAME; ++buffer) {
+                tracker.Consume(*buffers[buffer], [&](const Copy& copy) { checksum += copy.signalValue; });
+            }
+        }
+        return checksum;
+    });
+
+    std::printf("%u command buffers per frame with %u copies\n", BUFFERS_PER_FRAME, COPIES_PER_FRAME);
+    std::printf("global list:          %6.1f ns per submitted buffer\n", globalNs);
+    std::printf("PendingCopyTracker:   %6.1f ns per submitted buffer (includes the begin)\n", trackerNs);
+    return 0;
+}
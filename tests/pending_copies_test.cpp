@@ -0,0 +1,193 @@
+#include "test_framework.h"
+#include "utils/pending_copies.h"
+
+
+// Plays Cemu's command buffer usage against the tracker the way the hooks in framebuffer.cpp drive it, with a stand-in for
+// the shared textures' timeline semaphore so that the values injected into every submit can be checked.
+struct FakeSharedTexture {
+    uint64_t counter = 0;
+
+    uint64_t GetVulkanWaitValue() const { return counter; }
+    uint64_t GetVulkanSignalValue() { return ++counter; }
+    // what D3D12 does once it presented the copy
+    void Present() { ++counter; }
+};
+
+struct Copy {
+    FakeSharedTexture* texture;
+    uint32_t frame;
+};
+
+using Tracker = PendingCopyTracker<uint32_t, Copy>;
+
+struct InjectedSemaphores {
+    uint32_t frame;
+    uint64_t waitValue;
+    uint64_t signalValue;
+};
+
+class Simulation {
+public:
+    Tracker tracker;
+    std::vector<std::unique_ptr<Tracker::Buffer>> buffers;
+
+    uint32_t Allocate(uint32_t pool) {
+        buffers.emplace_back(std::make_unique<Tracker::Buffer>(pool));
+        return (uint32_t)buffers.size() - 1;
+    }
+
+    void Begin(uint32_t buffer) { tracker.Clear(*buffers[buffer]); }
+    void Record(uint32_t buffer, FakeSharedTexture& texture, uint32_t frame) { tracker.Add(*buffers[buffer], { &texture, frame }); }
+    void Free(uint32_t buffer) { tracker.Clear(*buffers[buffer]); }
+
+    std::vector<InjectedSemaphores> Submit(std::initializer_list<uint32_t> submitted) {
+        std::vector<InjectedSemaphores> injected;
+        for (uint32_t buffer : submitted) {
+            tracker.Consume(*buffers[buffer], [&](const Copy& copy) {
+                const uint64_t waitValue = copy.texture->GetVulkanWaitValue();
+                injected.push_back({ copy.frame, waitValue, copy.texture->GetVulkanSignalValue() });
+            });
+        }
+        return injected;
+    }
+};
+
+TEST_CASE(SubmitInjectsTheRecordedCopiesInOrder) {
+    Simulation sim;
+    FakeSharedTexture left, right;
+    const uint32_t buffer = sim.Allocate(1);
+    sim.Begin(buffer);
+    sim.Record(buffer, left, 10);
+    sim.Record(buffer, right, 10);
+    CHECK(sim.tracker.HasPendingCopies());
+    CHECK(sim.tracker.GetBufferCount() == 1);
+
+    const auto injected = sim.Submit({ buffer });
+    CHECK(injected.size() == 2);
+    CHECK(injected[0].frame == 10 && injected[0].waitValue == 0 && injected[0].signalValue == 1);
+    CHECK(injected[1].frame == 10 && injected[1].waitValue == 0 && injected[1].signalValue == 1);
+    CHECK(!sim.tracker.HasPendingCopies());
+
+    // submitting it again doesn't signal the copies twice
+    CHECK(sim.Submit({ buffer }).empty());
+}
+
+TEST_CASE(OnlyTheSubmittedBuffersAreConsumed) {
+    Simulation sim;
+    FakeSharedTexture texture;
+    const uint32_t first = sim.Allocate(1);
+    const uint32_t second = sim.Allocate(1);
+    const uint32_t empty = sim.Allocate(1);
+    sim.Record(first, texture, 1);
+    sim.Record(second, texture, 2);
+
+    const auto injected = sim.Submit({ empty, second });
+    CHECK(injected.size() == 1 && injected[0].frame == 2);
+    CHECK(sim.tracker.GetBufferCount() == 1);
+    CHECK(sim.buffers[first]->GetCopies().size() == 1);
+
+    // the texture was signalled for frame 2 and then presented, so frame 1's copy waits for that
+    texture.Present();
+    const auto later = sim.Submit({ first });
+    CHECK(later.size() == 1 && later[0].frame == 1 && later[0].waitValue == 2 && later[0].signalValue == 3);
+}
+
+TEST_CASE(TimelineValuesAdvanceAcrossFrames) {
+    Simulation sim;
+    FakeSharedTexture texture;
+    const uint32_t buffer = sim.Allocate(1);
+    for (uint32_t frame = 0; frame < 5; ++frame) {
+        sim.Begin(buffer);
+        sim.Record(buffer, texture, frame);
+        const auto injected = sim.Submit({ buffer });
+        CHECK(injected.size() == 1);
+        CHECK(injected[0].waitValue == frame * 2);
+        CHECK(injected[0].signalValue == frame * 2 + 1);
+        texture.Present();
+    }
+}
+
+TEST_CASE(BeginDropsCopiesThatWereNeverSubmitted) {
+    Simulation sim;
+    FakeSharedTexture texture;
+    const uint32_t buffer = sim.Allocate(1);
+    sim.Record(buffer, texture, 1);
+    sim.Begin(buffer);
+    CHECK(!sim.tracker.HasPendingCopies());
+    sim.Record(buffer, texture, 2);
+
+    const auto injected = sim.Submit({ buffer });
+    CHECK(injected.size() == 1 && injected[0].frame == 2);
+    // the dropped copy never signalled anything
+    CHECK(injected[0].signalValue == 1);
+}
+
+TEST_CASE(PoolResetDropsTheCopiesOfItsBuffers) {
+    Simulation sim;
+    FakeSharedTexture texture;
+    const uint32_t a1 = sim.Allocate(1);
+    const uint32_t b1 = sim.Allocate(2);
+    const uint32_t a2 = sim.Allocate(1);
+    const uint32_t b2 = sim.Allocate(2);
+    for (uint32_t buffer : { a1, b1, a2, b2 }) {
+        sim.Record(buffer, texture, buffer);
+    }
+    CHECK(sim.tracker.GetBufferCount() == 4);
+
+    CHECK(sim.tracker.ClearPool(1) == 2);
+    CHECK(sim.tracker.GetBufferCount() == 2);
+    CHECK(sim.buffers[a1]->GetCopies().empty() && sim.buffers[a2]->GetCopies().empty());
+    CHECK(sim.tracker.ClearPool(1) == 0);
+
+    const auto injected = sim.Submit({ a1, b1, a2, b2 });
+    CHECK(injected.size() == 2 && injected[0].frame == b1 && injected[1].frame == b2);
+    CHECK(!sim.tracker.HasPendingCopies());
+}
+
+TEST_CASE(FreedBuffersLeaveNothingBehind) {
+    Simulation sim;
+    FakeSharedTexture texture;
+    const uint32_t freed = sim.Allocate(1);
+    const uint32_t kept = sim.Allocate(1);
+    sim.Record(freed, texture, 1);
+    sim.Record(kept, texture, 2);
+    sim.Free(freed);
+    CHECK(sim.tracker.GetBufferCount() == 1);
+
+    // the buffer that was registered last got moved into the freed one's place, so it has to still be found by a pool reset
+    CHECK(sim.tracker.ClearPool(1) == 1);
+    CHECK(!sim.tracker.HasPendingCopies());
+}
+
+TEST_CASE(RandomSequencesKeepTheRegistryConsistent) {
+    Simulation sim;
+    FakeSharedTexture texture;
+    for (uint32_t i = 0; i < 32; ++i) {
+        sim.Allocate(i % 4);
+    }
+
+    uint32_t seed = 12345;
+    const auto next = [&seed](uint32_t range) {
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) % range;
+    };
+    for (uint32_t step = 0; step < 10000; ++step) {
+        const uint32_t buffer = next(32);
+        switch (next(5)) {
+            case 0: sim.Begin(buffer); break;
+            case 1:
+            case 2: sim.Record(buffer, texture, step); break;
+            case 3: sim.Submit({ buffer }); break;
+            case 4: sim.tracker.ClearPool(next(4)); break;
+        }
+
+        uint32_t withCopies = 0;
+        for (const auto& tracked : sim.buffers) {
+            withCopies += tracked->GetCopies().empty() ? 0 : 1;
+        }
+        if (withCopies != sim.tracker.GetBufferCount()) {
+            CHECK(withCopies == sim.tracker.GetBufferCount());
+            break;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "utils/pose_history.h"
+
+#include <cstdio>
+
+
+// Times what UpdateActions does for each hand every frame, adding the located pose and estimating the motion at the display
+// time, for a few window lengths. The finite difference of the last two samples is what the estimate replaced, as a baseline
+// for how much the least-squares fit costs on top of it.
+
+constexpr uint32_t FRAMES = 2'000'000;
+constexpr XrDuration FRAME_NS = 11'111'111; // 90 Hz
+
+static XrPosef PoseAt(uint32_t frame) {
+    const float t = (float)frame * 0.011f;
+    const glm::fquat orientation = glm::angleAxis(std::sin(t), glm::normalize(glm::fvec3(0.2f, 1.0f, 0.1f)));
+    return { ToXR(orientation), { std::sin(t) * 0.3f, 1.2f + std::cos(t * 2.0f) * 0.1f, -0.4f } };
+}
+
+static double RunEstimate(XrDuration window, float& sink) {
+    PoseHistory history;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        const XrTime time = 1'000'000'000 + (XrTime)frame * FRAME_NS;
+        history.Add(time, PoseAt(frame));
+        const PoseHistory::Motion motion = history.Estimate(time, window);
+        sink += motion.linearVelocity.x + motion.angularVelocity.y;
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+}
+
+static double RunFiniteDifference(float& sink) {
+    PoseHistory history;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        const XrTime time = 1'000'000'000 + (XrTime)frame * FRAME_NS;
+        history.Add(time, PoseAt(frame));
+        if (history.Size() >= 2) {
+            const PoseHistory::Sample& latest = history.GetFromLatest(0);
+            const PoseHistory::Sample& previous = history.GetFromLatest(1);
+            const float seconds = (float)(latest.time - previous.time) * 1e-9f;
+            const glm::fvec3 velocity = (latest.position - previous.position) / seconds;
+            sink += velocity.x;
+        }
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+}
+
+int main() {
+    float sink = 0.0f;
+    // the pose itself gets built in every run, so it's part of the baseline too
+    const double baseline = RunFiniteDifference(sink);
+    std::printf("Add + finite difference:       %7.2f ns per frame\n", baseline);
+    for (XrDuration windowMs : { 30, 60, 120, 250 }) {
+        const double estimate = RunEstimate(windowMs * 1'000'000, sink);
+        const uint32_t samples = (uint32_t)std::min<XrDuration>(windowMs * 1'000'000 / FRAME_NS + 1, PoseHistory::CAPACITY);
+        std::printf("Add + Estimate, %3lld ms window: %7.2f ns per frame (%2u samples)\n", (long long)windowMs, estimate, samples);
+    }
+    std::printf("(sink %f)\n", sink);
+    return 0;
+}
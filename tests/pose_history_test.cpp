@@ -0,0 +1,110 @@
+#include "test_framework.h"
+#include "utils/pose_history.h"
+
+
+constexpr XrTime BASE_TIME = 1'000'000'000;
+constexpr XrDuration MS = 1'000'000;
+
+TEST_CASE(OlderSamplesAreIgnored) {
+    PoseHistory history;
+    history.Add(BASE_TIME, glm::fvec3(1.0f), glm::identity<glm::fquat>());
+    history.Add(BASE_TIME - 10 * MS, glm::fvec3(2.0f), glm::identity<glm::fquat>());
+    history.Add(BASE_TIME, glm::fvec3(3.0f), glm::identity<glm::fquat>());
+    CHECK(history.Size() == 1);
+    CHECK(history.GetLatest().position.x == 1.0f);
+}
+
+TEST_CASE(LongGapsRestartTheHistory) {
+    PoseHistory history;
+    history.Add(BASE_TIME, glm::fvec3(0.0f), glm::identity<glm::fquat>());
+    history.Add(BASE_TIME + 10 * MS, glm::fvec3(0.0f), glm::identity<glm::fquat>());
+    history.Add(BASE_TIME + 10 * MS + PoseHistory::MAX_GAP_NS + 1, glm::fvec3(0.0f), glm::identity<glm::fquat>());
+    CHECK(history.Size() == 1);
+    CHECK(!history.Estimate(history.GetLatest().time).valid);
+}
+
+TEST_CASE(RingKeepsTheNewestSamples) {
+    PoseHistory history;
+    for (uint32_t i = 0; i < PoseHistory::CAPACITY + 5; i++) {
+        history.Add(BASE_TIME + i * MS, glm::fvec3((float)i), glm::identity<glm::fquat>());
+    }
+    CHECK(history.Size() == PoseHistory::CAPACITY);
+    CHECK(history.GetLatest().position.x == (float)(PoseHistory::CAPACITY + 4));
+    CHECK(history.GetFromLatest(PoseHistory::CAPACITY - 1).position.x == 5.0f);
+}
+
+TEST_CASE(SingleSampleHasNoMotion) {
+    PoseHistory history;
+    CHECK(!history.Estimate(BASE_TIME).valid);
+    history.Add(BASE_TIME, glm::fvec3(0.0f), glm::identity<glm::fquat>());
+    CHECK(!history.Estimate(BASE_TIME).valid);
+}
+
+TEST_CASE(TwoSamplesGiveTheirVelocity) {
+    PoseHistory history;
+    history.Add(BASE_TIME, glm::fvec3(0.0f), glm::identity<glm::fquat>());
+    history.Add(BASE_TIME + 10 * MS, glm::fvec3(0.01f, 0.0f, -0.02f), glm::identity<glm::fquat>());
+    const PoseHistory::Motion motion = history.Estimate(BASE_TIME + 10 * MS);
+    CHECK(motion.valid);
+    CHECK(motion.sampleCount == 2);
+    CHECK_NEAR(motion.linearVelocity.x, 1.0, 1e-3);
+    CHECK_NEAR(motion.linearVelocity.z, -2.0, 1e-3);
+    CHECK_NEAR(glm::length(motion.linearAcceleration), 0.0, 1e-6);
+}
+
+// samples of a thrown controller at irregular intervals, which the fit shouldn't care about
+TEST_CASE(ConstantAccelerationIsRecovered) {
+    const glm::dvec3 startVelocity = { 1.0, 2.0, 0.5 };
+    const glm::dvec3 acceleration = { 0.0, -9.81, 3.0 };
+    const XrDuration offsets[] = { 0, 9 * MS, 21 * MS, 30 * MS, 42 * MS, 50 * MS, 61 * MS };
+
+    PoseHistory history;
+    for (XrDuration offset : offsets) {
+        const double t = (double)offset * 1e-9;
+        history.Add(BASE_TIME + offset, glm::fvec3(startVelocity * t + 0.5 * acceleration * t * t), glm::identity<glm::fquat>());
+    }
+
+    const double latest = (double)offsets[std::size(offsets) - 1] * 1e-9;
+    const PoseHistory::Motion motion = history.Estimate(BASE_TIME + offsets[std::size(offsets) - 1]);
+    CHECK(motion.valid);
+    // the first sample is outside of the default window
+    CHECK(motion.sampleCount == std::size(offsets) - 1);
+    for (int axis = 0; axis < 3; axis++) {
+        CHECK_NEAR(motion.linearVelocity[axis], startVelocity[axis] + acceleration[axis] * latest, 1e-2);
+        CHECK_NEAR(motion.linearAcceleration[axis], acceleration[axis], 5e-2);
+    }
+}
+
+TEST_CASE(AngularVelocityIsInWorldSpace) {
+    // the controller is tilted, so a body space velocity would point along a different axis
+    const glm::fquat tilt = glm::angleAxis(glm::radians(40.0f), glm::fvec3(1.0f, 0.0f, 0.0f));
+    const glm::fvec3 axis = glm::fvec3(0.0f, 1.0f, 0.0f);
+    const float radiansPerSecond = 3.0f;
+
+    PoseHistory history;
+    for (uint32_t i = 0; i <= 6; i++) {
+        const float t = (float)i * 0.01f;
+        history.Add(BASE_TIME + i * 10 * MS, glm::fvec3(0.0f), glm::angleAxis(radiansPerSecond * t, axis) * tilt);
+    }
+
+    const PoseHistory::Motion motion = history.Estimate(history.GetLatest().time);
+    CHECK(motion.valid);
+    CHECK_NEAR(motion.angularVelocity.x, 0.0, 1e-2);
+    CHECK_NEAR(motion.angularVelocity.y, radiansPerSecond, 1e-2);
+    CHECK_NEAR(motion.angularVelocity.z, 0.0, 1e-2);
+    CHECK_NEAR(glm::length(motion.angularAcceleration), 0.0, 5e-2);
+}
+
+TEST_CASE(EstimateExtrapolatesToTheRequestedTime) {
+    const glm::dvec3 acceleration = { 2.0, 0.0, 0.0 };
+    PoseHistory history;
+    for (uint32_t i = 0; i <= 6; i++) {
+        const double t = (double)i * 0.01;
+        history.Add(BASE_TIME + i * 10 * MS, glm::fvec3(0.5 * acceleration * t * t), glm::identity<glm::fquat>());
+    }
+
+    // 20ms after the latest sample the velocity kept growing along the fitted acceleration
+    const PoseHistory::Motion motion = history.Estimate(history.GetLatest().time + 20 * MS);
+    CHECK(motion.valid);
+    CHECK_NEAR(motion.linearVelocity.x, acceleration.x * 0.08, 1e-2);
+}
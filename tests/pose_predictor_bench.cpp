@@ -0,0 +1,47 @@
+#include "pch.h"
+#include "utils/pose_predictor.h"
+
+#include <cstdio>
+
+
+// Times PosePredictor::Predict, which the skeleton hook runs for every hand bone it writes, for the motions it sees: a
+// trusted estimate, one that gets blended back towards the measured pose, and no estimate at all, which returns right away.
+
+constexpr uint32_t CALLS = 10'000'000;
+constexpr XrDuration HORIZON_NS = 22'000'000; // about two frames at 90 Hz
+
+static PoseHistory::Motion MakeMotion(uint32_t sampleCount, float linearAcceleration) {
+    PoseHistory::Motion motion;
+    motion.valid = sampleCount >= 2;
+    motion.sampleCount = sampleCount;
+    motion.linearVelocity = { 0.8f, -0.2f, 1.5f };
+    motion.linearAcceleration = { linearAcceleration, 0.0f, 0.0f };
+    motion.angularVelocity = { 0.5f, 3.0f, -1.0f };
+    motion.angularAcceleration = { 10.0f, 0.0f, 5.0f };
+    return motion;
+}
+
+static double Run(const PoseHistory::Motion& motion, float& sink) {
+    XrPosef pose = { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.2f, 1.1f, -0.3f } };
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < CALLS; i++) {
+        // moves the input a little so the calls can't be hoisted out of the loop
+        pose.position.x = (float)(i & 1023) * 0.001f;
+        const XrPosef predicted = PosePredictor::Predict(pose, motion, HORIZON_NS);
+        sink += predicted.position.x + predicted.orientation.y;
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / CALLS;
+}
+
+int main() {
+    float sink = 0.0f;
+    const double trusted = Run(MakeMotion(8, 20.0f), sink);
+    const double blended = Run(MakeMotion(3, 500.0f), sink);
+    const double invalid = Run(MakeMotion(1, 0.0f), sink);
+
+    std::printf("trusted estimate:         %6.2f ns per prediction\n", trusted);
+    std::printf("blended back (3 samples): %6.2f ns per prediction\n", blended);
+    std::printf("no estimate:              %6.2f ns per prediction\n", invalid);
+    std::printf("(sink %f)\n", sink);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "test_framework.h"
+#include "utils/pose_predictor.h"
+
+
+constexpr XrDuration MS = 1'000'000;
+
+static PoseHistory::Motion MakeMotion(uint32_t sampleCount, glm::fvec3 linearVelocity, glm::fvec3 angularVelocity = {}) {
+    return { .valid = true, .sampleCount = sampleCount, .linearVelocity = linearVelocity, .angularVelocity = angularVelocity };
+}
+
+static XrPosef MakePose(glm::fvec3 position, glm::fquat orientation = glm::identity<glm::fquat>()) {
+    XrPosef pose;
+    pose.position = ToXR(position);
+    pose.orientation = ToXR(orientation);
+    return pose;
+}
+
+TEST_CASE(ConfidenceGrowsWithTheSampleCount) {
+    CHECK(PosePredictor::GetConfidence({}) == 0.0f);
+    CHECK(PosePredictor::GetConfidence(MakeMotion(1, {})) == 0.0f);
+    CHECK(PosePredictor::GetConfidence(MakeMotion(2, {})) > 0.0f);
+    CHECK(PosePredictor::GetConfidence(MakeMotion(2, {})) < PosePredictor::GetConfidence(MakeMotion(3, {})));
+    CHECK(PosePredictor::GetConfidence(MakeMotion(PosePredictor::FULL_CONFIDENCE_SAMPLES, {})) == 1.0f);
+    CHECK(PosePredictor::GetConfidence(MakeMotion(PoseHistory::CAPACITY, {})) == 1.0f);
+}
+
+TEST_CASE(ImplausibleAccelerationsLowerTheConfidence) {
+    PoseHistory::Motion motion = MakeMotion(PosePredictor::FULL_CONFIDENCE_SAMPLES, {});
+    motion.linearAcceleration = { PosePredictor::MAX_LINEAR_ACCELERATION * 2.0f, 0.0f, 0.0f };
+    CHECK_NEAR(PosePredictor::GetConfidence(motion), 0.5, 1e-5);
+
+    motion.angularAcceleration = { 0.0f, 0.0f, PosePredictor::MAX_ANGULAR_ACCELERATION * 4.0f };
+    CHECK_NEAR(PosePredictor::GetConfidence(motion), 0.125, 1e-5);
+}
+
+TEST_CASE(InvalidMotionKeepsThePose) {
+    const XrPosef pose = MakePose({ 1.0f, 2.0f, 3.0f });
+    const XrPosef predicted = PosePredictor::Predict(pose, {}, 20 * MS);
+    CHECK(predicted.position.x == 1.0f && predicted.position.y == 2.0f && predicted.position.z == 3.0f);
+
+    const XrPosef notAhead = PosePredictor::Predict(pose, MakeMotion(8, { 1.0f, 0.0f, 0.0f }), 0);
+    CHECK(notAhead.position.x == 1.0f);
+}
+
+TEST_CASE(PositionFollowsTheVelocity) {
+    const XrPosef predicted = PosePredictor::Predict(MakePose({ 1.0f, 0.0f, 0.0f }), MakeMotion(8, { 2.0f, 0.0f, -1.0f }), 20 * MS);
+    CHECK_NEAR(predicted.position.x, 1.04, 1e-5);
+    CHECK_NEAR(predicted.position.y, 0.0, 1e-5);
+    CHECK_NEAR(predicted.position.z, -0.02, 1e-5);
+}
+
+TEST_CASE(HorizonIsClamped) {
+    const XrPosef predicted = PosePredictor::Predict(MakePose({}), MakeMotion(8, { 1.0f, 0.0f, 0.0f }), 10 * PosePredictor::MAX_HORIZON_NS);
+    CHECK_NEAR(predicted.position.x, (double)PosePredictor::MAX_HORIZON_NS * 1e-9, 1e-5);
+}
+
+TEST_CASE(LowConfidenceBlendsTowardsThePose) {
+    // two samples only give a third of the full confidence
+    const XrPosef predicted = PosePredictor::Predict(MakePose({}), MakeMotion(2, { 3.0f, 0.0f, 0.0f }), 20 * MS);
+    CHECK_NEAR(predicted.position.x, 0.06 / 3.0, 1e-5);
+}
+
+TEST_CASE(RotationIsAppliedInWorldSpace) {
+    const glm::fquat tilt = glm::angleAxis(glm::radians(30.0f), glm::fvec3(1.0f, 0.0f, 0.0f));
+    const XrPosef predicted = PosePredictor::Predict(MakePose({}, tilt), MakeMotion(8, {}, { 0.0f, 5.0f, 0.0f }), 20 * MS);
+
+    const glm::fquat expected = glm::angleAxis(0.1f, glm::fvec3(0.0f, 1.0f, 0.0f)) * tilt;
+    CHECK_NEAR(std::abs(glm::dot(ToGLM(predicted.orientation), expected)), 1.0, 1e-5);
+}
+
+TEST_CASE(RotationIsClamped) {
+    const XrPosef predicted = PosePredictor::Predict(MakePose({}), MakeMotion(8, {}, { 0.0f, 0.0f, 1000.0f }), 20 * MS);
+    const float angle = glm::angle(ToGLM(predicted.orientation));
+    CHECK_NEAR(angle, PosePredictor::MAX_ROTATION, 1e-4);
+}
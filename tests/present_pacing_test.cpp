@@ -0,0 +1,139 @@
+#include "test_framework.h"
+#include "rendering/present_worker.h"
+
+
+// Simulates Cemu's present thread and the XR frame thread around a PresentMailbox on a fake clock, to compare how long the
+// game gets stalled by publishing and how old the frames are once they're displayed with either policy.
+// The game finishes a frame every gameFrameNs and publishes it. The XR thread takes a frame, spends xrWorkNs submitting it
+// and then sits in xrWaitFrame until the next vsync, at which point the frame it submitted is shown.
+
+constexpr int64_t TICK_NS = 50'000;
+constexpr int64_t DISPLAY_PERIOD_NS = 11'111'111;
+constexpr int64_t SIMULATED_NS = 20'000'000'000;
+
+struct PacingStats {
+    uint64_t published = 0;
+    uint64_t displayed = 0;
+    uint64_t dropped = 0;
+    double stallMsPerFrame = 0.0;
+    double meanLatencyMs = 0.0;
+    double maxLatencyMs = 0.0;
+};
+
+static PacingStats Simulate(PresentWorker::Policy policy, int64_t gameFrameNs, int64_t xrWorkNs) {
+    PresentMailbox mailbox;
+    std::vector<int64_t> publishTimes;
+    PacingStats stats;
+
+    int64_t renderDoneAt = gameFrameNs;
+    int64_t stalledNs = 0;
+    std::optional<int64_t> workerBusyUntil;
+    double latencySumMs = 0.0;
+
+    for (int64_t now = 0; now < SIMULATED_NS; now += TICK_NS) {
+        // the XR thread
+        if (workerBusyUntil.has_value() && now >= *workerBusyUntil) {
+            workerBusyUntil.reset();
+        }
+        if (!workerBusyUntil.has_value()) {
+            if (const std::optional<uint64_t> frameId = mailbox.Take(); frameId.has_value()) {
+                const int64_t vsync = (now + xrWorkNs + DISPLAY_PERIOD_NS - 1) / DISPLAY_PERIOD_NS * DISPLAY_PERIOD_NS;
+                const double latencyMs = (double)(vsync - publishTimes[*frameId]) / 1e6;
+                latencySumMs += latencyMs;
+                stats.maxLatencyMs = std::max(stats.maxLatencyMs, latencyMs);
+                stats.displayed++;
+                workerBusyUntil = vsync;
+            }
+        }
+
+        // Cemu's present, which only starts rendering the next frame once Publish returned
+        if (now >= renderDoneAt) {
+            if (policy == PresentWorker::Policy::STRICT && mailbox.IsFull()) {
+                stalledNs += TICK_NS;
+                continue;
+            }
+            stats.dropped += mailbox.Publish() ? 1 : 0;
+            publishTimes.emplace_back(now);
+            stats.published++;
+            renderDoneAt = now + gameFrameNs;
+        }
+    }
+
+    stats.stallMsPerFrame = (double)stalledNs / 1e6 / (double)std::max<uint64_t>(stats.published, 1);
+    stats.meanLatencyMs = latencySumMs / (double)std::max<uint64_t>(stats.displayed, 1);
+    return stats;
+}
+
+static void Print(const char* name, const PacingStats& stats) {
+    std::printf("  %-28s %5llu published, %5llu displayed, %5llu dropped, %.2f ms stall per frame, %.2f ms mean latency (%.2f max)\n", name,
+        (unsigned long long)stats.published, (unsigned long long)stats.displayed, (unsigned long long)stats.dropped, stats.stallMsPerFrame, stats.meanLatencyMs, stats.maxLatencyMs);
+}
+
+TEST_CASE(GameFasterThanTheDisplay) {
+    // an unlocked game at 125 fps on a 90 Hz headset
+    const PacingStats strict = Simulate(PresentWorker::Policy::STRICT, 8'000'000, 3'000'000);
+    const PacingStats latest = Simulate(PresentWorker::Policy::LATEST_WINS, 8'000'000, 3'000'000);
+    Print("STRICT, 125 fps game:", strict);
+    Print("LATEST_WINS, 125 fps game:", latest);
+
+    // STRICT slows the game down to the display rate by stalling its present, but shows every frame
+    CHECK(strict.dropped == 0);
+    CHECK(strict.stallMsPerFrame > 1.0);
+    CHECK(strict.published <= strict.displayed + 1);
+    // LATEST_WINS never stalls and drops the frames the display can't keep up with instead
+    CHECK(latest.stallMsPerFrame == 0.0);
+    CHECK(latest.dropped > 0);
+    // every frame is either shown or replaced, except for the one that's still in the mailbox at the end
+    CHECK(latest.published - latest.displayed - latest.dropped <= 1);
+    // a dropped frame gets replaced by a newer one, so what's shown is fresher
+    CHECK(latest.meanLatencyMs < strict.meanLatencyMs);
+    CHECK(latest.maxLatencyMs <= strict.maxLatencyMs);
+    // both keep the display fed once per vsync
+    const uint64_t vsyncs = SIMULATED_NS / DISPLAY_PERIOD_NS;
+    CHECK(strict.displayed * 100 >= vsyncs * 95);
+    CHECK(latest.displayed * 100 >= vsyncs * 95);
+}
+
+TEST_CASE(GameSlowerThanTheDisplay) {
+    // the game's usual 30 fps, the worker is always waiting for the next frame so both policies behave the same
+    const PacingStats strict = Simulate(PresentWorker::Policy::STRICT, 33'333'333, 3'000'000);
+    const PacingStats latest = Simulate(PresentWorker::Policy::LATEST_WINS, 33'333'333, 3'000'000);
+    Print("STRICT, 30 fps game:", strict);
+    Print("LATEST_WINS, 30 fps game:", latest);
+
+    CHECK(strict.stallMsPerFrame == 0.0);
+    CHECK(latest.stallMsPerFrame == 0.0);
+    CHECK(strict.dropped == 0);
+    CHECK(latest.dropped == 0);
+    CHECK(strict.displayed == latest.displayed);
+    CHECK_NEAR(strict.meanLatencyMs, latest.meanLatencyMs, 1e-6);
+    // a frame is never older than the XR work plus one display period
+    CHECK(strict.maxLatencyMs <= (3'000'000 + DISPLAY_PERIOD_NS + TICK_NS) / 1e6);
+}
+
+TEST_CASE(SlowXrFrameStallsStrictOnly) {
+    // the XR thread itself misses every other vsync, e.g. while the runtime reprojects
+    const PacingStats strict = Simulate(PresentWorker::Policy::STRICT, 11'000'000, 14'000'000);
+    const PacingStats latest = Simulate(PresentWorker::Policy::LATEST_WINS, 11'000'000, 14'000'000);
+    Print("STRICT, slow XR frame:", strict);
+    Print("LATEST_WINS, slow XR frame:", latest);
+
+    CHECK(strict.stallMsPerFrame > latest.stallMsPerFrame);
+    CHECK(latest.stallMsPerFrame == 0.0);
+    CHECK(latest.published > strict.published);
+    CHECK(latest.meanLatencyMs < strict.meanLatencyMs);
+}
+
+TEST_CASE(MailboxKeepsOnlyTheNewestFrame) {
+    PresentMailbox mailbox;
+    CHECK(!mailbox.IsFull());
+    CHECK(!mailbox.Take().has_value());
+    CHECK(!mailbox.Publish());
+    CHECK(mailbox.IsFull());
+    CHECK(mailbox.Publish());
+    CHECK(mailbox.Publish());
+    CHECK(mailbox.Take() == std::optional<uint64_t>(2));
+    CHECK(!mailbox.IsFull());
+    CHECK(!mailbox.Publish());
+    CHECK(mailbox.Take() == std::optional<uint64_t>(3));
+}
@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "fake_guest_memory.h"
+#include "screen_states.h"
+
+#include <cstdio>
+
+
+// Compares the per-frame ScreenStates snapshot against chasing the screen manager's pointers for every query, which is what
+// IsScreenOpen did before. A release build queries a handful of screens per frame from the camera, input and menu detection
+// hooks, while the screen logging of debug builds used to query every screen.
+
+constexpr uint32_t GUEST_BASE = 0x10000000;
+constexpr uint32_t SCREEN_MANAGER = 0x10100000;
+constexpr uint32_t SCREEN_ARRAY = 0x10200000;
+constexpr uint32_t FRAMES = 200000;
+constexpr std::array QUERIED_SCREENS = { ScreenId::PauseMenuInfo_00, ScreenId::ShopBG_00, ScreenId::MessageDialog, ScreenId::PauseMenuInfo_00, ScreenId::ShopBG_00, ScreenId::MessageDialog, ScreenId::Title_00, ScreenId::PauseMenuInfo_00 };
+
+static uint32_t ReadBE32(FakeGuestMemory& memory, uint32_t address) {
+    std::array<uint8_t, 4> bytes;
+    memory.Read(address, bytes.data(), bytes.size());
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | (uint32_t)bytes[3];
+}
+
+static bool ChaseScreenPointers(FakeGuestMemory& memory, ScreenId screen) {
+    const uint32_t screenManagerInstance = ReadBE32(memory, ScreenStates::SCREEN_MANAGER_ADDRESS);
+    if (screenManagerInstance == 0) {
+        return false;
+    }
+    const uint32_t screenArray = ReadBE32(memory, screenManagerInstance + ScreenStates::SCREEN_ARRAY_OFFSET);
+    return ReadBE32(memory, screenArray + std::to_underlying(screen) * 4) != 0;
+}
+
+template <typename Function>
+static double MeasureNsPerFrame(Function&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t openCount = 0;
+    for (uint32_t frame = 0; frame < FRAMES; ++frame) {
+        openCount += function(frame);
+    }
+    const double nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if (openCount == 0) {
+        std::printf("unexpected open count\n");
+    }
+    return nanoseconds / FRAMES;
+}
+
+int main() {
+    FakeGuestMemory memory(GUEST_BASE, 0x00500000);
+    memory.WriteBE32(ScreenStates::SCREEN_MANAGER_ADDRESS, SCREEN_MANAGER);
+    memory.WriteBE32(SCREEN_MANAGER + ScreenStates::SCREEN_ARRAY_OFFSET, SCREEN_ARRAY);
+    memory.WriteBE32(SCREEN_ARRAY + std::to_underlying(ScreenId::ShopBG_00) * 4, 0x10300000);
+
+    // the game opens and closes a dialog every other frame, which also keeps the compiler from hoisting the reads out of the loop
+    const auto toggleDialog = [&](uint32_t frame) {
+        memory.WriteBE32(SCREEN_ARRAY + std::to_underlying(ScreenId::MessageDialog) * 4, frame % 2 == 0 ? 0 : 0x10400000);
+    };
+
+    const double chasingNs = MeasureNsPerFrame([&](uint32_t frame) {
+        toggleDialog(frame);
+        uint32_t open = 0;
+        for (ScreenId screen : QUERIED_SCREENS) {
+            open += ChaseScreenPointers(memory, screen) ? 1 : 0;
+        }
+        return open;
+    });
+    const double chasingAllNs = MeasureNsPerFrame([&](uint32_t frame) {
+        toggleDialog(frame);
+        uint32_t open = 0;
+        for (uint32_t i = 0; i < ScreenStates::SCREEN_COUNT; ++i) {
+            open += ChaseScreenPointers(memory, (ScreenId)i) ? 1 : 0;
+        }
+        return open;
+    });
+
+    const double snapshotNs = MeasureNsPerFrame([&](uint32_t frame) {
+        toggleDialog(frame);
+        const ScreenStates states = ScreenStates::ReadFromGuest(memory.Reader());
+        uint32_t open = 0;
+        for (ScreenId screen : QUERIED_SCREENS) {
+            open += states.IsOpen(screen) ? 1 : 0;
+        }
+        return open;
+    });
+    const double snapshotAllNs = MeasureNsPerFrame([&](uint32_t frame) {
+        toggleDialog(frame);
+        const ScreenStates states = ScreenStates::ReadFromGuest(memory.Reader());
+        uint32_t open = 0;
+        states.ForEachScreen([&](ScreenId) { open++; });
+        return open;
+    });
+
+    std::printf("                           %zu queries   all %u screens\n", QUERIED_SCREENS.size(), ScreenStates::SCREEN_COUNT);
+    std::printf("pointer chasing per query: %7.1f ns   %7.1f ns per frame\n", chasingNs, chasingAllNs);
+    std::printf("ScreenStates snapshot:     %7.1f ns   %7.1f ns per frame (includes the bulk read)\n", snapshotNs, snapshotAllNs);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "test_framework.h"
+#include "fake_guest_memory.h"
+#include "screen_states.h"
+
+
+constexpr uint32_t GUEST_BASE = 0x10000000;
+constexpr uint32_t SCREEN_MANAGER = 0x10100000;
+constexpr uint32_t SCREEN_ARRAY = 0x10200000;
+
+// the screen manager with an empty screen array, like while the game is running without any menus
+static FakeGuestMemory MakeGuestMemory() {
+    FakeGuestMemory memory(GUEST_BASE, 0x00500000);
+    memory.WriteBE32(ScreenStates::SCREEN_MANAGER_ADDRESS, SCREEN_MANAGER);
+    memory.WriteBE32(SCREEN_MANAGER + ScreenStates::SCREEN_ARRAY_OFFSET, SCREEN_ARRAY);
+    return memory;
+}
+
+static void OpenScreen(FakeGuestMemory& memory, ScreenId screen, uint32_t screenPtr = 0x10300000) {
+    memory.WriteBE32(SCREEN_ARRAY + std::to_underlying(screen) * 4, screenPtr);
+}
+
+TEST_CASE(NoScreenManagerMeansNoScreens) {
+    FakeGuestMemory memory(GUEST_BASE, 0x00500000);
+    CHECK(!ScreenStates::ReadFromGuest(memory.Reader()).Any());
+
+    // the screen manager exists, but hasn't allocated its array yet
+    memory.WriteBE32(ScreenStates::SCREEN_MANAGER_ADDRESS, SCREEN_MANAGER);
+    CHECK(!ScreenStates::ReadFromGuest(memory.Reader()).Any());
+}
+
+TEST_CASE(OpenScreensAreRead) {
+    FakeGuestMemory memory = MakeGuestMemory();
+    CHECK(!ScreenStates::ReadFromGuest(memory.Reader()).Any());
+
+    OpenScreen(memory, ScreenId::GamePadBG_00);
+    OpenScreen(memory, ScreenId::ShopBG_00);
+    OpenScreen(memory, ScreenId::ScreenId_END);
+    const ScreenStates states = ScreenStates::ReadFromGuest(memory.Reader());
+    CHECK(states.IsOpen(ScreenId::GamePadBG_00));
+    CHECK(states.IsOpen(ScreenId::ShopBG_00));
+    CHECK(states.IsOpen(ScreenId::ScreenId_END));
+    CHECK(!states.IsOpen(ScreenId::Title_00));
+    CHECK(!states.IsOpen(ScreenId::MessageDialog));
+
+    uint32_t openCount = 0;
+    states.ForEachScreen([&](ScreenId) { openCount++; });
+    CHECK(openCount == 3);
+}
+
+TEST_CASE(AnyNonNullPointerCountsAsOpen) {
+    FakeGuestMemory memory = MakeGuestMemory();
+    // the entries are only compared against null without swapping them, so zero bytes in either half don't matter
+    OpenScreen(memory, ScreenId::PauseMenuInfo_00, 0x00000100);
+    OpenScreen(memory, ScreenId::MessageDialog, 0x01000000);
+    const ScreenStates states = ScreenStates::ReadFromGuest(memory.Reader());
+    CHECK(states.IsOpen(ScreenId::PauseMenuInfo_00));
+    CHECK(states.IsOpen(ScreenId::MessageDialog));
+}
+
+TEST_CASE(EveryScreenMapsToItsOwnBit) {
+    for (uint32_t i = 0; i < ScreenStates::SCREEN_COUNT; ++i) {
+        FakeGuestMemory memory = MakeGuestMemory();
+        OpenScreen(memory, (ScreenId)i);
+        const ScreenStates states = ScreenStates::ReadFromGuest(memory.Reader());
+
+        std::vector<ScreenId> open;
+        states.ForEachScreen([&](ScreenId id) { open.push_back(id); });
+        if (open.size() != 1 || open[0] != (ScreenId)i) {
+            CHECK(open.size() == 1 && open[0] == (ScreenId)i);
+            break;
+        }
+    }
+}
+
+TEST_CASE(XorReportsTheChangedScreens) {
+    FakeGuestMemory memory = MakeGuestMemory();
+    OpenScreen(memory, ScreenId::ShopBG_00);
+    const ScreenStates before = ScreenStates::ReadFromGuest(memory.Reader());
+
+    OpenScreen(memory, ScreenId::ShopBG_00, 0);
+    OpenScreen(memory, ScreenId::MessageDialog);
+    const ScreenStates after = ScreenStates::ReadFromGuest(memory.Reader());
+
+    const ScreenStates changed = before ^ after;
+    std::vector<ScreenId> changedScreens;
+    changed.ForEachScreen([&](ScreenId id) { changedScreens.push_back(id); });
+    CHECK(changedScreens.size() == 2);
+    CHECK(changed.IsOpen(ScreenId::ShopBG_00) && changed.IsOpen(ScreenId::MessageDialog));
+    CHECK(!(after ^ after).Any());
+}
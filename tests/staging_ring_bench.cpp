@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "utils/alloc_tracker.h"
+#include "utils/staging_ring.h"
+
+#include <cstdio>
+
+
+// Allocates upload regions from the 16 MiB ring the way RND_Vulkan::AllocateStaging does, with a few uploads per command
+// buffer and the GPU completing each submission a couple of submissions later. The baseline is a heap allocation per
+// upload, which is only the host side of the dedicated staging buffer per upload that the ring replaced (that one also
+// created a VkBuffer and allocated and mapped device memory, which costs far more but needs a driver).
+// The heap allocations of the ring's own bookkeeping are counted with the alloc tracker as well.
+
+constexpr uint64_t CAPACITY = 16 * 1024 * 1024;
+constexpr uint64_t ALIGNMENT = 16;
+constexpr uint32_t UPLOADS = 5'000'000;
+constexpr uint32_t UPLOADS_PER_SUBMIT = 4;
+constexpr uint64_t FENCE_LAG = 2;
+
+static volatile uint64_t s_sink = 0;
+
+// odd sizes from a few bytes up to a 256 KiB mip level
+static std::vector<uint64_t> MakeSizes() {
+    std::vector<uint64_t> sizes;
+    uint64_t state = 0x9E3779B97F4A7C15;
+    for (uint32_t i = 0; i < 4096; i++) {
+        state = state * 6364136223846793005 + 1442695040888963407;
+        sizes.emplace_back(1 + (state >> 33) % (256 * 1024));
+    }
+    return sizes;
+}
+
+static double RunRing(const std::vector<uint64_t>& sizes, uint64_t& failed, uint64_t& heapAllocations) {
+    StagingRing ring(CAPACITY);
+    uint64_t fenceValue = 1;
+    uint64_t offsetSum = 0;
+
+    // one pass to let the ring's bookkeeping reach its steady state size
+    auto run = [&](uint32_t uploads) {
+        for (uint32_t i = 0; i < uploads; i++) {
+            const std::optional<uint64_t> offset = ring.Allocate(sizes[i % sizes.size()], ALIGNMENT, fenceValue);
+            if (offset) {
+                offsetSum += *offset;
+            }
+            else {
+                failed++;
+            }
+            if (i % UPLOADS_PER_SUBMIT == UPLOADS_PER_SUBMIT - 1) {
+                fenceValue++;
+                ring.Retire(fenceValue - FENCE_LAG);
+            }
+        }
+    };
+    run(100'000);
+    failed = 0;
+
+    const uint32_t scope = AllocTracker::RegisterScope("StagingRing");
+    AllocTracker::EndFrame();
+    const auto start = std::chrono::steady_clock::now();
+    {
+        AllocTracker::Scope allocScope(scope);
+        run(UPLOADS);
+    }
+    const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / UPLOADS;
+    AllocTracker::EndFrame();
+    heapAllocations = AllocTracker::GetFrameCounts(scope).allocations;
+    s_sink = offsetSum;
+    return ns;
+}
+
+static double RunHeap(const std::vector<uint64_t>& sizes) {
+    uint64_t sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < UPLOADS; i++) {
+        uint8_t* buffer = new uint8_t[sizes[i % sizes.size()]];
+        buffer[0] = (uint8_t)i;
+        sum += buffer[0];
+        delete[] buffer;
+    }
+    s_sink = sum;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / UPLOADS;
+}
+
+int main() {
+    const std::vector<uint64_t> sizes = MakeSizes();
+    const double heap = RunHeap(sizes);
+    uint64_t failed = 0;
+    uint64_t heapAllocations = 0;
+    const double ring = RunRing(sizes, failed, heapAllocations);
+
+    std::printf("heap allocation per upload (before): %.2f ns per upload\n", heap);
+    std::printf("StagingRing::Allocate + Retire:      %.2f ns per upload (%.2f%% didn't fit, %.4f heap allocations per upload)\n", ring,
+        100.0 * (double)failed / UPLOADS, (double)heapAllocations / UPLOADS);
+    return 0;
+}
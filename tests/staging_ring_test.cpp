@@ -0,0 +1,117 @@
+#include "test_framework.h"
+#include "utils/staging_ring.h"
+
+
+TEST_CASE(AlignUpRoundsToTheAlignment) {
+    CHECK(StagingRing::AlignUp(0, 256) == 0);
+    CHECK(StagingRing::AlignUp(1, 256) == 256);
+    CHECK(StagingRing::AlignUp(256, 256) == 256);
+    CHECK(StagingRing::AlignUp(300, 48) == 336);
+    // 0 and 1 mean that there's no alignment requirement
+    CHECK(StagingRing::AlignUp(13, 0) == 13);
+    CHECK(StagingRing::AlignUp(13, 1) == 13);
+}
+
+TEST_CASE(RegionsThatCanNeverFitAreRejected) {
+    StagingRing ring(1024);
+    CHECK(!ring.Fits(0));
+    CHECK(!ring.Fits(1025));
+    CHECK(ring.Fits(1024));
+    CHECK(!ring.Allocate(0, 16, 1).has_value());
+    CHECK(!ring.Allocate(2048, 16, 1).has_value());
+    CHECK(ring.GetRegionCount() == 0);
+}
+
+TEST_CASE(RegionsAreAllocatedInOrderWithTheirPadding) {
+    StagingRing ring(1024);
+    CHECK(ring.Allocate(100, 64, 1) == 0u);
+    CHECK(ring.Allocate(100, 64, 1) == 128u);
+    CHECK(ring.Allocate(10, 1, 2) == 228u);
+    CHECK(ring.GetRegionCount() == 3);
+    // the padding in front of the second region counts as used
+    CHECK(ring.GetUsedBytes() == 238);
+}
+
+TEST_CASE(RetireFreesTheCompletedRegionsOldestFirst) {
+    StagingRing ring(1024);
+    ring.Allocate(256, 1, 1);
+    ring.Allocate(256, 1, 2);
+    ring.Allocate(256, 1, 3);
+
+    ring.Retire(0);
+    CHECK(ring.GetRegionCount() == 3);
+    ring.Retire(2);
+    CHECK(ring.GetRegionCount() == 1);
+    CHECK(ring.GetUsedBytes() == 256);
+
+    // once everything is retired the next region starts at the beginning again
+    ring.Retire(3);
+    CHECK(ring.GetRegionCount() == 0);
+    CHECK(ring.GetUsedBytes() == 0);
+    CHECK(ring.Allocate(1024, 1, 4) == 0u);
+}
+
+TEST_CASE(RetireStopsAtTheFirstIncompleteRegion) {
+    StagingRing ring(1024);
+    ring.Allocate(256, 1, 2);
+    ring.Allocate(256, 1, 1);
+    // the newer region's fence completed, but the space in front of it is still in use
+    ring.Retire(1);
+    CHECK(ring.GetRegionCount() == 2);
+    ring.Retire(2);
+    CHECK(ring.GetRegionCount() == 0);
+}
+
+TEST_CASE(FullRingRejectsUntilRetired) {
+    StagingRing ring(1024);
+    CHECK(ring.Allocate(512, 1, 1) == 0u);
+    CHECK(ring.Allocate(512, 1, 2) == 512u);
+    CHECK(!ring.Allocate(1, 1, 3).has_value());
+    CHECK(ring.GetUsedBytes() == 1024);
+
+    ring.Retire(1);
+    CHECK(ring.Allocate(256, 1, 3) == 0u);
+}
+
+TEST_CASE(RegionsWrapAroundToTheStart) {
+    StagingRing ring(1024);
+    ring.Allocate(400, 1, 1);
+    ring.Allocate(400, 1, 2);
+    ring.Retire(1);
+
+    // 224 bytes are left at the end, so the region starts over at offset 0 and the end of the buffer is skipped
+    CHECK(ring.Allocate(300, 1, 3) == 0u);
+    CHECK(ring.GetUsedBytes() == 1024 - 400 + 300);
+    // the wrapped head can't run into the region that's still in use
+    CHECK(!ring.Allocate(101, 1, 3).has_value());
+    CHECK(ring.Allocate(100, 1, 3) == 300u);
+
+    // the skipped bytes belong to the wrapped region, so they're only freed along with it
+    ring.Retire(2);
+    CHECK(ring.GetUsedBytes() == 1024 - 800 + 400);
+    ring.Retire(3);
+    CHECK(ring.GetRegionCount() == 0);
+}
+
+TEST_CASE(WrappingNeedsRoomInFrontOfTheOldestRegion) {
+    StagingRing ring(1024);
+    ring.Allocate(200, 1, 1);
+    ring.Allocate(700, 1, 2);
+    ring.Retire(1);
+
+    // neither the 124 bytes at the end nor the 200 at the start fit this
+    CHECK(!ring.Allocate(300, 1, 3).has_value());
+    CHECK(ring.Allocate(200, 1, 3) == 0u);
+}
+
+TEST_CASE(AlignedRegionsInTheWrappedPartStayInFrontOfTheTail) {
+    StagingRing ring(1024);
+    ring.Allocate(512, 1, 1);
+    ring.Allocate(512, 1, 2);
+    ring.Retire(1);
+
+    CHECK(ring.Allocate(10, 1, 3) == 0u);
+    // aligned up to 256, which would overlap the region that starts at 512 once it's 257 bytes or longer
+    CHECK(!ring.Allocate(257, 256, 3).has_value());
+    CHECK(ring.Allocate(256, 256, 3) == 256u);
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "pch.h"
+
+#include <cstdio>
+
+
+// Minimal test runner, so that the tests don't need anything besides a C++ compiler. Every TEST_CASE registers itself, and
+// the CHECK macros record failures without aborting the test so that one run reports all of them.
+namespace Test {
+    struct Case {
+        const char* name;
+        void (*function)();
+    };
+
+    inline std::vector<Case>& GetCases() {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    inline uint32_t& GetFailureCount() {
+        static uint32_t failures = 0;
+        return failures;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, void (*function)()) {
+            GetCases().push_back({ name, function });
+        }
+    };
+
+    inline void Fail(const char* file, int line, const std::string& message) {
+        std::printf("  %s:%d: %s\n", file, line, message.c_str());
+        GetFailureCount()++;
+    }
+
+    inline int RunAll() {
+        uint32_t failedCases = 0;
+        for (const Case& testCase : GetCases()) {
+            const uint32_t failuresBefore = GetFailureCount();
+            try {
+                testCase.function();
+            }
+            catch (const std::exception& e) {
+                Fail(__FILE__, __LINE__, std::string("unexpected exception: ") + e.what());
+            }
+            const bool passed = GetFailureCount() == failuresBefore;
+            std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", testCase.name);
+            failedCases += passed ? 0 : 1;
+        }
+        std::printf("%zu test cases, %u failed\n", GetCases().size(), failedCases);
+        return failedCases == 0 ? 0 : 1;
+    }
+}
+
+#define TEST_CASE(name)                                              \
+    static void name();                                              \
+    static const Test::Registrar name##_registrar(#name, &name);     \
+    static void name()
+
+#define CHECK(condition)                                             \
+    do {                                                             \
+        if (!(condition)) {                                          \
+            Test::Fail(__FILE__, __LINE__, "CHECK(" #condition ")"); \
+        }                                                            \
+    } while (false)
+
+#define CHECK_NEAR(actual, expected, epsilon)                                                                                   \
+    do {                                                                                                                         \
+        const double actualValue = (double)(actual);                                                                            \
+        const double expectedValue = (double)(expected);                                                                        \
+        if (!(std::abs(actualValue - expectedValue) <= (double)(epsilon))) {                                                     \
+            Test::Fail(__FILE__, __LINE__, "CHECK_NEAR(" #actual ", " #expected "): " + std::to_string(actualValue) + " != " + std::to_string(expectedValue)); \
+        }                                                                                                                        \
+    } while (false)
+
+#define CHECK_THROWS(expression)                                               \
+    do {                                                                       \
+        bool threw = false;                                                    \
+        try {                                                                  \
+            (void)(expression);                                                \
+        }                                                                      \
+        catch (const std::exception&) {                                        \
+            threw = true;                                                      \
+        }                                                                      \
+        if (!threw) {                                                          \
+            Test::Fail(__FILE__, __LINE__, "CHECK_THROWS(" #expression ")");   \
+        }                                                                      \
+    } while (false)
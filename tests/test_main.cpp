@@ -0,0 +1,6 @@
+#include "test_framework.h"
+
+
+int main() {
+    return Test::RunAll();
+}
@@ -0,0 +1,97 @@
+#include "test_framework.h"
+#include "utils/alloc_tracker.h"
+#include "utils/update_divider.h"
+
+
+// Runs the divider like EndFrame does for the HUD layer: the first update renders until it got presented, after that only
+// every Nth frame is rendered while the other frames resubmit the quad with its last image.
+
+static std::vector<uint32_t> UpdatedFrames(UpdateDivider& divider, uint32_t dividerSetting, uint32_t frames, uint32_t firstFrame = 0) {
+    std::vector<uint32_t> updated;
+    for (uint32_t frame = firstFrame; frame < firstFrame + frames; frame++) {
+        if (divider.ShouldUpdate(dividerSetting, false)) {
+            divider.OnUpdated();
+            updated.emplace_back(frame);
+        }
+    }
+    return updated;
+}
+
+TEST_CASE(EveryFrameUpdatesUntilAnUpdateWasPresented) {
+    UpdateDivider divider;
+    for (uint32_t frame = 0; frame < 10; frame++) {
+        CHECK(divider.ShouldUpdate(4, false));
+    }
+    divider.OnUpdated();
+    CHECK(!divider.ShouldUpdate(4, false));
+}
+
+TEST_CASE(HudUpdatesEveryNthFrame) {
+    for (uint32_t setting = 1; setting <= 4; setting++) {
+        UpdateDivider divider;
+        const std::vector<uint32_t> updated = UpdatedFrames(divider, setting, 120);
+        CHECK(updated.size() == 120 / setting);
+        CHECK(!updated.empty() && updated.front() == 0);
+        for (size_t i = 1; i < updated.size(); i++) {
+            CHECK(updated[i] - updated[i - 1] == setting);
+        }
+    }
+
+    // 0 is treated like 1 instead of never updating
+    UpdateDivider divider;
+    CHECK(UpdatedFrames(divider, 0, 30).size() == 30);
+}
+
+TEST_CASE(ForcedUpdateRendersRightAwayAndRestartsTheCount) {
+    UpdateDivider divider;
+    CHECK(UpdatedFrames(divider, 4, 6) == std::vector<uint32_t>({ 0, 4 }));
+    // a menu opening on frame 6 doesn't wait for frame 8
+    CHECK(divider.ShouldUpdate(4, true));
+    divider.OnUpdated();
+    CHECK(UpdatedFrames(divider, 4, 8, 7) == std::vector<uint32_t>({ 10, 14 }));
+}
+
+TEST_CASE(DividerChangesApplyToTheRunningCount) {
+    UpdateDivider divider;
+    CHECK(UpdatedFrames(divider, 4, 2) == std::vector<uint32_t>({ 0 }));
+    // frame 2 is the second frame since the last update, which already reaches the new divider
+    CHECK(UpdatedFrames(divider, 2, 4, 2) == std::vector<uint32_t>({ 2, 4 }));
+    CHECK(UpdatedFrames(divider, 1, 3, 6) == std::vector<uint32_t>({ 6, 7, 8 }));
+}
+
+TEST_CASE(SkippedHudFramesDontReallocateTheLayers) {
+    // EndFrame's HUD section: the layer list and the quad are members that get refilled every frame, whether the HUD was
+    // rendered or not, so neither their storage nor the divider may allocate
+    struct Quad {
+        uint32_t frame = 0;
+        bool updated = false;
+    };
+    std::array<const Quad*, 2> compositionLayers = {};
+    Quad quad;
+    UpdateDivider divider;
+    const Quad* const* const layersStorage = compositionLayers.data();
+
+    const uint32_t scope = AllocTracker::RegisterScope("Test::HudFrame", 0);
+    AllocTracker::EndFrame();
+    uint32_t renderedFrames = 0;
+    for (uint32_t frame = 0; frame < 240; frame++) {
+        {
+            AllocTracker::Scope allocScope(scope);
+            uint32_t layerCount = 0;
+            const bool updateHUD = divider.ShouldUpdate(3, frame == 100);
+            if (updateHUD) {
+                divider.OnUpdated();
+                renderedFrames++;
+            }
+            quad = { .frame = frame, .updated = updateHUD };
+            compositionLayers[layerCount++] = &quad;
+            CHECK(layerCount <= compositionLayers.size());
+        }
+        AllocTracker::EndFrame();
+        CHECK(AllocTracker::GetFrameCounts(scope).allocations == 0);
+        CHECK(compositionLayers.data() == layersStorage);
+        CHECK(compositionLayers[0] == &quad && quad.frame == frame);
+    }
+    // every third frame plus the forced one, which restarted the count
+    CHECK(renderedFrames == 81);
+}
@@ -0,0 +1,149 @@
+#include "pch.h"
+#include "fake_openxr_loader.h"
+#include "rendering/xr_backend.h"
+
+#include <cstdio>
+#include <sstream>
+
+
+// Runs the OpenXR calls that the mod makes every frame through the scripted backend, replaying a timeline that changes the
+// head, both hands and a few actions every frame. The runtime underneath only paces frames, so this is the cost that the
+// scripted backend adds on top of it.
+
+constexpr uint32_t FRAMES = 20000;
+constexpr uint32_t ACTIONS = 24; // roughly what OpenXR::UpdateActions polls
+
+template <typename Handle>
+static Handle MakeHandle(uint64_t value) {
+    return (Handle)(uintptr_t)value;
+}
+
+class PacingRuntime final : public XrBackend {
+public:
+    const char* GetName() const override { return "Pacing"; }
+
+    XrResult CreateSession(XrInstance, const XrSessionCreateInfo*, XrSession* session) override {
+        *session = MakeHandle<XrSession>(1);
+        return XR_SUCCESS;
+    }
+    XrResult BeginSession(XrSession, const XrSessionBeginInfo*) override { return XR_SUCCESS; }
+    XrResult EndSession(XrSession) override { return XR_SUCCESS; }
+    XrResult RequestExitSession(XrSession) override { return XR_SUCCESS; }
+
+    XrResult WaitFrame(XrSession, const XrFrameWaitInfo*, XrFrameState* frameState) override {
+        m_clock += 11'111'111;
+        frameState->predictedDisplayTime = m_clock;
+        frameState->predictedDisplayPeriod = 11'111'111;
+        return XR_SUCCESS;
+    }
+    XrResult BeginFrame(XrSession, const XrFrameBeginInfo*) override { return XR_SUCCESS; }
+    XrResult EndFrame(XrSession, const XrFrameEndInfo*) override { return XR_SUCCESS; }
+
+    XrResult SyncActions(XrSession, const XrActionsSyncInfo*) override { return XR_SUCCESS; }
+    XrResult GetActionStateBoolean(XrSession, const XrActionStateGetInfo*, XrActionStateBoolean*) override { return XR_SUCCESS; }
+    XrResult GetActionStateFloat(XrSession, const XrActionStateGetInfo*, XrActionStateFloat*) override { return XR_SUCCESS; }
+    XrResult GetActionStateVector2f(XrSession, const XrActionStateGetInfo*, XrActionStateVector2f*) override { return XR_SUCCESS; }
+    XrResult GetActionStatePose(XrSession, const XrActionStateGetInfo*, XrActionStatePose*) override { return XR_SUCCESS; }
+    XrResult LocateSpace(XrSpace, XrSpace, XrTime, XrSpaceLocation*) override { return XR_SUCCESS; }
+    XrResult LocateViews(XrSession, const XrViewLocateInfo*, XrViewState*, uint32_t, uint32_t*, XrView*) override { return XR_SUCCESS; }
+    XrResult PollEvent(XrInstance, XrEventDataBuffer*) override { return XR_EVENT_UNAVAILABLE; }
+
+    XrResult ApplyHapticFeedback(XrSession, const XrHapticActionInfo*, const XrHapticBaseHeader*) override { return XR_SUCCESS; }
+    XrResult StopHapticFeedback(XrSession, const XrHapticActionInfo*) override { return XR_SUCCESS; }
+
+private:
+    XrTime m_clock = 0;
+};
+
+static std::string GenerateTimeline() {
+    std::ostringstream timeline;
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        const float t = (float)frame * 0.01f;
+        timeline << "frame " << (frame + 1) * 11'111'111ll << "\n";
+        timeline << "head " << std::sin(t) * 0.1f << " 1.6 0 0 " << std::sin(t * 0.5f) << " 0 " << std::cos(t * 0.5f) << "\n";
+        timeline << "hand left -0.2 1.2 -0.3 0 0 0 1 " << std::cos(t) << " 0 0 0 1 0\n";
+        timeline << "hand right 0.2 1.2 -0.3 0 0 0 1\n";
+        timeline << "bool action" << frame % ACTIONS << " " << (frame / ACTIONS) % 2 << "\n";
+        timeline << "vec2 action" << (frame + 1) % ACTIONS << " right " << std::sin(t) << " " << std::cos(t) << "\n";
+    }
+    return timeline.str();
+}
+
+int main() {
+    std::istringstream timeline(GenerateTimeline());
+    ScriptedXrBackend backend(timeline, std::make_unique<PacingRuntime>());
+
+    XrSession session = XR_NULL_HANDLE;
+    XrSessionCreateInfo createInfo = MakeXrStruct<XrSessionCreateInfo>(XR_TYPE_SESSION_CREATE_INFO);
+    backend.CreateSession(XR_NULL_HANDLE, &createInfo, &session);
+
+    const XrSpace stage = MakeHandle<XrSpace>(1);
+    const XrSpace head = MakeHandle<XrSpace>(2);
+    const std::array<XrSpace, 2> hands = { MakeHandle<XrSpace>(3), MakeHandle<XrSpace>(4) };
+    const std::array<XrPath, 2> handPaths = { 100, 101 };
+    backend.NameSpace(stage, "stage");
+    backend.NameSpace(head, "head");
+    backend.NameSpace(hands[0], "left");
+    backend.NameSpace(hands[1], "right");
+    backend.NamePath(handPaths[0], "left");
+    backend.NamePath(handPaths[1], "right");
+    std::vector<XrAction> actions;
+    for (uint32_t i = 0; i < ACTIONS; i++) {
+        actions.emplace_back(MakeHandle<XrAction>(1000 + i));
+        backend.NameAction(actions.back(), ("action" + std::to_string(i)).c_str());
+    }
+
+    double checksum = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        XrFrameWaitInfo waitInfo = MakeXrStruct<XrFrameWaitInfo>(XR_TYPE_FRAME_WAIT_INFO);
+        XrFrameState frameState = MakeXrStruct<XrFrameState>(XR_TYPE_FRAME_STATE);
+        backend.WaitFrame(session, &waitInfo, &frameState);
+        XrFrameBeginInfo beginInfo = MakeXrStruct<XrFrameBeginInfo>(XR_TYPE_FRAME_BEGIN_INFO);
+        backend.BeginFrame(session, &beginInfo);
+
+        XrActionsSyncInfo syncInfo = MakeXrStruct<XrActionsSyncInfo>(XR_TYPE_ACTIONS_SYNC_INFO);
+        backend.SyncActions(session, &syncInfo);
+        for (uint32_t side = 0; side < 2; side++) {
+            XrActionStateGetInfo getInfo = MakeXrStruct<XrActionStateGetInfo>(XR_TYPE_ACTION_STATE_GET_INFO);
+            getInfo.subactionPath = handPaths[side];
+            XrActionStatePose poseState = MakeXrStruct<XrActionStatePose>(XR_TYPE_ACTION_STATE_POSE);
+            backend.GetActionStatePose(session, &getInfo, &poseState);
+
+            XrSpaceVelocity velocity = MakeXrStruct<XrSpaceVelocity>(XR_TYPE_SPACE_VELOCITY);
+            XrSpaceLocation location = MakeXrStruct<XrSpaceLocation>(XR_TYPE_SPACE_LOCATION);
+            location.next = &velocity;
+            backend.LocateSpace(hands[side], stage, frameState.predictedDisplayTime, &location);
+            checksum += location.pose.position.y + velocity.linearVelocity.x;
+        }
+        for (uint32_t i = 0; i < ACTIONS; i++) {
+            XrActionStateGetInfo getInfo = MakeXrStruct<XrActionStateGetInfo>(XR_TYPE_ACTION_STATE_GET_INFO);
+            getInfo.action = actions[i];
+            XrActionStateVector2f state = MakeXrStruct<XrActionStateVector2f>(XR_TYPE_ACTION_STATE_VECTOR2F);
+            backend.GetActionStateVector2f(session, &getInfo, &state);
+            checksum += state.currentState.x;
+        }
+
+        XrSpaceLocation headLocation = MakeXrStruct<XrSpaceLocation>(XR_TYPE_SPACE_LOCATION);
+        backend.LocateSpace(head, stage, frameState.predictedDisplayTime, &headLocation);
+        XrViewLocateInfo locateInfo = MakeXrStruct<XrViewLocateInfo>(XR_TYPE_VIEW_LOCATE_INFO);
+        locateInfo.space = stage;
+        XrViewState viewState = MakeXrStruct<XrViewState>(XR_TYPE_VIEW_STATE);
+        std::array<XrView, 2> views = { MakeXrStruct<XrView>(XR_TYPE_VIEW), MakeXrStruct<XrView>(XR_TYPE_VIEW) };
+        uint32_t viewCount = 0;
+        backend.LocateViews(session, &locateInfo, &viewState, 2, &viewCount, views.data());
+        checksum += views[0].pose.position.x + headLocation.pose.orientation.y;
+
+        XrEventDataBuffer eventData = MakeXrStruct<XrEventDataBuffer>(XR_TYPE_EVENT_DATA_BUFFER);
+        while (backend.PollEvent(XR_NULL_HANDLE, &eventData) == XR_SUCCESS) {
+        }
+
+        XrFrameEndInfo endInfo = MakeXrStruct<XrFrameEndInfo>(XR_TYPE_FRAME_END_INFO);
+        endInfo.displayTime = frameState.predictedDisplayTime;
+        backend.EndFrame(session, &endInfo);
+    }
+    const double nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("scripted frame (%u actions, 3 spaces, views, events): %.2f us per frame (checksum %.3f)\n", ACTIONS, nanoseconds / FRAMES / 1000.0, checksum);
+    return 0;
+}
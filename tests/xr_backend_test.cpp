@@ -0,0 +1,349 @@
+#include "test_framework.h"
+#include "fake_openxr_loader.h"
+#include "rendering/xr_backend.h"
+
+#include <sstream>
+
+
+constexpr XrDuration MS = 1'000'000;
+constexpr XrDuration RUNTIME_PERIOD = 11 * MS;
+
+template <typename Handle>
+static Handle MakeHandle(uint64_t value) {
+    return (Handle)(uintptr_t)value;
+}
+
+// Plays the runtime's part in the frame loop: paces frames on its own clock, creates a session and queues its own events
+class FakeRuntime final : public XrBackend {
+public:
+    const char* GetName() const override { return "Fake"; }
+
+    XrResult CreateSession(XrInstance, const XrSessionCreateInfo*, XrSession* session) override {
+        *session = MakeHandle<XrSession>(0x5E55);
+        return XR_SUCCESS;
+    }
+    XrResult BeginSession(XrSession, const XrSessionBeginInfo*) override {
+        running = true;
+        return XR_SUCCESS;
+    }
+    XrResult EndSession(XrSession) override {
+        running = false;
+        return XR_SUCCESS;
+    }
+    XrResult RequestExitSession(XrSession) override { return XR_SUCCESS; }
+
+    XrResult WaitFrame(XrSession, const XrFrameWaitInfo*, XrFrameState* frameState) override {
+        clock += RUNTIME_PERIOD;
+        frameState->predictedDisplayTime = clock;
+        frameState->predictedDisplayPeriod = RUNTIME_PERIOD;
+        frameState->shouldRender = XR_TRUE;
+        return running ? XR_SUCCESS : XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    XrResult BeginFrame(XrSession, const XrFrameBeginInfo*) override { return XR_SUCCESS; }
+    XrResult EndFrame(XrSession, const XrFrameEndInfo* endInfo) override {
+        submittedDisplayTimes.emplace_back(endInfo->displayTime);
+        return XR_SUCCESS;
+    }
+
+    // the scripted backend answers all of these itself, so getting here is a failure
+    XrResult SyncActions(XrSession, const XrActionsSyncInfo*) override { return Unexpected(); }
+    XrResult GetActionStateBoolean(XrSession, const XrActionStateGetInfo*, XrActionStateBoolean*) override { return Unexpected(); }
+    XrResult GetActionStateFloat(XrSession, const XrActionStateGetInfo*, XrActionStateFloat*) override { return Unexpected(); }
+    XrResult GetActionStateVector2f(XrSession, const XrActionStateGetInfo*, XrActionStateVector2f*) override { return Unexpected(); }
+    XrResult GetActionStatePose(XrSession, const XrActionStateGetInfo*, XrActionStatePose*) override { return Unexpected(); }
+    XrResult LocateSpace(XrSpace, XrSpace, XrTime, XrSpaceLocation*) override { return Unexpected(); }
+    XrResult LocateViews(XrSession, const XrViewLocateInfo*, XrViewState*, uint32_t, uint32_t*, XrView*) override { return Unexpected(); }
+
+    XrResult PollEvent(XrInstance, XrEventDataBuffer* eventData) override {
+        if (events.empty()) {
+            return XR_EVENT_UNAVAILABLE;
+        }
+        XrEventDataSessionStateChanged* stateChanged = (XrEventDataSessionStateChanged*)eventData;
+        *stateChanged = MakeXrStruct<XrEventDataSessionStateChanged>(XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED);
+        stateChanged->state = events.front();
+        events.pop();
+        return XR_SUCCESS;
+    }
+
+    XrResult ApplyHapticFeedback(XrSession, const XrHapticActionInfo*, const XrHapticBaseHeader*) override { return Unexpected(); }
+    XrResult StopHapticFeedback(XrSession, const XrHapticActionInfo*) override { return Unexpected(); }
+
+    XrTime clock = 0;
+    bool running = false;
+    std::vector<XrTime> submittedDisplayTimes;
+    std::queue<XrSessionState> events;
+    uint32_t unexpectedCalls = 0;
+
+private:
+    XrResult Unexpected() {
+        unexpectedCalls++;
+        return XR_ERROR_FUNCTION_UNSUPPORTED;
+    }
+};
+
+const XrSpace STAGE = MakeHandle<XrSpace>(1);
+const XrSpace HEAD = MakeHandle<XrSpace>(2);
+const XrSpace LEFT_HAND = MakeHandle<XrSpace>(3);
+const XrSpace RIGHT_HAND = MakeHandle<XrSpace>(4);
+const XrAction JUMP = MakeHandle<XrAction>(10);
+const XrAction GRAB = MakeHandle<XrAction>(11);
+const XrAction MOVE = MakeHandle<XrAction>(12);
+constexpr XrPath LEFT_PATH = 100;
+constexpr XrPath RIGHT_PATH = 101;
+
+// Sets up the scripted backend the way OpenXR::CreateSession and OpenXR::CreateActions do, on top of a fake runtime
+struct Harness {
+    explicit Harness(const std::string& timeline) {
+        std::istringstream stream(timeline);
+        auto fakeRuntime = std::make_unique<FakeRuntime>();
+        runtime = fakeRuntime.get();
+        backend = std::make_unique<ScriptedXrBackend>(stream, std::move(fakeRuntime));
+
+        XrSessionCreateInfo createInfo = MakeXrStruct<XrSessionCreateInfo>(XR_TYPE_SESSION_CREATE_INFO);
+        CHECK(backend->CreateSession(XR_NULL_HANDLE, &createInfo, &session) == XR_SUCCESS);
+        XrSessionBeginInfo beginInfo = MakeXrStruct<XrSessionBeginInfo>(XR_TYPE_SESSION_BEGIN_INFO);
+        CHECK(backend->BeginSession(session, &beginInfo) == XR_SUCCESS);
+
+        backend->NameSpace(STAGE, "stage");
+        backend->NameSpace(HEAD, "head");
+        backend->NameSpace(LEFT_HAND, "left");
+        backend->NameSpace(RIGHT_HAND, "right");
+        backend->NamePath(LEFT_PATH, "left");
+        backend->NamePath(RIGHT_PATH, "right");
+        backend->NameAction(JUMP, "jump");
+        backend->NameAction(GRAB, "grab");
+        backend->NameAction(MOVE, "move");
+    }
+
+    // WaitFrame, BeginFrame, SyncActions, then EndFrame at the display time that WaitFrame predicted, like RND_Renderer does
+    XrFrameState RunFrame() {
+        XrFrameWaitInfo waitInfo = MakeXrStruct<XrFrameWaitInfo>(XR_TYPE_FRAME_WAIT_INFO);
+        XrFrameState frameState = MakeXrStruct<XrFrameState>(XR_TYPE_FRAME_STATE);
+        CHECK(backend->WaitFrame(session, &waitInfo, &frameState) == XR_SUCCESS);
+        XrFrameBeginInfo beginInfo = MakeXrStruct<XrFrameBeginInfo>(XR_TYPE_FRAME_BEGIN_INFO);
+        CHECK(backend->BeginFrame(session, &beginInfo) == XR_SUCCESS);
+        XrActionsSyncInfo syncInfo = MakeXrStruct<XrActionsSyncInfo>(XR_TYPE_ACTIONS_SYNC_INFO);
+        CHECK(backend->SyncActions(session, &syncInfo) == XR_SUCCESS);
+        XrFrameEndInfo endInfo = MakeXrStruct<XrFrameEndInfo>(XR_TYPE_FRAME_END_INFO);
+        endInfo.displayTime = frameState.predictedDisplayTime;
+        CHECK(backend->EndFrame(session, &endInfo) == XR_SUCCESS);
+        return frameState;
+    }
+
+    XrActionStateBoolean GetBool(XrAction action, XrPath hand = XR_NULL_PATH) {
+        XrActionStateGetInfo getInfo = MakeXrStruct<XrActionStateGetInfo>(XR_TYPE_ACTION_STATE_GET_INFO);
+        getInfo.action = action;
+        getInfo.subactionPath = hand;
+        XrActionStateBoolean state = MakeXrStruct<XrActionStateBoolean>(XR_TYPE_ACTION_STATE_BOOLEAN);
+        CHECK(backend->GetActionStateBoolean(session, &getInfo, &state) == XR_SUCCESS);
+        return state;
+    }
+
+    XrActionStateFloat GetFloat(XrAction action, XrPath hand = XR_NULL_PATH) {
+        XrActionStateGetInfo getInfo = MakeXrStruct<XrActionStateGetInfo>(XR_TYPE_ACTION_STATE_GET_INFO);
+        getInfo.action = action;
+        getInfo.subactionPath = hand;
+        XrActionStateFloat state = MakeXrStruct<XrActionStateFloat>(XR_TYPE_ACTION_STATE_FLOAT);
+        CHECK(backend->GetActionStateFloat(session, &getInfo, &state) == XR_SUCCESS);
+        return state;
+    }
+
+    XrActionStateVector2f GetVector2(XrAction action, XrPath hand = XR_NULL_PATH) {
+        XrActionStateGetInfo getInfo = MakeXrStruct<XrActionStateGetInfo>(XR_TYPE_ACTION_STATE_GET_INFO);
+        getInfo.action = action;
+        getInfo.subactionPath = hand;
+        XrActionStateVector2f state = MakeXrStruct<XrActionStateVector2f>(XR_TYPE_ACTION_STATE_VECTOR2F);
+        CHECK(backend->GetActionStateVector2f(session, &getInfo, &state) == XR_SUCCESS);
+        return state;
+    }
+
+    XrSpaceLocation Locate(XrSpace space, XrSpace baseSpace, XrSpaceVelocity* velocity = nullptr) {
+        XrSpaceLocation location = MakeXrStruct<XrSpaceLocation>(XR_TYPE_SPACE_LOCATION);
+        location.next = velocity;
+        CHECK(backend->LocateSpace(space, baseSpace, 0, &location) == XR_SUCCESS);
+        return location;
+    }
+
+    std::vector<XrSessionState> PollStates() {
+        std::vector<XrSessionState> states;
+        XrEventDataBuffer eventData = MakeXrStruct<XrEventDataBuffer>(XR_TYPE_EVENT_DATA_BUFFER);
+        while (backend->PollEvent(XR_NULL_HANDLE, &eventData) == XR_SUCCESS) {
+            const XrEventDataSessionStateChanged* stateChanged = (const XrEventDataSessionStateChanged*)&eventData;
+            CHECK(stateChanged->type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED);
+            states.emplace_back(stateChanged->state);
+            lastEventSession = stateChanged->session;
+            eventData = MakeXrStruct<XrEventDataBuffer>(XR_TYPE_EVENT_DATA_BUFFER);
+        }
+        return states;
+    }
+
+    FakeRuntime* runtime = nullptr;
+    std::unique_ptr<ScriptedXrBackend> backend;
+    XrSession session = XR_NULL_HANDLE;
+    XrSession lastEventSession = XR_NULL_HANDLE;
+};
+
+TEST_CASE(FrameLoopRunsWithoutARuntime) {
+    Harness harness(
+        "frame 1000000000 20000000\n"
+        "frame 1020000000\n"
+        "frame 1040000000 10000000\n");
+
+    const uint32_t loaderCallsBefore = FakeOpenXRLoader::GetCallCount();
+    const std::array<XrTime, 5> expectedTimes = { 1'000'000'000, 1'020'000'000, 1'040'000'000, 1'050'000'000, 1'060'000'000 };
+    const std::array<XrDuration, 5> expectedPeriods = { 20 * MS, 20 * MS, 10 * MS, 10 * MS, 10 * MS };
+    for (uint32_t frame = 0; frame < expectedTimes.size(); frame++) {
+        const XrFrameState frameState = harness.RunFrame();
+        // the timeline's times are handed to the game, and time keeps going at the last period once it runs out
+        CHECK(frameState.predictedDisplayTime == expectedTimes[frame]);
+        CHECK(frameState.predictedDisplayPeriod == expectedPeriods[frame]);
+    }
+
+    // but the runtime only ever sees the times that it predicted itself
+    CHECK(harness.runtime->submittedDisplayTimes.size() == 5);
+    for (uint32_t frame = 0; frame < 5; frame++) {
+        CHECK(harness.runtime->submittedDisplayTimes[frame] == (XrTime)(frame + 1) * RUNTIME_PERIOD);
+    }
+    CHECK(harness.runtime->unexpectedCalls == 0);
+    CHECK(FakeOpenXRLoader::GetCallCount() == loaderCallsBefore);
+
+    CHECK(harness.backend->EndSession(harness.session) == XR_SUCCESS);
+    CHECK(!harness.runtime->running);
+}
+
+TEST_CASE(TimelineStatesFollowTheRuntimesOwn) {
+    Harness harness(
+        "state ready\n"
+        "frame 1000\n"
+        "frame 2000\n"
+        "state synchronized\n"
+        "state focused\n");
+    harness.runtime->events.push(XR_SESSION_STATE_IDLE);
+
+    CHECK((harness.PollStates() == std::vector<XrSessionState>{ XR_SESSION_STATE_IDLE, XR_SESSION_STATE_READY }));
+    CHECK(harness.lastEventSession == harness.session);
+
+    harness.RunFrame();
+    CHECK(harness.PollStates().empty());
+    harness.RunFrame();
+    CHECK((harness.PollStates() == std::vector<XrSessionState>{ XR_SESSION_STATE_SYNCHRONIZED, XR_SESSION_STATE_FOCUSED }));
+}
+
+TEST_CASE(ActionsAreCombinedAcrossHands) {
+    Harness harness(
+        "frame 1000\n"
+        "bool jump right 1\n"
+        "float grab left 0.25\n"
+        "float grab right -0.75\n"
+        "vec2 move left 0.1 0.1\n"
+        "vec2 move right 0 0.5\n"
+        "frame 2000\n"
+        "frame 3000\n"
+        "bool jump 0\n");
+
+    harness.RunFrame();
+    CHECK(harness.GetBool(JUMP).currentState == XR_TRUE);
+    CHECK(harness.GetBool(JUMP, LEFT_PATH).currentState == XR_FALSE);
+    CHECK(harness.GetBool(JUMP, RIGHT_PATH).currentState == XR_TRUE);
+    CHECK(harness.GetBool(JUMP).changedSinceLastSync == XR_TRUE);
+    CHECK(harness.GetBool(JUMP).lastChangeTime == 1000);
+    CHECK(harness.GetBool(JUMP, LEFT_PATH).changedSinceLastSync == XR_FALSE);
+
+    // the value furthest from zero and the longest vector win without a subaction path
+    CHECK_NEAR(harness.GetFloat(GRAB).currentState, -0.75, 1e-6);
+    CHECK_NEAR(harness.GetFloat(GRAB, LEFT_PATH).currentState, 0.25, 1e-6);
+    CHECK_NEAR(harness.GetVector2(MOVE).currentState.y, 0.5, 1e-6);
+    CHECK_NEAR(harness.GetVector2(MOVE, LEFT_PATH).currentState.x, 0.1, 1e-6);
+
+    // values stick, but only count as changed on the sync after they changed
+    harness.RunFrame();
+    CHECK(harness.GetBool(JUMP).currentState == XR_TRUE);
+    CHECK(harness.GetBool(JUMP).changedSinceLastSync == XR_FALSE);
+    CHECK(harness.GetFloat(GRAB).changedSinceLastSync == XR_FALSE);
+
+    harness.RunFrame();
+    CHECK(harness.GetBool(JUMP).currentState == XR_FALSE);
+    CHECK(harness.GetBool(JUMP).changedSinceLastSync == XR_TRUE);
+    CHECK(harness.GetBool(JUMP).lastChangeTime == 3000);
+
+    // actions that the timeline never mentions are active but idle
+    CHECK(harness.GetBool(MakeHandle<XrAction>(99)).isActive == XR_TRUE);
+    CHECK(harness.GetBool(MakeHandle<XrAction>(99)).currentState == XR_FALSE);
+}
+
+TEST_CASE(PosesAreLocatedRelativeToTheBaseSpace) {
+    Harness harness(
+        "frame 1000\n"
+        "head 0 1.6 0 0 0.7071068 0 0.7071068\n"
+        "hand left 0.5 1.6 0 0 0 0 1 1 0 0 0 2 0\n"
+        "hand right lost\n");
+    harness.RunFrame();
+
+    XrSpaceVelocity velocity = MakeXrStruct<XrSpaceVelocity>(XR_TYPE_SPACE_VELOCITY);
+    const XrSpaceLocation inStage = harness.Locate(LEFT_HAND, STAGE, &velocity);
+    CHECK((inStage.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0);
+    CHECK_NEAR(inStage.pose.position.x, 0.5, 1e-5);
+    CHECK_NEAR(inStage.pose.position.y, 1.6, 1e-5);
+    CHECK((velocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) != 0);
+    CHECK_NEAR(velocity.linearVelocity.x, 1.0, 1e-5);
+    CHECK_NEAR(velocity.angularVelocity.y, 2.0, 1e-5);
+
+    // the head is turned 90 degrees to the left, so the hand that's to the right of the stage origin is behind the head
+    const XrSpaceLocation inHead = harness.Locate(LEFT_HAND, HEAD, &velocity);
+    CHECK_NEAR(inHead.pose.position.x, 0.0, 1e-5);
+    CHECK_NEAR(inHead.pose.position.y, 0.0, 1e-5);
+    CHECK_NEAR(inHead.pose.position.z, 0.5, 1e-5);
+    CHECK_NEAR(velocity.linearVelocity.z, 1.0, 1e-5);
+
+    const XrSpaceLocation lost = harness.Locate(RIGHT_HAND, STAGE);
+    CHECK(lost.locationFlags == 0);
+
+    XrActionStateGetInfo getInfo = MakeXrStruct<XrActionStateGetInfo>(XR_TYPE_ACTION_STATE_GET_INFO);
+    getInfo.subactionPath = RIGHT_PATH;
+    XrActionStatePose poseState = MakeXrStruct<XrActionStatePose>(XR_TYPE_ACTION_STATE_POSE);
+    harness.backend->GetActionStatePose(harness.session, &getInfo, &poseState);
+    CHECK(poseState.isActive == XR_FALSE);
+    getInfo.subactionPath = LEFT_PATH;
+    harness.backend->GetActionStatePose(harness.session, &getInfo, &poseState);
+    CHECK(poseState.isActive == XR_TRUE);
+}
+
+TEST_CASE(ViewsAreOffsetByTheIpd) {
+    Harness harness(
+        "ipd 0.07\n"
+        "fov -0.5 0.6 0.7 -0.8\n"
+        "frame 1000\n"
+        "head 0 1.6 0 0 0 0 1\n");
+    harness.RunFrame();
+
+    XrViewLocateInfo locateInfo = MakeXrStruct<XrViewLocateInfo>(XR_TYPE_VIEW_LOCATE_INFO);
+    locateInfo.space = STAGE;
+    XrViewState viewState = MakeXrStruct<XrViewState>(XR_TYPE_VIEW_STATE);
+    std::array<XrView, 2> views = { MakeXrStruct<XrView>(XR_TYPE_VIEW), MakeXrStruct<XrView>(XR_TYPE_VIEW) };
+    uint32_t viewCount = 0;
+
+    CHECK(harness.backend->LocateViews(harness.session, &locateInfo, &viewState, 0, &viewCount, nullptr) == XR_SUCCESS);
+    CHECK(viewCount == 2);
+    CHECK(harness.backend->LocateViews(harness.session, &locateInfo, &viewState, 1, &viewCount, views.data()) == XR_ERROR_SIZE_INSUFFICIENT);
+    CHECK(harness.backend->LocateViews(harness.session, &locateInfo, &viewState, 2, &viewCount, views.data()) == XR_SUCCESS);
+
+    CHECK((viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) != 0);
+    CHECK_NEAR(views[0].pose.position.x, -0.035, 1e-5);
+    CHECK_NEAR(views[1].pose.position.x, 0.035, 1e-5);
+    CHECK_NEAR(views[1].pose.position.y, 1.6, 1e-5);
+    CHECK_NEAR(views[0].fov.angleLeft, -0.5, 1e-6);
+    CHECK_NEAR(views[0].fov.angleDown, -0.8, 1e-6);
+}
+
+TEST_CASE(MalformedLinesDontStopTheTimeline) {
+    Harness harness(
+        "# a comment\n"
+        "bogus 1 2 3\n"
+        "frame 1000\n"
+        "hand middle 0 0 0 0 0 0 1\n"
+        "bool jump maybe\n"
+        "bool jump left 1 # trailing comment\n");
+    harness.RunFrame();
+    CHECK(harness.GetBool(JUMP, LEFT_PATH).currentState == XR_TRUE);
+    CHECK(harness.runtime->unexpectedCalls == 0);
+}